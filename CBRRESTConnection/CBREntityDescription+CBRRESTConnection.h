@@ -52,11 +52,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, nullable, readonly) NSArray *stiSubentities;
 
+/**
+ Returns the first entity of `stiSubentities` whose `stiValue` equals `stiValue`. Constant time lookup for frozen entities.
+ */
+- (nullable CBREntityDescription *)stiSubentityForValue:(NSString *)stiValue;
+
 /**
  The value of `restPrefix` will be used to prefix JSON dictionaries with this prefix.
  */
 @property (nonatomic, nullable, readonly) NSString *restPrefix;
 
+/**
+ The key under which objects of this entity are sideloaded in a compound document. Set `restType` in the entities `userInfo` dictionary, defaults to the entities name.
+ */
+@property (nonatomic, readonly) NSString *restType;
+
+/**
+ Set `restFingerprint` in the entities `userInfo` dictionary to the name of a string attribute which stores a fingerprint of the last mapped cloud object and of the state it produced. Updates with an unchanged payload are skipped unless the instance was changed since.
+ */
+@property (nonatomic, nullable, readonly) NSString *restFingerprint;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -21,6 +21,8 @@
  THE SOFTWARE.
  */
 
+#import <objc/runtime.h>
+
 #import "CBREntityDescription+CBRRESTConnection.h"
 
 @implementation CBREntityDescription (CBRRESTConnection)
@@ -55,16 +57,58 @@
 
 - (NSArray *)stiSubentities
 {
+    NSArray *stiSubentities = objc_getAssociatedObject(self, _cmd);
+    if (stiSubentities) {
+        return stiSubentities;
+    }
+
     NSMutableArray *subentities = [NSMutableArray array];
     [self _dumpSTISubentitiesInArray:subentities];
+
+    if (self.isFrozen) {
+        objc_setAssociatedObject(self, _cmd, subentities.copy, OBJC_ASSOCIATION_RETAIN);
+    }
+
     return subentities.copy;
 }
 
+- (CBREntityDescription *)stiSubentityForValue:(NSString *)stiValue
+{
+    NSDictionary<NSString *, CBREntityDescription *> *stiSubentitiesByValue = objc_getAssociatedObject(self, _cmd);
+
+    if (!stiSubentitiesByValue) {
+        NSMutableDictionary<NSString *, CBREntityDescription *> *result = [NSMutableDictionary dictionary];
+        for (CBREntityDescription *subentity in self.stiSubentities) {
+            if (!result[subentity.stiValue]) {
+                result[subentity.stiValue] = subentity;
+            }
+        }
+
+        stiSubentitiesByValue = result.copy;
+
+        if (self.isFrozen) {
+            objc_setAssociatedObject(self, _cmd, stiSubentitiesByValue, OBJC_ASSOCIATION_RETAIN);
+        }
+    }
+
+    return stiSubentitiesByValue[stiValue];
+}
+
 - (NSString *)restPrefix
 {
     return self.userInfo[@"restPrefix"];
 }
 
+- (NSString *)restType
+{
+    return self.userInfo[@"restType"] ?: self.name;
+}
+
+- (NSString *)restFingerprint
+{
+    return self.userInfo[@"restFingerprint"];
+}
+
 - (void)_dumpSTISubentitiesInArray:(NSMutableArray *)subentities
 {
     for (CBREntityDescription *entity in self.subentities) {
@@ -0,0 +1,72 @@
+/**
+ CBRRESTConnection
+ Copyright (c) 2014 Oliver Letterer <oliver.letterer@gmail.com>, Sparrow-Labs
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CloudBridge/CBRPersistentObject.h>
+
+@class CBRJSONDictionaryTransformer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Maps the attributes of exactly one entity between persistent objects and cloud objects. Implementations are usually generated from the data model by `Scripts/cbr-generate-mappers` and registered with `-[CBRJSONDictionaryTransformer registerEntityMapper:forEntity:]`, which then uses them instead of its generic attribute mapping. Relationships are always mapped by the transformer.
+ */
+@protocol CBREntityMapper <NSObject>
+
+@property (nonatomic, readonly) NSString *entityName;
+
+/**
+ Cloud key path of every mapped attribute, used to verify that the mapper was generated for the property mapping of a transformer.
+ */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSString *> *cloudKeyPathsByAttributeName;
+
+/**
+ Must behave exactly like the attribute part of `-[CBRJSONDictionaryTransformer updatePersistentObject:withPropertiesFromCloudObject:]`.
+ */
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer;
+
+/**
+ Must behave exactly like the attribute part of `-[CBRJSONDictionaryTransformer updateCloudObject:withPropertiesFromPersistentObject:]`.
+ */
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer;
+
+@end
+
+/**
+ `YES` if an attribute currently holding `oldValue` needs to be updated for `cloudValue` which converts to `newValue`, `NSNull` clears the attribute.
+ */
+static inline BOOL CBREntityMapperShouldUpdateValue(id cloudValue, id _Nullable newValue, id _Nullable oldValue)
+{
+    if ([cloudValue isKindOfClass:[NSNull class]]) {
+        return oldValue != nil;
+    }
+
+    return newValue != oldValue && ![newValue isEqual:oldValue];
+}
+
+/**
+ Stores `value` in `cloudObject` under a key path that has already been split into its components, creating intermediate dictionaries.
+ */
+FOUNDATION_EXTERN void CBREntityMapperSetCloudValue(NSMutableDictionary *cloudObject, id value, NSArray<NSString *> *keys);
+
+NS_ASSUME_NONNULL_END
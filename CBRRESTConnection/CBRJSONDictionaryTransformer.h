@@ -24,9 +24,10 @@
 #import <CloudBridge/CBRPropertyMapping.h>
 #import <CloudBridge/CBRPersistentObject.h>
 #import <CloudBridge/CBRCloudObjectTransformer.h>
+#import <CloudBridge/CBREntityMapper.h>
 #import <CloudBridge/NSDictionary+CBRRESTConnection.h>
 
-@class CBRAttributeDescription;
+@class CBRAttributeDescription, CBRRelationshipDescription;
 @protocol CBRPropertyDescription;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -59,6 +60,26 @@ __attribute__((objc_subclassing_restricted))
  */
 @property (nonatomic, nullable) NSDateFormatter *dateFormatter;
 
+/**
+ Key path of the primary objects in a compound document. Defaults to `data`.
+ */
+@property (nonatomic, copy) NSString *dataKeyPath;
+
+/**
+ Key path of the sideloaded objects in a compound document, keyed by `restType`. Defaults to `included`.
+ */
+@property (nonatomic, copy) NSString *includedKeyPath;
+
+/**
+ Remembers a fingerprint of the last cloud object an instance was updated with, together with a fingerprint of the instances resulting state, and skips updates with an unchanged payload as long as the instance has not been changed or deleted since. Entities with a `restFingerprint` attribute store the fingerprint there, all others in memory alongside the instance. Objects whose references could not all be resolved are not fingerprinted. Defaults to `NO`.
+ */
+@property (nonatomic, assign) BOOL fingerprintsCloudObjects;
+
+/**
+ Maps the attributes of `entity` with `entityMapper` instead of the generic attribute mapping. Returns `NO` and ignores the mapper if its cloud key paths differ from the ones of this transformer, i.e. if it was generated for another property mapping.
+ */
+- (BOOL)registerEntityMapper:(id<CBREntityMapper>)entityMapper forEntity:(CBREntityDescription *)entity;
+
 /**
  Transforms a `NSManagedObject` instance into a `NSDictionary`.
  */
@@ -69,6 +90,11 @@ __attribute__((objc_subclassing_restricted))
  */
 - (void)updateCloudObject:(NSMutableDictionary *)cloudObject withPropertiesFromPersistentObject:(id<CBRPersistentObject>)persistentObject;
 
+/**
+ Transforms all `NSDictionary` instances of a response at once with one lookup per entity. Every compound document (`{ "data": [...], "included": { "<restType>": [...] } }`) among `cloudObjects` contributes its primary objects, its sideloaded objects are mapped first and references are resolved against them.
+ */
+- (NSArray *)persistentObjectsFromCloudObjects:(NSArray<NSDictionary *> *)cloudObjects forEntity:(CBREntityDescription *)entity;
+
 /**
  Transforms a `NSDictionary` instance into a `NSManagedObject`.
  */
@@ -100,6 +126,11 @@ __attribute__((objc_subclassing_restricted))
  */
 - (NSString *)persistentObjectKeyPathFromCloudKeyPath:(NSString *)cloudKeyPath ofEntity:(CBREntityDescription *)entity;
 
+/**
+ Returns the foreign key of a to-one relationship, found under `<relationship><RestIdentifier>` in the cloud object (e.g. `parent_id`).
+ */
+- (nullable id)primaryKeyOfRelationship:(CBRRelationshipDescription *)relationshipDescription inCloudObject:(NSDictionary *)cloudObject;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -27,6 +27,131 @@
 #import <CBREntityDescription+CBRRESTConnection.h>
 #import <CBRRelationshipDescription+CBRRESTConnection.h>
 
+#import <objc/runtime.h>
+
+/**
+ `YES` if `klass` does not override `cloudValueForKey:` and `setCloudValue:forKey:fromCloudObject:`, attributes can then be accessed through `CBRPropertyAccessor`.
+ */
+static BOOL CBRClassUsesDefaultCloudValueHooks(Class klass)
+{
+    Class prototype = [CBRPersistentObjectPrototype class];
+
+    return class_getMethodImplementation(klass, @selector(cloudValueForKey:)) == class_getMethodImplementation(prototype, @selector(cloudValueForKey:))
+        && class_getMethodImplementation(klass, @selector(setCloudValue:forKey:fromCloudObject:)) == class_getMethodImplementation(prototype, @selector(setCloudValue:forKey:fromCloudObject:));
+}
+
+static id CBRCloudObjectValueForKeyPath(NSDictionary *cloudObject, NSString *keyPath)
+{
+    if ([cloudObject isKindOfClass:[NSDictionary class]] && ![keyPath hasPrefix:@"@"] && [keyPath rangeOfString:@"."].location == NSNotFound) {
+        return cloudObject[keyPath];
+    }
+
+    return [cloudObject valueForKeyPath:keyPath];
+}
+
+static const uint64_t CBRFingerprintOffsetBasis = 14695981039346656037ULL;
+static const uint64_t CBRFingerprintPrime = 1099511628211ULL;
+
+static uint64_t CBRFingerprintBytes(uint64_t fingerprint, const void *bytes, NSUInteger length)
+{
+    const uint8_t *data = bytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        fingerprint ^= data[i];
+        fingerprint *= CBRFingerprintPrime;
+    }
+
+    return fingerprint;
+}
+
+static uint64_t CBRFingerprintString(uint64_t fingerprint, NSString *string)
+{
+    const char *UTF8String = string.UTF8String;
+    return CBRFingerprintBytes(fingerprint, UTF8String, strlen(UTF8String) + 1);
+}
+
+static uint64_t CBRFingerprintJSONObject(uint64_t fingerprint, id object, NSMapTable *fingerprints);
+
+/**
+ Dictionaries are fingerprinted on their own and mixed into their parent, `fingerprints` remembers each result so that nested objects are hashed once per mapping.
+ */
+static uint64_t CBRFingerprintJSONDictionary(NSDictionary *dictionary, NSMapTable *fingerprints)
+{
+    NSNumber *cachedFingerprint = [fingerprints objectForKey:dictionary];
+    if (cachedFingerprint) {
+        return cachedFingerprint.unsignedLongLongValue;
+    }
+
+    uint64_t fingerprint = CBRFingerprintBytes(CBRFingerprintOffsetBasis, "{", 1);
+    for (NSString *key in [dictionary.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        fingerprint = CBRFingerprintString(fingerprint, key.description);
+        fingerprint = CBRFingerprintJSONObject(fingerprint, dictionary[key], fingerprints);
+    }
+    fingerprint = CBRFingerprintBytes(fingerprint, "}", 1);
+
+    [fingerprints setObject:@(fingerprint) forKey:dictionary];
+    return fingerprint;
+}
+
+/**
+ FNV-1a over a canonical walk of a JSON object, dictionary keys are visited in sorted order.
+ */
+static uint64_t CBRFingerprintJSONObject(uint64_t fingerprint, id object, NSMapTable *fingerprints)
+{
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        uint64_t dictionaryFingerprint = CBRFingerprintJSONDictionary(object, fingerprints);
+
+        fingerprint = CBRFingerprintBytes(fingerprint, "d", 1);
+        return CBRFingerprintBytes(fingerprint, &dictionaryFingerprint, sizeof(dictionaryFingerprint));
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        fingerprint = CBRFingerprintBytes(fingerprint, "[", 1);
+
+        for (id element in object) {
+            fingerprint = CBRFingerprintJSONObject(fingerprint, element, fingerprints);
+        }
+
+        return CBRFingerprintBytes(fingerprint, "]", 1);
+    } else if ([object isKindOfClass:[NSString class]]) {
+        fingerprint = CBRFingerprintBytes(fingerprint, "s", 1);
+        return CBRFingerprintString(fingerprint, object);
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        fingerprint = CBRFingerprintBytes(fingerprint, "n", 1);
+        fingerprint = CBRFingerprintString(fingerprint, @([object objCType]).description);
+        return CBRFingerprintString(fingerprint, [object stringValue]);
+    } else if ([object isKindOfClass:[NSNull class]]) {
+        return CBRFingerprintBytes(fingerprint, "0", 1);
+    }
+
+    return CBRFingerprintString(fingerprint, [object description]);
+}
+
+/**
+ Fingerprints a value read back from a persistent object, values which are no JSON objects are hashed by their contents.
+ */
+static uint64_t CBRFingerprintPersistentValue(uint64_t fingerprint, id value)
+{
+    if ([value isKindOfClass:[NSData class]]) {
+        fingerprint = CBRFingerprintBytes(fingerprint, "b", 1);
+        return CBRFingerprintBytes(fingerprint, [value bytes], [value length]);
+    } else if ([value isKindOfClass:[NSDate class]]) {
+        NSTimeInterval timeInterval = [value timeIntervalSinceReferenceDate];
+
+        fingerprint = CBRFingerprintBytes(fingerprint, "t", 1);
+        return CBRFingerprintBytes(fingerprint, &timeInterval, sizeof(timeInterval));
+    } else if (!value) {
+        return CBRFingerprintBytes(fingerprint, "0", 1);
+    }
+
+    return CBRFingerprintJSONObject(fingerprint, value, nil);
+}
+
+
+
+@interface CBRJSONDictionaryTransformer ()
+
+@property (atomic, copy) NSDictionary<NSString *, id<CBREntityMapper>> *entityMappers;
+
+@end
+
 
 
 @implementation CBRJSONDictionaryTransformer
@@ -46,6 +171,10 @@
         _dateFormatter = [[NSDateFormatter alloc] init];
         _dateFormatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss'Z'";
         _dateFormatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+
+        _dataKeyPath = @"data";
+        _includedKeyPath = @"included";
+        _entityMappers = @{};
     }
     return self;
 }
@@ -57,6 +186,31 @@
     return entityDescription.restIdentifier;
 }
 
+- (BOOL)registerEntityMapper:(id<CBREntityMapper>)entityMapper forEntity:(CBREntityDescription *)entity
+{
+    NSParameterAssert([entityMapper.entityName isEqualToString:entity.name]);
+
+    NSMutableDictionary<NSString *, NSString *> *cloudKeyPathsByAttributeName = [NSMutableDictionary dictionary];
+    for (CBRAttributeDescription *attributeDescription in entity.attributes) {
+        if (![attributeDescription.name isEqualToString:entity.restFingerprint]) {
+            cloudKeyPathsByAttributeName[attributeDescription.name] = [self cloudKeyPathFromPropertyDescription:attributeDescription];
+        }
+    }
+
+    if (![cloudKeyPathsByAttributeName isEqualToDictionary:entityMapper.cloudKeyPathsByAttributeName]) {
+        NSLog(@"WARNING: Ignoring entity mapper %@ which doesn't match the property mapping of %@", entityMapper, self);
+        return NO;
+    }
+
+    @synchronized(self) {
+        NSMutableDictionary *entityMappers = self.entityMappers.mutableCopy;
+        entityMappers[entity.name] = entityMapper;
+        self.entityMappers = entityMappers;
+    }
+
+    return YES;
+}
+
 - (id)cloudValueFromPersistentObjectValue:(id)managedObjectValue forAttributeDescription:(CBRAttributeDescription *)attributeDescription
 {
     switch (attributeDescription.type) {
@@ -143,6 +297,22 @@
     return [self.propertyMapping persistentObjectPropertyFromCloudKeyPath:cloudKeyPath];
 }
 
+- (id)primaryKeyOfRelationship:(CBRRelationshipDescription *)relationshipDescription inCloudObject:(NSDictionary *)cloudObject
+{
+    NSParameterAssert(!relationshipDescription.toMany);
+
+    CBREntityDescription *destinationEntity = relationshipDescription.destinationEntity;
+    NSString *restIdentifier = destinationEntity.restIdentifier;
+    if (!restIdentifier || ![cloudObject isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+
+    NSString *firstLetterUppercaseString = [restIdentifier stringByReplacingCharactersInRange:NSMakeRange(0,1) withString:[restIdentifier substringToIndex:1].uppercaseString];
+    NSString *foreignKey = [self.propertyMapping cloudKeyPathFromPersistentObjectProperty:[relationshipDescription.name stringByAppendingString:firstLetterUppercaseString]];
+
+    return [self persistentObjectValueFromCloudValue:cloudObject[foreignKey] forAttributeDescription:destinationEntity.attributesByName[restIdentifier]];
+}
+
 #pragma mark - CBRManagedObjectToCloudObjectTransformer
 
 - (NSDictionary *)cloudObjectFromPersistentObject:(id<CBRPersistentObject>)persistentObject
@@ -165,40 +335,45 @@
     }
 
     CBREntityDescription *entity = persistentObject.cloudBridgeEntityDescription;
-    for (CBRAttributeDescription *attributeDescription in entity.attributes) {
-        if (attributeDescription.restDisabled) {
-            continue;
-        }
+    id<CBREntityMapper> entityMapper = self.entityMappers[entity.name];
+    if (entityMapper) {
+        [entityMapper updateCloudObject:cloudObject withAttributesFromPersistentObject:persistentObject transformer:self];
+    } else {
+        for (CBRAttributeDescription *attributeDescription in entity.attributes) {
+            if (attributeDescription.restDisabled || [attributeDescription.name isEqualToString:entity.restFingerprint]) {
+                continue;
+            }
 
-        id value = [persistentObject valueForKey:attributeDescription.name];
-        if (!value) {
-            continue;
-        }
+            id value = CBRPropertyAccessorGetValue(persistentObject, attributeDescription.name);
+            if (!value) {
+                continue;
+            }
 
-        NSString *JSONObjectKeyPath = [self cloudKeyPathFromPropertyDescription:attributeDescription];
-        id JSONObjectValue = [self cloudValueFromPersistentObjectValue:value forAttributeDescription:attributeDescription];
+            NSString *JSONObjectKeyPath = [self cloudKeyPathFromPropertyDescription:attributeDescription];
+            id JSONObjectValue = [self cloudValueFromPersistentObjectValue:value forAttributeDescription:attributeDescription];
 
-        if (!JSONObjectValue) {
-            continue;
-        }
-
-        __block NSMutableDictionary *currentDictionary = cloudObject;
+            if (!JSONObjectValue) {
+                continue;
+            }
 
-        NSArray *JSONObjectKeyPaths = [JSONObjectKeyPath componentsSeparatedByString:@"."];
-        NSUInteger count = JSONObjectKeyPaths.count;
-        [JSONObjectKeyPaths enumerateObjectsUsingBlock:^(NSString *JSONObjectKey, NSUInteger idx, BOOL *stop) {
-            if (idx == count - 1) {
-                currentDictionary[JSONObjectKey] = JSONObjectValue;
-            } else {
-                NSMutableDictionary *dictionary = currentDictionary[JSONObjectKey];
-                if (!dictionary) {
-                    dictionary = [NSMutableDictionary dictionary];
-                    currentDictionary[JSONObjectKey] = dictionary;
+            __block NSMutableDictionary *currentDictionary = cloudObject;
+
+            NSArray *JSONObjectKeyPaths = [JSONObjectKeyPath componentsSeparatedByString:@"."];
+            NSUInteger count = JSONObjectKeyPaths.count;
+            [JSONObjectKeyPaths enumerateObjectsUsingBlock:^(NSString *JSONObjectKey, NSUInteger idx, BOOL *stop) {
+                if (idx == count - 1) {
+                    currentDictionary[JSONObjectKey] = JSONObjectValue;
+                } else {
+                    NSMutableDictionary *dictionary = currentDictionary[JSONObjectKey];
+                    if (!dictionary) {
+                        dictionary = [NSMutableDictionary dictionary];
+                        currentDictionary[JSONObjectKey] = dictionary;
+                    }
+
+                    currentDictionary = dictionary;
                 }
-
-                currentDictionary = dictionary;
-            }
-        }];
+            }];
+        }
     }
 
     for (CBRRelationshipDescription *relationshipDescription in entity.relationships) {
@@ -217,7 +392,96 @@
     }
 }
 
+- (NSArray *)persistentObjectsFromCloudObjects:(NSArray *)cloudObjects forEntity:(CBREntityDescription *)entity
+{
+    NSParameterAssert(entity);
+
+    NSMutableArray *primaryCloudObjects = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSMutableArray *> *includedCloudObjects = [NSMutableDictionary dictionary];
+
+    // compound documents are recognized by their structure, a response may consist of several of them, e.g. one per page
+    for (id cloudObject in cloudObjects) {
+        if (![self _isCompoundDocument:cloudObject]) {
+            [primaryCloudObjects addObject:cloudObject];
+            continue;
+        }
+
+        id data = [cloudObject valueForKeyPath:self.dataKeyPath];
+        if ([data isKindOfClass:[NSArray class]]) {
+            [primaryCloudObjects addObjectsFromArray:data];
+        } else if (![data isKindOfClass:[NSNull class]]) {
+            [primaryCloudObjects addObject:data];
+        }
+
+        NSDictionary *included = [cloudObject valueForKeyPath:self.includedKeyPath];
+        for (NSString *type in included) {
+            if (![included[type] isKindOfClass:[NSArray class]]) {
+                NSLog(@"WARNING: Skipping included objects of type %@ which are no array", type);
+                continue;
+            }
+
+            if (!includedCloudObjects[type]) {
+                includedCloudObjects[type] = [NSMutableArray array];
+            }
+            [includedCloudObjects[type] addObjectsFromArray:included[type]];
+        }
+    }
+
+    CBRDatabaseAdapter *databaseAdapter = [NSClassFromString(entity.name) cloudBridge].databaseAdapter;
+    NSMutableDictionary<NSString *, NSMutableDictionary *> *includedObjects = [NSMutableDictionary dictionary];
+    NSMutableArray *persistentObjects = [NSMutableArray array];
+    NSMutableArray *preparedCloudObjects = [NSMutableArray array];
+
+    // sideloaded objects are inserted first so that references from the primary objects resolve against them
+    for (NSString *type in includedCloudObjects) {
+        CBREntityDescription *includedEntity = [self _entityForRestType:type inDatabaseAdapter:databaseAdapter];
+        NSArray *objects = includedCloudObjects[type];
+
+        if (!includedEntity) {
+            NSLog(@"WARNING: Skipping included objects of unknown type %@", type);
+            continue;
+        }
+
+        [self _insertCloudObjects:objects forEntity:includedEntity includedObjects:includedObjects persistentObjects:persistentObjects preparedCloudObjects:preparedCloudObjects];
+    }
+
+    NSUInteger numberOfIncludedObjects = persistentObjects.count;
+    [self _insertCloudObjects:primaryCloudObjects forEntity:entity includedObjects:includedObjects persistentObjects:persistentObjects preparedCloudObjects:preparedCloudObjects];
+    [self _prefetchObjectsReferencedByCloudObjects:preparedCloudObjects ofPersistentObjects:persistentObjects includedObjects:includedObjects];
+
+    NSMapTable *fingerprints = [self _fingerprintsTable];
+    [persistentObjects enumerateObjectsUsingBlock:^(id<CBRPersistentObject> persistentObject, NSUInteger idx, BOOL *stop) {
+        [self _updatePersistentObject:persistentObject withPropertiesFromCloudObject:preparedCloudObjects[idx] includedObjects:includedObjects fingerprints:fingerprints];
+    }];
+
+    return [persistentObjects subarrayWithRange:NSMakeRange(numberOfIncludedObjects, persistentObjects.count - numberOfIncludedObjects)];
+}
+
 - (id<CBRPersistentObject>)persistentObjectFromCloudObject:(NSDictionary *)cloudObject forEntity:(CBREntityDescription *)entity
+{
+    return [self _persistentObjectFromCloudObject:cloudObject forEntity:entity includedObjects:nil fingerprints:[self _fingerprintsTable] resolved:NULL];
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withPropertiesFromCloudObject:(NSDictionary *)cloudObject
+{
+    [self _updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject includedObjects:nil fingerprints:[self _fingerprintsTable]];
+}
+
+#pragma mark - Private category implementation ()
+
+/**
+ A compound document carries its sideloaded objects as a dictionary under `includedKeyPath` next to its primary objects under `dataKeyPath`.
+ */
+- (BOOL)_isCompoundDocument:(id)cloudObject
+{
+    if (![cloudObject isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+
+    return [[cloudObject valueForKeyPath:self.includedKeyPath] isKindOfClass:[NSDictionary class]] && [cloudObject valueForKeyPath:self.dataKeyPath] != nil;
+}
+
+- (id<CBRPersistentObject>)_persistentObjectFromCloudObject:(NSDictionary *)cloudObject forEntity:(CBREntityDescription *)entity includedObjects:(NSDictionary *)includedObjects fingerprints:(NSMapTable *)fingerprints resolved:(BOOL *)resolved
 {
     NSParameterAssert(entity);
 
@@ -247,39 +511,74 @@
         return nil;
     }
 
-    id<CBRPersistentObject> persistentObject = [[NSClassFromString(entity.name) cloudBridge].databaseAdapter persistentObjectOfType:entity withPrimaryKey:identifier];
+    id<CBRPersistentObject> persistentObject = [self _includedObjectOfType:entity withPrimaryKey:identifier includedObjects:includedObjects];
     if (!persistentObject) {
         persistentObject = [[NSClassFromString(entity.name) cloudBridge].databaseAdapter newMutablePersistentObjectOfType:entity];
         [persistentObject awakeFromCloudFetch];
     }
 
-    [self updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject];
+    BOOL objectResolved = [self _updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject includedObjects:includedObjects fingerprints:fingerprints];
+    if (resolved) {
+        *resolved = objectResolved;
+    }
+
     return persistentObject;
 }
 
-- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withPropertiesFromCloudObject:(NSDictionary *)cloudObject
+/**
+ Returns `NO` if a referenced object could not be resolved, the fingerprint is then not remembered so that the reference is retried with the next identical payload.
+ */
+- (BOOL)_updatePersistentObject:(id<CBRPersistentObject>)persistentObject withPropertiesFromCloudObject:(NSDictionary *)cloudObject includedObjects:(NSDictionary *)includedObjects fingerprints:(NSMapTable *)fingerprints
 {
+    CBREntityDescription *entity = persistentObject.cloudBridgeEntityDescription;
+
+    NSString *fingerprint = [self _fingerprintOfCloudObject:cloudObject forEntity:entity fingerprints:fingerprints];
+    if (fingerprint && [self _persistentObject:persistentObject entity:entity isUnchangedSinceFingerprint:fingerprint]) {
+        return YES;
+    }
+
+    BOOL resolved = YES;
+
     [persistentObject prepareForUpdateWithCloudObject:cloudObject];
 
-    CBREntityDescription *entity = persistentObject.cloudBridgeEntityDescription;
-    for (CBRAttributeDescription *attributeDescription in entity.attributes) {
-        id jsonValue = [cloudObject valueForKeyPath:[self cloudKeyPathFromPropertyDescription:attributeDescription]];
-        id newValue = [self persistentObjectValueFromCloudValue:jsonValue forAttributeDescription:attributeDescription];
-        id oldValue = [persistentObject cloudValueForKey:attributeDescription.name];
+    Class persistentObjectClass = object_getClass(persistentObject);
+    BOOL usesDefaultCloudValueHooks = CBRClassUsesDefaultCloudValueHooks(persistentObjectClass);
 
-        if (!jsonValue) {
-            continue;
-        }
+    // generated mappers access attributes directly and therefore only replace the default hooks
+    id<CBREntityMapper> entityMapper = usesDefaultCloudValueHooks && [cloudObject isKindOfClass:[NSDictionary class]] ? self.entityMappers[entity.name] : nil;
+    if (entityMapper) {
+        [entityMapper updatePersistentObject:persistentObject withAttributesFromCloudObject:cloudObject transformer:self];
+    } else {
+        for (CBRAttributeDescription *attributeDescription in entity.attributes) {
+            if ([attributeDescription.name isEqualToString:entity.restFingerprint]) {
+                continue;
+            }
 
-        if ([jsonValue isKindOfClass:[NSNull class]]) {
-            if (oldValue) {
-                [persistentObject setCloudValue:nil forKey:attributeDescription.name fromCloudObject:cloudObject];
+            id jsonValue = CBRCloudObjectValueForKeyPath(cloudObject, [self cloudKeyPathFromPropertyDescription:attributeDescription]);
+            if (!jsonValue) {
+                continue;
             }
-            continue;
-        }
 
-        if (![newValue isEqual:oldValue] && newValue != oldValue) {
-            [persistentObject setCloudValue:newValue forKey:attributeDescription.name fromCloudObject:cloudObject];
+            CBRPropertyAccessor *accessor = usesDefaultCloudValueHooks ? [CBRPropertyAccessor accessorForClass:persistentObjectClass key:attributeDescription.name] : nil;
+
+            id newValue = [self persistentObjectValueFromCloudValue:jsonValue forAttributeDescription:attributeDescription];
+            id oldValue = accessor ? [accessor valueOfObject:persistentObject] : [persistentObject cloudValueForKey:attributeDescription.name];
+
+            if ([jsonValue isKindOfClass:[NSNull class]]) {
+                newValue = nil;
+
+                if (!oldValue) {
+                    continue;
+                }
+            } else if ([newValue isEqual:oldValue] || newValue == oldValue) {
+                continue;
+            }
+
+            if (accessor) {
+                [accessor setValue:newValue ofObject:persistentObject];
+            } else {
+                [persistentObject setCloudValue:newValue forKey:attributeDescription.name fromCloudObject:cloudObject];
+            }
         }
     }
 
@@ -287,27 +586,19 @@
         CBREntityDescription *destinationEntity = relationshipDescription.destinationEntity;
         NSString *restKeyPath = [self cloudKeyPathFromPropertyDescription:relationshipDescription];
 
-        if ([relationshipDescription.name isEqualToString:@"children"]) {
-            NSLog(@"");
-        }
-
         if (!relationshipDescription.toMany) {
             // map destination_entity_id to destinationEntity
-            NSString *restIdentifier = destinationEntity.restIdentifier;
-            if (!restIdentifier) {
+            if (!destinationEntity.restIdentifier) {
                 continue;
             }
 
-            NSString *firstLetterUppercaseString = [restIdentifier stringByReplacingCharactersInRange:NSMakeRange(0,1) withString:[restIdentifier substringToIndex:1].uppercaseString];
-            restIdentifier = [self.propertyMapping cloudKeyPathFromPersistentObjectProperty:[relationshipDescription.name stringByAppendingString:firstLetterUppercaseString]];
-
-            id jsonIdentifier = cloudObject[restIdentifier];
-            id identifier = [self persistentObjectValueFromCloudValue:jsonIdentifier forAttributeDescription:destinationEntity.attributesByName[destinationEntity.restIdentifier]];
-
+            id identifier = [self primaryKeyOfRelationship:relationshipDescription inCloudObject:cloudObject];
             if (identifier) {
-                id<CBRPersistentObject> newPersistentObject = [[NSClassFromString(destinationEntity.name) cloudBridge].databaseAdapter persistentObjectOfType:destinationEntity withPrimaryKey:identifier];
+                id<CBRPersistentObject> newPersistentObject = [self _includedObjectOfType:destinationEntity withPrimaryKey:identifier includedObjects:includedObjects];
                 if (newPersistentObject) {
                     [persistentObject setValue:newPersistentObject forKey:relationshipDescription.name];
+                } else {
+                    resolved = NO;
                 }
             }
         }
@@ -343,11 +634,15 @@
             NSDictionary *existingObjectsByPrimaryKey = [[NSClassFromString(destinationEntity.name) cloudBridge].databaseAdapter indexedObjectsOfType:destinationEntity withValues:uniqueIdentifiers forAttribute:primaryKey];
 
             id relationshipObjects = [persistentObject valueForKey:relationshipDescription.name];
-            id enumartionObjects = [relationshipObjects conformsToProtocol:@protocol(NSCopying)] ? [relationshipObjects copy] : relationshipObjects;
-            for (id oldPersistentObject in enumartionObjects) {
-                [oldPersistentObject setValue:nil forKey:relationshipDescription.inverseRelationship.name];
+
+            // only detach children which disappeared and attach new ones, unchanged children are left untouched
+            NSMutableSet *removedPersistentObjects = [NSMutableSet set];
+            for (id oldPersistentObject in relationshipObjects) {
+                [removedPersistentObjects addObject:oldPersistentObject];
             }
 
+            NSMutableSet *addedPersistentObjects = [NSMutableSet set];
+
             for (NSDictionary *dictionary in cloudObjects) {
                 if (![dictionary isKindOfClass:[NSDictionary class]]) {
                     continue;
@@ -361,36 +656,326 @@
                     [newPersistentObject awakeFromCloudFetch];
                 }
 
-                [self updatePersistentObject:newPersistentObject withPropertiesFromCloudObject:dictionary];
-                [newPersistentObject setValue:persistentObject forKey:relationshipDescription.inverseRelationship.name];
+                resolved &= [self _updatePersistentObject:newPersistentObject withPropertiesFromCloudObject:dictionary includedObjects:includedObjects fingerprints:fingerprints];
+
+                if ([removedPersistentObjects containsObject:newPersistentObject]) {
+                    [removedPersistentObjects removeObject:newPersistentObject];
+                } else {
+                    [addedPersistentObjects addObject:newPersistentObject];
+                }
+            }
+
+            if (removedPersistentObjects.count == 0 && addedPersistentObjects.count == 0) {
+                continue;
+            }
+
+            if ([relationshipObjects isKindOfClass:[NSSet class]]) {
+                NSMutableSet *mutableRelationshipObjects = [(id)persistentObject mutableSetValueForKey:relationshipDescription.name];
+                [mutableRelationshipObjects minusSet:removedPersistentObjects];
+                [mutableRelationshipObjects unionSet:addedPersistentObjects];
+            } else {
+                for (id oldPersistentObject in removedPersistentObjects) {
+                    [oldPersistentObject setValue:nil forKey:relationshipDescription.inverseRelationship.name];
+                }
+
+                for (id newPersistentObject in addedPersistentObjects) {
+                    [newPersistentObject setValue:persistentObject forKey:relationshipDescription.inverseRelationship.name];
+                }
             }
         } else {
             if (![relationshipObject isKindOfClass:[NSDictionary class]]) {
                 continue;
             }
 
-            id<CBRPersistentObject> newPersistentObject = [self persistentObjectFromCloudObject:relationshipObject forEntity:destinationEntity];
+            BOOL relationshipResolved = YES;
+            id<CBRPersistentObject> newPersistentObject = [self _persistentObjectFromCloudObject:relationshipObject forEntity:destinationEntity includedObjects:includedObjects fingerprints:fingerprints resolved:&relationshipResolved];
             if (newPersistentObject) {
                 [persistentObject setValue:newPersistentObject forKey:relationshipDescription.name];
             }
+
+            resolved &= relationshipResolved;
         }
     }
 
     [persistentObject finalizeUpdateWithCloudObject:cloudObject];
+
+    if (fingerprint) {
+        // an unresolved reference must not be skipped once its destination got synced
+        // the state is recorded alongside so that local edits, merges and refaults invalidate the fingerprint
+        NSString *recordedFingerprint = [fingerprint stringByAppendingString:[self _stateFingerprintOfPersistentObject:persistentObject entity:entity]];
+        [self _setFingerprint:resolved ? recordedFingerprint : nil ofPersistentObject:persistentObject entity:entity];
+    }
+
+    return resolved;
 }
 
-#pragma mark - Private category implementation ()
+- (NSMapTable *)_fingerprintsTable
+{
+    // keys are retained for the duration of a mapping, so their pointers identify them
+    return [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory capacity:0];
+}
+
+- (NSString *)_fingerprintOfCloudObject:(NSDictionary *)cloudObject forEntity:(CBREntityDescription *)entity fingerprints:(NSMapTable *)fingerprints
+{
+    if (!entity.restFingerprint && !self.fingerprintsCloudObjects) {
+        return nil;
+    }
+
+    uint64_t fingerprint = [cloudObject isKindOfClass:[NSDictionary class]] ? CBRFingerprintJSONDictionary(cloudObject, fingerprints) : CBRFingerprintJSONObject(CBRFingerprintOffsetBasis, cloudObject, fingerprints);
+    return [NSString stringWithFormat:@"%016llx", fingerprint];
+}
+
+/**
+ Returns `YES` if `persistentObject` was last updated with a cloud object of `fingerprint` and has not been changed, deleted or reloaded with different values since.
+ */
+- (BOOL)_persistentObject:(id<CBRPersistentObject>)persistentObject entity:(CBREntityDescription *)entity isUnchangedSinceFingerprint:(NSString *)fingerprint
+{
+    NSString *recordedFingerprint = [self _fingerprintOfPersistentObject:persistentObject entity:entity];
+    if (recordedFingerprint.length != fingerprint.length * 2 || ![recordedFingerprint hasPrefix:fingerprint]) {
+        return NO;
+    }
+
+    if ([persistentObject respondsToSelector:@selector(isDeleted)] && [(id)persistentObject isDeleted]) {
+        return NO;
+    }
+
+    if ([persistentObject respondsToSelector:@selector(isInvalidated)] && [(id)persistentObject isInvalidated]) {
+        return NO;
+    }
+
+    return [[recordedFingerprint substringFromIndex:fingerprint.length] isEqualToString:[self _stateFingerprintOfPersistentObject:persistentObject entity:entity]];
+}
+
+/**
+ Fingerprints the current attribute values and relationship destinations of `persistentObject`, destinations are identified by their primary key.
+ */
+- (NSString *)_stateFingerprintOfPersistentObject:(id<CBRPersistentObject>)persistentObject entity:(CBREntityDescription *)entity
+{
+    uint64_t fingerprint = CBRFingerprintOffsetBasis;
+
+    for (CBRAttributeDescription *attributeDescription in entity.attributes) {
+        if ([attributeDescription.name isEqualToString:entity.restFingerprint]) {
+            continue;
+        }
+
+        fingerprint = CBRFingerprintString(fingerprint, attributeDescription.name);
+        fingerprint = CBRFingerprintPersistentValue(fingerprint, CBRPropertyAccessorGetValue(persistentObject, attributeDescription.name));
+    }
+
+    for (CBRRelationshipDescription *relationshipDescription in entity.relationships) {
+        NSString *primaryKey = relationshipDescription.destinationEntity.restIdentifier;
+        if (!primaryKey) {
+            continue;
+        }
+
+        fingerprint = CBRFingerprintString(fingerprint, relationshipDescription.name);
+
+        id relationshipObject = [persistentObject valueForKey:relationshipDescription.name];
+        if (!relationshipDescription.toMany) {
+            fingerprint = CBRFingerprintPersistentValue(fingerprint, relationshipObject ? CBRPropertyAccessorGetValue(relationshipObject, primaryKey) : nil);
+            continue;
+        }
+
+        // to many relationships are unordered, destinations are combined independent of their order
+        uint64_t destinationsFingerprint = 0;
+        NSUInteger count = 0;
+        for (id destination in relationshipObject) {
+            destinationsFingerprint ^= CBRFingerprintPersistentValue(CBRFingerprintOffsetBasis, CBRPropertyAccessorGetValue(destination, primaryKey));
+            count++;
+        }
+
+        fingerprint = CBRFingerprintBytes(fingerprint, &count, sizeof(count));
+        fingerprint = CBRFingerprintBytes(fingerprint, &destinationsFingerprint, sizeof(destinationsFingerprint));
+    }
+
+    return [NSString stringWithFormat:@"%016llx", fingerprint];
+}
+
+- (NSString *)_fingerprintOfPersistentObject:(id<CBRPersistentObject>)persistentObject entity:(CBREntityDescription *)entity
+{
+    if (entity.restFingerprint) {
+        return CBRPropertyAccessorGetValue(persistentObject, entity.restFingerprint);
+    }
+
+    return objc_getAssociatedObject(persistentObject, @selector(_fingerprintOfPersistentObject:entity:));
+}
+
+- (void)_setFingerprint:(NSString *)fingerprint ofPersistentObject:(id<CBRPersistentObject>)persistentObject entity:(CBREntityDescription *)entity
+{
+    if (entity.restFingerprint) {
+        id oldFingerprint = CBRPropertyAccessorGetValue(persistentObject, entity.restFingerprint);
+        if (fingerprint != oldFingerprint && ![fingerprint isEqual:oldFingerprint]) {
+            CBRPropertyAccessorSetValue(persistentObject, fingerprint, entity.restFingerprint);
+        }
+        return;
+    }
+
+    objc_setAssociatedObject(persistentObject, @selector(_fingerprintOfPersistentObject:entity:), fingerprint, OBJC_ASSOCIATION_COPY_NONATOMIC);
+}
+
+- (id<CBRPersistentObject>)_includedObjectOfType:(CBREntityDescription *)entity withPrimaryKey:(id)primaryKey includedObjects:(NSDictionary *)includedObjects
+{
+    id includedObject = includedObjects[entity.name][primaryKey];
+    if (includedObject) {
+        return includedObject == [NSNull null] ? nil : includedObject;
+    }
+
+    return [[NSClassFromString(entity.name) cloudBridge].databaseAdapter persistentObjectOfType:entity withPrimaryKey:primaryKey];
+}
+
+- (void)_insertCloudObjects:(NSArray *)cloudObjects
+                  forEntity:(CBREntityDescription *)entity
+            includedObjects:(NSMutableDictionary<NSString *, NSMutableDictionary *> *)includedObjects
+          persistentObjects:(NSMutableArray *)persistentObjects
+       preparedCloudObjects:(NSMutableArray *)preparedCloudObjects
+{
+    CBRDatabaseAdapter *databaseAdapter = [NSClassFromString(entity.name) cloudBridge].databaseAdapter;
+
+    NSMutableArray *entities = [NSMutableArray array];
+    NSMutableArray *identifiers = [NSMutableArray array];
+    NSMutableArray *objects = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSMutableSet *> *identifiersByEntity = [NSMutableDictionary dictionary];
+
+    for (NSDictionary *rawCloudObject in cloudObjects) {
+        NSDictionary *cloudObject = rawCloudObject;
+        CBREntityDescription *concreteEntity = entity;
+
+        if (concreteEntity.restPrefix && [cloudObject isKindOfClass:[NSDictionary class]]) {
+            cloudObject = cloudObject[concreteEntity.restPrefix] ?: cloudObject;
+        }
+
+        cloudObject = (NSDictionary *)[NSClassFromString(concreteEntity.name) prepareForUpdateWithCloudObject:cloudObject];
+        if (![cloudObject isKindOfClass:[NSDictionary class]]) {
+            NSLog(@"WARNING: JSON Object is not a NSDictionary (%@)", cloudObject);
+            continue;
+        }
+
+        CBREntityDescription *stiEntity = [self _stiEntityForEntity:concreteEntity cloudObject:cloudObject];
+        if (stiEntity != concreteEntity) {
+            concreteEntity = stiEntity;
+            cloudObject = (NSDictionary *)[NSClassFromString(concreteEntity.name) prepareForUpdateWithCloudObject:cloudObject];
+        }
+
+        CBRAttributeDescription *identifierAttribute = concreteEntity.attributesByName[concreteEntity.restIdentifier];
+        id jsonIdentifier = cloudObject[[self cloudKeyPathFromPropertyDescription:identifierAttribute]];
+        id identifier = [self persistentObjectValueFromCloudValue:jsonIdentifier forAttributeDescription:identifierAttribute] ?: jsonIdentifier;
+
+        if (!identifier || [identifier isEqual:[NSNull null]]) {
+            NSLog(@"WARNING: JSON Object did not have an id (%@)", cloudObject);
+            continue;
+        }
+
+        [entities addObject:concreteEntity];
+        [identifiers addObject:identifier];
+        [objects addObject:cloudObject];
+
+        if (!includedObjects[concreteEntity.name][identifier]) {
+            NSMutableSet *entityIdentifiers = identifiersByEntity[concreteEntity.name] ?: [NSMutableSet set];
+            identifiersByEntity[concreteEntity.name] = entityIdentifiers;
+            [entityIdentifiers addObject:identifier];
+        }
+    }
+
+    // one lookup per entity instead of one per object
+    for (NSString *entityName in identifiersByEntity) {
+        CBREntityDescription *concreteEntity = databaseAdapter.entitiesByName[entityName];
+        NSDictionary *existingObjects = [databaseAdapter indexedObjectsOfType:concreteEntity withValues:identifiersByEntity[entityName] forAttribute:concreteEntity.restIdentifier];
+
+        NSMutableDictionary *index = includedObjects[entityName] ?: [NSMutableDictionary dictionary];
+        includedObjects[entityName] = index;
+        [index addEntriesFromDictionary:existingObjects];
+    }
+
+    [objects enumerateObjectsUsingBlock:^(NSDictionary *cloudObject, NSUInteger idx, BOOL *stop) {
+        CBREntityDescription *concreteEntity = entities[idx];
+        id identifier = identifiers[idx];
+
+        NSMutableDictionary *index = includedObjects[concreteEntity.name] ?: [NSMutableDictionary dictionary];
+        includedObjects[concreteEntity.name] = index;
+
+        id<CBRPersistentObject> persistentObject = index[identifier];
+        if (!persistentObject || persistentObject == (id)[NSNull null]) {
+            persistentObject = [databaseAdapter newMutablePersistentObjectOfType:concreteEntity];
+            [persistentObject awakeFromCloudFetch];
+
+            index[identifier] = persistentObject;
+        }
+
+        if (concreteEntity != entity) {
+            NSMutableDictionary *baseIndex = includedObjects[entity.name] ?: [NSMutableDictionary dictionary];
+            includedObjects[entity.name] = baseIndex;
+            baseIndex[identifier] = persistentObject;
+        }
+
+        [persistentObjects addObject:persistentObject];
+        [preparedCloudObjects addObject:cloudObject];
+    }];
+}
+
+- (void)_prefetchObjectsReferencedByCloudObjects:(NSArray *)cloudObjects
+                             ofPersistentObjects:(NSArray *)persistentObjects
+                                 includedObjects:(NSMutableDictionary<NSString *, NSMutableDictionary *> *)includedObjects
+{
+    NSMutableDictionary<NSString *, NSMutableSet *> *identifiersByEntity = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, CBREntityDescription *> *entitiesByName = [NSMutableDictionary dictionary];
+
+    [cloudObjects enumerateObjectsUsingBlock:^(NSDictionary *cloudObject, NSUInteger idx, BOOL *stop) {
+        CBREntityDescription *entity = [persistentObjects[idx] cloudBridgeEntityDescription];
+
+        for (CBRRelationshipDescription *relationshipDescription in entity.relationships) {
+            CBREntityDescription *destinationEntity = relationshipDescription.destinationEntity;
+            if (relationshipDescription.toMany || !destinationEntity.restIdentifier) {
+                continue;
+            }
+
+            id identifier = [self primaryKeyOfRelationship:relationshipDescription inCloudObject:cloudObject];
+            if (!identifier || includedObjects[destinationEntity.name][identifier]) {
+                continue;
+            }
+
+            NSMutableSet *identifiers = identifiersByEntity[destinationEntity.name] ?: [NSMutableSet set];
+            identifiersByEntity[destinationEntity.name] = identifiers;
+            entitiesByName[destinationEntity.name] = destinationEntity;
+            [identifiers addObject:identifier];
+        }
+    }];
+
+    for (NSString *entityName in identifiersByEntity) {
+        CBREntityDescription *entity = entitiesByName[entityName];
+        CBRDatabaseAdapter *databaseAdapter = [NSClassFromString(entity.name) cloudBridge].databaseAdapter;
+        NSDictionary *existingObjects = [databaseAdapter indexedObjectsOfType:entity withValues:identifiersByEntity[entityName] forAttribute:entity.restIdentifier];
+
+        NSMutableDictionary *index = includedObjects[entityName] ?: [NSMutableDictionary dictionary];
+        includedObjects[entityName] = index;
+
+        for (id identifier in identifiersByEntity[entityName]) {
+            // remember misses so that they are not looked up again one by one
+            index[identifier] = existingObjects[identifier] ?: [NSNull null];
+        }
+    }
+}
+
+- (CBREntityDescription *)_entityForRestType:(NSString *)type inDatabaseAdapter:(CBRDatabaseAdapter *)databaseAdapter
+{
+    for (CBREntityDescription *entity in databaseAdapter.entities) {
+        if ([entity.restType isEqualToString:type]) {
+            return entity;
+        }
+    }
+
+    return nil;
+}
 
 - (CBREntityDescription *)_stiEntityForEntity:(CBREntityDescription *)entity cloudObject:(NSDictionary *)cloudObject
 {
     if (entity.stiKeyPath) {
         NSString *restKeyPath = [self.propertyMapping cloudKeyPathFromPersistentObjectProperty:entity.stiKeyPath];
-        NSString *stringToMatch = [NSString stringWithFormat:@"%@", [cloudObject valueForKeyPath:restKeyPath]];
+        id value = [cloudObject valueForKeyPath:restKeyPath];
+        NSString *stringToMatch = [value isKindOfClass:[NSString class]] ? value : [NSString stringWithFormat:@"%@", value];
 
-        for (CBREntityDescription *subentity in entity.stiSubentities) {
-            if ([stringToMatch isEqualToString:subentity.stiValue]) {
-                return [self _stiEntityForEntity:subentity cloudObject:cloudObject];
-            }
+        CBREntityDescription *subentity = [entity stiSubentityForValue:stringToMatch];
+        if (subentity) {
+            return [self _stiEntityForEntity:subentity cloudObject:cloudObject];
         }
     }
 
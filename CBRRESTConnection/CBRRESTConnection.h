@@ -28,6 +28,7 @@
 #import <CloudBridge/CBRIdentityPropertyMapping.h>
 #import <CloudBridge/CBRUnderscoredPropertyMapping.h>
 
+#import <CloudBridge/CBREntityMapper.h>
 #import <CloudBridge/CBRJSONDictionaryTransformer.h>
 #import <CloudBridge/NSDictionary+CBRRESTConnection.h>
 #import <CloudBridge/CBREntityDescription+CBRRESTConnection.h>
@@ -48,6 +49,11 @@ NS_ASSUME_NONNULL_BEGIN
 
 extern NSString * const CBRRESTConnectionUserInfoURLOverrideKey;
 
+/**
+ Overrides the query parameter which carries the parent identifiers of a batched relationship fetch, e.g. `parent_ids=1,2,3`.
+ */
+extern NSString * const CBRRESTConnectionUserInfoBatchParameterKey;
+
 
 
 /**
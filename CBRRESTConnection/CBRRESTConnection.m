@@ -26,8 +26,10 @@
 
 #import <CBRUnderscoredPropertyMapping.h>
 #import <CBREntityDescription+CBRRESTConnection.h>
+#import <CBRInstrumentation.h>
 
 NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
+NSString * const CBRRESTConnectionUserInfoBatchParameterKey = @"restBatchParameter";
 
 
 
@@ -94,9 +96,12 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
         }
     };
 
+    NSTimeInterval start = CBRInstrumentationTimestamp();
     [self.sessionManager GET:path parameters:parameters progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nullable responseObject) {
+        [self _recordMetricsOfTask:task since:start failed:NO];
         successHandler(responseObject);
     } failure:^(NSURLSessionDataTask * _Nullable task, NSError * _Nonnull error) {
+        [self _recordMetricsOfTask:task since:start failed:YES];
         errorHandler(error);
     }];
 }
@@ -154,7 +159,7 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
                           userInfo:(NSDictionary *)userInfo
                  completionHandler:(void (^)(NSArray *, NSError *))completionHandler
 {
-    _CBRRESTConnectionFetchQuery *query = [self _parsePredicate:predicate ofEntity:entity];
+    _CBRRESTConnectionFetchQuery *query = [self _parsePredicate:predicate ofEntity:entity userInfo:userInfo];
 
     if (userInfo[CBRRESTConnectionUserInfoURLOverrideKey]) {
         query.path = userInfo[CBRRESTConnectionUserInfoURLOverrideKey];
@@ -179,9 +184,12 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
         }
     };
 
+    NSTimeInterval start = CBRInstrumentationTimestamp();
     [self.sessionManager POST:path parameters:cloudObject progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
+        [self _recordMetricsOfTask:task since:start failed:NO];
         successHandler(responseObject);
     } failure:^(NSURLSessionDataTask * _Nonnull task, NSError * _Nonnull error) {
+        [self _recordMetricsOfTask:task since:start failed:YES];
         errorHandler(error);
     }];
 }
@@ -202,9 +210,12 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
         }
     };
 
+    NSTimeInterval start = CBRInstrumentationTimestamp();
     [self.sessionManager GET:path parameters:nil progress:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
+        [self _recordMetricsOfTask:task since:start failed:NO];
         successHandler(responseObject);
     } failure:^(NSURLSessionDataTask * _Nonnull task, NSError * _Nonnull error) {
+        [self _recordMetricsOfTask:task since:start failed:YES];
         errorHandler(error);
     }];
 }
@@ -225,9 +236,12 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
         }
     };
 
+    NSTimeInterval start = CBRInstrumentationTimestamp();
     [self.sessionManager PUT:path parameters:cloudObject success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
+        [self _recordMetricsOfTask:task since:start failed:NO];
         successHandler(responseObject);
     } failure:^(NSURLSessionDataTask * _Nonnull task, NSError * _Nonnull error) {
+        [self _recordMetricsOfTask:task since:start failed:YES];
         errorHandler(error);
     }];
 }
@@ -248,15 +262,37 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
         }
     };
 
+    NSTimeInterval start = CBRInstrumentationTimestamp();
     [self.sessionManager DELETE:path parameters:nil success:^(NSURLSessionDataTask * _Nonnull task, id  _Nonnull responseObject) {
+        [self _recordMetricsOfTask:task since:start failed:NO];
         successHandler(responseObject);
     } failure:^(NSURLSessionDataTask * _Nonnull task, NSError * _Nonnull error) {
+        [self _recordMetricsOfTask:task since:start failed:YES];
         errorHandler(error);
     }];
 }
 
 #pragma mark - Private category implementation ()
 
+- (void)_recordMetricsOfTask:(NSURLSessionTask *)task since:(NSTimeInterval)start failed:(BOOL)failed
+{
+    id<CBRInstrumentation> instrumentation = CBRInstrumentationGetCurrent();
+    if (!instrumentation) {
+        return;
+    }
+
+    [instrumentation recordValue:CBRInstrumentationTimestamp() - start forMetric:CBRMetricRequestDuration];
+
+    if (task) {
+        [instrumentation recordValue:task.countOfBytesSent forMetric:CBRMetricRequestBytesSent];
+        [instrumentation recordValue:task.countOfBytesReceived forMetric:CBRMetricRequestBytesReceived];
+    }
+
+    if (failed) {
+        [instrumentation incrementCounter:CBRCounterRequestFailures by:1];
+    }
+}
+
 - (NSString *)_CRUDPathForPersistentObject:(id<CBRPersistentObject>)persistentObject userInfo:(NSDictionary *)userInfo appendIdentifier:(BOOL)appendIdentifier
 {
     NSString *path = userInfo[CBRRESTConnectionUserInfoURLOverrideKey];
@@ -275,7 +311,7 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
     return [self pathBySubstitutingParametersInPath:path fromPersistentObject:persistentObject];
 }
 
-- (_CBRRESTConnectionFetchQuery *)_parsePredicate:(NSPredicate *)predicate ofEntity:(CBREntityDescription *)entityDescription
+- (_CBRRESTConnectionFetchQuery *)_parsePredicate:(NSPredicate *)predicate ofEntity:(CBREntityDescription *)entityDescription userInfo:(NSDictionary *)userInfo
 {
     NSParameterAssert(entityDescription);
 
@@ -292,11 +328,38 @@ NSString * const CBRRESTConnectionUserInfoURLOverrideKey = @"restBaseURL";
     }
 
     void(^parseComparisonPredicate)(NSComparisonPredicate *comparisonPredicate) = ^(NSComparisonPredicate *comparisonPredicate) {
-        NSParameterAssert(comparisonPredicate.predicateOperatorType == NSEqualToPredicateOperatorType);
+        NSParameterAssert(comparisonPredicate.predicateOperatorType == NSEqualToPredicateOperatorType || comparisonPredicate.predicateOperatorType == NSInPredicateOperatorType);
         NSParameterAssert(comparisonPredicate.leftExpression.keyPath);
         NSParameterAssert(comparisonPredicate.rightExpression.constantValue);
 
-        if ([comparisonPredicate.rightExpression.constantValue conformsToProtocol:@protocol(CBRPersistentObject)]) {
+        if (comparisonPredicate.predicateOperatorType == NSInPredicateOperatorType) {
+            NSAssert(hasFoundRelationship == NO, @"only one relationship is supported.");
+            hasFoundRelationship = YES;
+
+            CBRRelationshipDescription *relationshipDescription = entityDescription.relationshipsByName[comparisonPredicate.leftExpression.keyPath];
+            NSParameterAssert(relationshipDescription);
+            NSParameterAssert(!relationshipDescription.toMany);
+
+            NSString *primaryKey = [self.objectTransformer primaryKeyOfEntitiyDescription:relationshipDescription.destinationEntity];
+            NSMutableArray *identifiers = [NSMutableArray array];
+
+            for (id<CBRPersistentObject> persistentObject in comparisonPredicate.rightExpression.constantValue) {
+                NSParameterAssert([persistentObject conformsToProtocol:@protocol(CBRPersistentObject)]);
+
+                id identifier = [persistentObject valueForKey:primaryKey];
+                if (identifier) {
+                    [identifiers addObject:identifier];
+                }
+            }
+
+            NSString *parameterName = userInfo[CBRRESTConnectionUserInfoBatchParameterKey] ?: relationshipDescription.restBatchParameter ?: relationshipDescription.inverseRelationship.restBatchParameter;
+            if (!parameterName) {
+                parameterName = [self.propertyMapping cloudKeyPathFromPersistentObjectProperty:[relationshipDescription.name stringByAppendingString:@"Ids"]];
+            }
+
+            NSAssert1(path != nil || userInfo[CBRRESTConnectionUserInfoURLOverrideKey] != nil, @"restBaseURL not found for entity %@", entityDescription);
+            parameters[parameterName] = [identifiers componentsJoinedByString:@","];
+        } else if ([comparisonPredicate.rightExpression.constantValue conformsToProtocol:@protocol(CBRPersistentObject)]) {
             NSAssert(hasFoundRelationship == NO, @"only one relationship is supported.");
             hasFoundRelationship = YES;
 
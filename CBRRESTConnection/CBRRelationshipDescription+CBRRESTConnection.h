@@ -47,6 +47,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, nullable, readonly) NSString *restIncluded;
 
+/**
+ Add `restBatchParameter` to the to-one relationship's `userInfo` dictionary to name the query parameter used when fetching objects for multiple parents at once. Defaults to `<relationship>_ids` according to the property mapping.
+ */
+@property (nonatomic, nullable, readonly) NSString *restBatchParameter;
+
 @end
 
 NS_ASSUME_NONNULL_END
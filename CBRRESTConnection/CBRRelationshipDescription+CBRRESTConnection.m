@@ -45,4 +45,9 @@
     return self.userInfo[@"restIncluded"];
 }
 
+- (NSString *)restBatchParameter
+{
+    return self.userInfo[@"restBatchParameter"];
+}
+
 @end
@@ -173,7 +173,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
     if (self = [super init]) {
         [[self.class propertyClassMapping] enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, Class  _Nonnull obj, BOOL * _Nonnull stop) {
             if (obj == [NSDate class] || [obj isKindOfClass:[NSDate class]]) {
-                [self setValue:[NSDate date] forKey:key];
+                CBRPropertyAccessorSetValue(self, [NSDate date], key);
             }
         }];
     }
@@ -197,7 +197,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
     id copy = [[self.class allocWithZone:zone] init];
 
     for (NSString *property in [self.class serializableProperties]) {
-        [copy setValue:[self valueForKey:property] forKey:property];
+        CBRPropertyAccessorSetValue(copy, CBRPropertyAccessorGetValue(self, property), property);
     }
 
     return copy;
@@ -211,9 +211,9 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
 
     [[self.class serializableProperties] enumerateObjectsUsingBlock:^(NSString *property, NSUInteger idx, BOOL *stop) {
         if (idx == 0) {
-            [description appendFormat:@"%@ => %@", property, [self valueForKey:property]];
+            [description appendFormat:@"%@ => %@", property, CBRPropertyAccessorGetValue(self, property)];
         } else {
-            [description appendFormat:@", %@ => %@", property, [self valueForKey:property]];
+            [description appendFormat:@", %@ => %@", property, CBRPropertyAccessorGetValue(self, property)];
         }
     }];
 
@@ -235,7 +235,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
         for (NSString *property in propertyClassMapping) {
             Class class = propertyClassMapping[property];
 
-            [self setValue:[aDecoder decodeObjectOfClass:class forKey:property] forKey:property];
+            CBRPropertyAccessorSetValue(self, [aDecoder decodeObjectOfClass:class forKey:property], property);
         }
     }
     return self;
@@ -246,7 +246,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
     NSArray<NSString *> *serializableProperties = [self.class serializableProperties];
 
     for (NSString *property in serializableProperties) {
-        [aCoder encodeObject:[self valueForKey:property] forKey:property];
+        [aCoder encodeObject:CBRPropertyAccessorGetValue(self, property) forKey:property];
     }
 }
 
@@ -258,7 +258,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
     CBRRESTConnection *connection = [self.class restConnection];
 
     for (NSString *property in serializableProperties) {
-        id value = [self valueForKey:property];
+        id value = CBRPropertyAccessorGetValue(self, property);
         NSString *jsonProperty = [connection.propertyMapping cloudKeyPathFromPersistentObjectProperty:property];
         result[jsonProperty] = encodeJsonValue(value, connection) ?: [NSNull null];
     }
@@ -297,7 +297,7 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
             }
 
             id nextValue = [[expectedClass alloc] initWithDictionary:value error:error];
-            [self setValue:nextValue forKey:property];
+            CBRPropertyAccessorSetValue(self, nextValue, property);
         } else if ([expectedClass isSubclassOfClass:[NSArray class]]) {
             if (![value isKindOfClass:[NSArray class]]) {
                 continue;
@@ -316,19 +316,19 @@ static id encodeJsonValue(id value, CBRRESTConnection *connection)
                     }
                 }
             }
-            [self setValue:result forKey:property];
+            CBRPropertyAccessorSetValue(self, result, property);
         } else if ([expectedClass isSubclassOfClass:[NSDate class]]) {
             if (![value isKindOfClass:[NSString class]]) {
                 continue;
             }
 
-            [self setValue:[dateFormatter dateFromString:value] forKey:property];
+            CBRPropertyAccessorSetValue(self, [dateFormatter dateFromString:value], property);
         } else {
             if (![value isKindOfClass:expectedClass]) {
                 continue;
             }
 
-            [self setValue:value forKey:property];
+            CBRPropertyAccessorSetValue(self, value, property);
         }
     }
 
@@ -60,6 +60,16 @@ NS_ASSUME_NONNULL_BEGIN
                              userInfo:(nullable NSDictionary *)userInfo
                     completionHandler:(void(^_Nullable)(NSArray * _Nullable fetchedObjects, NSError * _Nullable error))completionHandler;
 
+/**
+ Fetches the objects of a to-many `relationship` for all `persistentObjects` with a single cloud request and maps the response in one transaction.
+
+ The cloud connection receives the predicate `inverseRelationship IN persistentObjects`. Fetched objects are assigned to their parents through the inverse relationship based on `-[CBRCloudObjectTransformer primaryKeyOfRelationship:inCloudObject:]`.
+ */
+- (void)fetchPersistentObjectsForRelationship:(NSString *)relationship
+                          ofPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects
+                                     userInfo:(nullable NSDictionary *)userInfo
+                            completionHandler:(void(^_Nullable)(NSArray * _Nullable fetchedObjects, NSError * _Nullable error))completionHandler;
+
 - (void)createPersistentObject:(id<CBRPersistentObject>)persistentObject withCompletionHandler:(void(^_Nullable)(id _Nullable persistentObject, NSError * _Nullable error))completionHandler;
 - (void)reloadPersistentObject:(id<CBRPersistentObject>)persistentObject withCompletionHandler:(void(^_Nullable)(id _Nullable persistentObject, NSError * _Nullable error))completionHandler;
 - (void)savePersistentObject:(id<CBRPersistentObject>)persistentObject withCompletionHandler:(void(^_Nullable)(id _Nullable persistentObject, NSError * _Nullable error))completionHandler;
@@ -23,6 +23,8 @@
 
 #import "CBRCloudBridge.h"
 #import "CBREntityDescription.h"
+#import "CBRInstrumentation.h"
+#import "CBRMaintenanceScheduler.h"
 
 @implementation NSNumber (CBRPersistentIdentifier) @end
 @implementation NSString (CBRPersistentIdentifier) @end
@@ -155,20 +157,34 @@
                 parentObject = [self.databaseAdapter persistentObjectOfType:relationshipDescription.destinationEntity withPrimaryKey:description.primaryKey];
             }
 
-            for (id<CBRCloudObject> cloudObject in fetchedObjects) {
-                id<CBRPersistentObject>persistentObject = [self.cloudConnection.objectTransformer persistentObjectFromCloudObject:cloudObject
-                                                                                                                        forEntity:entityDescription];
+            id<CBRCloudObjectTransformer> objectTransformer = self.cloudConnection.objectTransformer;
+            NSMutableArray *persistentObjects = [NSMutableArray array];
+            NSTimeInterval mappingStart = CBRInstrumentationTimestamp();
 
-                if (persistentObject) {
-                    [parsedPersistentObjects addObject:persistentObject];
-                    [persistentObjectsIdentifiers addObject:[persistentObject valueForKey:cloudIdentifier]];
+            if ([objectTransformer respondsToSelector:@selector(persistentObjectsFromCloudObjects:forEntity:)]) {
+                [persistentObjects addObjectsFromArray:[objectTransformer persistentObjectsFromCloudObjects:fetchedObjects forEntity:entityDescription]];
+            } else {
+                for (id<CBRCloudObject> cloudObject in fetchedObjects) {
+                    id<CBRPersistentObject> persistentObject = [objectTransformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
 
-                    if (description.relationshipToUpdate) {
-                        [persistentObject setValue:parentObject forKey:description.relationshipToUpdate];
+                    if (persistentObject) {
+                        [persistentObjects addObject:persistentObject];
                     }
                 }
             }
 
+            [self _recordMappingOfPersistentObjects:persistentObjects forEntity:entityDescription since:mappingStart];
+            [self _markPersistentObjects:persistentObjects ofEntity:entityDescription asSyncedAtDate:[NSDate date]];
+
+            for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+                [parsedPersistentObjects addObject:persistentObject];
+                [persistentObjectsIdentifiers addObject:[persistentObject valueForKey:cloudIdentifier]];
+
+                if (description.relationshipToUpdate) {
+                    [persistentObject setValue:parentObject forKey:description.relationshipToUpdate];
+                }
+            }
+
             if (description.deleteEveryOtherObject) {
                 NSPredicate *predicate = [NSPredicate predicateWithFormat:@"NOT %K IN %@", cloudIdentifier, persistentObjectsIdentifiers];
 
@@ -201,6 +217,107 @@
     }];
 }
 
+- (void)fetchPersistentObjectsForRelationship:(NSString *)relationship
+                          ofPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects
+                                     userInfo:(NSDictionary *)userInfo
+                            completionHandler:(void(^)(NSArray *fetchedObjects, NSError *error))completionHandler
+{
+    if (persistentObjects.count == 0) {
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(@[], nil);
+            });
+        }
+        return;
+    }
+
+    CBREntityDescription *parentEntityDescription = [persistentObjects.firstObject cloudBridgeEntityDescription];
+    CBRRelationshipDescription *relationshipDescription = parentEntityDescription.relationshipsByName[relationship];
+    NSParameterAssert(relationshipDescription);
+    NSParameterAssert(relationshipDescription.toMany);
+
+    CBRRelationshipDescription *inverseRelationship = relationshipDescription.inverseRelationship;
+    NSParameterAssert(inverseRelationship);
+    NSParameterAssert(!inverseRelationship.toMany);
+
+    CBREntityDescription *entityDescription = relationshipDescription.destinationEntity;
+    NSParameterAssert(entityDescription);
+
+    if ([self.databaseAdapter.interface conformsToProtocol:@protocol(_CBRPersistentStoreInterfaceInternal)]) {
+        id<_CBRPersistentStoreInterfaceInternal> interface = (id<_CBRPersistentStoreInterfaceInternal>)self.databaseAdapter.interface;
+        assert([interface hasPersistedObjects:persistentObjects]);
+    }
+
+    NSString *parentCloudIdentifier = [self.cloudConnection.objectTransformer primaryKeyOfEntitiyDescription:parentEntityDescription];
+    NSMutableSet *parentIdentifiers = [NSMutableSet set];
+    for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+        id identifier = [persistentObject valueForKey:parentCloudIdentifier];
+        if (identifier) {
+            [parentIdentifiers addObject:identifier];
+        }
+    }
+
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"%K IN %@", inverseRelationship.name, persistentObjects];
+    [self.cloudConnection fetchCloudObjectsForEntity:entityDescription withPredicate:predicate userInfo:userInfo completionHandler:^(NSArray *fetchedObjects, NSError *error) {
+        if (error) {
+            if (completionHandler) {
+                completionHandler(nil, error);
+            }
+            return;
+        }
+
+        [self.databaseAdapter transactionWithObject:nil transaction:^id _Nullable(id  _Nullable object) {
+            id<CBRCloudObjectTransformer> objectTransformer = self.cloudConnection.objectTransformer;
+            BOOL resolvesParents = [objectTransformer respondsToSelector:@selector(primaryKeyOfRelationship:inCloudObject:)];
+
+            NSDictionary *parentsByIdentifier = [self.databaseAdapter indexedObjectsOfType:parentEntityDescription withValues:parentIdentifiers forAttribute:parentCloudIdentifier];
+            id singleParent = parentsByIdentifier.count == 1 ? parentsByIdentifier.allValues.firstObject : nil;
+
+            NSString *cloudIdentifier = [objectTransformer primaryKeyOfEntitiyDescription:entityDescription];
+            NSMutableArray *parsedPersistentObjects = [NSMutableArray array];
+            NSMutableArray *persistentObjectsIdentifiers = [NSMutableArray array];
+            NSTimeInterval mappingStart = CBRInstrumentationTimestamp();
+
+            for (id<CBRCloudObject> cloudObject in fetchedObjects) {
+                id<CBRPersistentObject> persistentObject = [objectTransformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+                if (!persistentObject) {
+                    continue;
+                }
+
+                [parsedPersistentObjects addObject:persistentObject];
+                [persistentObjectsIdentifiers addObject:[persistentObject valueForKey:cloudIdentifier]];
+
+                id parentIdentifier = resolvesParents ? [objectTransformer primaryKeyOfRelationship:inverseRelationship inCloudObject:cloudObject] : nil;
+                id parent = parentIdentifier ? parentsByIdentifier[parentIdentifier] : singleParent;
+
+                if (parent && [persistentObject valueForKey:inverseRelationship.name] != parent) {
+                    [persistentObject setValue:parent forKey:inverseRelationship.name];
+                }
+            }
+
+            [self _recordMappingOfPersistentObjects:parsedPersistentObjects forEntity:entityDescription since:mappingStart];
+            [self _markPersistentObjects:parsedPersistentObjects ofEntity:entityDescription asSyncedAtDate:[NSDate date]];
+
+            if (inverseRelationship.cascades && parentsByIdentifier.count > 0) {
+                NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entityDescription.name];
+                fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K IN %@ AND NOT %K IN %@", inverseRelationship.name, parentsByIdentifier.allValues, cloudIdentifier, persistentObjectsIdentifiers];
+
+                NSError *error = nil;
+                NSArray *objectsToBeDeleted = [self.databaseAdapter executeFetchRequest:fetchRequest error:&error];
+                NSAssert(error == nil, @"error executing fetch request: %@", error);
+
+                [self.databaseAdapter deletePersistentObjects:objectsToBeDeleted];
+            }
+
+            return parsedPersistentObjects;
+        } completion:^(id  _Nullable object, NSError * _Nullable error) {
+            if (completionHandler) {
+                completionHandler(object, error);
+            }
+        }];
+    }];
+}
+
 - (void)createPersistentObject:(id<CBRPersistentObject>)persistentObject withCompletionHandler:(void(^)(id persistentObject, NSError *error))completionHandler
 {
     [self createPersistentObject:persistentObject withUserInfo:nil completionHandler:completionHandler];
@@ -238,7 +355,10 @@
         }
 
         [self.databaseAdapter transactionWithObject:persistentObject transaction:^id _Nullable(id  _Nullable persistentObject) {
+            NSTimeInterval mappingStart = CBRInstrumentationTimestamp();
             [self.cloudConnection.objectTransformer updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject];
+            [self _recordMappingOfPersistentObjects:@[ persistentObject ] forEntity:[persistentObject cloudBridgeEntityDescription] since:mappingStart];
+            [self _markPersistentObjects:@[ persistentObject ] ofEntity:[persistentObject cloudBridgeEntityDescription] asSyncedAtDate:[NSDate date]];
             return persistentObject;
         } completion:^(id  _Nullable persistentObject, NSError * _Nullable error) {
             if (completionHandler) {
@@ -264,7 +384,10 @@
         }
 
         [self.databaseAdapter transactionWithObject:persistentObject transaction:^id _Nullable(id  _Nullable persistentObject) {
+            NSTimeInterval mappingStart = CBRInstrumentationTimestamp();
             [self.cloudConnection.objectTransformer updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject];
+            [self _recordMappingOfPersistentObjects:@[ persistentObject ] forEntity:[persistentObject cloudBridgeEntityDescription] since:mappingStart];
+            [self _markPersistentObjects:@[ persistentObject ] ofEntity:[persistentObject cloudBridgeEntityDescription] asSyncedAtDate:[NSDate date]];
             return persistentObject;
         } completion:^(id  _Nullable persistentObject, NSError * _Nullable error) {
             if (completionHandler) {
@@ -291,7 +414,10 @@
         }
 
         [self.databaseAdapter transactionWithObject:persistentObject transaction:^id _Nullable(id  _Nullable persistentObject) {
+            NSTimeInterval mappingStart = CBRInstrumentationTimestamp();
             [self.cloudConnection.objectTransformer updatePersistentObject:persistentObject withPropertiesFromCloudObject:cloudObject];
+            [self _recordMappingOfPersistentObjects:@[ persistentObject ] forEntity:[persistentObject cloudBridgeEntityDescription] since:mappingStart];
+            [self _markPersistentObjects:@[ persistentObject ] ofEntity:[persistentObject cloudBridgeEntityDescription] asSyncedAtDate:[NSDate date]];
             return persistentObject;
         } completion:^(id  _Nullable persistentObject, NSError * _Nullable error) {
             if (completionHandler) {
@@ -330,4 +456,43 @@
 
 #pragma mark - Private category implementation ()
 
+- (void)_markPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects ofEntity:(CBREntityDescription *)entityDescription asSyncedAtDate:(NSDate *)date
+{
+    NSString *syncDateAttribute = entityDescription.syncDateAttribute;
+    if (!syncDateAttribute) {
+        return;
+    }
+
+    for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+        [persistentObject setValue:date forKey:syncDateAttribute];
+    }
+}
+
+- (void)_recordMappingOfPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects forEntity:(CBREntityDescription *)entityDescription since:(NSTimeInterval)start
+{
+    id<CBRInstrumentation> instrumentation = CBRInstrumentationGetCurrent();
+    if (!instrumentation) {
+        return;
+    }
+
+    NSString *metric = [NSString stringWithFormat:@"%@.%@", CBRMetricMappingDuration, entityDescription.name];
+    [instrumentation recordValue:CBRInstrumentationTimestamp() - start forMetric:metric];
+
+    // inserted objects are already counted by the database adapter
+    NSUInteger numberOfUpdatedObjects = persistentObjects.count;
+    if ([self.databaseAdapter.interface conformsToProtocol:@protocol(_CBRPersistentStoreInterfaceInternal)]) {
+        id<_CBRPersistentStoreInterfaceInternal> interface = (id<_CBRPersistentStoreInterfaceInternal>)self.databaseAdapter.interface;
+
+        for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+            if (![interface hasPersistedObjects:@[ persistentObject ]]) {
+                numberOfUpdatedObjects--;
+            }
+        }
+    }
+
+    if (numberOfUpdatedObjects > 0) {
+        [instrumentation incrementCounter:CBRCounterObjectsUpdated by:numberOfUpdatedObjects];
+    }
+}
+
 @end
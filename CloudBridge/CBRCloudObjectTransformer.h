@@ -24,7 +24,7 @@
 #import <Foundation/Foundation.h>
 
 @protocol CBRPersistentObject, CBRCloudObject, CBRMutableCloudObject;
-@class CBREntityDescription;
+@class CBREntityDescription, CBRRelationshipDescription;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -55,6 +55,18 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withPropertiesFromCloudObject:(id<CBRCloudObject>)cloudObject;
 
+@optional
+
+/**
+ Transforms all `CBRCloudObject` instances of a single response at once. Implementations can batch their lookups or map compound documents here.
+ */
+- (NSArray *)persistentObjectsFromCloudObjects:(NSArray *)cloudObjects forEntity:(CBREntityDescription *)entity;
+
+/**
+ Returns the primary key of the object a `CBRCloudObject` references through the to-one `relationshipDescription`, if any.
+ */
+- (nullable id)primaryKeyOfRelationship:(CBRRelationshipDescription *)relationshipDescription inCloudObject:(id<CBRCloudObject>)cloudObject;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,55 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CloudBridge/CBRPersistentStoreInterface.h>
+
+@class CBRPersistentObjectChange;
+
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Notification token which merges all changes of the observed token within `interval` into one `CBRPersistentObjectChange`. Merged changes are delivered on the run loop of the observing thread in common modes, so tracking a scroll view does not hold them back. `count`, `allObjects` and subscripts return the objects of the last delivered change.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRCoalescedNotificationToken : NSObject <CBRNotificationToken>
+
+@property (nonatomic, readonly) NSTimeInterval interval;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+
+/**
+ `observe` is called once with the observer which has to be registered, e.g. with `changesWithFetchRequest:block:`.
+ */
+- (instancetype)initWithInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block observe:(id<CBRNotificationToken>(^)(void(^observer)(NSArray *objects, CBRPersistentObjectChange *change)))observe NS_DESIGNATED_INITIALIZER;
+
+/**
+ Delivers pending changes immediately.
+ */
+- (void)flush;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,130 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRCoalescedNotificationToken.h"
+#import "CBRPersistentObjectChange.h"
+
+@interface CBRCoalescedNotificationToken ()
+
+@property (nonatomic, strong, nullable) id<CBRNotificationToken> token;
+@property (nonatomic, copy, nullable) void(^block)(NSArray *objects, CBRPersistentObjectChange *change);
+
+@property (nonatomic, copy) NSArray *deliveredObjects;
+@property (nonatomic, strong, nullable) NSArray *pendingObjects;
+@property (nonatomic, strong, nullable) CBRPersistentObjectChange *pendingChange;
+
+- (void)_enqueueChange:(CBRPersistentObjectChange *)change objects:(NSArray *)objects;
+
+@end
+
+
+
+@implementation CBRCoalescedNotificationToken
+
+#pragma mark - Initialization
+
+- (instancetype)initWithInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block observe:(id<CBRNotificationToken>(^)(void(^observer)(NSArray *objects, CBRPersistentObjectChange *change)))observe
+{
+    if (self = [super init]) {
+        _interval = interval;
+        _block = [block copy];
+
+        __weak typeof(self) weakSelf = self;
+        _token = observe(^(NSArray *objects, CBRPersistentObjectChange *change) {
+            __strong typeof(self) self = weakSelf;
+            [self _enqueueChange:change objects:objects];
+        });
+
+        _deliveredObjects = [_token.allObjects copy] ?: @[];
+    }
+    return self;
+}
+
+#pragma mark - Instance methods
+
+- (void)flush
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(flush) object:nil];
+
+    NSArray *objects = self.pendingObjects;
+    CBRPersistentObjectChange *change = self.pendingChange;
+
+    self.pendingObjects = nil;
+    self.pendingChange = nil;
+
+    if (change != nil && self.block != nil) {
+        self.deliveredObjects = objects;
+        self.block(objects, change);
+    }
+}
+
+#pragma mark - CBRNotificationToken
+
+// objects as of the last delivered change, so that data sources stay consistent with the changes they were told about
+
+- (NSInteger)count
+{
+    return self.deliveredObjects.count;
+}
+
+- (NSArray *)allObjects
+{
+    return self.deliveredObjects;
+}
+
+- (id)objectAtIndexedSubscript:(NSUInteger)idx
+{
+    return self.deliveredObjects[idx];
+}
+
+- (void)invalidate
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(flush) object:nil];
+    [self.token invalidate];
+
+    self.token = nil;
+    self.block = nil;
+    self.pendingObjects = nil;
+    self.pendingChange = nil;
+    self.deliveredObjects = @[];
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_enqueueChange:(CBRPersistentObjectChange *)change objects:(NSArray *)objects
+{
+    if (self.block == nil) {
+        return;
+    }
+
+    BOOL scheduled = self.pendingChange != nil;
+
+    self.pendingObjects = objects;
+    self.pendingChange = scheduled ? [self.pendingChange changeByAppendingChange:change] : change;
+
+    if (!scheduled) {
+        [self performSelector:@selector(flush) withObject:nil afterDelay:self.interval inModes:@[ NSRunLoopCommonModes ]];
+    }
+}
+
+@end
@@ -28,6 +28,7 @@
 #import "CBREntityDescription.h"
 #import "CBRThreadingEnvironment.h"
 #import "CBRPersistentObjectCache.h"
+#import "CBRInstrumentation.h"
 
 @interface CBRDatabaseAdapter ()
 
@@ -58,9 +59,13 @@
 
 - (void)inlineTransaction:(NS_NOESCAPE dispatch_block_t)transaction
 {
+    NSTimeInterval start = CBRInstrumentationTimestamp();
+
     [self.interface beginWriteTransaction];
     transaction();
     [self.interface commitWriteTransaction:NULL];
+
+    [CBRInstrumentationGetCurrent() recordValue:CBRInstrumentationTimestamp() - start forMetric:CBRMetricTransactionDuration];
 }
 
 - (void)transactionWithBlock:(dispatch_block_t)transaction
@@ -104,12 +109,16 @@
             return;
         }
 
+        NSTimeInterval start = CBRInstrumentationTimestamp();
+
         [self.interface beginWriteTransaction];
         id result = transaction(object);
 
         NSError *saveError = nil;
         [self.interface commitWriteTransaction:&error];
 
+        [CBRInstrumentationGetCurrent() recordValue:CBRInstrumentationTimestamp() - start forMetric:CBRMetricTransactionDuration];
+
         if (saveError != nil) {
             if (completion != nil) {
                 dispatch_async(dispatch_get_main_queue(), ^{
@@ -164,6 +173,7 @@
 
 - (__kindof id<CBRPersistentObject>)newMutablePersistentObjectOfType:(CBREntityDescription *)entityDescription
 {
+    [CBRInstrumentationGetCurrent() incrementCounter:CBRCounterObjectsInserted by:1];
     return [self.interface newMutablePersistentObjectOfType:entityDescription];
 }
 
@@ -197,8 +207,10 @@
 - (void)deletePersistentObjects:(id)persistentObjects
 {
     if ([persistentObjects conformsToProtocol:@protocol(NSFastEnumeration)]) {
+        [CBRInstrumentationGetCurrent() incrementCounter:CBRCounterObjectsDeleted by:[persistentObjects count]];
         [self.interface deletePersistentObjects:persistentObjects];
     } else {
+        [CBRInstrumentationGetCurrent() incrementCounter:CBRCounterObjectsDeleted by:1];
         [self.interface deletePersistentObjects:@[ persistentObjects ]];
     }
 }
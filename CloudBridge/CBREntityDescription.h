@@ -90,13 +90,57 @@ __attribute__((objc_subclassing_restricted))
 
 @property (nonatomic, readonly) NSDictionary<NSString *, CBRAttributeDescription *> *attributesByName;
 @property (nonatomic, readonly) NSDictionary<NSString *, CBRRelationshipDescription *> *relationshipsByName;
-@property (nonatomic, readonly) NSArray<CBRRelationshipDescription *> *subentities;
+@property (nonatomic, readonly) NSArray<CBREntityDescription *> *subentities;
+
+/**
+ All direct and indirect subentities, depth first.
+ */
+@property (nonatomic, readonly) NSArray<CBREntityDescription *> *allSubentities;
 
 @property (nonatomic, weak, readonly) id<CBRPersistentStoreInterface> interface;
 
+/**
+ `YES` once `freeze` has been called. Lookup tables of frozen descriptions are computed once, they must not be mutated anymore.
+ */
+@property (nonatomic, readonly, getter=isFrozen) BOOL frozen;
+
 - (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithInterface:(id<CBRPersistentStoreInterface>)interface NS_DESIGNATED_INITIALIZER;
 
+/**
+ Precomputes all lookup tables of this entity and its relationships. Called by the interface once all entities are known.
+ */
+- (void)freeze;
+
+@end
+
+
+
+/**
+ Derived entity descriptions cached across launches, so that interfaces do not need to open their store to know the schema.
+ */
+@interface CBREntityDescription (CBRSchemaCache)
+
++ (NSString *)schemaCacheKeyWithComponents:(NSArray<NSString *> *)components;
+
+/**
+ Entities previously stored for `key`, `nil` if there are none or the cache cannot be read. Returned entities are not frozen.
+ */
++ (nullable NSArray<CBREntityDescription *> *)cachedEntitiesForKey:(NSString *)key interface:(id<CBRPersistentStoreInterface>)interface;
+
+/**
+ Stores `entities` for `key` in the background.
+ */
++ (void)cacheEntities:(NSArray<CBREntityDescription *> *)entities forKey:(NSString *)key;
+
+/**
+ Removes all cached entities once pending stores have finished.
+ */
++ (void)removeAllCachedEntities;
+
+- (instancetype)initWithInterface:(id<CBRPersistentStoreInterface>)interface schemaRepresentation:(NSDictionary<NSString *, id> *)schemaRepresentation;
+- (NSDictionary<NSString *, id> *)schemaRepresentation;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -8,6 +8,7 @@
 
 #import "CBREntityDescription.h"
 #import "CBRDatabaseAdapter.h"
+#import <CommonCrypto/CommonDigest.h>
 
 static NSDictionary *indexBy(NSArray *array, NSString *key)
 {
@@ -41,20 +42,48 @@ static NSDictionary *indexBy(NSArray *array, NSString *key)
 
 
 
+@interface CBRRelationshipDescription () {
+    dispatch_once_t _inverseRelationshipOnceToken;
+}
+
+@property (nonatomic, weak) CBREntityDescription *frozenEntity;
+@property (nonatomic, weak) CBREntityDescription *frozenDestinationEntity;
+@property (nonatomic, weak) CBRRelationshipDescription *frozenInverseRelationship;
+@property (nonatomic, assign, getter=isFrozen) BOOL frozen;
+
+@end
+
 @implementation CBRRelationshipDescription
 
 - (CBREntityDescription *)entity
 {
+    if (self.isFrozen) {
+        return self.frozenEntity;
+    }
+
     return self.interface.entitiesByName[self.entityName];
 }
 
 - (CBRRelationshipDescription *)inverseRelationship
 {
-    return [self.interface inverseRelationshipForEntity:self.entity relationship:self];
+    if (!self.isFrozen) {
+        return [self.interface inverseRelationshipForEntity:self.entity relationship:self];
+    }
+
+    // resolved lazily, interfaces assert on relationships without an inverse
+    dispatch_once(&_inverseRelationshipOnceToken, ^{
+        self.frozenInverseRelationship = [self.interface inverseRelationshipForEntity:self.entity relationship:self];
+    });
+
+    return self.frozenInverseRelationship;
 }
 
 - (CBREntityDescription *)destinationEntity
 {
+    if (self.isFrozen) {
+        return self.frozenDestinationEntity;
+    }
+
     return self.interface.entitiesByName[self.destinationEntityName];
 }
 
@@ -71,24 +100,45 @@ static NSDictionary *indexBy(NSArray *array, NSString *key)
     return self;
 }
 
+- (void)_freeze
+{
+    self.frozenEntity = self.interface.entitiesByName[self.entityName];
+    self.frozenDestinationEntity = self.interface.entitiesByName[self.destinationEntityName];
+    self.frozen = YES;
+}
+
 @end
 
 
 
+@interface CBREntityDescription ()
+
+@property (nonatomic, copy) NSDictionary<NSString *, CBRAttributeDescription *> *frozenAttributesByName;
+@property (nonatomic, copy) NSDictionary<NSString *, CBRRelationshipDescription *> *frozenRelationshipsByName;
+@property (nonatomic, copy) NSArray<CBREntityDescription *> *frozenSubentities;
+@property (nonatomic, copy) NSArray<CBREntityDescription *> *frozenAllSubentities;
+@property (nonatomic, assign, getter=isFrozen) BOOL frozen;
+
+@end
+
 @implementation CBREntityDescription
 
 - (NSDictionary *)attributesByName
 {
-    return indexBy(self.attributes, @"name");
+    return self.frozenAttributesByName ?: indexBy(self.attributes, @"name");
 }
 
 - (NSDictionary *)relationshipsByName
 {
-    return indexBy(self.relationships, @"name");
+    return self.frozenRelationshipsByName ?: indexBy(self.relationships, @"name");
 }
 
 - (NSArray *)subentities
 {
+    if (self.frozenSubentities) {
+        return self.frozenSubentities;
+    }
+
     NSMutableArray *result = [NSMutableArray array];
 
     for (NSString *name in self.subentityNames) {
@@ -98,6 +148,22 @@ static NSDictionary *indexBy(NSArray *array, NSString *key)
     return result;
 }
 
+- (NSArray *)allSubentities
+{
+    if (self.frozenAllSubentities) {
+        return self.frozenAllSubentities;
+    }
+
+    NSMutableArray *result = [NSMutableArray array];
+
+    for (CBREntityDescription *subentity in self.subentities) {
+        [result addObject:subentity];
+        [result addObjectsFromArray:subentity.allSubentities];
+    }
+
+    return result;
+}
+
 - (instancetype)init
 {
     return [super init];
@@ -111,4 +177,178 @@ static NSDictionary *indexBy(NSArray *array, NSString *key)
     return self;
 }
 
+- (void)freeze
+{
+    if (self.isFrozen) {
+        return;
+    }
+
+    self.frozenAttributesByName = self.attributesByName;
+    self.frozenRelationshipsByName = self.relationshipsByName;
+    self.frozenSubentities = self.subentities;
+    self.frozenAllSubentities = self.allSubentities;
+
+    for (CBRRelationshipDescription *relationship in self.relationships) {
+        [relationship _freeze];
+    }
+
+    self.frozen = YES;
+}
+
+@end
+
+
+
+@implementation CBREntityDescription (CBRSchemaCache)
+
++ (dispatch_queue_t)_schemaCacheQueue
+{
+    static dispatch_queue_t queue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("de.sparrow-labs.CloudBridge.schema", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    });
+    return queue;
+}
+
++ (NSURL *)_schemaCacheURLForKey:(NSString *)key
+{
+    NSURL *cachesDirectory = [[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask].lastObject;
+    return [[cachesDirectory URLByAppendingPathComponent:@"CloudBridge/Schema" isDirectory:YES] URLByAppendingPathComponent:[key stringByAppendingPathExtension:@"plist"]];
+}
+
++ (NSString *)schemaCacheKeyWithComponents:(NSArray<NSString *> *)components
+{
+    NSData *data = [[components componentsJoinedByString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+
+    NSMutableString *result = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [result appendFormat:@"%02x", digest[i]];
+    }
+
+    return result;
+}
+
++ (NSArray<CBREntityDescription *> *)cachedEntitiesForKey:(NSString *)key interface:(id<CBRPersistentStoreInterface>)interface
+{
+    NSData *data = [NSData dataWithContentsOfURL:[self _schemaCacheURLForKey:key]];
+    NSArray<NSDictionary *> *representations = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL] : nil;
+
+    if (![representations isKindOfClass:[NSArray class]]) {
+        return nil;
+    }
+
+    NSMutableArray<CBREntityDescription *> *result = [NSMutableArray arrayWithCapacity:representations.count];
+    for (NSDictionary *representation in representations) {
+        if (![representation isKindOfClass:[NSDictionary class]] || ![representation[@"name"] isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+
+        [result addObject:[[CBREntityDescription alloc] initWithInterface:interface schemaRepresentation:representation]];
+    }
+
+    return result;
+}
+
++ (void)cacheEntities:(NSArray<CBREntityDescription *> *)entities forKey:(NSString *)key
+{
+    NSArray<NSDictionary *> *representations = [entities valueForKey:NSStringFromSelector(@selector(schemaRepresentation))];
+    NSURL *URL = [self _schemaCacheURLForKey:key];
+
+    dispatch_async([self _schemaCacheQueue], ^{
+        NSError *error = nil;
+        NSData *data = [NSPropertyListSerialization dataWithPropertyList:representations format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+
+        if (data == nil) {
+            NSLog(@"WARNING: schema of %@ cannot be cached: %@", [representations valueForKey:@"name"], error);
+            return;
+        }
+
+        [[NSFileManager defaultManager] createDirectoryAtURL:URL.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+        [data writeToURL:URL options:NSDataWritingAtomic error:NULL];
+    });
+}
+
++ (void)removeAllCachedEntities
+{
+    NSURL *directoryURL = [self _schemaCacheURLForKey:@""].URLByDeletingLastPathComponent;
+
+    dispatch_sync([self _schemaCacheQueue], ^{
+        [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+    });
+}
+
+- (instancetype)initWithInterface:(id<CBRPersistentStoreInterface>)interface schemaRepresentation:(NSDictionary<NSString *, id> *)schemaRepresentation
+{
+    if (self = [self initWithInterface:interface]) {
+        self.name = schemaRepresentation[@"name"];
+        self.userInfo = schemaRepresentation[@"userInfo"];
+        self.subentityNames = schemaRepresentation[@"subentityNames"] ?: @[];
+
+        NSMutableArray<CBRAttributeDescription *> *attributes = [NSMutableArray array];
+        for (NSDictionary *representation in schemaRepresentation[@"attributes"]) {
+            CBRAttributeDescription *attribute = [[CBRAttributeDescription alloc] initWithInterface:interface];
+            attribute.name = representation[@"name"];
+            attribute.type = [representation[@"type"] integerValue];
+            attribute.userInfo = representation[@"userInfo"];
+
+            [attributes addObject:attribute];
+        }
+        self.attributes = attributes.copy;
+
+        NSMutableArray<CBRRelationshipDescription *> *relationships = [NSMutableArray array];
+        for (NSDictionary *representation in schemaRepresentation[@"relationships"]) {
+            CBRRelationshipDescription *relationship = [[CBRRelationshipDescription alloc] initWithInterface:interface];
+            relationship.entityName = representation[@"entityName"];
+            relationship.name = representation[@"name"];
+            relationship.toMany = [representation[@"toMany"] boolValue];
+            relationship.cascades = [representation[@"cascades"] boolValue];
+            relationship.destinationEntityName = representation[@"destinationEntityName"];
+            relationship.userInfo = representation[@"userInfo"];
+
+            [relationships addObject:relationship];
+        }
+        self.relationships = relationships.copy;
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, id> *)schemaRepresentation
+{
+    NSMutableArray<NSDictionary *> *attributes = [NSMutableArray arrayWithCapacity:self.attributes.count];
+    for (CBRAttributeDescription *attribute in self.attributes) {
+        NSMutableDictionary *representation = [NSMutableDictionary dictionary];
+        representation[@"name"] = attribute.name;
+        representation[@"type"] = @(attribute.type);
+        representation[@"userInfo"] = attribute.userInfo;
+
+        [attributes addObject:representation];
+    }
+
+    NSMutableArray<NSDictionary *> *relationships = [NSMutableArray arrayWithCapacity:self.relationships.count];
+    for (CBRRelationshipDescription *relationship in self.relationships) {
+        NSMutableDictionary *representation = [NSMutableDictionary dictionary];
+        representation[@"entityName"] = relationship.entityName;
+        representation[@"name"] = relationship.name;
+        representation[@"toMany"] = @(relationship.toMany);
+        representation[@"cascades"] = @(relationship.cascades);
+        representation[@"destinationEntityName"] = relationship.destinationEntityName;
+        representation[@"userInfo"] = relationship.userInfo;
+
+        [relationships addObject:representation];
+    }
+
+    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+    result[@"name"] = self.name;
+    result[@"userInfo"] = self.userInfo;
+    result[@"subentityNames"] = self.subentityNames ?: @[];
+    result[@"attributes"] = attributes;
+    result[@"relationships"] = relationships;
+
+    return result;
+}
+
 @end
@@ -20,19 +20,65 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
  */
-
 #import <Foundation/Foundation.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
 /**
- NSCache subclass that is enumaratable.
+ Thread safe, bounded least recently used cache that can be enumerated. Keeps track of the keys of every object, so that all keys of an object can be removed without enumerating the cache. Trims itself under memory pressure.
  */
 __attribute__((objc_subclassing_restricted))
-@interface CBREnumaratableCache : NSCache <NSFastEnumeration>
+@interface CBREnumaratableCache<KeyType, ObjectType> : NSObject <NSFastEnumeration>
+
+/**
+ Maximum number of objects, `0` means no limit.
+ */
+@property (nonatomic, assign) NSUInteger countLimit;
+
+/**
+ Maximum total cost of all objects, `0` means no limit.
+ */
+@property (nonatomic, assign) NSUInteger totalCostLimit;
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+@property (nonatomic, readonly) NSUInteger hits;
+@property (nonatomic, readonly) NSUInteger misses;
+@property (nonatomic, readonly) NSUInteger evictions;
+
+/**
+ Called for every object evicted because of a limit or memory pressure, but not for explicitly removed objects. Called without holding the internal lock, possibly on a background queue.
+ */
+@property (nonatomic, copy, nullable) void(^evictionHandler)(KeyType key, ObjectType object);
 
 - (instancetype)init NS_DESIGNATED_INITIALIZER;
 
+- (nullable ObjectType)objectForKey:(KeyType)key;
+
+- (void)setObject:(ObjectType)object forKey:(KeyType)key;
+- (void)setObject:(ObjectType)object forKey:(KeyType)key cost:(NSUInteger)cost;
+
+/**
+ @param group Total costs are accounted per group as well, e.g. per entity.
+ */
+- (void)setObject:(ObjectType)object forKey:(KeyType)key cost:(NSUInteger)cost group:(nullable NSString *)group;
+
+- (void)removeObjectForKey:(KeyType)key;
+
+/**
+ Removes all keys under which `object` is stored, compared by identity.
+ */
+- (void)removeObject:(ObjectType)object;
+- (void)removeAllObjects;
+
+- (NSUInteger)totalCostOfGroup:(NSString *)group;
+
+/**
+ Evicts least recently used objects until `count` and `totalCost` are at most `fraction` of their current value.
+ */
+- (void)trimToFraction:(double)fraction;
+
 @end
 
 NS_ASSUME_NONNULL_END
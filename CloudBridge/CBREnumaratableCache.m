@@ -20,13 +20,45 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
  */
-
 #import "CBREnumaratableCache.h"
 
+#import <pthread.h>
+
+
+
+@interface _CBREnumaratableCacheEntry : NSObject {
+@public
+    id _key;
+    id _object;
+    NSString *_group;
+    NSUInteger _cost;
+
+    __unsafe_unretained _CBREnumaratableCacheEntry *_previous;
+    __unsafe_unretained _CBREnumaratableCacheEntry *_next;
+}
+
+@end
 
+@implementation _CBREnumaratableCacheEntry
+
+@end
+
+
+
+@interface CBREnumaratableCache () {
+    pthread_mutex_t _lock;
+
+    // most recently used entry first
+    __unsafe_unretained _CBREnumaratableCacheEntry *_head;
+    __unsafe_unretained _CBREnumaratableCacheEntry *_tail;
+}
+
+@property (nonatomic, readonly) NSMutableDictionary<id, _CBREnumaratableCacheEntry *> *entries;
+@property (nonatomic, readonly) NSMapTable<id, NSMutableSet *> *keysByObject;
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, NSNumber *> *costsByGroup;
+
+@property (nonatomic, readonly) dispatch_source_t memoryPressureSource;
 
-@interface CBREnumaratableCache ()
-@property (nonatomic, strong) NSMutableSet *enumeratableKeys;
 @end
 
 
@@ -38,38 +70,295 @@
 - (instancetype)init
 {
     if (self = [super init]) {
-        _enumeratableKeys = [NSMutableSet set];
+        pthread_mutex_init(&_lock, NULL);
+
+        _entries = [NSMutableDictionary dictionary];
+        _keysByObject = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality | NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+        _costsByGroup = [NSMutableDictionary dictionary];
+
+        __weak typeof(self) weakSelf = self;
+        _memoryPressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0, DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        dispatch_source_set_event_handler(_memoryPressureSource, ^{
+            __strong typeof(self) self = weakSelf;
+            if (!self) {
+                return;
+            }
+
+            unsigned long status = dispatch_source_get_data(self.memoryPressureSource);
+            [self trimToFraction:status & DISPATCH_MEMORYPRESSURE_CRITICAL ? 0.0 : 0.5];
+        });
+        dispatch_resume(_memoryPressureSource);
     }
     return self;
 }
 
-#pragma mark - NSCache
+- (void)dealloc
+{
+    dispatch_source_cancel(_memoryPressureSource);
+    pthread_mutex_destroy(&_lock);
+}
 
-- (void)setObject:(id)obj forKey:(id)key
+#pragma mark - Instance methods
+
+- (NSUInteger)count
 {
-    [super setObject:obj forKey:key];
-    [self.enumeratableKeys addObject:key];
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = self.entries.count;
+    pthread_mutex_unlock(&_lock);
+
+    return count;
+}
+
+- (id)objectForKey:(id)key
+{
+    pthread_mutex_lock(&_lock);
+
+    _CBREnumaratableCacheEntry *entry = self.entries[key];
+    if (entry) {
+        _hits++;
+        [self _moveEntryToHead:entry];
+    } else {
+        _misses++;
+    }
+
+    id object = entry ? entry->_object : nil;
+    pthread_mutex_unlock(&_lock);
+
+    return object;
 }
 
-- (void)setObject:(id)obj forKey:(id)key cost:(NSUInteger)g
+- (void)setObject:(id)object forKey:(id)key
 {
-    [super setObject:obj forKey:key cost:g];
-    [self.enumeratableKeys addObject:key];
+    [self setObject:object forKey:key cost:0 group:nil];
+}
+
+- (void)setObject:(id)object forKey:(id)key cost:(NSUInteger)cost
+{
+    [self setObject:object forKey:key cost:cost group:nil];
+}
+
+- (void)setObject:(id)object forKey:(id)key cost:(NSUInteger)cost group:(NSString *)group
+{
+    NSParameterAssert(object);
+    NSParameterAssert(key);
+
+    NSMutableArray<_CBREnumaratableCacheEntry *> *evictedEntries = [NSMutableArray array];
+
+    pthread_mutex_lock(&_lock);
+
+    _CBREnumaratableCacheEntry *existingEntry = self.entries[key];
+    if (existingEntry) {
+        [self _removeEntry:existingEntry];
+    }
+
+    _CBREnumaratableCacheEntry *entry = [[_CBREnumaratableCacheEntry alloc] init];
+    entry->_key = [key conformsToProtocol:@protocol(NSCopying)] ? [key copy] : key;
+    entry->_object = object;
+    entry->_group = group;
+    entry->_cost = cost;
+
+    self.entries[entry->_key] = entry;
+    [self _insertEntryAtHead:entry];
+
+    NSMutableSet *keys = [self.keysByObject objectForKey:object];
+    if (!keys) {
+        keys = [NSMutableSet set];
+        [self.keysByObject setObject:keys forKey:object];
+    }
+    [keys addObject:entry->_key];
+
+    _totalCost += cost;
+    if (group) {
+        self.costsByGroup[group] = @(self.costsByGroup[group].unsignedIntegerValue + cost);
+    }
+
+    while (_tail != nil && _tail != entry && ((self.countLimit > 0 && self.entries.count > self.countLimit) || (self.totalCostLimit > 0 && _totalCost > self.totalCostLimit))) {
+        [evictedEntries addObject:_tail];
+        [self _removeEntry:_tail];
+        _evictions++;
+    }
+
+    pthread_mutex_unlock(&_lock);
+
+    [self _notifyEvictionOfEntries:evictedEntries];
 }
 
 - (void)removeObjectForKey:(id)key
 {
-    [super removeObjectForKey:key];
-    [self.enumeratableKeys removeObject:key];
+    pthread_mutex_lock(&_lock);
+
+    _CBREnumaratableCacheEntry *entry = self.entries[key];
+    if (entry) {
+        [self _removeEntry:entry];
+    }
+
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)removeObject:(id)object
+{
+    pthread_mutex_lock(&_lock);
+
+    for (id key in [[self.keysByObject objectForKey:object] copy]) {
+        [self _removeEntry:self.entries[key]];
+    }
+
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)removeAllObjects
+{
+    pthread_mutex_lock(&_lock);
+
+    [self.entries removeAllObjects];
+    [self.keysByObject removeAllObjects];
+    [self.costsByGroup removeAllObjects];
+
+    _head = nil;
+    _tail = nil;
+    _totalCost = 0;
+
+    pthread_mutex_unlock(&_lock);
+}
+
+- (NSUInteger)totalCostOfGroup:(NSString *)group
+{
+    pthread_mutex_lock(&_lock);
+    NSUInteger cost = self.costsByGroup[group].unsignedIntegerValue;
+    pthread_mutex_unlock(&_lock);
+
+    return cost;
+}
+
+- (void)trimToFraction:(double)fraction
+{
+    NSMutableArray<_CBREnumaratableCacheEntry *> *evictedEntries = [NSMutableArray array];
+
+    pthread_mutex_lock(&_lock);
+
+    NSUInteger count = (NSUInteger)(self.entries.count * fraction);
+    NSUInteger totalCost = (NSUInteger)(_totalCost * fraction);
+
+    while (_tail != nil && (self.entries.count > count || _totalCost > totalCost)) {
+        [evictedEntries addObject:_tail];
+        [self _removeEntry:_tail];
+        _evictions++;
+    }
+
+    pthread_mutex_unlock(&_lock);
+
+    [self _notifyEvictionOfEntries:evictedEntries];
 }
 
 #pragma mark - NSFastEnumeration
 
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len
 {
-    return [self.enumeratableKeys countByEnumeratingWithState:state objects:buffer count:len];
+    if (state->state == 0) {
+        pthread_mutex_lock(&_lock);
+        NSArray *keys = self.entries.allKeys;
+        pthread_mutex_unlock(&_lock);
+
+        // enumerates a snapshot which stays alive until the surrounding autorelease pool drains
+        CFAutorelease(CFBridgingRetain(keys));
+        state->extra[0] = (unsigned long)(__bridge void *)keys;
+        state->extra[1] = 0;
+        state->mutationsPtr = &state->extra[1];
+        state->state = 1;
+    }
+
+    NSArray *keys = (__bridge NSArray *)(void *)state->extra[0];
+    NSUInteger index = state->extra[2];
+    NSUInteger count = MIN(len, keys.count - index);
+
+    for (NSUInteger i = 0; i < count; i++) {
+        buffer[i] = keys[index + i];
+    }
+
+    state->itemsPtr = buffer;
+    state->extra[2] = index + count;
+
+    return count;
 }
 
 #pragma mark - Private category implementation ()
 
+- (void)_insertEntryAtHead:(_CBREnumaratableCacheEntry *)entry
+{
+    entry->_previous = nil;
+    entry->_next = _head;
+
+    if (_head) {
+        _head->_previous = entry;
+    }
+
+    _head = entry;
+
+    if (!_tail) {
+        _tail = entry;
+    }
+}
+
+- (void)_unlinkEntry:(_CBREnumaratableCacheEntry *)entry
+{
+    if (entry->_previous) {
+        entry->_previous->_next = entry->_next;
+    } else {
+        _head = entry->_next;
+    }
+
+    if (entry->_next) {
+        entry->_next->_previous = entry->_previous;
+    } else {
+        _tail = entry->_previous;
+    }
+
+    entry->_previous = nil;
+    entry->_next = nil;
+}
+
+- (void)_moveEntryToHead:(_CBREnumaratableCacheEntry *)entry
+{
+    if (_head == entry) {
+        return;
+    }
+
+    [self _unlinkEntry:entry];
+    [self _insertEntryAtHead:entry];
+}
+
+- (void)_removeEntry:(_CBREnumaratableCacheEntry *)entry
+{
+    if (!entry) {
+        return;
+    }
+
+    [self _unlinkEntry:entry];
+
+    NSMutableSet *keys = [self.keysByObject objectForKey:entry->_object];
+    [keys removeObject:entry->_key];
+    if (keys.count == 0) {
+        [self.keysByObject removeObjectForKey:entry->_object];
+    }
+
+    _totalCost -= entry->_cost;
+    if (entry->_group) {
+        self.costsByGroup[entry->_group] = @(self.costsByGroup[entry->_group].unsignedIntegerValue - entry->_cost);
+    }
+
+    [self.entries removeObjectForKey:entry->_key];
+}
+
+- (void)_notifyEvictionOfEntries:(NSArray<_CBREnumaratableCacheEntry *> *)entries
+{
+    void(^evictionHandler)(id key, id object) = self.evictionHandler;
+    if (!evictionHandler) {
+        return;
+    }
+
+    for (_CBREnumaratableCacheEntry *entry in entries) {
+        evictionHandler(entry->_key, entry->_object);
+    }
+}
+
 @end
@@ -0,0 +1,115 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreData/CoreData.h>
+
+#import <CloudBridge/CBRPersistentObject.h>
+#import <CloudBridge/CBRPersistentObjectCache.h>
+#import <CloudBridge/CBRPersistentStoreInterface.h>
+
+@class CBRInMemoryInterface, CBRInMemoryObjectReference;
+
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Object of a `CBRInMemoryInterface`, every entity needs a subclass of the same name. Objects are confined to the thread they were fetched or created on. `@dynamic` object properties are backed by the attribute or relationship of the same name.
+ */
+@interface CBRInMemoryObject : NSObject
+
+/**
+ `YES` once the object has been deleted.
+ */
+@property (nonatomic, readonly, getter=isInvalidated) BOOL invalidated;
+
+/**
+ Reference to resolve this object on another thread once it has been committed.
+ */
+@property (nonatomic, readonly) CBRInMemoryObjectReference *reference;
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+/**
+ Stored value of `key`, to-one relationships are stored as the identifier of their destination.
+ */
+- (nullable id)primitiveValueForKey:(NSString *)key;
+- (void)setPrimitiveValue:(nullable id)value forKey:(NSString *)key;
+
+@end
+
+
+
+@interface CBRInMemoryObject (CBRPersistentObject) <CBRPersistentObject>
+
+@end
+
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRInMemoryObjectReference : NSObject
+
+@property (nonatomic, weak, readonly) CBRInMemoryInterface *interface;
+@property (nonatomic, readonly) NSString *entityName;
+@property (nonatomic, readonly) NSNumber *identifier;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithInterface:(CBRInMemoryInterface *)interface entityName:(NSString *)entityName identifier:(NSNumber *)identifier NS_DESIGNATED_INITIALIZER;
+
+@end
+
+
+
+/**
+ Store interface without any persistence for ephemeral data. Committed objects form immutable snapshots which are shared between threads, a commit copies only what it changes. Each thread reads its own snapshot together with its uncommitted changes and advances to the latest snapshot when it fetches or begins a write transaction, the main thread also after every commit.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRInMemoryInterface : NSObject <CBRPersistentStoreInterface>
+
+/**
+ Version of the latest committed snapshot.
+ */
+@property (nonatomic, readonly) uint64_t version;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+
+/**
+ Entities in the format of `-[CBREntityDescription schemaRepresentation]`, e.g. the `schemaRepresentation`s of the entities of another interface. Attributes listed comma separated in the `cloudBridgeIndexedAttributes` userInfo entry of an entity are hash indexed from the start, all others once they are first fetched with `==` or `IN`. The inverse of a relationship is the only relationship of its destination entity pointing back.
+ */
+- (instancetype)initWithSchemaRepresentations:(NSArray<NSDictionary<NSString *, id> *> *)schemaRepresentations NS_DESIGNATED_INITIALIZER;
+
+/**
+ Advances the current thread to the latest committed snapshot, unless it is in a write transaction or has uncommitted changes.
+ */
+- (void)refresh;
+
+/**
+ Resolves `reference` on the current thread, `nil` if the object does not exist anymore.
+ */
+- (nullable __kindof CBRInMemoryObject *)objectForReference:(CBRInMemoryObjectReference *)reference;
+
+@end
+
+NS_ASSUME_NONNULL_END
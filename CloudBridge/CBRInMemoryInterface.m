@@ -0,0 +1,1392 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+#import "CBRInMemoryInterface.h"
+#import "CBREntityDescription.h"
+#import "CBRPersistentObjectChange.h"
+#import "CBRCoalescedNotificationToken.h"
+
+static const NSUInteger CBRInMemoryNumberOfShards = 64;
+static NSString *const CBRInMemoryContextKeyPrefix = @"CBRInMemoryInterface.";
+
+
+
+/**
+ Immutable dictionary split into shards, a changed copy only copies the shards containing changed keys.
+ */
+@interface _CBRInMemoryShardedDictionary : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (nullable id)objectForKey:(id)key;
+- (void)enumerateKeysAndObjectsUsingBlock:(NS_NOESCAPE void(^)(id key, id object, BOOL *stop))block;
+
+/**
+ Copy with the objects of `changes` set, keys mapped to `NSNull` are removed.
+ */
+- (instancetype)dictionaryByApplyingChanges:(NSDictionary *)changes;
+
+@end
+
+@implementation _CBRInMemoryShardedDictionary {
+    NSArray<NSDictionary *> *_shards;
+}
+
+- (instancetype)init
+{
+    NSMutableArray<NSDictionary *> *shards = [NSMutableArray arrayWithCapacity:CBRInMemoryNumberOfShards];
+    for (NSUInteger i = 0; i < CBRInMemoryNumberOfShards; i++) {
+        [shards addObject:@{}];
+    }
+
+    return [self initWithShards:shards count:0];
+}
+
+- (instancetype)initWithShards:(NSArray<NSDictionary *> *)shards count:(NSUInteger)count
+{
+    if (self = [super init]) {
+        _shards = shards.copy;
+        _count = count;
+    }
+    return self;
+}
+
+- (id)objectForKey:(id)key
+{
+    return _shards[[key hash] % CBRInMemoryNumberOfShards][key];
+}
+
+- (void)enumerateKeysAndObjectsUsingBlock:(NS_NOESCAPE void(^)(id key, id object, BOOL *stop))block
+{
+    __block BOOL stop = NO;
+
+    for (NSDictionary *shard in _shards) {
+        [shard enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *shardStop) {
+            block(key, object, &stop);
+            *shardStop = stop;
+        }];
+
+        if (stop) {
+            return;
+        }
+    }
+}
+
+- (instancetype)dictionaryByApplyingChanges:(NSDictionary *)changes
+{
+    NSMutableArray<NSDictionary *> *shards = _shards.mutableCopy;
+    NSMutableDictionary<NSNumber *, NSMutableDictionary *> *changedShards = [NSMutableDictionary dictionary];
+    __block NSUInteger count = _count;
+
+    [changes enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+        NSNumber *index = @([key hash] % CBRInMemoryNumberOfShards);
+
+        NSMutableDictionary *shard = changedShards[index];
+        if (shard == nil) {
+            shard = [self->_shards[index.unsignedIntegerValue] mutableCopy];
+            changedShards[index] = shard;
+        }
+
+        BOOL exists = shard[key] != nil;
+
+        if (object == [NSNull null]) {
+            count -= exists ? 1 : 0;
+            [shard removeObjectForKey:key];
+        } else {
+            count += exists ? 0 : 1;
+            shard[key] = object;
+        }
+    }];
+
+    [changedShards enumerateKeysAndObjectsUsingBlock:^(NSNumber *index, NSMutableDictionary *shard, BOOL *stop) {
+        shards[index.unsignedIntegerValue] = shard.copy;
+    }];
+
+    return [[_CBRInMemoryShardedDictionary alloc] initWithShards:shards count:count];
+}
+
+@end
+
+
+
+/**
+ Committed records of one entity by identifier. Hash indexes map values of a key to the identifiers of all records with this value, they are built on first use and carried over into the tables of later commits.
+ */
+@interface _CBRInMemoryTable : NSObject
+
+@property (nonatomic, readonly) _CBRInMemoryShardedDictionary *records;
+
+- (instancetype)initWithIndexedKeys:(NSArray<NSString *> *)indexedKeys;
+
+- (NSSet<NSNumber *> *)identifiersWithValue:(id)value forKey:(NSString *)key;
+
+/**
+ Copy with the records of `records` set, identifiers mapped to `NSNull` are removed.
+ */
+- (_CBRInMemoryTable *)tableByApplyingRecords:(NSDictionary<NSNumber *, id> *)records;
+
+@end
+
+@implementation _CBRInMemoryTable {
+    NSMutableDictionary<NSString *, _CBRInMemoryShardedDictionary *> *_indexes;
+}
+
+- (instancetype)initWithIndexedKeys:(NSArray<NSString *> *)indexedKeys
+{
+    NSMutableDictionary<NSString *, _CBRInMemoryShardedDictionary *> *indexes = [NSMutableDictionary dictionary];
+    for (NSString *key in indexedKeys) {
+        indexes[key] = [[_CBRInMemoryShardedDictionary alloc] init];
+    }
+
+    return [self initWithRecords:[[_CBRInMemoryShardedDictionary alloc] init] indexes:indexes];
+}
+
+- (instancetype)initWithRecords:(_CBRInMemoryShardedDictionary *)records indexes:(NSDictionary<NSString *, _CBRInMemoryShardedDictionary *> *)indexes
+{
+    if (self = [super init]) {
+        _records = records;
+        _indexes = indexes.mutableCopy;
+    }
+    return self;
+}
+
+- (NSSet<NSNumber *> *)identifiersWithValue:(id)value forKey:(NSString *)key
+{
+    _CBRInMemoryShardedDictionary *index = nil;
+
+    @synchronized (self) {
+        index = _indexes[key];
+
+        if (index == nil) {
+            index = [self _indexForKey:key];
+            _indexes[key] = index;
+        }
+    }
+
+    return [index objectForKey:value] ?: [NSSet set];
+}
+
+- (_CBRInMemoryTable *)tableByApplyingRecords:(NSDictionary<NSNumber *, id> *)records
+{
+    NSDictionary<NSString *, _CBRInMemoryShardedDictionary *> *indexes = nil;
+    @synchronized (self) {
+        indexes = _indexes.copy;
+    }
+
+    NSMutableDictionary<NSString *, _CBRInMemoryShardedDictionary *> *newIndexes = [NSMutableDictionary dictionaryWithCapacity:indexes.count];
+
+    [indexes enumerateKeysAndObjectsUsingBlock:^(NSString *key, _CBRInMemoryShardedDictionary *index, BOOL *stop) {
+        NSMutableDictionary<id, NSMutableSet<NSNumber *> *> *changedIdentifiers = [NSMutableDictionary dictionary];
+        NSMutableSet<NSNumber *> *(^identifiersWithValue)(id value) = ^NSMutableSet<NSNumber *> *(id value) {
+            if (changedIdentifiers[value] == nil) {
+                changedIdentifiers[value] = [[index objectForKey:value] mutableCopy] ?: [NSMutableSet set];
+            }
+
+            return changedIdentifiers[value];
+        };
+
+        [records enumerateKeysAndObjectsUsingBlock:^(NSNumber *identifier, id record, BOOL *recordsStop) {
+            id oldValue = [[self.records objectForKey:identifier] objectForKey:key];
+            id newValue = record == [NSNull null] ? nil : record[key];
+
+            if (oldValue == newValue || [oldValue isEqual:newValue]) {
+                return;
+            }
+
+            if (oldValue != nil) {
+                [identifiersWithValue(oldValue) removeObject:identifier];
+            }
+
+            if (newValue != nil) {
+                [identifiersWithValue(newValue) addObject:identifier];
+            }
+        }];
+
+        NSMutableDictionary *changes = [NSMutableDictionary dictionaryWithCapacity:changedIdentifiers.count];
+        [changedIdentifiers enumerateKeysAndObjectsUsingBlock:^(id value, NSMutableSet<NSNumber *> *identifiers, BOOL *changesStop) {
+            changes[value] = identifiers.count > 0 ? identifiers.copy : [NSNull null];
+        }];
+
+        newIndexes[key] = [index dictionaryByApplyingChanges:changes];
+    }];
+
+    return [[_CBRInMemoryTable alloc] initWithRecords:[self.records dictionaryByApplyingChanges:records] indexes:newIndexes];
+}
+
+- (_CBRInMemoryShardedDictionary *)_indexForKey:(NSString *)key
+{
+    NSMutableDictionary<id, NSMutableSet<NSNumber *> *> *identifiersByValue = [NSMutableDictionary dictionary];
+
+    [self.records enumerateKeysAndObjectsUsingBlock:^(NSNumber *identifier, NSDictionary *record, BOOL *stop) {
+        id value = record[key];
+        if (value == nil) {
+            return;
+        }
+
+        if (identifiersByValue[value] == nil) {
+            identifiersByValue[value] = [NSMutableSet set];
+        }
+
+        [identifiersByValue[value] addObject:identifier];
+    }];
+
+    return [[[_CBRInMemoryShardedDictionary alloc] init] dictionaryByApplyingChanges:identifiersByValue];
+}
+
+@end
+
+
+
+/**
+ Committed state of all entities after one commit.
+ */
+@interface _CBRInMemorySnapshot : NSObject
+
+@property (nonatomic, readonly) uint64_t version;
+
+/**
+ Number of objects deleted up to this snapshot, contexts evict deleted objects from their cache only if it changed.
+ */
+@property (nonatomic, readonly) uint64_t numberOfDeletions;
+
+@property (nonatomic, readonly) NSDictionary<NSString *, _CBRInMemoryTable *> *tablesByEntityName;
+
+@end
+
+@implementation _CBRInMemorySnapshot
+
+- (instancetype)initWithVersion:(uint64_t)version numberOfDeletions:(uint64_t)numberOfDeletions tablesByEntityName:(NSDictionary<NSString *, _CBRInMemoryTable *> *)tablesByEntityName
+{
+    if (self = [super init]) {
+        _version = version;
+        _numberOfDeletions = numberOfDeletions;
+        _tablesByEntityName = tablesByEntityName.copy;
+    }
+    return self;
+}
+
+@end
+
+
+
+/**
+ Key of `predicate` or of one of its AND-ed subpredicates which compares with `==` or `IN` against constants that can be looked up in a hash index.
+ */
+static NSString *CBRInMemoryIndexedKey(NSPredicate *predicate, CBREntityDescription *entity, NSArray **values)
+{
+    if ([predicate isKindOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *compoundPredicate = (NSCompoundPredicate *)predicate;
+        if (compoundPredicate.compoundPredicateType != NSAndPredicateType) {
+            return nil;
+        }
+
+        for (NSPredicate *subpredicate in compoundPredicate.subpredicates) {
+            NSString *key = CBRInMemoryIndexedKey(subpredicate, entity, values);
+            if (key != nil) {
+                return key;
+            }
+        }
+
+        return nil;
+    }
+
+    if (![predicate isKindOfClass:[NSComparisonPredicate class]]) {
+        return nil;
+    }
+
+    NSComparisonPredicate *comparisonPredicate = (NSComparisonPredicate *)predicate;
+    if (comparisonPredicate.leftExpression.expressionType != NSKeyPathExpressionType || comparisonPredicate.rightExpression.expressionType != NSConstantValueExpressionType) {
+        return nil;
+    }
+
+    if (comparisonPredicate.options != 0 || comparisonPredicate.comparisonPredicateModifier != NSDirectPredicateModifier) {
+        return nil;
+    }
+
+    NSString *key = comparisonPredicate.leftExpression.keyPath;
+    CBRRelationshipDescription *relationship = entity.relationshipsByName[key];
+
+    if (entity.attributesByName[key] == nil && (relationship == nil || relationship.toMany)) {
+        return nil;
+    }
+
+    id constantValue = comparisonPredicate.rightExpression.constantValue;
+    NSMutableArray *result = [NSMutableArray array];
+
+    switch (comparisonPredicate.predicateOperatorType) {
+        case NSEqualToPredicateOperatorType:
+            if (constantValue == nil || constantValue == [NSNull null]) {
+                return nil;
+            }
+
+            [result addObject:constantValue];
+            break;
+        case NSInPredicateOperatorType:
+            if ([constantValue isKindOfClass:[NSSet class]] || [constantValue isKindOfClass:[NSOrderedSet class]]) {
+                constantValue = [constantValue allObjects];
+            }
+
+            if (![constantValue isKindOfClass:[NSArray class]]) {
+                return nil;
+            }
+
+            [result addObjectsFromArray:constantValue];
+            break;
+        default:
+            return nil;
+    }
+
+    for (NSUInteger i = 0; i < result.count; i++) {
+        if ([result[i] isKindOfClass:[CBRInMemoryObject class]]) {
+            result[i] = [result[i] reference].identifier;
+        }
+    }
+
+    *values = result;
+    return key;
+}
+
+
+
+@class _CBRInMemoryContext;
+
+@interface CBRInMemoryObject () {
+    @public
+    NSNumber *_inMemoryIdentifier;
+    NSString *_inMemoryEntityName;
+    _CBRInMemoryContext *_inMemoryContext;
+}
+
+- (instancetype)_initWithIdentifier:(NSNumber *)identifier entityName:(NSString *)entityName context:(_CBRInMemoryContext *)context;
+
+@end
+
+
+
+@interface CBRInMemoryInterface () <_CBRPersistentStoreInterfaceInternal>
+
+@property (nonatomic, readonly) _CBRInMemorySnapshot *latestSnapshot;
+
+- (NSNumber *)_nextIdentifier;
+- (_CBRInMemorySnapshot *)_commitValues:(NSDictionary<NSNumber *, NSDictionary<NSString *, id> *> *)values
+                    insertedIdentifiers:(NSSet<NSNumber *> *)insertedIdentifiers
+                     deletedIdentifiers:(NSSet<NSNumber *> *)deletedIdentifiers
+                            entityNames:(NSDictionary<NSNumber *, NSString *> *)entityNames;
+
+@end
+
+
+
+/**
+ Snapshot, uncommitted changes and objects of one interface on one thread.
+ */
+@interface _CBRInMemoryContext : NSObject
+
+@property (nonatomic, weak, readonly) CBRInMemoryInterface *interface;
+@property (nonatomic, readonly) _CBRInMemorySnapshot *snapshot;
+@property (nonatomic, readonly) CBRPersistentObjectCache *cache;
+
+@property (nonatomic, assign) NSInteger transactionDepth;
+@property (nonatomic, readonly) BOOL hasChanges;
+
+- (instancetype)initWithInterface:(CBRInMemoryInterface *)interface snapshot:(_CBRInMemorySnapshot *)snapshot;
+
+- (void)refresh;
+- (BOOL)save:(NSError **)error;
+
+- (CBRInMemoryObject *)insertObjectOfEntity:(CBREntityDescription *)entity;
+- (void)deleteObject:(CBRInMemoryObject *)object;
+
+- (CBRInMemoryObject *)objectWithIdentifier:(NSNumber *)identifier entityName:(NSString *)entityName;
+
+/**
+ Existing object of `entity` or one of its subentities.
+ */
+- (nullable CBRInMemoryObject *)objectWithIdentifier:(NSNumber *)identifier ofEntity:(CBREntityDescription *)entity;
+- (NSArray<CBRInMemoryObject *> *)objectsMatchingFetchRequest:(NSFetchRequest *)fetchRequest;
+
+- (BOOL)containsObject:(CBRInMemoryObject *)object;
+- (BOOL)hasCommittedObject:(CBRInMemoryObject *)object;
+
+- (nullable id)valueForKey:(NSString *)key ofObject:(CBRInMemoryObject *)object;
+- (void)setValue:(nullable id)value forKey:(NSString *)key ofObject:(CBRInMemoryObject *)object;
+
+/**
+ Changes whenever the values of `object` change, compared by identity.
+ */
+- (id)recordOfObject:(CBRInMemoryObject *)object;
+
+@end
+
+@implementation _CBRInMemoryContext {
+    NSMutableDictionary<NSNumber *, NSMutableDictionary<NSString *, id> *> *_pendingValues;
+    NSMutableDictionary<NSNumber *, NSString *> *_pendingEntityNames;
+    NSMutableSet<NSNumber *> *_insertedIdentifiers;
+    NSMutableSet<NSNumber *> *_deletedIdentifiers;
+    NSMapTable<NSNumber *, CBRInMemoryObject *> *_objectsByIdentifier;
+}
+
+- (BOOL)hasChanges
+{
+    return _pendingEntityNames.count > 0;
+}
+
+- (instancetype)initWithInterface:(CBRInMemoryInterface *)interface snapshot:(_CBRInMemorySnapshot *)snapshot
+{
+    if (self = [super init]) {
+        _interface = interface;
+        _snapshot = snapshot;
+        _cache = [[CBRPersistentObjectCache alloc] initWithInterface:interface];
+
+        _pendingValues = [NSMutableDictionary dictionary];
+        _pendingEntityNames = [NSMutableDictionary dictionary];
+        _insertedIdentifiers = [NSMutableSet set];
+        _deletedIdentifiers = [NSMutableSet set];
+        _objectsByIdentifier = [NSMapTable strongToWeakObjectsMapTable];
+    }
+    return self;
+}
+
+- (void)refresh
+{
+    CBRInMemoryInterface *interface = self.interface;
+    if (interface == nil || self.transactionDepth > 0 || self.hasChanges) {
+        return;
+    }
+
+    [self _setSnapshot:interface.latestSnapshot];
+}
+
+- (BOOL)save:(NSError **)error
+{
+    if (!self.hasChanges) {
+        [self refresh];
+        return YES;
+    }
+
+    _CBRInMemorySnapshot *snapshot = [self.interface _commitValues:_pendingValues insertedIdentifiers:_insertedIdentifiers deletedIdentifiers:_deletedIdentifiers entityNames:_pendingEntityNames];
+
+    [_pendingValues removeAllObjects];
+    [_pendingEntityNames removeAllObjects];
+    [_insertedIdentifiers removeAllObjects];
+    [_deletedIdentifiers removeAllObjects];
+
+    [self _setSnapshot:snapshot];
+    return YES;
+}
+
+- (CBRInMemoryObject *)insertObjectOfEntity:(CBREntityDescription *)entity
+{
+    NSNumber *identifier = [self.interface _nextIdentifier];
+
+    [_insertedIdentifiers addObject:identifier];
+    _pendingValues[identifier] = [NSMutableDictionary dictionary];
+    _pendingEntityNames[identifier] = entity.name;
+
+    return [self objectWithIdentifier:identifier entityName:entity.name];
+}
+
+- (void)deleteObject:(CBRInMemoryObject *)object
+{
+    NSNumber *identifier = object->_inMemoryIdentifier;
+    if (![self containsObject:object]) {
+        return;
+    }
+
+    [self.cache removePersistentObject:object];
+    [_pendingValues removeObjectForKey:identifier];
+
+    if ([_insertedIdentifiers containsObject:identifier]) {
+        [_insertedIdentifiers removeObject:identifier];
+        [_pendingEntityNames removeObjectForKey:identifier];
+        return;
+    }
+
+    [_deletedIdentifiers addObject:identifier];
+    _pendingEntityNames[identifier] = object->_inMemoryEntityName;
+}
+
+- (CBRInMemoryObject *)objectWithIdentifier:(NSNumber *)identifier entityName:(NSString *)entityName
+{
+    CBRInMemoryObject *object = [_objectsByIdentifier objectForKey:identifier];
+    if (object != nil) {
+        return object;
+    }
+
+    Class klass = NSClassFromString(entityName);
+    NSAssert([klass isSubclassOfClass:[CBRInMemoryObject class]], @"%@ must be a subclass of CBRInMemoryObject", entityName);
+
+    object = [[klass alloc] _initWithIdentifier:identifier entityName:entityName context:self];
+    [_objectsByIdentifier setObject:object forKey:identifier];
+
+    return object;
+}
+
+- (CBRInMemoryObject *)objectWithIdentifier:(NSNumber *)identifier ofEntity:(CBREntityDescription *)entity
+{
+    if ([_deletedIdentifiers containsObject:identifier]) {
+        return nil;
+    }
+
+    if ([_insertedIdentifiers containsObject:identifier]) {
+        return [self objectWithIdentifier:identifier entityName:_pendingEntityNames[identifier]];
+    }
+
+    for (CBREntityDescription *candidate in [@[ entity ] arrayByAddingObjectsFromArray:entity.allSubentities]) {
+        if ([self.snapshot.tablesByEntityName[candidate.name].records objectForKey:identifier] != nil) {
+            return [self objectWithIdentifier:identifier entityName:candidate.name];
+        }
+    }
+
+    return nil;
+}
+
+- (NSArray<CBRInMemoryObject *> *)objectsMatchingFetchRequest:(NSFetchRequest *)fetchRequest
+{
+    CBREntityDescription *entity = self.interface.entitiesByName[fetchRequest.entityName];
+    NSParameterAssert(entity);
+
+    NSPredicate *predicate = fetchRequest.predicate;
+    NSArray<CBREntityDescription *> *entities = fetchRequest.includesSubentities ? [@[ entity ] arrayByAddingObjectsFromArray:entity.allSubentities] : @[ entity ];
+
+    NSMutableArray<CBRInMemoryObject *> *result = [NSMutableArray array];
+
+    for (CBREntityDescription *candidateEntity in entities) {
+        for (NSNumber *identifier in [self _candidateIdentifiersOfEntity:candidateEntity predicate:predicate]) {
+            CBRInMemoryObject *object = [self objectWithIdentifier:identifier entityName:candidateEntity.name];
+
+            if (predicate == nil || [predicate evaluateWithObject:object]) {
+                [result addObject:object];
+            }
+        }
+    }
+
+    NSArray<NSSortDescriptor *> *sortDescriptors = fetchRequest.sortDescriptors;
+    [result sortUsingComparator:^NSComparisonResult(CBRInMemoryObject *object1, CBRInMemoryObject *object2) {
+        for (NSSortDescriptor *sortDescriptor in sortDescriptors) {
+            NSComparisonResult comparisonResult = [sortDescriptor compareObject:object1 toObject:object2];
+            if (comparisonResult != NSOrderedSame) {
+                return comparisonResult;
+            }
+        }
+
+        // objects without a defined order are returned in the order they were inserted
+        return [object1->_inMemoryIdentifier compare:object2->_inMemoryIdentifier];
+    }];
+
+    NSUInteger offset = MIN(fetchRequest.fetchOffset, result.count);
+    NSUInteger length = result.count - offset;
+
+    if (fetchRequest.fetchLimit > 0) {
+        length = MIN(length, fetchRequest.fetchLimit);
+    }
+
+    return [result subarrayWithRange:NSMakeRange(offset, length)];
+}
+
+- (BOOL)containsObject:(CBRInMemoryObject *)object
+{
+    NSNumber *identifier = object->_inMemoryIdentifier;
+    if ([_deletedIdentifiers containsObject:identifier]) {
+        return NO;
+    }
+
+    return [_insertedIdentifiers containsObject:identifier] || [self hasCommittedObject:object];
+}
+
+- (BOOL)hasCommittedObject:(CBRInMemoryObject *)object
+{
+    return [self _committedRecordOfObject:object] != nil;
+}
+
+- (id)valueForKey:(NSString *)key ofObject:(CBRInMemoryObject *)object
+{
+    id value = _pendingValues[object->_inMemoryIdentifier][key];
+    if (value != nil) {
+        return value == [NSNull null] ? nil : value;
+    }
+
+    return [self _committedRecordOfObject:object][key];
+}
+
+- (void)setValue:(id)value forKey:(NSString *)key ofObject:(CBRInMemoryObject *)object
+{
+    NSNumber *identifier = object->_inMemoryIdentifier;
+    if (![self containsObject:object]) {
+        [NSException raise:NSInternalInconsistencyException format:@"Cannot set %@ of deleted object %@", key, object];
+    }
+
+    NSMutableDictionary<NSString *, id> *values = _pendingValues[identifier];
+    if (values == nil) {
+        values = [NSMutableDictionary dictionary];
+        _pendingValues[identifier] = values;
+        _pendingEntityNames[identifier] = object->_inMemoryEntityName;
+    }
+
+    // committed values are shared between threads and must not change anymore
+    if ([value conformsToProtocol:@protocol(NSCopying)]) {
+        value = [value copy];
+    }
+
+    values[key] = value ?: [NSNull null];
+}
+
+- (id)recordOfObject:(CBRInMemoryObject *)object
+{
+    return _pendingValues[object->_inMemoryIdentifier] ?: [self _committedRecordOfObject:object] ?: [NSNull null];
+}
+
+- (nullable NSDictionary<NSString *, id> *)_committedRecordOfObject:(CBRInMemoryObject *)object
+{
+    return [self.snapshot.tablesByEntityName[object->_inMemoryEntityName].records objectForKey:object->_inMemoryIdentifier];
+}
+
+- (NSSet<NSNumber *> *)_candidateIdentifiersOfEntity:(CBREntityDescription *)entity predicate:(NSPredicate *)predicate
+{
+    _CBRInMemoryTable *table = self.snapshot.tablesByEntityName[entity.name];
+    NSMutableSet<NSNumber *> *result = [NSMutableSet set];
+
+    NSArray *values = nil;
+    NSString *key = CBRInMemoryIndexedKey(predicate, entity, &values);
+
+    if (key != nil) {
+        for (id value in values) {
+            [result unionSet:[table identifiersWithValue:value forKey:key]];
+        }
+    } else {
+        [table.records enumerateKeysAndObjectsUsingBlock:^(NSNumber *identifier, id record, BOOL *stop) {
+            [result addObject:identifier];
+        }];
+    }
+
+    // uncommitted objects are not indexed, they are matched against the predicate in any case
+    [_pendingEntityNames enumerateKeysAndObjectsUsingBlock:^(NSNumber *identifier, NSString *entityName, BOOL *stop) {
+        if ([entityName isEqualToString:entity.name]) {
+            [result addObject:identifier];
+        }
+    }];
+
+    [result minusSet:_deletedIdentifiers];
+    return result;
+}
+
+- (void)_setSnapshot:(_CBRInMemorySnapshot *)snapshot
+{
+    _CBRInMemorySnapshot *previousSnapshot = _snapshot;
+    _snapshot = snapshot;
+
+    if (snapshot.numberOfDeletions == previousSnapshot.numberOfDeletions) {
+        return;
+    }
+
+    // objects deleted on other threads must not be returned from the cache anymore
+    for (CBRInMemoryObject *object in _objectsByIdentifier.objectEnumerator.allObjects) {
+        if (![self containsObject:object]) {
+            [self.cache removePersistentObject:object];
+        }
+    }
+}
+
+@end
+
+
+
+@interface _CBRInMemoryNotificationToken : NSObject <CBRNotificationToken>
+
+@property (nonatomic, readonly) NSArray *allObjects;
+
+- (instancetype)initWithFetchRequest:(NSFetchRequest *)fetchRequest context:(_CBRInMemoryContext *)context observer:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))observer;
+
+/**
+ Schedules an update on the observing thread if any of `entityNames` is observed.
+ */
+- (void)setNeedsUpdateForEntityNames:(NSSet<NSString *> *)entityNames;
+
+@end
+
+@implementation _CBRInMemoryNotificationToken {
+    NSFetchRequest *_fetchRequest;
+    NSSet<NSString *> *_entityNames;
+    _CBRInMemoryContext *_context;
+    NSThread *_thread;
+    NSArray *_records;
+    BOOL _needsUpdate;
+    void(^_observer)(NSArray *objects, CBRPersistentObjectChange *change);
+}
+@synthesize allObjects = _allObjects;
+
+- (NSInteger)count
+{
+    return _allObjects.count;
+}
+
+- (instancetype)initWithFetchRequest:(NSFetchRequest *)fetchRequest context:(_CBRInMemoryContext *)context observer:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))observer
+{
+    if (self = [super init]) {
+        CBREntityDescription *entity = context.interface.entitiesByName[fetchRequest.entityName];
+        NSParameterAssert(entity);
+
+        _fetchRequest = fetchRequest.copy;
+        _entityNames = [NSSet setWithArray:[[@[ entity ] arrayByAddingObjectsFromArray:entity.allSubentities] valueForKey:@"name"]];
+        _context = context;
+        _thread = [NSThread currentThread];
+        _observer = [observer copy];
+
+        _allObjects = [context objectsMatchingFetchRequest:_fetchRequest];
+        _records = [self _recordsOfObjects:_allObjects];
+    }
+    return self;
+}
+
+- (void)setNeedsUpdateForEntityNames:(NSSet<NSString *> *)entityNames
+{
+    if (![_entityNames intersectsSet:entityNames]) {
+        return;
+    }
+
+    @synchronized (self) {
+        if (_needsUpdate || _observer == nil) {
+            return;
+        }
+
+        _needsUpdate = YES;
+    }
+
+    [self performSelector:@selector(_update) onThread:_thread withObject:nil waitUntilDone:NO modes:@[ NSRunLoopCommonModes ]];
+}
+
+- (void)invalidate
+{
+    @synchronized (self) {
+        _observer = nil;
+    }
+
+    _allObjects = nil;
+    _records = nil;
+}
+
+- (id)objectAtIndexedSubscript:(NSUInteger)idx
+{
+    return _allObjects[idx];
+}
+
+- (void)_update
+{
+    void(^observer)(NSArray *objects, CBRPersistentObjectChange *change) = nil;
+
+    @synchronized (self) {
+        _needsUpdate = NO;
+        observer = _observer;
+    }
+
+    if (observer == nil) {
+        return;
+    }
+
+    [_context refresh];
+
+    NSArray<CBRInMemoryObject *> *objects = [_context objectsMatchingFetchRequest:_fetchRequest];
+    NSArray *records = [self _recordsOfObjects:objects];
+
+    CBRPersistentObjectChange *change = [self _changeFromObjects:_allObjects records:_records toObjects:objects records:records];
+    if (change.count == 0) {
+        return;
+    }
+
+    _allObjects = objects;
+    _records = records;
+
+    observer(objects, change);
+}
+
+- (NSArray *)_recordsOfObjects:(NSArray<CBRInMemoryObject *> *)objects
+{
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:objects.count];
+    for (CBRInMemoryObject *object in objects) {
+        [result addObject:[_context recordOfObject:object]];
+    }
+
+    return result;
+}
+
+- (CBRPersistentObjectChange *)_changeFromObjects:(NSArray<CBRInMemoryObject *> *)oldObjects records:(NSArray *)oldRecords toObjects:(NSArray<CBRInMemoryObject *> *)newObjects records:(NSArray *)newRecords
+{
+    NSMutableDictionary<NSNumber *, NSNumber *> *oldIndexes = [NSMutableDictionary dictionaryWithCapacity:oldObjects.count];
+    [oldObjects enumerateObjectsUsingBlock:^(CBRInMemoryObject *object, NSUInteger idx, BOOL *stop) {
+        oldIndexes[object->_inMemoryIdentifier] = @(idx);
+    }];
+
+    NSMutableIndexSet *keptIndexes = [NSMutableIndexSet indexSet];
+    NSMutableIndexSet *insertedIndexes = [NSMutableIndexSet indexSet];
+    NSMutableIndexSet *updatedIndexes = [NSMutableIndexSet indexSet];
+    __block NSInteger lastIndex = -1;
+
+    [newObjects enumerateObjectsUsingBlock:^(CBRInMemoryObject *object, NSUInteger idx, BOOL *stop) {
+        NSNumber *oldIndex = oldIndexes[object->_inMemoryIdentifier];
+
+        // objects which moved in front of an object they were behind are a deletion plus an insertion
+        if (oldIndex == nil || oldIndex.integerValue < lastIndex) {
+            [insertedIndexes addIndex:idx];
+            return;
+        }
+
+        lastIndex = oldIndex.integerValue;
+        [keptIndexes addIndex:lastIndex];
+
+        if (oldRecords[lastIndex] != newRecords[idx]) {
+            [updatedIndexes addIndex:lastIndex];
+        }
+    }];
+
+    NSMutableIndexSet *deletedIndexes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, oldObjects.count)];
+    [deletedIndexes removeIndexes:keptIndexes];
+
+    return [[CBRPersistentObjectChange alloc] initWithDeletedIndexes:deletedIndexes insertedIndexes:insertedIndexes updatedIndexes:updatedIndexes];
+}
+
+@end
+
+
+
+@implementation CBRInMemoryObject
+
++ (void)load
+{
+    class_implementProtocolExtension(self, @protocol(CBRPersistentObject), [CBRPersistentObjectPrototype class]);
+}
+
++ (BOOL)resolveInstanceMethod:(SEL)selector
+{
+    if ([super resolveInstanceMethod:selector]) {
+        return YES;
+    }
+
+    if ([CBRPersistentObjectPrototype resolveRelationshipForSelector:selector inClass:self]) {
+        return YES;
+    }
+
+    return [self _resolvePropertyAccessorForSelector:selector];
+}
+
++ (BOOL)_resolvePropertyAccessorForSelector:(SEL)selector
+{
+    NSString *selectorName = NSStringFromSelector(selector);
+    NSRange colonRange = [selectorName rangeOfString:@":"];
+
+    BOOL isSetter = selectorName.length > 4 && [selectorName hasPrefix:@"set"] && colonRange.location == selectorName.length - 1;
+    if (colonRange.location != NSNotFound && !isSetter) {
+        return NO;
+    }
+
+    NSString *name = selectorName;
+    if (isSetter) {
+        name = [selectorName substringWithRange:NSMakeRange(3, selectorName.length - 4)];
+        name = [[name substringToIndex:1].lowercaseString stringByAppendingString:[name substringFromIndex:1]];
+    }
+
+    objc_property_t property = class_getProperty(self, name.UTF8String);
+    if (property == NULL) {
+        return NO;
+    }
+
+    char *dynamic = property_copyAttributeValue(property, "D");
+    char *type = property_copyAttributeValue(property, "T");
+    BOOL isDynamicObjectProperty = dynamic != NULL && type != NULL && type[0] == '@';
+
+    free(dynamic);
+    free(type);
+
+    if (!isDynamicObjectProperty) {
+        return NO;
+    }
+
+    if (isSetter) {
+        IMP implementation = imp_implementationWithBlock(^(CBRInMemoryObject *object, id value) {
+            [object setValue:value forKey:name];
+        });
+
+        return class_addMethod(self, selector, implementation, "v@:@");
+    }
+
+    IMP implementation = imp_implementationWithBlock(^id(CBRInMemoryObject *object) {
+        return [object valueForKey:name];
+    });
+
+    return class_addMethod(self, selector, implementation, "@@:");
+}
+
+- (BOOL)isInvalidated
+{
+    return ![_inMemoryContext containsObject:self];
+}
+
+- (CBRInMemoryObjectReference *)reference
+{
+    return [[CBRInMemoryObjectReference alloc] initWithInterface:_inMemoryContext.interface entityName:_inMemoryEntityName identifier:_inMemoryIdentifier];
+}
+
+- (instancetype)_initWithIdentifier:(NSNumber *)identifier entityName:(NSString *)entityName context:(_CBRInMemoryContext *)context
+{
+    if (self = [super init]) {
+        _inMemoryIdentifier = identifier;
+        _inMemoryEntityName = entityName;
+        _inMemoryContext = context;
+    }
+    return self;
+}
+
+- (id)primitiveValueForKey:(NSString *)key
+{
+    return [_inMemoryContext valueForKey:key ofObject:self];
+}
+
+- (void)setPrimitiveValue:(id)value forKey:(NSString *)key
+{
+    [_inMemoryContext setValue:value forKey:key ofObject:self];
+}
+
+- (id)valueForKey:(NSString *)key
+{
+    CBREntityDescription *entity = _inMemoryContext.interface.entitiesByName[_inMemoryEntityName];
+
+    if (entity.attributesByName[key] != nil) {
+        return [self primitiveValueForKey:key];
+    }
+
+    CBRRelationshipDescription *relationship = entity.relationshipsByName[key];
+    if (relationship == nil) {
+        return [super valueForKey:key];
+    }
+
+    if (relationship.toMany) {
+        CBRRelationshipDescription *inverseRelationship = relationship.inverseRelationship;
+        NSParameterAssert(inverseRelationship && !inverseRelationship.toMany);
+
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:relationship.destinationEntityName];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@", inverseRelationship.name, self];
+
+        return [_inMemoryContext objectsMatchingFetchRequest:fetchRequest];
+    }
+
+    NSNumber *identifier = [self primitiveValueForKey:key];
+    return identifier != nil ? [_inMemoryContext objectWithIdentifier:identifier ofEntity:relationship.destinationEntity] : nil;
+}
+
+- (void)setValue:(id)value forKey:(NSString *)key
+{
+    CBREntityDescription *entity = _inMemoryContext.interface.entitiesByName[_inMemoryEntityName];
+
+    if (entity.attributesByName[key] != nil) {
+        return [self setPrimitiveValue:value forKey:key];
+    }
+
+    CBRRelationshipDescription *relationship = entity.relationshipsByName[key];
+    if (relationship == nil) {
+        return [super setValue:value forKey:key];
+    }
+
+    if (!relationship.toMany) {
+        CBRInMemoryObject *object = value;
+        NSParameterAssert(object == nil || object->_inMemoryContext == _inMemoryContext);
+
+        return [self setPrimitiveValue:object != nil ? object->_inMemoryIdentifier : nil forKey:key];
+    }
+
+    // to-many relationships are derived from their to-one inverse
+    CBRRelationshipDescription *inverseRelationship = relationship.inverseRelationship;
+    NSParameterAssert(inverseRelationship && !inverseRelationship.toMany);
+
+    NSMutableArray *newObjects = [NSMutableArray array];
+    for (CBRInMemoryObject *object in value) {
+        [newObjects addObject:object];
+    }
+
+    for (CBRInMemoryObject *object in [self valueForKey:key]) {
+        if (![newObjects containsObject:object]) {
+            [object setValue:nil forKey:inverseRelationship.name];
+        }
+    }
+
+    for (CBRInMemoryObject *object in newObjects) {
+        [object setValue:self forKey:inverseRelationship.name];
+    }
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; identifier = %@>", _inMemoryEntityName, self, _inMemoryIdentifier];
+}
+
+@end
+
+
+
+@implementation CBRInMemoryObjectReference
+
+- (instancetype)init
+{
+    return [super init];
+}
+
+- (instancetype)initWithInterface:(CBRInMemoryInterface *)interface entityName:(NSString *)entityName identifier:(NSNumber *)identifier
+{
+    if (self = [super init]) {
+        _interface = interface;
+        _entityName = entityName.copy;
+        _identifier = identifier;
+    }
+    return self;
+}
+
+@end
+
+
+
+@implementation CBRInMemoryInterface {
+    NSString *_contextKey;
+    NSHashTable<_CBRInMemoryNotificationToken *> *_observers;
+    _CBRInMemorySnapshot *_latestSnapshot;
+    _Atomic(uint64_t) _lastIdentifier;
+}
+@synthesize entities = _entities, entitiesByName = _entitiesByName;
+
+- (uint64_t)version
+{
+    return self.latestSnapshot.version;
+}
+
+- (_CBRInMemorySnapshot *)latestSnapshot
+{
+    @synchronized (self) {
+        return _latestSnapshot;
+    }
+}
+
+- (instancetype)init
+{
+    return [super init];
+}
+
+- (instancetype)initWithSchemaRepresentations:(NSArray<NSDictionary<NSString *, id> *> *)schemaRepresentations
+{
+    if (self = [super init]) {
+        static _Atomic(uint64_t) identifier = 0;
+        _contextKey = [CBRInMemoryContextKeyPrefix stringByAppendingFormat:@"%llu", atomic_fetch_add(&identifier, 1) + 1];
+        _observers = [NSHashTable weakObjectsHashTable];
+
+        NSMutableArray<CBREntityDescription *> *entities = [NSMutableArray array];
+        NSMutableDictionary<NSString *, CBREntityDescription *> *entitiesByName = [NSMutableDictionary dictionary];
+
+        for (NSDictionary<NSString *, id> *representation in schemaRepresentations) {
+            CBREntityDescription *entity = [[CBREntityDescription alloc] initWithInterface:self schemaRepresentation:representation];
+
+            [entities addObject:entity];
+            entitiesByName[entity.name] = entity;
+        }
+
+        _entities = entities.copy;
+        _entitiesByName = entitiesByName.copy;
+
+        [_entities makeObjectsPerformSelector:@selector(freeze)];
+
+        NSMutableDictionary<NSString *, _CBRInMemoryTable *> *tables = [NSMutableDictionary dictionary];
+        for (CBREntityDescription *entity in _entities) {
+            tables[entity.name] = [[_CBRInMemoryTable alloc] initWithIndexedKeys:[self _indexedKeysOfEntity:entity]];
+        }
+
+        _latestSnapshot = [[_CBRInMemorySnapshot alloc] initWithVersion:0 numberOfDeletions:0 tablesByEntityName:tables];
+    }
+    return self;
+}
+
+- (void)refresh
+{
+    [[self _context] refresh];
+}
+
+- (CBRInMemoryObject *)objectForReference:(CBRInMemoryObjectReference *)reference
+{
+    NSParameterAssert(reference.interface == self);
+
+    _CBRInMemoryContext *context = [self _context];
+    [context refresh];
+
+    CBREntityDescription *entity = self.entitiesByName[reference.entityName];
+    return entity != nil ? [context objectWithIdentifier:reference.identifier ofEntity:entity] : nil;
+}
+
+#pragma mark - _CBRPersistentStoreInterfaceInternal
+
+- (BOOL)hasPersistedObjects:(NSArray<CBRInMemoryObject *> *)persistentObjects
+{
+    for (CBRInMemoryObject *object in persistentObjects) {
+        if (![object->_inMemoryContext hasCommittedObject:object]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+- (BOOL)saveChangedForPersistentObject:(CBRInMemoryObject *)persistentObject error:(NSError **)error
+{
+    _CBRInMemoryContext *context = persistentObject->_inMemoryContext;
+    if (context.transactionDepth > 0 || !context.hasChanges) {
+        return YES;
+    }
+
+    return [context save:error];
+}
+
+#pragma mark - CBRPersistentStoreInterface
+
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
+{
+    _CBRInMemoryContext *context = [self _context];
+    [context refresh];
+
+    _CBRInMemoryNotificationToken *token = [[_CBRInMemoryNotificationToken alloc] initWithFetchRequest:fetchRequest context:context observer:block];
+
+    @synchronized (_observers) {
+        [_observers addObject:token];
+    }
+
+    return token;
+}
+
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest coalescingInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
+{
+    return [[CBRCoalescedNotificationToken alloc] initWithInterval:interval block:block observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        return [self changesWithFetchRequest:fetchRequest block:observer];
+    }];
+}
+
+- (CBRPersistentObjectCache *)persistentObjectCacheOnCurrentThreadForEntity:(CBREntityDescription *)entityDescription
+{
+    return [self _context].cache;
+}
+
+- (void)beginWriteTransaction
+{
+    _CBRInMemoryContext *context = [self _context];
+
+    // writes are merged per key into the latest snapshot, starting from it keeps reads within the transaction current
+    [context refresh];
+    context.transactionDepth++;
+}
+
+- (BOOL)commitWriteTransaction:(NSError * _Nullable __autoreleasing *)error
+{
+    _CBRInMemoryContext *context = [self _context];
+    NSParameterAssert(context.transactionDepth > 0);
+
+    context.transactionDepth--;
+    return context.transactionDepth > 0 ? YES : [context save:error];
+}
+
+- (CBRRelationshipDescription *)inverseRelationshipForEntity:(CBREntityDescription *)entity relationship:(CBRRelationshipDescription *)relationship
+{
+    CBRRelationshipDescription *result = nil;
+
+    for (CBRRelationshipDescription *candidate in relationship.destinationEntity.relationships) {
+        if (candidate == relationship || ![candidate.destinationEntityName isEqualToString:entity.name]) {
+            continue;
+        }
+
+        if (result != nil) {
+            NSLog(@"[CBRInMemoryInterface] %@.%@ has more than one inverse relationship", entity.name, relationship.name);
+            return nil;
+        }
+
+        result = candidate;
+    }
+
+    return result;
+}
+
+- (__kindof id<CBRPersistentObject>)newMutablePersistentObjectOfType:(CBREntityDescription *)entityDescription
+{
+    return [[self _context] insertObjectOfEntity:entityDescription];
+}
+
+- (NSArray *)executeFetchRequest:(NSFetchRequest *)fetchRequest error:(NSError **)error
+{
+    assert(self.entitiesByName[fetchRequest.entityName] != nil);
+
+    _CBRInMemoryContext *context = [self _context];
+    [context refresh];
+
+    return [context objectsMatchingFetchRequest:fetchRequest];
+}
+
+- (void)deletePersistentObjects:(id<NSFastEnumeration>)persistentObjects
+{
+    for (CBRInMemoryObject *object in persistentObjects) {
+        [object->_inMemoryContext deleteObject:object];
+    }
+}
+
+#pragma mark - Private category implementation ()
+
+- (NSNumber *)_nextIdentifier
+{
+    return @(atomic_fetch_add(&_lastIdentifier, 1) + 1);
+}
+
+- (_CBRInMemorySnapshot *)_commitValues:(NSDictionary<NSNumber *, NSDictionary<NSString *, id> *> *)values
+                    insertedIdentifiers:(NSSet<NSNumber *> *)insertedIdentifiers
+                     deletedIdentifiers:(NSSet<NSNumber *> *)deletedIdentifiers
+                            entityNames:(NSDictionary<NSNumber *, NSString *> *)entityNames
+{
+    _CBRInMemorySnapshot *snapshot = nil;
+
+    // snapshots are built without holding the lock, so readers of latestSnapshot never wait for a commit
+    while (snapshot == nil) {
+        _CBRInMemorySnapshot *latestSnapshot = self.latestSnapshot;
+        _CBRInMemorySnapshot *newSnapshot = [self _snapshotByApplyingValues:values insertedIdentifiers:insertedIdentifiers deletedIdentifiers:deletedIdentifiers entityNames:entityNames toSnapshot:latestSnapshot];
+
+        // a concurrent commit published first, the values are applied again on top of its snapshot
+        @synchronized (self) {
+            if (_latestSnapshot == latestSnapshot) {
+                _latestSnapshot = newSnapshot;
+                snapshot = newSnapshot;
+            }
+        }
+    }
+
+    NSSet<NSString *> *changedEntityNames = [NSSet setWithArray:entityNames.allValues];
+    NSArray<_CBRInMemoryNotificationToken *> *observers = nil;
+
+    @synchronized (_observers) {
+        observers = _observers.allObjects;
+    }
+
+    for (_CBRInMemoryNotificationToken *observer in observers) {
+        [observer setNeedsUpdateForEntityNames:changedEntityNames];
+    }
+
+    if (![NSThread isMainThread]) {
+        [self performSelectorOnMainThread:@selector(refresh) withObject:nil waitUntilDone:NO modes:@[ NSRunLoopCommonModes ]];
+    }
+
+    return snapshot;
+}
+
+- (_CBRInMemorySnapshot *)_snapshotByApplyingValues:(NSDictionary<NSNumber *, NSDictionary<NSString *, id> *> *)values
+                                insertedIdentifiers:(NSSet<NSNumber *> *)insertedIdentifiers
+                                 deletedIdentifiers:(NSSet<NSNumber *> *)deletedIdentifiers
+                                        entityNames:(NSDictionary<NSNumber *, NSString *> *)entityNames
+                                         toSnapshot:(_CBRInMemorySnapshot *)latestSnapshot
+{
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSNumber *, id> *> *recordsByEntityName = [NSMutableDictionary dictionary];
+    uint64_t numberOfDeletions = 0;
+
+    for (NSNumber *identifier in entityNames) {
+        NSString *entityName = entityNames[identifier];
+        NSDictionary<NSString *, id> *record = [latestSnapshot.tablesByEntityName[entityName].records objectForKey:identifier];
+
+        // objects deleted by a concurrent commit stay deleted
+        if (record == nil && ![insertedIdentifiers containsObject:identifier]) {
+            continue;
+        }
+
+        NSMutableDictionary<NSNumber *, id> *records = recordsByEntityName[entityName];
+        if (records == nil) {
+            records = [NSMutableDictionary dictionary];
+            recordsByEntityName[entityName] = records;
+        }
+
+        if ([deletedIdentifiers containsObject:identifier]) {
+            records[identifier] = [NSNull null];
+            numberOfDeletions++;
+            continue;
+        }
+
+        // values are merged per key, keys changed by concurrent commits are kept
+        NSMutableDictionary<NSString *, id> *newRecord = record.mutableCopy ?: [NSMutableDictionary dictionary];
+        [values[identifier] enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stop) {
+            if (value == [NSNull null]) {
+                [newRecord removeObjectForKey:key];
+            } else {
+                newRecord[key] = value;
+            }
+        }];
+
+        records[identifier] = newRecord.copy;
+    }
+
+    NSMutableDictionary<NSString *, _CBRInMemoryTable *> *tables = latestSnapshot.tablesByEntityName.mutableCopy;
+    [recordsByEntityName enumerateKeysAndObjectsUsingBlock:^(NSString *entityName, NSDictionary<NSNumber *, id> *records, BOOL *stop) {
+        tables[entityName] = [tables[entityName] tableByApplyingRecords:records];
+    }];
+
+    return [[_CBRInMemorySnapshot alloc] initWithVersion:latestSnapshot.version + 1 numberOfDeletions:latestSnapshot.numberOfDeletions + numberOfDeletions tablesByEntityName:tables];
+}
+
+- (NSArray<NSString *> *)_indexedKeysOfEntity:(CBREntityDescription *)entity
+{
+    NSString *indexedAttributes = entity.userInfo[@"cloudBridgeIndexedAttributes"];
+    if (![indexedAttributes isKindOfClass:[NSString class]]) {
+        return @[];
+    }
+
+    NSMutableArray<NSString *> *result = [NSMutableArray array];
+    for (NSString *component in [indexedAttributes componentsSeparatedByString:@","]) {
+        NSString *attribute = [component stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+
+        if (entity.attributesByName[attribute] != nil) {
+            [result addObject:attribute];
+        } else {
+            NSLog(@"WARNING: cannot index unknown attribute %@ of %@", attribute, entity.name);
+        }
+    }
+
+    return result;
+}
+
+- (_CBRInMemoryContext *)_context
+{
+    NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+
+    _CBRInMemoryContext *context = threadDictionary[_contextKey];
+    if (context != nil) {
+        return context;
+    }
+
+    // contexts of deallocated interfaces would otherwise keep their snapshots until the thread exits
+    for (id key in threadDictionary.allKeys) {
+        if ([key isKindOfClass:[NSString class]] && [key hasPrefix:CBRInMemoryContextKeyPrefix] && [threadDictionary[key] interface] == nil) {
+            [threadDictionary removeObjectForKey:key];
+        }
+    }
+
+    context = [[_CBRInMemoryContext alloc] initWithInterface:self snapshot:self.latestSnapshot];
+    threadDictionary[_contextKey] = context;
+
+    return context;
+}
+
+@end
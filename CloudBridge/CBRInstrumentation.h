@@ -0,0 +1,107 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Durations are reported in seconds, sizes in bytes. Mapping durations are reported per entity as `CBRMetricMappingDuration.<entity name>`.
+ */
+extern NSString * const CBRMetricRequestDuration;
+extern NSString * const CBRMetricRequestBytesSent;
+extern NSString * const CBRMetricRequestBytesReceived;
+extern NSString * const CBRMetricMappingDuration;
+extern NSString * const CBRMetricTransactionDuration;
+extern NSString * const CBRMetricMainThreadHandoffDuration;
+extern NSString * const CBRMetricQueueWaitDuration;
+
+extern NSString * const CBRCounterRequestFailures;
+extern NSString * const CBRCounterObjectsInserted;
+extern NSString * const CBRCounterObjectsUpdated;
+extern NSString * const CBRCounterObjectsDeleted;
+extern NSString * const CBRCounterCacheHits;
+extern NSString * const CBRCounterCacheMisses;
+extern NSString * const CBRCounterCacheEvictions;
+extern NSString * const CBRCounterPrimaryKeyFilterSkips;
+
+
+
+/**
+ Receives metrics from all CloudBridge components. Implementations are called from arbitrary threads and must be thread safe.
+ */
+@protocol CBRInstrumentation <NSObject>
+
+/**
+ Records one sample of a distribution, e.g. a duration or a size.
+ */
+- (void)recordValue:(double)value forMetric:(NSString *)metric;
+
+/**
+ Increments a monotonic counter.
+ */
+- (void)incrementCounter:(NSString *)counter by:(NSUInteger)count;
+
+@end
+
+
+
+/**
+ The instrumentation all components report into. Defaults to `nil`, in which case no metrics are collected.
+ */
+FOUNDATION_EXTERN id<CBRInstrumentation> _Nullable CBRInstrumentationGetCurrent(void);
+FOUNDATION_EXTERN void CBRInstrumentationSetCurrent(id<CBRInstrumentation> _Nullable instrumentation);
+
+/**
+ Monotonic timestamp in seconds to measure durations with.
+ */
+FOUNDATION_EXTERN NSTimeInterval CBRInstrumentationTimestamp(void);
+
+
+
+/**
+ In-memory `CBRInstrumentation` which keeps counters and log-linear histograms with fixed memory per metric. Every thread records into its own storage, which is merged when a snapshot is taken. Non-finite values are ignored.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRInstrumentationAggregator : NSObject <CBRInstrumentation>
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns `counters` and `metrics` with `count`, `sum`, `min`, `max`, `mean`, `p50`, `p90`, `p95` and `p99` of every metric.
+ */
+- (NSDictionary<NSString *, NSDictionary *> *)snapshot;
+
+/**
+ `snapshot` serialized as JSON.
+ */
+- (nullable NSData *)JSONSnapshotWithError:(NSError **)error;
+
+/**
+ Discards all collected metrics.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,435 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRInstrumentation.h"
+
+#import <math.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <mach/mach_time.h>
+
+NSString * const CBRMetricRequestDuration = @"request.duration";
+NSString * const CBRMetricRequestBytesSent = @"request.bytesSent";
+NSString * const CBRMetricRequestBytesReceived = @"request.bytesReceived";
+NSString * const CBRMetricMappingDuration = @"mapping.duration";
+NSString * const CBRMetricTransactionDuration = @"transaction.duration";
+NSString * const CBRMetricMainThreadHandoffDuration = @"threading.mainThreadHandoff";
+NSString * const CBRMetricQueueWaitDuration = @"threading.queueWait";
+
+NSString * const CBRCounterRequestFailures = @"request.failures";
+NSString * const CBRCounterObjectsInserted = @"objects.inserted";
+NSString * const CBRCounterObjectsUpdated = @"objects.updated";
+NSString * const CBRCounterObjectsDeleted = @"objects.deleted";
+NSString * const CBRCounterCacheHits = @"cache.hits";
+NSString * const CBRCounterCacheMisses = @"cache.misses";
+NSString * const CBRCounterCacheEvictions = @"cache.evictions";
+NSString * const CBRCounterPrimaryKeyFilterSkips = @"cache.filter_skips";
+
+static pthread_rwlock_t CBRInstrumentationLock = PTHREAD_RWLOCK_INITIALIZER;
+static id<CBRInstrumentation> CBRInstrumentationCurrent = nil;
+static _Atomic(uint64_t) CBRInstrumentationGeneration = 1;
+
+/**
+ Every thread keeps a retained copy of the current instrumentation and only takes the lock once it has been replaced.
+ */
+typedef struct {
+    uint64_t generation;
+    CFTypeRef instrumentation;
+} _CBRInstrumentationThreadCache;
+
+static pthread_key_t CBRInstrumentationThreadCacheKey;
+
+static void _CBRInstrumentationThreadCacheDestroy(void *value)
+{
+    _CBRInstrumentationThreadCache *cache = value;
+    if (cache->instrumentation) {
+        CFRelease(cache->instrumentation);
+    }
+    free(cache);
+}
+
+static _CBRInstrumentationThreadCache *_CBRInstrumentationThreadCacheGetCurrent(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&CBRInstrumentationThreadCacheKey, _CBRInstrumentationThreadCacheDestroy);
+    });
+
+    _CBRInstrumentationThreadCache *cache = pthread_getspecific(CBRInstrumentationThreadCacheKey);
+    if (!cache) {
+        cache = calloc(1, sizeof(_CBRInstrumentationThreadCache));
+        pthread_setspecific(CBRInstrumentationThreadCacheKey, cache);
+    }
+
+    return cache;
+}
+
+id<CBRInstrumentation> CBRInstrumentationGetCurrent(void)
+{
+    _CBRInstrumentationThreadCache *cache = _CBRInstrumentationThreadCacheGetCurrent();
+    uint64_t generation = atomic_load(&CBRInstrumentationGeneration);
+
+    if (cache->generation != generation) {
+        pthread_rwlock_rdlock(&CBRInstrumentationLock);
+        CFTypeRef instrumentation = CBRInstrumentationCurrent ? CFBridgingRetain(CBRInstrumentationCurrent) : NULL;
+        generation = atomic_load(&CBRInstrumentationGeneration);
+        pthread_rwlock_unlock(&CBRInstrumentationLock);
+
+        if (cache->instrumentation) {
+            CFRelease(cache->instrumentation);
+        }
+
+        cache->instrumentation = instrumentation;
+        cache->generation = generation;
+    }
+
+    return (__bridge id<CBRInstrumentation>)cache->instrumentation;
+}
+
+void CBRInstrumentationSetCurrent(id<CBRInstrumentation> instrumentation)
+{
+    pthread_rwlock_wrlock(&CBRInstrumentationLock);
+    CBRInstrumentationCurrent = instrumentation;
+    atomic_fetch_add(&CBRInstrumentationGeneration, 1);
+    pthread_rwlock_unlock(&CBRInstrumentationLock);
+}
+
+NSTimeInterval CBRInstrumentationTimestamp(void)
+{
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+
+
+// 8 linear sub buckets for every power of two between 2^-40 and 2^50, bucket 0 collects values <= 0
+static const int _CBRHistogramMinExponent = -40;
+static const int _CBRHistogramMaxExponent = 50;
+static const int _CBRHistogramSubBuckets = 8;
+#define _CBRHistogramBucketCount ((50 + 40 + 1) * 8 + 1)
+
+@interface _CBRHistogram : NSObject {
+    uint64_t _buckets[_CBRHistogramBucketCount];
+}
+
+@property (nonatomic, readonly) uint64_t count;
+@property (nonatomic, readonly) double sum;
+@property (nonatomic, readonly) double min;
+@property (nonatomic, readonly) double max;
+
+- (void)recordValue:(double)value;
+- (void)addHistogram:(_CBRHistogram *)histogram;
+- (double)valueAtPercentile:(double)percentile;
+
+@end
+
+@implementation _CBRHistogram
+
+- (void)recordValue:(double)value
+{
+    _min = _count == 0 ? value : MIN(_min, value);
+    _max = _count == 0 ? value : MAX(_max, value);
+    _count++;
+    _sum += value;
+
+    _buckets[[self _bucketForValue:value]]++;
+}
+
+- (void)addHistogram:(_CBRHistogram *)histogram
+{
+    if (histogram->_count == 0) {
+        return;
+    }
+
+    _min = _count == 0 ? histogram->_min : MIN(_min, histogram->_min);
+    _max = _count == 0 ? histogram->_max : MAX(_max, histogram->_max);
+    _count += histogram->_count;
+    _sum += histogram->_sum;
+
+    for (NSUInteger bucket = 0; bucket < _CBRHistogramBucketCount; bucket++) {
+        _buckets[bucket] += histogram->_buckets[bucket];
+    }
+}
+
+- (double)valueAtPercentile:(double)percentile
+{
+    if (_count == 0) {
+        return 0.0;
+    }
+
+    uint64_t target = (uint64_t)ceil(percentile * _count);
+    uint64_t seen = 0;
+
+    for (NSUInteger bucket = 0; bucket < _CBRHistogramBucketCount; bucket++) {
+        seen += _buckets[bucket];
+
+        if (seen >= target && _buckets[bucket] > 0) {
+            return MIN(MAX([self _representativeValueOfBucket:bucket], _min), _max);
+        }
+    }
+
+    return _max;
+}
+
+- (NSUInteger)_bucketForValue:(double)value
+{
+    if (!(value > 0.0)) {
+        return 0;
+    }
+
+    int exponent = 0;
+    double mantissa = frexp(value, &exponent);
+
+    if (exponent < _CBRHistogramMinExponent) {
+        return 1;
+    } else if (exponent > _CBRHistogramMaxExponent) {
+        return _CBRHistogramBucketCount - 1;
+    }
+
+    int subBucket = MIN((int)((mantissa - 0.5) * 2.0 * _CBRHistogramSubBuckets), _CBRHistogramSubBuckets - 1);
+    return 1 + (exponent - _CBRHistogramMinExponent) * _CBRHistogramSubBuckets + subBucket;
+}
+
+- (double)_representativeValueOfBucket:(NSUInteger)bucket
+{
+    if (bucket == 0) {
+        return 0.0;
+    }
+
+    int exponent = (int)((bucket - 1) / _CBRHistogramSubBuckets) + _CBRHistogramMinExponent;
+    int subBucket = (int)((bucket - 1) % _CBRHistogramSubBuckets);
+    double mantissa = 0.5 + (subBucket + 0.5) / (2.0 * _CBRHistogramSubBuckets);
+
+    return ldexp(mantissa, exponent);
+}
+
+@end
+
+
+
+/**
+ Metrics recorded by one thread. Only the owning thread and snapshots take its lock, so recording does not contend with other threads.
+ */
+@interface _CBRInstrumentationShard : NSObject {
+@public
+    pthread_mutex_t _lock;
+}
+
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, _CBRHistogram *> *histograms;
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, NSNumber *> *counters;
+
+@end
+
+@implementation _CBRInstrumentationShard
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+
+        _histograms = [NSMutableDictionary dictionary];
+        _counters = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_lock);
+}
+
+@end
+
+/**
+ Replaces values which JSON can not represent with `NSNull`.
+ */
+static id CBRInstrumentationJSONSanitizedObject(id object)
+{
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:[object count]];
+        [object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            dictionary[key] = CBRInstrumentationJSONSanitizedObject(value);
+        }];
+        return dictionary;
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        return isfinite([object doubleValue]) ? object : [NSNull null];
+    }
+
+    return object;
+}
+
+
+
+@interface CBRInstrumentationAggregator () {
+    pthread_mutex_t _lock;
+    pthread_key_t _shardKey;
+}
+
+@property (nonatomic, readonly) NSMutableArray<_CBRInstrumentationShard *> *shards;
+
+@end
+
+
+
+@implementation CBRInstrumentationAggregator
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        pthread_mutex_init(&_lock, NULL);
+        pthread_key_create(&_shardKey, NULL);
+
+        _shards = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    // shards are owned by the array, thread specific values are unretained
+    pthread_key_delete(_shardKey);
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark - Instance methods
+
+- (NSDictionary<NSString *, NSDictionary *> *)snapshot
+{
+    NSMutableDictionary<NSString *, _CBRHistogram *> *histograms = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSNumber *> *counters = [NSMutableDictionary dictionary];
+
+    pthread_mutex_lock(&_lock);
+    for (_CBRInstrumentationShard *shard in self.shards) {
+        pthread_mutex_lock(&shard->_lock);
+
+        [shard.counters enumerateKeysAndObjectsUsingBlock:^(NSString *counter, NSNumber *count, BOOL *stop) {
+            counters[counter] = @(counters[counter].unsignedLongLongValue + count.unsignedLongLongValue);
+        }];
+
+        [shard.histograms enumerateKeysAndObjectsUsingBlock:^(NSString *metric, _CBRHistogram *histogram, BOOL *stop) {
+            if (!histograms[metric]) {
+                histograms[metric] = [[_CBRHistogram alloc] init];
+            }
+            [histograms[metric] addHistogram:histogram];
+        }];
+
+        pthread_mutex_unlock(&shard->_lock);
+    }
+    pthread_mutex_unlock(&_lock);
+
+    NSMutableDictionary *metrics = [NSMutableDictionary dictionary];
+    [histograms enumerateKeysAndObjectsUsingBlock:^(NSString *metric, _CBRHistogram *histogram, BOOL *stop) {
+        metrics[metric] = @{
+                            @"count": @(histogram.count),
+                            @"sum": @(histogram.sum),
+                            @"min": @(histogram.min),
+                            @"max": @(histogram.max),
+                            @"mean": @(histogram.count > 0 ? histogram.sum / histogram.count : 0.0),
+                            @"p50": @([histogram valueAtPercentile:0.5]),
+                            @"p90": @([histogram valueAtPercentile:0.9]),
+                            @"p95": @([histogram valueAtPercentile:0.95]),
+                            @"p99": @([histogram valueAtPercentile:0.99]),
+                            };
+    }];
+
+    return @{ @"counters": [counters copy], @"metrics": metrics };
+}
+
+- (NSData *)JSONSnapshotWithError:(NSError **)error
+{
+    // sums of huge samples can still overflow to infinity
+    return [NSJSONSerialization dataWithJSONObject:CBRInstrumentationJSONSanitizedObject([self snapshot]) options:NSJSONWritingPrettyPrinted error:error];
+}
+
+- (void)reset
+{
+    pthread_mutex_lock(&_lock);
+    for (_CBRInstrumentationShard *shard in self.shards) {
+        pthread_mutex_lock(&shard->_lock);
+        [shard.histograms removeAllObjects];
+        [shard.counters removeAllObjects];
+        pthread_mutex_unlock(&shard->_lock);
+    }
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - CBRInstrumentation
+
+- (void)recordValue:(double)value forMetric:(NSString *)metric
+{
+    // NaN and infinite samples would poison sum, mean and the percentiles
+    if (!isfinite(value)) {
+        return;
+    }
+
+    _CBRInstrumentationShard *shard = [self _shardOfCurrentThread];
+    pthread_mutex_lock(&shard->_lock);
+
+    _CBRHistogram *histogram = shard.histograms[metric];
+    if (!histogram) {
+        histogram = [[_CBRHistogram alloc] init];
+        shard.histograms[metric] = histogram;
+    }
+
+    [histogram recordValue:value];
+
+    pthread_mutex_unlock(&shard->_lock);
+}
+
+- (void)incrementCounter:(NSString *)counter by:(NSUInteger)count
+{
+    _CBRInstrumentationShard *shard = [self _shardOfCurrentThread];
+
+    pthread_mutex_lock(&shard->_lock);
+    shard.counters[counter] = @(shard.counters[counter].unsignedLongLongValue + count);
+    pthread_mutex_unlock(&shard->_lock);
+}
+
+#pragma mark - Private category implementation ()
+
+- (_CBRInstrumentationShard *)_shardOfCurrentThread
+{
+    _CBRInstrumentationShard *shard = (__bridge _CBRInstrumentationShard *)pthread_getspecific(_shardKey);
+    if (shard) {
+        return shard;
+    }
+
+    // shards outlive their threads so that their metrics remain part of the snapshot
+    shard = [[_CBRInstrumentationShard alloc] init];
+
+    pthread_mutex_lock(&_lock);
+    [self.shards addObject:shard];
+    pthread_mutex_unlock(&_lock);
+
+    pthread_setspecific(_shardKey, (__bridge void *)shard);
+    return shard;
+}
+
+@end
@@ -0,0 +1,98 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CloudBridge/CBREntityDescription.h>
+
+@class CBRCloudBridge;
+
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Retention policy of an entity, declared in its `userInfo`.
+ */
+@interface CBREntityDescription (CBRMaintenanceScheduler)
+
+/**
+ `cloudBridgeSyncDateAttribute`: date attribute which `CBRCloudBridge` sets whenever an object is mapped from a cloud object. Required by the policies below.
+ */
+@property (nonatomic, nullable, readonly) NSString *syncDateAttribute;
+
+/**
+ `cloudBridgeTimeToLive`: seconds after which objects which were not synced again are evicted, `0` keeps them.
+ */
+@property (nonatomic, readonly) NSTimeInterval timeToLive;
+
+/**
+ `cloudBridgeCountLimit`: maximum number of synced objects kept, the least recently synced ones are evicted first. `0` means no limit.
+ */
+@property (nonatomic, readonly) NSUInteger countLimit;
+
+@end
+
+
+
+/**
+ Evicts objects according to the retention policy of their entity and compacts the store once it is fragmented. Evictions run in small write transactions on the background thread of `cloudBridge`, deleted objects are removed from the caches of both threads.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRMaintenanceScheduler : NSObject
+
+@property (nonatomic, readonly) CBRCloudBridge *cloudBridge;
+
+/**
+ Seconds between two runs after `start`, defaults to 10 minutes.
+ */
+@property (nonatomic, assign) NSTimeInterval interval;
+
+/**
+ Maximum number of objects evicted in one write transaction, defaults to 200.
+ */
+@property (nonatomic, assign) NSUInteger batchSize;
+
+/**
+ Unused fraction of the store file above which the store is compacted, defaults to 0.3.
+ */
+@property (nonatomic, assign) double compactionThreshold;
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithCloudBridge:(CBRCloudBridge *)cloudBridge NS_DESIGNATED_INITIALIZER;
+
+/**
+ Runs maintenance now and every `interval` until `stop` is called.
+ */
+- (void)start;
+- (void)stop;
+
+/**
+ Runs maintenance once. `completionHandler` is called on the main queue, calls during a running pass join it.
+ */
+- (void)runWithCompletionHandler:(nullable void(^)(NSUInteger numberOfEvictedObjects))completionHandler;
+
+@end
+
+NS_ASSUME_NONNULL_END
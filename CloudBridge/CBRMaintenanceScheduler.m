@@ -0,0 +1,264 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRMaintenanceScheduler.h"
+#import "CBRCloudBridge.h"
+#import "CBRCloudObjectTransformer.h"
+#import "CBRDatabaseAdapter.h"
+#import "CBRPersistentObjectCache.h"
+
+
+
+@implementation CBREntityDescription (CBRMaintenanceScheduler)
+
+- (NSString *)syncDateAttribute
+{
+    return self.userInfo[@"cloudBridgeSyncDateAttribute"];
+}
+
+- (NSTimeInterval)timeToLive
+{
+    return [self.userInfo[@"cloudBridgeTimeToLive"] doubleValue];
+}
+
+- (NSUInteger)countLimit
+{
+    return [self.userInfo[@"cloudBridgeCountLimit"] unsignedIntegerValue];
+}
+
+@end
+
+
+
+@interface CBRMaintenanceScheduler ()
+
+@property (nonatomic, assign) BOOL running;
+@property (nonatomic, assign) BOOL started;
+
+@property (nonatomic, readonly) NSMutableArray<void(^)(NSUInteger numberOfEvictedObjects)> *completionHandlers;
+
+@end
+
+
+
+@implementation CBRMaintenanceScheduler
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    return [super init];
+}
+
+- (instancetype)initWithCloudBridge:(CBRCloudBridge *)cloudBridge
+{
+    if (self = [super init]) {
+        _cloudBridge = cloudBridge;
+        _interval = 10.0 * 60.0;
+        _batchSize = 200;
+        _compactionThreshold = 0.3;
+        _completionHandlers = [NSMutableArray array];
+    }
+    return self;
+}
+
+#pragma mark - Instance methods
+
+- (void)start
+{
+    if (self.started) {
+        return;
+    }
+
+    self.started = YES;
+    [self _runAndReschedule];
+}
+
+- (void)stop
+{
+    self.started = NO;
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_runAndReschedule) object:nil];
+}
+
+- (void)runWithCompletionHandler:(void(^)(NSUInteger numberOfEvictedObjects))completionHandler
+{
+    NSParameterAssert([NSThread isMainThread]);
+
+    if (completionHandler != nil) {
+        [self.completionHandlers addObject:[completionHandler copy]];
+    }
+
+    if (self.running) {
+        return;
+    }
+
+    self.running = YES;
+
+    NSMutableArray<CBREntityDescription *> *entities = [NSMutableArray array];
+    for (CBREntityDescription *entityDescription in self.cloudBridge.databaseAdapter.entities) {
+        if (entityDescription.syncDateAttribute != nil && (entityDescription.timeToLive > 0.0 || entityDescription.countLimit > 0)) {
+            [entities addObject:entityDescription];
+        }
+    }
+
+    [self _evictObjectsOfEntities:entities atIndex:0 numberOfEvictedObjects:0];
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_runAndReschedule
+{
+    [self runWithCompletionHandler:^(NSUInteger numberOfEvictedObjects) {
+        if (self.started) {
+            [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_runAndReschedule) object:nil];
+            [self performSelector:@selector(_runAndReschedule) withObject:nil afterDelay:self.interval];
+        }
+    }];
+}
+
+- (void)_evictObjectsOfEntities:(NSArray<CBREntityDescription *> *)entities atIndex:(NSUInteger)index numberOfEvictedObjects:(NSUInteger)numberOfEvictedObjects
+{
+    if (index >= entities.count) {
+        [self _compactStoreWithNumberOfEvictedObjects:numberOfEvictedObjects];
+        return;
+    }
+
+    CBREntityDescription *entityDescription = entities[index];
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+
+    NSString *primaryKey = [self.cloudBridge.cloudConnection.objectTransformer primaryKeyOfEntitiyDescription:entityDescription];
+    NSUInteger batchSize = MAX(self.batchSize, 1);
+    NSDate *date = [NSDate date];
+
+    [databaseAdapter transactionWithObject:nil transaction:^id _Nullable(id  _Nullable object) {
+        NSArray *evictedObjects = [self _evictableObjectsOfEntity:entityDescription date:date limit:batchSize];
+
+        NSMutableArray *evictedPrimaryKeys = [NSMutableArray arrayWithCapacity:evictedObjects.count];
+        for (id<CBRPersistentObject> persistentObject in evictedObjects) {
+            id value = [persistentObject valueForKey:primaryKey];
+
+            if (value != nil) {
+                [evictedPrimaryKeys addObject:value];
+            }
+        }
+
+        [databaseAdapter deletePersistentObjects:evictedObjects];
+        return @[ evictedPrimaryKeys, @(evictedObjects.count) ];
+    } completion:^(NSArray * _Nullable result, NSError * _Nullable error) {
+        if (error != nil) {
+            NSLog(@"[CBRMaintenanceScheduler] evicting objects of %@ failed: %@", entityDescription.name, error);
+        }
+
+        // the main thread has its own cache, which still holds its instances of the evicted objects
+        CBRPersistentObjectCache *cache = [databaseAdapter.interface persistentObjectCacheOnCurrentThreadForEntity:entityDescription];
+        for (id value in result.firstObject) {
+            [cache removeObjectOfType:entityDescription.name withValue:value];
+        }
+
+        NSUInteger count = [result.lastObject unsignedIntegerValue];
+        BOOL exhausted = error != nil || count < batchSize;
+
+        [self _evictObjectsOfEntities:entities atIndex:exhausted ? index + 1 : index numberOfEvictedObjects:numberOfEvictedObjects + count];
+    }];
+}
+
+/**
+ Objects which outlived the time to live of their entity, followed by the least recently synced objects beyond its count limit. Objects which were never synced are kept.
+ */
+- (NSArray *)_evictableObjectsOfEntity:(CBREntityDescription *)entityDescription date:(NSDate *)date limit:(NSUInteger)limit
+{
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+    NSString *syncDateAttribute = entityDescription.syncDateAttribute;
+    NSMutableArray *evictableObjects = [NSMutableArray array];
+
+    if (entityDescription.timeToLive > 0.0) {
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entityDescription.name];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K < %@", syncDateAttribute, [date dateByAddingTimeInterval:-entityDescription.timeToLive]];
+        fetchRequest.fetchLimit = limit;
+
+        NSError *error = nil;
+        NSArray *fetchedObjects = [databaseAdapter executeFetchRequest:fetchRequest error:&error];
+        NSAssert(error == nil, @"error executing fetch request: %@", error);
+
+        [evictableObjects addObjectsFromArray:fetchedObjects];
+    }
+
+    if (entityDescription.countLimit > 0 && evictableObjects.count < limit) {
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entityDescription.name];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K != nil", syncDateAttribute];
+        fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:syncDateAttribute ascending:NO] ];
+        fetchRequest.fetchOffset = entityDescription.countLimit;
+        fetchRequest.fetchLimit = limit;
+
+        NSError *error = nil;
+        NSArray *fetchedObjects = [databaseAdapter executeFetchRequest:fetchRequest error:&error];
+        NSAssert(error == nil, @"error executing fetch request: %@", error);
+
+        // expired objects are still counted towards the limit, both fetches may return them
+        NSMutableSet *expiredObjects = [NSMutableSet setWithArray:evictableObjects];
+        for (id persistentObject in fetchedObjects) {
+            if (evictableObjects.count >= limit) {
+                break;
+            }
+
+            if (![expiredObjects containsObject:persistentObject]) {
+                [evictableObjects addObject:persistentObject];
+            }
+        }
+    }
+
+    return evictableObjects;
+}
+
+- (void)_compactStoreWithNumberOfEvictedObjects:(NSUInteger)numberOfEvictedObjects
+{
+    id<CBRPersistentStoreInterface> interface = self.cloudBridge.databaseAdapter.interface;
+    double compactionThreshold = self.compactionThreshold;
+
+    dispatch_block_t completion = ^{
+        self.running = NO;
+
+        NSArray<void(^)(NSUInteger numberOfEvictedObjects)> *completionHandlers = self.completionHandlers.copy;
+        [self.completionHandlers removeAllObjects];
+
+        for (void(^completionHandler)(NSUInteger numberOfEvictedObjects) in completionHandlers) {
+            completionHandler(numberOfEvictedObjects);
+        }
+    };
+
+    if (![interface respondsToSelector:@selector(compactStoreIfFragmentationExceeds:error:)]) {
+        completion();
+        return;
+    }
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSError *error = nil;
+        if (![interface compactStoreIfFragmentationExceeds:compactionThreshold error:&error] && error != nil) {
+            NSLog(@"[CBRMaintenanceScheduler] compacting store failed: %@", error);
+        }
+
+        dispatch_async(dispatch_get_main_queue(), completion);
+    });
+}
+
+@end
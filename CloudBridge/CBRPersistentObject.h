@@ -100,6 +100,11 @@ void class_implementProtocolExtension(Class klass, Protocol *protocol, Class pro
 - (void)fetchObjectForRelationship:(NSString *)relationship withCompletionHandler:(void(^_Nullable)(id _Nullable object, NSError * _Nullable error))completionHandler NS_REFINED_FOR_SWIFT;
 - (void)fetchObjectsForRelationship:(NSString *)relationship withCompletionHandler:(void(^_Nullable)(NSArray * _Nullable objects, NSError * _Nullable error))completionHandler NS_REFINED_FOR_SWIFT;
 
+/**
+ Fetches a to-many relationship for multiple objects with a single request, see `-[CBRCloudBridge fetchPersistentObjectsForRelationship:ofPersistentObjects:userInfo:completionHandler:]`.
+ */
++ (void)fetchObjectsForRelationship:(NSString *)relationship ofObjects:(NSArray *)objects withCompletionHandler:(void(^_Nullable)(NSArray * _Nullable objects, NSError * _Nullable error))completionHandler;
+
 - (void)createWithCompletionHandler:(void(^_Nullable)(id _Nullable managedObject, NSError * _Nullable error))completionHandler NS_REFINED_FOR_SWIFT;
 - (void)reloadWithCompletionHandler:(void(^_Nullable)(id _Nullable managedObject, NSError * _Nullable error))completionHandler NS_REFINED_FOR_SWIFT;
 - (void)saveWithCompletionHandler:(void(^_Nullable)(id _Nullable managedObject, NSError * _Nullable error))completionHandler NS_REFINED_FOR_SWIFT;
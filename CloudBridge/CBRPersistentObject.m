@@ -289,6 +289,11 @@ void class_implementProtocolExtension(Class klass, Protocol *protocol, Class pro
                                   completionHandler:completionHandler];
 }
 
++ (void)fetchObjectsForRelationship:(NSString *)relationship ofObjects:(NSArray *)objects withCompletionHandler:(void(^)(NSArray *objects, NSError *error))completionHandler
+{
+    [[self cloudBridge] fetchPersistentObjectsForRelationship:relationship ofPersistentObjects:objects userInfo:nil completionHandler:completionHandler];
+}
+
 + (instancetype)persistentObjectFromCloudObject:(id<CBRCloudObject>)cloudObject
 {
     CBREntityDescription *entity = [self cloudBridgeEntityDescription];
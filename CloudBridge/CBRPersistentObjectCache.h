@@ -35,6 +35,15 @@ __attribute__((objc_subclassing_restricted))
 
 @property (nonatomic, weak, readonly) id<CBRPersistentStoreInterface> interface;
 
+/**
+ Maximum number of cached objects, least recently used objects are evicted first. Defaults to 10000, `0` means no limit.
+ */
+@property (nonatomic, assign) NSUInteger countLimit;
+
+@property (nonatomic, readonly) NSUInteger hits;
+@property (nonatomic, readonly) NSUInteger misses;
+@property (nonatomic, readonly) NSUInteger evictions;
+
 - (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithInterface:(id<CBRPersistentStoreInterface>)interface NS_DESIGNATED_INITIALIZER;
 
@@ -57,6 +66,16 @@ __attribute__((objc_subclassing_restricted))
  */
 - (void)removePersistentObject:(id<CBRPersistentObject>)persistentObject;
 
+/**
+ Removes the cached object of `type` where `attribute == value`, e.g. after it has been deleted on another thread.
+ */
+- (void)removeObjectOfType:(NSString *)type withValue:(id)value;
+
+/**
+ Number of cached objects of `type`.
+ */
+- (NSUInteger)numberOfObjectsOfType:(NSString *)type;
+
 @end
 
 NS_ASSUME_NONNULL_END
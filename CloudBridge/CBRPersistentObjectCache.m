@@ -25,6 +25,9 @@
 
 #import "CBRPersistentObjectCache.h"
 #import "CBREnumaratableCache.h"
+#import "CBRPersistentObjectIndex.h"
+#import "CBRPrimaryKeyFilter.h"
+#import "CBRInstrumentation.h"
 
 
 
@@ -48,12 +51,46 @@
     if (self = [super init]) {
         _interface = interface;
         _internalCache = [[CBREnumaratableCache alloc] init];
+        _internalCache.countLimit = 10000;
+        _internalCache.evictionHandler = ^(id key, id object) {
+            [CBRInstrumentationGetCurrent() incrementCounter:CBRCounterCacheEvictions by:1];
+        };
     }
     return self;
 }
 
 #pragma mark - Instance methods
 
+- (NSUInteger)countLimit
+{
+    return self.internalCache.countLimit;
+}
+
+- (void)setCountLimit:(NSUInteger)countLimit
+{
+    self.internalCache.countLimit = countLimit;
+}
+
+- (NSUInteger)hits
+{
+    return self.internalCache.hits;
+}
+
+- (NSUInteger)misses
+{
+    return self.internalCache.misses;
+}
+
+- (NSUInteger)evictions
+{
+    return self.internalCache.evictions;
+}
+
+- (NSUInteger)numberOfObjectsOfType:(NSString *)type
+{
+    return [self.internalCache totalCostOfGroup:type];
+}
+
 - (id)objectOfType:(NSString *)type withValue:(id)value forAttribute:(NSString *)attribute
 {
     if (!value) {
@@ -61,8 +98,26 @@
     }
 
     NSString *cacheKey = [NSString stringWithFormat:@"%@#%@", type, value];
-    if ([self.internalCache objectForKey:cacheKey]) {
-        return [self.internalCache objectForKey:cacheKey];
+    id cachedObject = [self.internalCache objectForKey:cacheKey];
+
+    [CBRInstrumentationGetCurrent() incrementCounter:cachedObject ? CBRCounterCacheHits : CBRCounterCacheMisses by:1];
+
+    if (cachedObject) {
+        return cachedObject;
+    }
+
+    id indexedObject = [self _indexedObjectOfType:type withValue:value];
+    if (indexedObject) {
+        [self.internalCache setObject:indexedObject forKey:cacheKey cost:1 group:type];
+        return indexedObject;
+    }
+
+    CBRPrimaryKeyFilter *filter = [self _primaryKeyFilterOfType:type attribute:attribute];
+    if (filter && ![filter containsValue:value]) {
+        // the caller is about to insert an object for value, which must be found by the next lookup
+        [filter addValue:value];
+        [CBRInstrumentationGetCurrent() incrementCounter:CBRCounterPrimaryKeyFilterSkips by:1];
+        return nil;
     }
 
     NSFetchRequest *fetchRequest = [[NSFetchRequest alloc] initWithEntityName:type];
@@ -75,7 +130,8 @@
 
     if (fetchedObjects.count > 0) {
         NSManagedObject *managedObject = fetchedObjects.firstObject;
-        [self.internalCache setObject:managedObject forKey:cacheKey];
+        [self.internalCache setObject:managedObject forKey:cacheKey cost:1 group:type];
+        [self _indexPersistentObject:managedObject ofType:type withValue:value];
         return managedObject;
     }
 
@@ -95,6 +151,14 @@
         NSString *key = [NSString stringWithFormat:@"%@#%@", type, value];
         id cachedObject = [self.internalCache objectForKey:key];
 
+        if (!cachedObject) {
+            cachedObject = [self _indexedObjectOfType:type withValue:value];
+
+            if (cachedObject) {
+                [self.internalCache setObject:cachedObject forKey:key cost:1 group:type];
+            }
+        }
+
         if (cachedObject) {
             indexedObjects[value] = cachedObject;
         } else {
@@ -102,6 +166,28 @@
         }
     }
 
+    id<CBRInstrumentation> instrumentation = CBRInstrumentationGetCurrent();
+    [instrumentation incrementCounter:CBRCounterCacheHits by:indexedObjects.count];
+    [instrumentation incrementCounter:CBRCounterCacheMisses by:valuesToFetch.count];
+
+    CBRPrimaryKeyFilter *filter = [self _primaryKeyFilterOfType:type attribute:attribute];
+    if (filter) {
+        NSUInteger numberOfValues = valuesToFetch.count;
+
+        for (id value in valuesToFetch.allObjects) {
+            if (![filter containsValue:value]) {
+                [filter addValue:value];
+                [valuesToFetch removeObject:value];
+            }
+        }
+
+        [instrumentation incrementCounter:CBRCounterPrimaryKeyFilterSkips by:numberOfValues - valuesToFetch.count];
+    }
+
+    if (valuesToFetch.count == 0) {
+        return [indexedObjects copy];
+    }
+
     NSFetchRequest *request = [NSFetchRequest fetchRequestWithEntityName:type];
     request.predicate = [NSPredicate predicateWithFormat:@"%K IN %@", attribute, valuesToFetch];
 
@@ -113,7 +199,8 @@
         id value = [managedObject valueForKey:attribute];
         NSString *cacheKey = [NSString stringWithFormat:@"%@#%@", type, value];
 
-        [self.internalCache setObject:managedObject forKey:cacheKey];
+        [self.internalCache setObject:managedObject forKey:cacheKey cost:1 group:type];
+        [self _indexPersistentObject:managedObject ofType:type withValue:value];
         indexedObjects[value] = managedObject;
     }
 
@@ -122,19 +209,58 @@
 
 - (void)removePersistentObject:(id<CBRPersistentObject>)managedObject
 {
-    NSMutableSet *keysToRemove = [NSMutableSet set];
+    [self.internalCache removeObject:managedObject];
 
-    for (id key in self.internalCache) {
-        if ([self.internalCache objectForKey:key] == managedObject) {
-            [keysToRemove addObject:key];
+    id<CBRPersistentStoreInterface> interface = self.interface;
+    if ([interface respondsToSelector:@selector(persistentObjectIndex)]) {
+        id reference = [interface indexReferenceForPersistentObject:managedObject];
+
+        if (reference) {
+            [interface.persistentObjectIndex removeReference:reference];
         }
     }
+}
 
-    for (id key in keysToRemove) {
-        [self.internalCache removeObjectForKey:key];
-    }
+- (void)removeObjectOfType:(NSString *)type withValue:(id)value
+{
+    NSString *cacheKey = [NSString stringWithFormat:@"%@#%@", type, value];
+    [self.internalCache removeObjectForKey:cacheKey];
 }
 
 #pragma mark - Private category implementation ()
 
+- (id)_indexedObjectOfType:(NSString *)type withValue:(id)value
+{
+    id<CBRPersistentStoreInterface> interface = self.interface;
+    if (![interface respondsToSelector:@selector(persistentObjectIndex)]) {
+        return nil;
+    }
+
+    id reference = [interface.persistentObjectIndex referenceForEntity:type value:value];
+    return reference ? [interface persistentObjectForIndexReference:reference] : nil;
+}
+
+- (CBRPrimaryKeyFilter *)_primaryKeyFilterOfType:(NSString *)type attribute:(NSString *)attribute
+{
+    id<CBRPersistentStoreInterface> interface = self.interface;
+    if (![interface respondsToSelector:@selector(primaryKeyFilterForEntity:attribute:)]) {
+        return nil;
+    }
+
+    return [interface primaryKeyFilterForEntity:type attribute:attribute];
+}
+
+- (void)_indexPersistentObject:(id)persistentObject ofType:(NSString *)type withValue:(id)value
+{
+    id<CBRPersistentStoreInterface> interface = self.interface;
+    if (![interface respondsToSelector:@selector(persistentObjectIndex)]) {
+        return;
+    }
+
+    id reference = [interface indexReferenceForPersistentObject:persistentObject];
+    if (reference) {
+        [interface.persistentObjectIndex setReference:reference forEntity:type value:value];
+    }
+}
+
 @end
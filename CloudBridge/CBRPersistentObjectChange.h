@@ -32,6 +32,13 @@ __attribute__((objc_subclassing_restricted))
 
 @property (nonatomic, readonly) NSInteger count;
 
+/**
+ Deletions and updates are indexes before, insertions indexes after the change. Moves are a deletion plus an insertion.
+ */
+@property (nonatomic, readonly) NSIndexSet *deletedIndexes;
+@property (nonatomic, readonly) NSIndexSet *insertedIndexes;
+@property (nonatomic, readonly) NSIndexSet *updatedIndexes;
+
 @property (nonatomic, readonly) NSArray<NSNumber *> *deletions;
 @property (nonatomic, readonly) NSArray<NSNumber *> *insertions;
 @property (nonatomic, readonly) NSArray<NSNumber *> *updates;
@@ -40,6 +47,13 @@ __attribute__((objc_subclassing_restricted))
 - (NSArray<NSIndexPath *> *)insertionsWithSection:(NSInteger)section;
 - (NSArray<NSIndexPath *> *)updatesWithSection:(NSInteger)section;
 
+/**
+ Single change equivalent to applying the receiver and then `change`.
+ */
+- (CBRPersistentObjectChange *)changeByAppendingChange:(CBRPersistentObjectChange *)change;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithDeletedIndexes:(NSIndexSet *)deletedIndexes insertedIndexes:(NSIndexSet *)insertedIndexes updatedIndexes:(NSIndexSet *)updatedIndexes NS_DESIGNATED_INITIALIZER;
 - (instancetype)initWithDeletions:(NSArray<NSNumber *> *)deletions insertions:(NSArray<NSNumber *> *)insertions updates:(NSArray<NSNumber *> *)updates;
 
 @end
@@ -23,16 +23,107 @@
 
 #import "CBRPersistentObjectChange.h"
 
-@implementation CBRPersistentObjectChange
+static NSIndexSet *CBRIndexSetFromNumbers(NSArray<NSNumber *> *numbers)
+{
+    NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+    for (NSNumber *number in numbers) {
+        [result addIndex:number.unsignedIntegerValue];
+    }
+    return result;
+}
+
+static NSArray<NSNumber *> *CBRNumbersFromIndexSet(NSIndexSet *indexSet)
+{
+    NSMutableArray<NSNumber *> *result = [NSMutableArray arrayWithCapacity:indexSet.count];
+    [indexSet enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        [result addObject:@(index)];
+    }];
+    return result;
+}
+
+static NSArray<NSIndexPath *> *CBRIndexPathsFromIndexSet(NSIndexSet *indexSet, NSInteger section)
+{
+    NSMutableArray<NSIndexPath *> *result = [NSMutableArray arrayWithCapacity:indexSet.count];
+    [indexSet enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        NSUInteger indexes[] = { section, index };
+        [result addObject:[NSIndexPath indexPathWithIndexes:indexes length:2]];
+    }];
+    return result;
+}
+
+/**
+ Returns the `rank`th index, starting at 0, which is not contained in `indexSet`.
+ */
+static NSUInteger CBRIndexNotInIndexSet(NSIndexSet *indexSet, NSUInteger rank)
+{
+    NSUInteger index = rank;
+    while (YES) {
+        NSUInteger nextIndex = rank + [indexSet countOfIndexesInRange:NSMakeRange(0, index + 1)];
+        if (nextIndex == index) {
+            return index;
+        }
+        index = nextIndex;
+    }
+}
+
+/**
+ Returns the position of `index` after all indexes of `indexSet` have been removed.
+ */
+static NSUInteger CBRRankOfIndexNotInIndexSet(NSIndexSet *indexSet, NSUInteger index)
+{
+    return index - [indexSet countOfIndexesInRange:NSMakeRange(0, index)];
+}
+
+
+
+@implementation CBRPersistentObjectChange {
+    NSArray<NSNumber *> *_deletions;
+    NSArray<NSNumber *> *_insertions;
+    NSArray<NSNumber *> *_updates;
+}
 
 - (NSInteger)count
 {
-    return self.deletions.count + self.insertions.count + self.updates.count;
+    return self.deletedIndexes.count + self.insertedIndexes.count + self.updatedIndexes.count;
 }
 
-- (instancetype)initWithDeletions:(NSArray<NSNumber *> *)deletions insertions:(NSArray<NSNumber *> *)insertions updates:(NSArray<NSNumber *> *)updates
+- (NSArray<NSNumber *> *)deletions
+{
+    if (_deletions == nil) {
+        _deletions = CBRNumbersFromIndexSet(self.deletedIndexes);
+    }
+    return _deletions;
+}
+
+- (NSArray<NSNumber *> *)insertions
+{
+    if (_insertions == nil) {
+        _insertions = CBRNumbersFromIndexSet(self.insertedIndexes);
+    }
+    return _insertions;
+}
+
+- (NSArray<NSNumber *> *)updates
+{
+    if (_updates == nil) {
+        _updates = CBRNumbersFromIndexSet(self.updatedIndexes);
+    }
+    return _updates;
+}
+
+- (instancetype)initWithDeletedIndexes:(NSIndexSet *)deletedIndexes insertedIndexes:(NSIndexSet *)insertedIndexes updatedIndexes:(NSIndexSet *)updatedIndexes
 {
     if (self = [super init]) {
+        _deletedIndexes = [deletedIndexes copy];
+        _insertedIndexes = [insertedIndexes copy];
+        _updatedIndexes = [updatedIndexes copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithDeletions:(NSArray<NSNumber *> *)deletions insertions:(NSArray<NSNumber *> *)insertions updates:(NSArray<NSNumber *> *)updates
+{
+    if (self = [self initWithDeletedIndexes:CBRIndexSetFromNumbers(deletions) insertedIndexes:CBRIndexSetFromNumbers(insertions) updatedIndexes:CBRIndexSetFromNumbers(updates)]) {
         _deletions = deletions;
         _insertions = insertions;
         _updates = updates;
@@ -42,38 +133,69 @@
 
 - (NSArray<NSIndexPath *> *)deletionsWithSection:(NSInteger)section
 {
-    NSMutableArray<NSIndexPath *> *result = [NSMutableArray array];
-
-    for (NSNumber *number in self.deletions) {
-        NSUInteger indexes[] = { section, number.unsignedIntegerValue };
-        [result addObject:[NSIndexPath indexPathWithIndexes:indexes length:2]];
-    }
-
-    return result;
+    return CBRIndexPathsFromIndexSet(self.deletedIndexes, section);
 }
 
 - (NSArray<NSIndexPath *> *)insertionsWithSection:(NSInteger)section
 {
-    NSMutableArray<NSIndexPath *> *result = [NSMutableArray array];
-
-    for (NSNumber *number in self.insertions) {
-        NSUInteger indexes[] = { section, number.unsignedIntegerValue };
-        [result addObject:[NSIndexPath indexPathWithIndexes:indexes length:2]];
-    }
-
-    return result;
+    return CBRIndexPathsFromIndexSet(self.insertedIndexes, section);
 }
 
 - (NSArray<NSIndexPath *> *)updatesWithSection:(NSInteger)section
 {
-    NSMutableArray<NSIndexPath *> *result = [NSMutableArray array];
+    return CBRIndexPathsFromIndexSet(self.updatedIndexes, section);
+}
 
-    for (NSNumber *number in self.updates) {
-        NSUInteger indexes[] = { section, number.unsignedIntegerValue };
-        [result addObject:[NSIndexPath indexPathWithIndexes:indexes length:2]];
+- (CBRPersistentObjectChange *)changeByAppendingChange:(CBRPersistentObjectChange *)change
+{
+    if (self.count == 0) {
+        return change;
+    } else if (change.count == 0) {
+        return self;
     }
 
-    return result;
+    // the receiver maps A to B, change maps B to C
+    NSIndexSet *deletedFromA = self.deletedIndexes, *insertedIntoB = self.insertedIndexes;
+    NSIndexSet *deletedFromB = change.deletedIndexes, *insertedIntoC = change.insertedIndexes;
+
+    NSUInteger (^indexInA)(NSUInteger) = ^NSUInteger(NSUInteger indexInB) {
+        return CBRIndexNotInIndexSet(deletedFromA, CBRRankOfIndexNotInIndexSet(insertedIntoB, indexInB));
+    };
+
+    NSMutableIndexSet *deletedIndexes = [deletedFromA mutableCopy];
+    NSMutableIndexSet *insertedIndexes = [insertedIntoC mutableCopy];
+    NSMutableIndexSet *updatedIndexes = [NSMutableIndexSet indexSet];
+
+    [deletedFromB enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        if (![insertedIntoB containsIndex:index]) {
+            [deletedIndexes addIndex:indexInA(index)];
+        }
+    }];
+
+    [insertedIntoB enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        if (![deletedFromB containsIndex:index]) {
+            [insertedIndexes addIndex:CBRIndexNotInIndexSet(insertedIntoC, CBRRankOfIndexNotInIndexSet(deletedFromB, index))];
+        }
+    }];
+
+    [self.updatedIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        if ([deletedFromA containsIndex:index]) {
+            return;
+        }
+
+        NSUInteger indexInB = CBRIndexNotInIndexSet(insertedIntoB, CBRRankOfIndexNotInIndexSet(deletedFromA, index));
+        if (![deletedFromB containsIndex:indexInB]) {
+            [updatedIndexes addIndex:index];
+        }
+    }];
+
+    [change.updatedIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        if (![deletedFromB containsIndex:index] && ![insertedIntoB containsIndex:index]) {
+            [updatedIndexes addIndex:indexInA(index)];
+        }
+    }];
+
+    return [[CBRPersistentObjectChange alloc] initWithDeletedIndexes:deletedIndexes insertedIndexes:insertedIndexes updatedIndexes:updatedIndexes];
 }
 
 - (NSString *)description
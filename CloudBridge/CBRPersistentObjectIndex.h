@@ -0,0 +1,79 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Thread safe index from an entity and a cloud identifier to a reference which is valid on every thread, like an `NSManagedObjectID`. Shared by the `CBRPersistentObjectCache`s of all threads of one persistent store interface.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRPersistentObjectIndex : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ Directory of the journal, see `-[CBRPersistentObjectIndex restoreFromDirectory:encoder:decoder:validation:completionHandler:]`.
+ */
+@property (nonatomic, readonly, nullable) NSURL *directoryURL;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER;
+
+- (nullable id)referenceForEntity:(NSString *)entity value:(id)value;
+- (void)setReference:(id<NSCopying>)reference forEntity:(NSString *)entity value:(id)value;
+
+/**
+ Removes every entry pointing to `reference`.
+ */
+- (void)removeReference:(id<NSCopying>)reference;
+- (void)removeAllReferences;
+
+@end
+
+
+
+@interface CBRPersistentObjectIndex (Persistence)
+
+/**
+ Journals every change to one append-only file per entity in `directoryURL` and restores the existing journal on a background queue. Journals are read memory mapped and compacted while restoring, every record carries a checksum and replaying stops at the first torn or corrupted record.
+
+ @param encoder Converts a reference into data, return `nil` for references which should not be persisted.
+ @param decoder Converts data back into a reference.
+ @param validation Called on the background queue with all restored references of one entity, returns the references which are still valid.
+ @param completionHandler Called on the main queue once restored references are available.
+ */
+- (void)restoreFromDirectory:(NSURL *)directoryURL
+                     encoder:(NSData *_Nullable(^)(id reference))encoder
+                     decoder:(id _Nullable(^)(NSData *data))decoder
+                  validation:(nullable NSSet *(^)(NSString *entity, NSSet *references))validation
+           completionHandler:(nullable dispatch_block_t)completionHandler;
+
+/**
+ Appends all changes since the last call to the journal and syncs them to disk, asynchronously.
+ */
+- (void)synchronize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,563 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRPersistentObjectIndex.h"
+
+#import <pthread.h>
+#import <fcntl.h>
+#import <unistd.h>
+
+static const char CBRPersistentObjectIndexMagic[4] = { 'C', 'B', 'R', 'I' };
+static const uint32_t CBRPersistentObjectIndexVersion = 2;
+
+typedef NS_ENUM(uint8_t, CBRPersistentObjectIndexOperation) {
+    CBRPersistentObjectIndexOperationSet = 1,
+    CBRPersistentObjectIndexOperationRemove = 2,
+};
+
+static NSString *CBRPersistentObjectIndexKey(NSString *entity, id value)
+{
+    return [NSString stringWithFormat:@"%@#%@", entity, value];
+}
+
+static NSString *CBRPersistentObjectIndexEntityOfKey(NSString *key)
+{
+    return [key substringToIndex:[key rangeOfString:@"#"].location];
+}
+
+static NSData *CBRPersistentObjectIndexHeader(void)
+{
+    NSMutableData *header = [NSMutableData dataWithBytes:CBRPersistentObjectIndexMagic length:sizeof(CBRPersistentObjectIndexMagic)];
+    [header appendBytes:&CBRPersistentObjectIndexVersion length:sizeof(CBRPersistentObjectIndexVersion)];
+    return header;
+}
+
+/**
+ FNV-1a over one record, stored behind it to detect torn and corrupted records.
+ */
+static uint32_t CBRPersistentObjectIndexChecksum(const uint8_t *bytes, NSUInteger length)
+{
+    uint32_t checksum = 2166136261U;
+
+    for (NSUInteger i = 0; i < length; i++) {
+        checksum ^= bytes[i];
+        checksum *= 16777619U;
+    }
+
+    return checksum;
+}
+
+static void CBRPersistentObjectIndexAppendRecord(NSMutableData *journal, CBRPersistentObjectIndexOperation operation, NSString *key, NSData *data)
+{
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    uint32_t keyLength = (uint32_t)keyData.length;
+    NSUInteger start = journal.length;
+
+    [journal appendBytes:&operation length:sizeof(operation)];
+    [journal appendBytes:&keyLength length:sizeof(keyLength)];
+    [journal appendData:keyData];
+
+    if (operation == CBRPersistentObjectIndexOperationSet) {
+        uint32_t dataLength = (uint32_t)data.length;
+        [journal appendBytes:&dataLength length:sizeof(dataLength)];
+        [journal appendData:data];
+    }
+
+    uint32_t checksum = CBRPersistentObjectIndexChecksum((const uint8_t *)journal.bytes + start, journal.length - start);
+    [journal appendBytes:&checksum length:sizeof(checksum)];
+}
+
+static BOOL CBRPersistentObjectIndexWrite(int fileDescriptor, NSData *data)
+{
+    const uint8_t *bytes = data.bytes;
+    NSUInteger offset = 0;
+
+    while (offset < data.length) {
+        ssize_t written = write(fileDescriptor, bytes + offset, data.length - offset);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NO;
+        }
+
+        offset += (NSUInteger)written;
+    }
+
+    return YES;
+}
+
+/**
+ Replays a journal, returns `nil` for foreign files. `complete` is `NO` if the journal ends with a partially written or corrupted record, nothing behind such a record is replayed.
+ */
+static NSDictionary<NSString *, NSData *> *CBRPersistentObjectIndexReadJournal(NSData *journal, NSUInteger *recordCount, BOOL *complete)
+{
+    const uint8_t *bytes = journal.bytes;
+    NSUInteger length = journal.length;
+    NSUInteger offset = sizeof(CBRPersistentObjectIndexMagic) + sizeof(CBRPersistentObjectIndexVersion);
+
+    if (length < offset || memcmp(bytes, CBRPersistentObjectIndexMagic, sizeof(CBRPersistentObjectIndexMagic)) != 0) {
+        return nil;
+    }
+
+    uint32_t version = 0;
+    memcpy(&version, bytes + sizeof(CBRPersistentObjectIndexMagic), sizeof(version));
+    if (version != CBRPersistentObjectIndexVersion) {
+        return nil;
+    }
+
+    NSMutableDictionary<NSString *, NSData *> *result = [NSMutableDictionary dictionary];
+    *recordCount = 0;
+    *complete = NO;
+
+    while (offset < length) {
+        NSUInteger recordOffset = offset;
+        uint8_t operation = 0;
+        uint32_t keyLength = 0;
+        uint32_t dataLength = 0;
+        uint32_t checksum = 0;
+
+        if (offset + sizeof(operation) + sizeof(keyLength) > length) {
+            return result;
+        }
+
+        memcpy(&operation, bytes + offset, sizeof(operation));
+        memcpy(&keyLength, bytes + offset + sizeof(operation), sizeof(keyLength));
+        offset += sizeof(operation) + sizeof(keyLength);
+
+        if (operation != CBRPersistentObjectIndexOperationSet && operation != CBRPersistentObjectIndexOperationRemove) {
+            return result;
+        }
+
+        if (keyLength > length - offset) {
+            return result;
+        }
+
+        NSUInteger keyOffset = offset;
+        offset += keyLength;
+
+        NSUInteger dataOffset = offset;
+        if (operation == CBRPersistentObjectIndexOperationSet) {
+            if (offset + sizeof(dataLength) > length) {
+                return result;
+            }
+
+            memcpy(&dataLength, bytes + offset, sizeof(dataLength));
+            offset += sizeof(dataLength);
+            dataOffset = offset;
+
+            if (dataLength > length - offset) {
+                return result;
+            }
+
+            offset += dataLength;
+        }
+
+        if (offset + sizeof(checksum) > length) {
+            return result;
+        }
+
+        memcpy(&checksum, bytes + offset, sizeof(checksum));
+        if (checksum != CBRPersistentObjectIndexChecksum(bytes + recordOffset, offset - recordOffset)) {
+            return result;
+        }
+        offset += sizeof(checksum);
+
+        NSString *key = [[NSString alloc] initWithBytes:bytes + keyOffset length:keyLength encoding:NSUTF8StringEncoding];
+        if (key && operation == CBRPersistentObjectIndexOperationSet) {
+            result[key] = [journal subdataWithRange:NSMakeRange(dataOffset, dataLength)];
+        } else if (key) {
+            [result removeObjectForKey:key];
+        }
+
+        (*recordCount)++;
+    }
+
+    *complete = YES;
+    return result;
+}
+
+
+
+@interface CBRPersistentObjectIndex () {
+    pthread_rwlock_t _lock;
+}
+
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, id> *references;
+@property (nonatomic, readonly) NSMutableDictionary<id, NSMutableSet<NSString *> *> *keysByReference;
+
+@property (nonatomic, strong) NSURL *directoryURL;
+@property (atomic, copy) NSData *(^encoder)(id reference);
+@property (nonatomic, readonly) dispatch_queue_t journalQueue;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableData *> *pendingJournals;
+@property (nonatomic, assign) BOOL pendingTruncation;
+
+@property (nonatomic, strong) NSMutableSet<NSString *> *keysRemovedWhileRestoring;
+@property (nonatomic, assign) BOOL discardsRestoredReferences;
+
+@end
+
+
+
+@implementation CBRPersistentObjectIndex
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        pthread_rwlock_init(&_lock, NULL);
+
+        _references = [NSMutableDictionary dictionary];
+        _keysByReference = [NSMutableDictionary dictionary];
+        _journalQueue = dispatch_queue_create("de.sparrow-labs.CloudBridge.index", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    pthread_rwlock_destroy(&_lock);
+}
+
+#pragma mark - Instance methods
+
+- (NSUInteger)count
+{
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger count = self.references.count;
+    pthread_rwlock_unlock(&_lock);
+
+    return count;
+}
+
+- (id)referenceForEntity:(NSString *)entity value:(id)value
+{
+    NSString *key = CBRPersistentObjectIndexKey(entity, value);
+
+    pthread_rwlock_rdlock(&_lock);
+    id reference = self.references[key];
+    pthread_rwlock_unlock(&_lock);
+
+    return reference;
+}
+
+- (void)setReference:(id<NSCopying>)reference forEntity:(NSString *)entity value:(id)value
+{
+    NSParameterAssert(reference);
+    NSString *key = CBRPersistentObjectIndexKey(entity, value);
+    NSData *data = self.encoder ? self.encoder(reference) : nil;
+
+    pthread_rwlock_wrlock(&_lock);
+
+    id previousReference = self.references[key];
+    if (previousReference && ![previousReference isEqual:reference]) {
+        NSMutableSet *previousKeys = self.keysByReference[previousReference];
+        [previousKeys removeObject:key];
+
+        // references of deleted or re-keyed objects would otherwise stay around forever
+        if (previousKeys.count == 0) {
+            [self.keysByReference removeObjectForKey:previousReference];
+        }
+    }
+
+    self.references[key] = reference;
+
+    NSMutableSet *keys = self.keysByReference[reference];
+    if (!keys) {
+        keys = [NSMutableSet set];
+        self.keysByReference[reference] = keys;
+    }
+    [keys addObject:key];
+
+    if (data) {
+        CBRPersistentObjectIndexAppendRecord([self _pendingJournalForEntity:entity], CBRPersistentObjectIndexOperationSet, key, data);
+    }
+
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)removeReference:(id<NSCopying>)reference
+{
+    pthread_rwlock_wrlock(&_lock);
+
+    for (NSString *key in self.keysByReference[reference]) {
+        [self.references removeObjectForKey:key];
+        [self.keysRemovedWhileRestoring addObject:key];
+
+        if (self.directoryURL) {
+            CBRPersistentObjectIndexAppendRecord([self _pendingJournalForEntity:CBRPersistentObjectIndexEntityOfKey(key)], CBRPersistentObjectIndexOperationRemove, key, nil);
+        }
+    }
+    [self.keysByReference removeObjectForKey:reference];
+
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)removeAllReferences
+{
+    pthread_rwlock_wrlock(&_lock);
+
+    [self.references removeAllObjects];
+    [self.keysByReference removeAllObjects];
+
+    if (self.keysRemovedWhileRestoring) {
+        self.discardsRestoredReferences = YES;
+    }
+
+    if (self.directoryURL) {
+        [self.pendingJournals removeAllObjects];
+        self.pendingTruncation = YES;
+    }
+
+    pthread_rwlock_unlock(&_lock);
+}
+
+#pragma mark - Private category implementation ()
+
+- (NSMutableData *)_pendingJournalForEntity:(NSString *)entity
+{
+    if (!self.pendingJournals) {
+        self.pendingJournals = [NSMutableDictionary dictionary];
+    }
+
+    NSMutableData *journal = self.pendingJournals[entity];
+    if (!journal) {
+        journal = [NSMutableData data];
+        self.pendingJournals[entity] = journal;
+    }
+
+    return journal;
+}
+
+- (NSURL *)_journalURLForEntity:(NSString *)entity
+{
+    return [self.directoryURL URLByAppendingPathComponent:[entity stringByAppendingPathExtension:@"cbrindex"]];
+}
+
+/**
+ Appends `journal` and syncs it to disk. A failed append is truncated again, every record behind a torn record would be lost while replaying.
+ */
+- (void)_appendJournal:(NSData *)journal toEntity:(NSString *)entity
+{
+    NSURL *URL = [self _journalURLForEntity:entity];
+
+    int fileDescriptor = open(URL.fileSystemRepresentation, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fileDescriptor < 0) {
+        NSLog(@"WARNING: Could not open journal %@: %s", URL.path, strerror(errno));
+        return;
+    }
+
+    off_t size = lseek(fileDescriptor, 0, SEEK_END);
+    BOOL success = size >= 0;
+
+    if (success && size == 0) {
+        success = CBRPersistentObjectIndexWrite(fileDescriptor, CBRPersistentObjectIndexHeader());
+    }
+
+    success = success && CBRPersistentObjectIndexWrite(fileDescriptor, journal) && fsync(fileDescriptor) == 0;
+
+    if (!success) {
+        NSLog(@"WARNING: Could not append to journal %@: %s", URL.path, strerror(errno));
+
+        if (size < 0 || ftruncate(fileDescriptor, size) != 0 || fsync(fileDescriptor) != 0) {
+            unlink(URL.fileSystemRepresentation);
+        }
+    }
+
+    close(fileDescriptor);
+}
+
+- (void)_compactJournalOfEntity:(NSString *)entity withRecords:(NSDictionary<NSString *, NSData *> *)records
+{
+    NSMutableData *journal = [CBRPersistentObjectIndexHeader() mutableCopy];
+
+    [records enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSData *data, BOOL *stop) {
+        CBRPersistentObjectIndexAppendRecord(journal, CBRPersistentObjectIndexOperationSet, key, data);
+    }];
+
+    // written and synced next to the journal, then renamed over it
+    NSURL *URL = [self _journalURLForEntity:entity];
+    NSString *temporaryPath = [URL.path stringByAppendingPathExtension:@"compacting"];
+
+    int fileDescriptor = open(temporaryPath.fileSystemRepresentation, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    BOOL success = fileDescriptor >= 0 && CBRPersistentObjectIndexWrite(fileDescriptor, journal) && fsync(fileDescriptor) == 0;
+
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+
+    if (!success || rename(temporaryPath.fileSystemRepresentation, URL.fileSystemRepresentation) != 0) {
+        NSLog(@"WARNING: Could not compact journal %@: %s", URL.path, strerror(errno));
+        unlink(temporaryPath.fileSystemRepresentation);
+    }
+}
+
+@end
+
+
+
+@implementation CBRPersistentObjectIndex (Persistence)
+
+- (void)restoreFromDirectory:(NSURL *)directoryURL
+                     encoder:(NSData *(^)(id))encoder
+                     decoder:(id (^)(NSData *))decoder
+                  validation:(NSSet *(^)(NSString *, NSSet *))validation
+           completionHandler:(dispatch_block_t)completionHandler
+{
+    NSParameterAssert(directoryURL);
+    NSParameterAssert(encoder);
+    NSParameterAssert(decoder);
+
+    pthread_rwlock_wrlock(&_lock);
+    NSAssert(self.directoryURL == nil, @"%@ is already persisted to %@", self, self.directoryURL);
+
+    self.directoryURL = directoryURL;
+    self.encoder = encoder;
+    self.keysRemovedWhileRestoring = [NSMutableSet set];
+
+    // entries indexed before persistence was enabled
+    [self.references enumerateKeysAndObjectsUsingBlock:^(NSString *key, id reference, BOOL *stop) {
+        NSData *data = encoder(reference);
+
+        if (data) {
+            CBRPersistentObjectIndexAppendRecord([self _pendingJournalForEntity:CBRPersistentObjectIndexEntityOfKey(key)], CBRPersistentObjectIndexOperationSet, key, data);
+        }
+    }];
+    pthread_rwlock_unlock(&_lock);
+
+    dispatch_async(self.journalQueue, ^{
+        [[NSFileManager defaultManager] createDirectoryAtURL:directoryURL withIntermediateDirectories:YES attributes:nil error:NULL];
+
+        NSArray<NSURL *> *journalURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:directoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:NULL];
+        NSMutableDictionary<NSString *, id> *restoredReferences = [NSMutableDictionary dictionary];
+
+        for (NSURL *journalURL in journalURLs) {
+            if (![journalURL.pathExtension isEqualToString:@"cbrindex"]) {
+                continue;
+            }
+
+            @autoreleasepool {
+                NSString *entity = journalURL.lastPathComponent.stringByDeletingPathExtension;
+                NSData *journal = [NSData dataWithContentsOfURL:journalURL options:NSDataReadingMappedAlways error:NULL];
+
+                NSUInteger recordCount = 0;
+                BOOL complete = NO;
+                NSDictionary<NSString *, NSData *> *records = CBRPersistentObjectIndexReadJournal(journal, &recordCount, &complete);
+
+                NSMutableDictionary<NSString *, id> *references = [NSMutableDictionary dictionaryWithCapacity:records.count];
+                [records enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSData *data, BOOL *stop) {
+                    id reference = decoder(data);
+
+                    if (reference) {
+                        references[key] = reference;
+                    }
+                }];
+
+                if (validation && references.count > 0) {
+                    NSSet *validReferences = validation(entity, [NSSet setWithArray:references.allValues]);
+                    [references.copy enumerateKeysAndObjectsUsingBlock:^(NSString *key, id reference, BOOL *stop) {
+                        if (![validReferences containsObject:reference]) {
+                            [references removeObjectForKey:key];
+                        }
+                    }];
+                }
+
+                [restoredReferences addEntriesFromDictionary:references];
+
+                if (!complete || references.count < records.count || recordCount > 2 * records.count + 64) {
+                    NSMutableDictionary<NSString *, NSData *> *validRecords = [NSMutableDictionary dictionaryWithCapacity:references.count];
+                    for (NSString *key in references) {
+                        validRecords[key] = records[key];
+                    }
+
+                    [self _compactJournalOfEntity:entity withRecords:validRecords];
+                }
+            }
+        }
+
+        pthread_rwlock_wrlock(&self->_lock);
+
+        if (!self.discardsRestoredReferences) {
+            [restoredReferences enumerateKeysAndObjectsUsingBlock:^(NSString *key, id reference, BOOL *stop) {
+                if (self.references[key] != nil || [self.keysRemovedWhileRestoring containsObject:key]) {
+                    return;
+                }
+
+                self.references[key] = reference;
+
+                NSMutableSet *keys = self.keysByReference[reference];
+                if (!keys) {
+                    keys = [NSMutableSet set];
+                    self.keysByReference[reference] = keys;
+                }
+                [keys addObject:key];
+            }];
+        }
+
+        self.keysRemovedWhileRestoring = nil;
+        self.discardsRestoredReferences = NO;
+
+        pthread_rwlock_unlock(&self->_lock);
+
+        [self synchronize];
+
+        if (completionHandler) {
+            dispatch_async(dispatch_get_main_queue(), completionHandler);
+        }
+    });
+}
+
+- (void)synchronize
+{
+    pthread_rwlock_wrlock(&_lock);
+
+    NSDictionary<NSString *, NSMutableData *> *pendingJournals = self.pendingJournals;
+    BOOL pendingTruncation = self.pendingTruncation;
+
+    self.pendingJournals = nil;
+    self.pendingTruncation = NO;
+
+    pthread_rwlock_unlock(&_lock);
+
+    if (pendingJournals.count == 0 && !pendingTruncation) {
+        return;
+    }
+
+    dispatch_async(self.journalQueue, ^{
+        if (pendingTruncation) {
+            for (NSURL *journalURL in [[NSFileManager defaultManager] contentsOfDirectoryAtURL:self.directoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:NULL]) {
+                if ([journalURL.pathExtension isEqualToString:@"cbrindex"]) {
+                    [[NSFileManager defaultManager] removeItemAtURL:journalURL error:NULL];
+                }
+            }
+        }
+
+        [pendingJournals enumerateKeysAndObjectsUsingBlock:^(NSString *entity, NSMutableData *journal, BOOL *stop) {
+            [self _appendJournal:journal toEntity:entity];
+        }];
+    });
+}
+
+@end
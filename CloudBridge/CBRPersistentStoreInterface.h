@@ -24,7 +24,7 @@
 #import <Foundation/Foundation.h>
 #import <CoreData/CoreData.h>
 
-@class CBREntityDescription, CBRRelationshipDescription, CBRPersistentObjectCache, CBRPersistentObjectChange;
+@class CBREntityDescription, CBRRelationshipDescription, CBRPersistentObjectCache, CBRPersistentObjectIndex, CBRPrimaryKeyFilter, CBRPersistentObjectChange;
 @protocol CBRPersistentObject;
 
 
@@ -62,6 +62,31 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block;
 
+@optional
+
+/**
+ Index shared by the caches of all threads. Cache misses are resolved through `persistentObjectForIndexReference:` before falling back to a fetch.
+ */
+@property (nonatomic, readonly) CBRPersistentObjectIndex *persistentObjectIndex;
+
+- (nullable id)indexReferenceForPersistentObject:(id<CBRPersistentObject>)persistentObject;
+- (nullable __kindof id<CBRPersistentObject>)persistentObjectForIndexReference:(id)reference;
+
+/**
+ Filter over all values of `attribute` in the store, cache misses for values which are not contained skip the fetch. Return `nil` if no filter is available for `attribute`.
+ */
+- (nullable CBRPrimaryKeyFilter *)primaryKeyFilterForEntity:(NSString *)entity attribute:(NSString *)attribute;
+
+/**
+ Like `changesWithFetchRequest:block:`, but merges all changes within `interval` into a single change. Use the display frame duration to lay out list UIs at most once per frame.
+ */
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest coalescingInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block;
+
+/**
+ Compacts the store if more than `threshold` of its file is unused. Returns `NO` without an error if the store was left as is.
+ */
+- (BOOL)compactStoreIfFragmentationExceeds:(double)threshold error:(NSError **)error;
+
 @end
 
 
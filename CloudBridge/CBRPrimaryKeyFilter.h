@@ -0,0 +1,64 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Thread safe counting Bloom filter over primary key values. `containsValue:` never returns `NO` for a value which has been added and not removed, but may return `YES` for values which have never been added.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRPrimaryKeyFilter : NSObject
+
+/**
+ Number of values the filter is sized for at a false positive rate of about 1%.
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ Number of values added and not removed again.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ `YES` once more than `capacity` values have been added, the false positive rate grows beyond that and the filter should be rebuilt.
+ */
+@property (nonatomic, readonly, getter=isSaturated) BOOL saturated;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+- (BOOL)containsValue:(id)value;
+
+- (void)addValue:(id)value;
+- (void)addValues:(id<NSFastEnumeration>)values;
+
+/**
+ Only call with values which have been added before, otherwise the filter can return false negatives.
+ */
+- (void)removeValue:(id)value;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,179 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRPrimaryKeyFilter.h"
+
+#import <pthread.h>
+
+static const NSUInteger CBRPrimaryKeyFilterNumberOfHashes = 7;
+static const NSUInteger CBRPrimaryKeyFilterCountersPerValue = 10;
+
+static void CBRPrimaryKeyFilterHash(id value, uint64_t *h1, uint64_t *h2)
+{
+    NSString *string = [value isKindOfClass:[NSString class]] ? value : [value description];
+
+    uint64_t fnv = 14695981039346656037ULL;
+    uint64_t djb = 5381;
+
+    const char *bytes = string.UTF8String;
+    for (const char *byte = bytes; byte != NULL && *byte != '\0'; byte++) {
+        fnv = (fnv ^ (uint8_t)*byte) * 1099511628211ULL;
+        djb = ((djb << 5) + djb) + (uint8_t)*byte;
+    }
+
+    *h1 = fnv;
+    *h2 = djb | 1;
+}
+
+
+
+@interface CBRPrimaryKeyFilter () {
+    pthread_rwlock_t _lock;
+    uint8_t *_counters;
+    NSUInteger _numberOfCounters;
+    NSUInteger _count;
+}
+
+@end
+
+
+
+@implementation CBRPrimaryKeyFilter
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    return [super init];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    if (self = [super init]) {
+        pthread_rwlock_init(&_lock, NULL);
+
+        _capacity = MAX(capacity, 1);
+        _numberOfCounters = _capacity * CBRPrimaryKeyFilterCountersPerValue;
+        _counters = calloc(_numberOfCounters, sizeof(uint8_t));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_counters);
+    pthread_rwlock_destroy(&_lock);
+}
+
+#pragma mark - Instance methods
+
+- (NSUInteger)count
+{
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger count = _count;
+    pthread_rwlock_unlock(&_lock);
+
+    return count;
+}
+
+- (BOOL)isSaturated
+{
+    return self.count > self.capacity;
+}
+
+- (BOOL)containsValue:(id)value
+{
+    uint64_t h1 = 0, h2 = 0;
+    CBRPrimaryKeyFilterHash(value, &h1, &h2);
+
+    BOOL result = YES;
+
+    pthread_rwlock_rdlock(&_lock);
+    for (NSUInteger i = 0; i < CBRPrimaryKeyFilterNumberOfHashes && result; i++) {
+        result = _counters[(h1 + i * h2) % _numberOfCounters] > 0;
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    return result;
+}
+
+- (void)addValue:(id)value
+{
+    pthread_rwlock_wrlock(&_lock);
+    [self _addValue:value];
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)addValues:(id<NSFastEnumeration>)values
+{
+    pthread_rwlock_wrlock(&_lock);
+    for (id value in values) {
+        [self _addValue:value];
+    }
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)removeValue:(id)value
+{
+    uint64_t h1 = 0, h2 = 0;
+    CBRPrimaryKeyFilterHash(value, &h1, &h2);
+
+    pthread_rwlock_wrlock(&_lock);
+    for (NSUInteger i = 0; i < CBRPrimaryKeyFilterNumberOfHashes; i++) {
+        uint8_t *counter = &_counters[(h1 + i * h2) % _numberOfCounters];
+
+        // saturated counters have lost track of their count and stay set
+        if (*counter > 0 && *counter < UINT8_MAX) {
+            (*counter)--;
+        }
+    }
+
+    if (_count > 0) {
+        _count--;
+    }
+    pthread_rwlock_unlock(&_lock);
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_addValue:(id)value
+{
+    if (!value || value == [NSNull null]) {
+        return;
+    }
+
+    uint64_t h1 = 0, h2 = 0;
+    CBRPrimaryKeyFilterHash(value, &h1, &h2);
+
+    for (NSUInteger i = 0; i < CBRPrimaryKeyFilterNumberOfHashes; i++) {
+        uint8_t *counter = &_counters[(h1 + i * h2) % _numberOfCounters];
+
+        if (*counter < UINT8_MAX) {
+            (*counter)++;
+        }
+    }
+
+    _count++;
+}
+
+@end
@@ -0,0 +1,51 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Reads and writes one object property of one class through its resolved getter and setter implementations instead of key value coding. Meant for attributes, properties without object accessors fall back to `primitiveValueForKey:` for `NSManagedObject`s and to key value coding otherwise.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRPropertyAccessor : NSObject
+
+@property (nonatomic, readonly) NSString *key;
+
+/**
+ Returns a cached accessor, `klass` should be the dynamic class of the accessed objects, i.e. `object_getClass(object)`.
+ */
++ (instancetype)accessorForClass:(Class)klass key:(NSString *)key;
+
+- (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
+
+- (nullable id)valueOfObject:(id)object;
+- (void)setValue:(nullable id)value ofObject:(id)object;
+
+@end
+
+FOUNDATION_EXTERN id _Nullable CBRPropertyAccessorGetValue(id object, NSString *key);
+FOUNDATION_EXTERN void CBRPropertyAccessorSetValue(id object, id _Nullable value, NSString *key);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,180 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRPropertyAccessor.h"
+
+#import <CoreData/CoreData.h>
+#import <objc/runtime.h>
+
+typedef NS_ENUM(NSInteger, CBRPropertyAccessorKind) {
+    CBRPropertyAccessorKindKeyValueCoding,
+    CBRPropertyAccessorKindPrimitive,
+    CBRPropertyAccessorKindImplementation,
+};
+
+static NSString *CBRPropertyAccessorCopyAttributeValue(objc_property_t property, const char *attribute)
+{
+    char *value = property_copyAttributeValue(property, attribute);
+    if (!value) {
+        return nil;
+    }
+
+    NSString *result = @(value);
+    free(value);
+
+    return result;
+}
+
+
+
+@interface CBRPropertyAccessor () {
+    CBRPropertyAccessorKind _getterKind;
+    SEL _getter;
+    IMP _getterImplementation;
+
+    CBRPropertyAccessorKind _setterKind;
+    SEL _setter;
+    IMP _setterImplementation;
+}
+
+@end
+
+
+
+@implementation CBRPropertyAccessor
+
+#pragma mark - Initialization
+
+- (instancetype)init
+{
+    return [super init];
+}
+
+- (instancetype)initWithClass:(Class)klass key:(NSString *)key
+{
+    if (self = [super init]) {
+        _key = key.copy;
+
+        CBRPropertyAccessorKind fallbackKind = [klass isSubclassOfClass:[NSManagedObject class]] ? CBRPropertyAccessorKindPrimitive : CBRPropertyAccessorKindKeyValueCoding;
+        _getterKind = fallbackKind;
+        _setterKind = fallbackKind;
+
+        objc_property_t property = class_getProperty(klass, key.UTF8String);
+        if (property && [CBRPropertyAccessorCopyAttributeValue(property, "T") hasPrefix:@"@"]) {
+            NSString *getterName = CBRPropertyAccessorCopyAttributeValue(property, "G") ?: key;
+            _getter = NSSelectorFromString(getterName);
+
+            if ([klass instancesRespondToSelector:_getter]) {
+                _getterKind = CBRPropertyAccessorKindImplementation;
+                _getterImplementation = class_getMethodImplementation(klass, _getter);
+            }
+
+            char *readonly = property_copyAttributeValue(property, "R");
+            if (!readonly) {
+                NSString *setterName = CBRPropertyAccessorCopyAttributeValue(property, "S") ?: [NSString stringWithFormat:@"set%@%@:", [key substringToIndex:1].uppercaseString, [key substringFromIndex:1]];
+                _setter = NSSelectorFromString(setterName);
+
+                if ([klass instancesRespondToSelector:_setter]) {
+                    _setterKind = CBRPropertyAccessorKindImplementation;
+                    _setterImplementation = class_getMethodImplementation(klass, _setter);
+                }
+            }
+            free(readonly);
+        }
+    }
+    return self;
+}
+
++ (instancetype)accessorForClass:(Class)klass key:(NSString *)key
+{
+    NSDictionary<NSString *, CBRPropertyAccessor *> *accessors = objc_getAssociatedObject(klass, _cmd);
+    CBRPropertyAccessor *accessor = accessors[key];
+
+    if (accessor) {
+        return accessor;
+    }
+
+    @synchronized (klass) {
+        NSMutableDictionary<NSString *, CBRPropertyAccessor *> *newAccessors = [objc_getAssociatedObject(klass, _cmd) mutableCopy] ?: [NSMutableDictionary dictionary];
+
+        accessor = newAccessors[key];
+        if (!accessor) {
+            accessor = [[CBRPropertyAccessor alloc] initWithClass:klass key:key];
+            newAccessors[key] = accessor;
+
+            // readers never lock, the dictionary is replaced instead of mutated
+            objc_setAssociatedObject(klass, _cmd, newAccessors.copy, OBJC_ASSOCIATION_RETAIN);
+        }
+    }
+
+    return accessor;
+}
+
+#pragma mark - Instance methods
+
+- (id)valueOfObject:(id)object
+{
+    switch (_getterKind) {
+        case CBRPropertyAccessorKindImplementation:
+            return ((id(*)(id, SEL))_getterImplementation)(object, _getter);
+        case CBRPropertyAccessorKindPrimitive: {
+            [object willAccessValueForKey:_key];
+            id value = [object primitiveValueForKey:_key];
+            [object didAccessValueForKey:_key];
+            return value;
+        }
+        case CBRPropertyAccessorKindKeyValueCoding:
+            return [object valueForKey:_key];
+    }
+}
+
+- (void)setValue:(id)value ofObject:(id)object
+{
+    switch (_setterKind) {
+        case CBRPropertyAccessorKindImplementation:
+            ((void(*)(id, SEL, id))_setterImplementation)(object, _setter, value);
+            break;
+        case CBRPropertyAccessorKindPrimitive:
+            [object willChangeValueForKey:_key];
+            [object setPrimitiveValue:value forKey:_key];
+            [object didChangeValueForKey:_key];
+            break;
+        case CBRPropertyAccessorKindKeyValueCoding:
+            [object setValue:value forKey:_key];
+            break;
+    }
+}
+
+@end
+
+
+
+id CBRPropertyAccessorGetValue(id object, NSString *key)
+{
+    return [[CBRPropertyAccessor accessorForClass:object_getClass(object) key:key] valueOfObject:object];
+}
+
+void CBRPropertyAccessorSetValue(id object, id value, NSString *key)
+{
+    [[CBRPropertyAccessor accessorForClass:object_getClass(object) key:key] setValue:value ofObject:object];
+}
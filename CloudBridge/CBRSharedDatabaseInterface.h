@@ -26,6 +26,11 @@ __attribute__((objc_subclassing_restricted))
 
 - (instancetype)initWithCoreDataInterface:(CBRCoreDataInterface *)coreDataInterface realmInterface:(CBRRealmInterface *)realmInterface;
 
+/**
+ Saves the CoreData changes first and discards the changes of both stores if that fails, e.g. because of a validation error. Afterwards the realm commits: if that fails, the saved CoreData changes are not reverted and `NO` is returned.
+ */
+- (BOOL)commitWriteTransaction:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
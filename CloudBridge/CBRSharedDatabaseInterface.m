@@ -8,11 +8,17 @@
 
 #import "CBRSharedDatabaseInterface.h"
 #import "CBREntityDescription.h"
+#import <objc/runtime.h>
 
 #if CBRRealmAvailable && CBRCoreDataAvailable
 
 @interface CBRSharedDatabaseInterface () <_CBRPersistentStoreInterfaceInternal>
 
+@property (nonatomic, readonly) NSDictionary<NSString *, id<CBRPersistentStoreInterface>> *interfacesByEntityName;
+
+- (id<CBRPersistentStoreInterface>)_interfaceForEntityName:(NSString *)entityName;
+- (void)_partitionPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects managedObjects:(NSMutableArray<NSManagedObject *> *)managedObjects realmObjects:(NSMutableArray<CBRRealmObject *> *)realmObjects;
+
 @end
 
 
@@ -33,6 +39,15 @@
             entitiesByName[entity.name] = entity;
         }
         _entitiesByName = entitiesByName;
+
+        NSMutableDictionary<NSString *, id<CBRPersistentStoreInterface>> *interfacesByEntityName = [NSMutableDictionary dictionary];
+        for (CBREntityDescription *entity in self.realmInterface.entities) {
+            interfacesByEntityName[entity.name] = self.realmInterface;
+        }
+        for (CBREntityDescription *entity in self.coreDataInterface.entities) {
+            interfacesByEntityName[entity.name] = self.coreDataInterface;
+        }
+        _interfacesByEntityName = interfacesByEntityName;
     }
     return self;
 }
@@ -41,20 +56,12 @@
 
 - (CBRRelationshipDescription *)inverseRelationshipForEntity:(CBREntityDescription *)entity relationship:(CBRRelationshipDescription *)relationship
 {
-    if ([self.coreDataInterface.entities containsObject:entity]) {
-        return [self.coreDataInterface inverseRelationshipForEntity:entity relationship:relationship];
-    } else {
-        return [self.realmInterface inverseRelationshipForEntity:entity relationship:relationship];
-    }
+    return [[self _interfaceForEntityName:entity.name] inverseRelationshipForEntity:entity relationship:relationship];
 }
 
 - (__kindof id<CBRPersistentObject>)newMutablePersistentObjectOfType:(CBREntityDescription *)entityDescription
 {
-    if ([self.coreDataInterface.entities containsObject:entityDescription]) {
-        return [self.coreDataInterface newMutablePersistentObjectOfType:entityDescription];
-    } else {
-        return [self.realmInterface newMutablePersistentObjectOfType:entityDescription];
-    }
+    return [[self _interfaceForEntityName:entityDescription.name] newMutablePersistentObjectOfType:entityDescription];
 }
 
 - (void)beginWriteTransaction
@@ -65,33 +72,30 @@
 
 - (BOOL)commitWriteTransaction:(NSError **)error
 {
-    BOOL realmSuccess = [self.realmInterface commitWriteTransaction:error];
-    BOOL coreDataSuccess = [self.coreDataInterface commitWriteTransaction:error];
+    // runs on the calling thread, which is the one owning the realm transaction and the queue of the CoreData context
+    if (![self.coreDataInterface commitWriteTransaction:error]) {
+        // saving validates the CoreData changes, nothing is written to either store yet
+        if (self.realmInterface.realm.inWriteTransaction) {
+            [self.realmInterface.realm cancelWriteTransaction];
+        }
+
+        [self.coreDataInterface rollbackWriteTransaction];
+        return NO;
+    }
 
-    return coreDataSuccess && realmSuccess;
+    return [self.realmInterface commitWriteTransaction:error];
 }
 
 - (NSArray *)executeFetchRequest:(NSFetchRequest *)fetchRequest error:(NSError **)error
 {
-    if (self.coreDataInterface.entitiesByName[fetchRequest.entityName] != nil) {
-        return [self.coreDataInterface executeFetchRequest:fetchRequest error:error];
-    } else {
-        return [self.realmInterface executeFetchRequest:fetchRequest error:error];
-    }
+    return [[self _interfaceForEntityName:fetchRequest.entityName] executeFetchRequest:fetchRequest error:error];
 }
 
 - (void)deletePersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects
 {
     NSMutableArray<NSManagedObject *> *managedObjects = [NSMutableArray array];
     NSMutableArray<CBRRealmObject *> *realmObjects = [NSMutableArray array];
-
-    for (id<CBRPersistentObject> object in persistentObjects) {
-        if ([object isKindOfClass:[NSManagedObject class]]) {
-            [managedObjects addObject:(NSManagedObject *)object];
-        } else if ([object isKindOfClass:[CBRRealmObject class]]) {
-            [realmObjects addObject:(CBRRealmObject *)object];
-        }
-    }
+    [self _partitionPersistentObjects:persistentObjects managedObjects:managedObjects realmObjects:realmObjects];
 
     if (managedObjects.count > 0) {
         [self.coreDataInterface deletePersistentObjects:managedObjects];
@@ -104,20 +108,32 @@
 
 - (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
 {
-    if (self.coreDataInterface.entitiesByName[fetchRequest.entityName] != nil) {
-        return [self.coreDataInterface changesWithFetchRequest:fetchRequest block:block];
-    } else {
-        return [self.realmInterface changesWithFetchRequest:fetchRequest block:block];
-    }
+    return [[self _interfaceForEntityName:fetchRequest.entityName] changesWithFetchRequest:fetchRequest block:block];
+}
+
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest coalescingInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
+{
+    return [[self _interfaceForEntityName:fetchRequest.entityName] changesWithFetchRequest:fetchRequest coalescingInterval:interval block:block];
 }
 
 - (CBRPersistentObjectCache *)persistentObjectCacheOnCurrentThreadForEntity:(CBREntityDescription *)entityDescription
 {
-    if ([self.coreDataInterface.entities containsObject:entityDescription]) {
-        return [self.coreDataInterface persistentObjectCacheOnCurrentThreadForEntity:entityDescription];
-    } else {
-        return [self.realmInterface persistentObjectCacheOnCurrentThreadForEntity:entityDescription];
+    return [[self _interfaceForEntityName:entityDescription.name] persistentObjectCacheOnCurrentThreadForEntity:entityDescription];
+}
+
+- (BOOL)compactStoreIfFragmentationExceeds:(double)threshold error:(NSError **)error
+{
+    NSError *coreDataError = nil;
+    BOOL compacted = [self.coreDataInterface compactStoreIfFragmentationExceeds:threshold error:&coreDataError];
+
+    if (coreDataError != nil) {
+        if (error != NULL) {
+            *error = coreDataError;
+        }
+        return NO;
     }
+
+    return [self.realmInterface compactStoreIfFragmentationExceeds:threshold error:error] || compacted;
 }
 
 #pragma mark - _CBRPersistentStoreInterfaceInternal
@@ -126,14 +142,7 @@
 {
     NSMutableArray<NSManagedObject *> *managedObjects = [NSMutableArray array];
     NSMutableArray<CBRRealmObject *> *realmObjects = [NSMutableArray array];
-
-    for (id<CBRPersistentObject> object in persistentObjects) {
-        if ([object isKindOfClass:[NSManagedObject class]]) {
-            [managedObjects addObject:(NSManagedObject *)object];
-        } else if ([object isKindOfClass:[CBRRealmObject class]]) {
-            [realmObjects addObject:(CBRRealmObject *)object];
-        }
-    }
+    [self _partitionPersistentObjects:persistentObjects managedObjects:managedObjects realmObjects:realmObjects];
 
     id<_CBRPersistentStoreInterfaceInternal> coreDataInterface = (id<_CBRPersistentStoreInterfaceInternal>)self.coreDataInterface;
     id<_CBRPersistentStoreInterfaceInternal> realmInterface = (id<_CBRPersistentStoreInterfaceInternal>)self.realmInterface;
@@ -155,6 +164,38 @@
     }
 }
 
+#pragma mark - Private category implementation ()
+
+- (id<CBRPersistentStoreInterface>)_interfaceForEntityName:(NSString *)entityName
+{
+    return self.interfacesByEntityName[entityName] ?: self.realmInterface;
+}
+
+- (void)_partitionPersistentObjects:(NSArray<id<CBRPersistentObject>> *)persistentObjects managedObjects:(NSMutableArray<NSManagedObject *> *)managedObjects realmObjects:(NSMutableArray<CBRRealmObject *> *)realmObjects
+{
+    // batches are usually homogeneous, only walk the class hierarchy when the class changes
+    Class lastClass = Nil;
+    NSMutableArray *lastDestination = nil;
+
+    for (id<CBRPersistentObject> object in persistentObjects) {
+        Class klass = object_getClass(object);
+
+        if (klass != lastClass) {
+            lastClass = klass;
+
+            if ([klass isSubclassOfClass:[NSManagedObject class]]) {
+                lastDestination = managedObjects;
+            } else if ([klass isSubclassOfClass:[CBRRealmObject class]]) {
+                lastDestination = realmObjects;
+            } else {
+                lastDestination = nil;
+            }
+        }
+
+        [lastDestination addObject:object];
+    }
+}
+
 @end
 
 #endif
@@ -23,6 +23,7 @@
 
 #import <Foundation/Foundation.h>
 #import <CloudBridge/CBRDefines.h>
+#import <CloudBridge/CBRInMemoryInterface.h>
 
 #if CBRCoreDataAvailable
 #import <CloudBridge/CBRCoreDataInterface.h>
@@ -46,6 +47,8 @@ typedef NS_ENUM(NSInteger, CBRThread) {
 @interface NSArray (CBRThreadTransferable) <CBRThreadTransferable> @end
 @interface NSDictionary (CBRThreadTransferable) <CBRThreadTransferable> @end
 @interface NSNull (CBRThreadTransferable) <CBRThreadTransferable> @end
+@interface CBRInMemoryObject (CBRThreadTransferable) <CBRThreadTransferable> @end
+@interface CBRInMemoryObjectReference (CBRThreadTransferable) <CBRThreadTransferable> @end
 
 #if CBRCoreDataAvailable
 @interface NSManagedObject (CBRThreadTransferable) <CBRThreadTransferable> @end
@@ -22,6 +22,7 @@
  */
 
 #import "CBRThreadingEnvironment.h"
+#import "CBRInstrumentation.h"
 #import <CoreData/CoreData.h>
 
 #if CBRRealmAvailable
@@ -36,6 +37,8 @@
 @implementation NSArray (CBRThreadTransferable) @end
 @implementation NSDictionary (CBRThreadTransferable) @end
 @implementation NSNull (CBRThreadTransferable) @end
+@implementation CBRInMemoryObject (CBRThreadTransferable) @end
+@implementation CBRInMemoryObjectReference (CBRThreadTransferable) @end
 
 #if CBRCoreDataAvailable
 @implementation NSManagedObject (CBRThreadTransferable) @end
@@ -99,8 +102,12 @@
 - (void)moveObject:(nullable id)object toThread:(CBRThread)thread completion:(void(^)(id _Nullable object, NSError * _Nullable error))completion
 {
     id reference = [self _threadSafeReferenceForObject:object];
+    NSTimeInterval start = CBRInstrumentationTimestamp();
 
     dispatch_block_t block = ^{
+        NSString *metric = thread == CBRThreadMain ? CBRMetricMainThreadHandoffDuration : CBRMetricQueueWaitDuration;
+        [CBRInstrumentationGetCurrent() recordValue:CBRInstrumentationTimestamp() - start forMetric:metric];
+
 #if CBRRealmAvailable
         if (self.realmAdapter != nil) {
             [self.realmAdapter.realm refresh];
@@ -208,6 +215,8 @@
         [self _assertRealm];
         return object;
 #endif
+    } else if ([object isKindOfClass:[CBRInMemoryObject class]]) {
+        return [object reference];
     } else if ([object conformsToProtocol:@protocol(CBRThreadTransferable)]) {
         return object;
     }
@@ -306,6 +315,19 @@
     } else if ([reference isKindOfClass:[RLMObject class]]) {
         return reference;
 #endif
+    } else if ([reference isKindOfClass:[CBRInMemoryObjectReference class]]) {
+        CBRInMemoryObjectReference *objectReference = reference;
+        id object = [objectReference.interface objectForReference:objectReference];
+
+        if (object == nil) {
+            NSDictionary *userInfo = @{
+                                       NSLocalizedDescriptionKey: NSLocalizedString(@"Could not resolve in-memory reference", @""),
+                                       };
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSCoreDataError userInfo:userInfo];
+            return nil;
+        }
+
+        return object;
     } else if ([reference conformsToProtocol:@protocol(CBRThreadTransferable)]) {
         return reference;
     }
@@ -35,17 +35,26 @@
 #import <CloudBridge/CBROfflineCapableCloudBridge.h>
 
 #import <CloudBridge/CBRPersistentObjectChange.h>
+#import <CloudBridge/CBRCoalescedNotificationToken.h>
 #import <CloudBridge/CBRPersistentStoreInterface.h>
 #import <CloudBridge/CBRDatabaseAdapter.h>
 #import <CloudBridge/CBRCloudObjectTransformer.h>
 #import <CloudBridge/CBRThreadingEnvironment.h>
 #import <CloudBridge/CBRPersistentObjectCache.h>
+#import <CloudBridge/CBRPersistentObjectIndex.h>
+#import <CloudBridge/CBRPrimaryKeyFilter.h>
+#import <CloudBridge/CBRPropertyAccessor.h>
 #import <CloudBridge/CBRSharedDatabaseInterface.h>
+#import <CloudBridge/CBRInMemoryInterface.h>
+#import <CloudBridge/CBRInstrumentation.h>
+#import <CloudBridge/CBRMaintenanceScheduler.h>
 
 #if CBRRealmAvailable
+#import <CloudBridge/CBRRealmObjectCodec.h>
 #import <CloudBridge/CBRRealmObject.h>
 #import <CloudBridge/CBRRealmInterface.h>
 #import <CloudBridge/RLMResults+CloudBridge.h>
+#import <CloudBridge/CBRRealmResultsArray.h>
 #endif
 
 #if CBRCoreDataAvailable
@@ -29,7 +29,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-@class CBRThreadingEnvironment, CBRPersistentObjectCache;
+@class CBRThreadingEnvironment, CBRPersistentObjectCache, CBRPersistentObjectIndex;
 
 
 
@@ -47,11 +47,26 @@ __attribute__((objc_subclassing_restricted))
 
 @property (nonatomic, readonly) CBRCoreDataStack *stack;
 
+/**
+ Cloud identifier to `NSManagedObjectID` index shared by the caches of all contexts. Updated whenever a context of `stack` saves to the persistent store.
+ */
+@property (nonatomic, readonly) CBRPersistentObjectIndex *persistentObjectIndex;
+
 - (instancetype)init NS_DESIGNATED_INITIALIZER UNAVAILABLE_ATTRIBUTE;
 - (instancetype)initWithStack:(CBRCoreDataStack *)stack NS_DESIGNATED_INITIALIZER;
 
 - (CBRPersistentObjectCache *)cacheForManagedObjectContext:(NSManagedObjectContext *)context;
 
+/**
+ Discards the pending changes of the current thread's context.
+ */
+- (void)rollbackWriteTransaction;
+
+/**
+ Persists `persistentObjectIndex` in `directoryURL` and restores the index of a previous launch in the background, so that the first sync after launch does not need to fetch existing objects. Restored entries are validated against the persistent store.
+ */
+- (void)restorePersistentObjectIndexFromDirectory:(NSURL *)directoryURL completionHandler:(nullable dispatch_block_t)completionHandler;
+
 @end
 
 NS_ASSUME_NONNULL_END
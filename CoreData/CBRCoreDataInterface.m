@@ -24,12 +24,16 @@
 #import <objc/runtime.h>
 
 #import "CBRPersistentObjectChange.h"
+#import "CBRCoalescedNotificationToken.h"
 #import "CBRThreadingEnvironment.h"
 #import "CBRCoreDataInterface.h"
 #import "CBRCloudBridge.h"
 #import "CBREntityDescription.h"
 #import "CBREntityDescription+CBRCoreDataInterface.h"
 #import "CBRPersistentObjectCache.h"
+#import "CBRPersistentObjectIndex.h"
+#import "CBRPrimaryKeyFilter.h"
+#import "CBRCloudConnection.h"
 
 static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSelector)
 {
@@ -44,11 +48,51 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 
 
+/**
+ Share of free pages of the SQLite database at `URL`, read from its file header. Pages freed since the last checkpoint of the WAL are not counted yet, checkpoint before reading it.
+ */
+static double CBRSQLiteFragmentationOfDatabaseAtURL(NSURL *URL)
+{
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingFromURL:URL error:NULL];
+    NSData *header = [fileHandle readDataOfLength:100];
+    [fileHandle closeFile];
+
+    if (header.length < 100 || memcmp(header.bytes, "SQLite format 3", 16) != 0) {
+        return 0.0;
+    }
+
+    // all header fields are big endian
+    const uint8_t *bytes = header.bytes;
+    uint16_t pageSize = 0;
+    uint32_t changeCounter = 0, pageCount = 0, freelistCount = 0, validForChangeCounter = 0;
+
+    memcpy(&pageSize, bytes + 16, sizeof(pageSize));
+    memcpy(&changeCounter, bytes + 24, sizeof(changeCounter));
+    memcpy(&pageCount, bytes + 28, sizeof(pageCount));
+    memcpy(&freelistCount, bytes + 36, sizeof(freelistCount));
+    memcpy(&validForChangeCounter, bytes + 92, sizeof(validForChangeCounter));
+
+    pageCount = CFSwapInt32BigToHost(pageCount);
+    freelistCount = CFSwapInt32BigToHost(freelistCount);
+
+    // the page count of the header is only valid if it was written by the last change
+    if (changeCounter != validForChangeCounter || pageCount == 0) {
+        unsigned long long fileSize = [[NSFileManager defaultManager] attributesOfItemAtPath:URL.path error:NULL].fileSize;
+        uint32_t size = CFSwapInt16BigToHost(pageSize) == 1 ? 65536 : CFSwapInt16BigToHost(pageSize);
+
+        pageCount = size > 0 ? (uint32_t)(fileSize / size) : 0;
+    }
+
+    return pageCount > 0 ? (double)freelistCount / pageCount : 0.0;
+}
+
+
+
 @interface _CBRFetchedResultsControllerObserver : NSObject <CBRNotificationToken, NSFetchedResultsControllerDelegate>
 
-@property (nonatomic, strong) NSMutableArray<NSNumber *> *deletions;
-@property (nonatomic, strong) NSMutableArray<NSNumber *> *insertions;
-@property (nonatomic, strong) NSMutableArray<NSNumber *> *updates;
+@property (nonatomic, strong) NSMutableIndexSet *deletions;
+@property (nonatomic, strong) NSMutableIndexSet *insertions;
+@property (nonatomic, strong) NSMutableIndexSet *updates;
 
 @property (nonatomic, strong) NSFetchedResultsController *controller;
 @property (nonatomic, strong) void(^observer)(NSArray *objects, CBRPersistentObjectChange *change);
@@ -101,27 +145,27 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 - (void)controllerWillChangeContent:(NSFetchedResultsController *)controller
 {
-    self.deletions = [NSMutableArray array];
-    self.insertions = [NSMutableArray array];
-    self.updates = [NSMutableArray array];
+    self.deletions = [NSMutableIndexSet indexSet];
+    self.insertions = [NSMutableIndexSet indexSet];
+    self.updates = [NSMutableIndexSet indexSet];
 }
 
 - (void)controller:(NSFetchedResultsController *)controller didChangeObject:(NSManagedObject *)anObject atIndexPath:(NSIndexPath *)indexPath forChangeType:(NSFetchedResultsChangeType)type newIndexPath:(NSIndexPath *)newIndexPath
 {
     switch (type) {
         case NSFetchedResultsChangeInsert: {
-            [self.insertions addObject:@([newIndexPath indexAtPosition:1])];
+            [self.insertions addIndex:[newIndexPath indexAtPosition:1]];
             break;
         } case NSFetchedResultsChangeDelete: {
-            [self.deletions addObject:@([indexPath indexAtPosition:1])];
+            [self.deletions addIndex:[indexPath indexAtPosition:1]];
             break;
         } case NSFetchedResultsChangeMove: {
-            [self.deletions addObject:@([indexPath indexAtPosition:1])];
-            [self.insertions addObject:@([newIndexPath indexAtPosition:1])];
+            [self.deletions addIndex:[indexPath indexAtPosition:1]];
+            [self.insertions addIndex:[newIndexPath indexAtPosition:1]];
             break;
         } case NSFetchedResultsChangeUpdate: {
             if (anObject.changedValuesForCurrentEvent.count > 0) {
-                [self.updates addObject:@([indexPath indexAtPosition:1])];
+                [self.updates addIndex:[indexPath indexAtPosition:1]];
             }
             break;
         }
@@ -131,7 +175,7 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 - (void)controllerDidChangeContent:(NSFetchedResultsController *)controller
 {
     if (self.observer != nil) {
-        CBRPersistentObjectChange *change = [[CBRPersistentObjectChange alloc] initWithDeletions:self.deletions insertions:self.insertions updates:self.updates];
+        CBRPersistentObjectChange *change = [[CBRPersistentObjectChange alloc] initWithDeletedIndexes:self.deletions insertedIndexes:self.insertions updatedIndexes:self.updates];
         self.observer(controller.fetchedObjects, change);
     }
 
@@ -183,6 +227,9 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 @property (nonatomic, readonly) NSManagedObjectModel *managedObjectModel;
 
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, CBRPrimaryKeyFilter *> *primaryKeyFilters;
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, CBRPrimaryKeyFilter *> *seedingPrimaryKeyFilters;
+
 @end
 
 @implementation CBRCoreDataInterface
@@ -197,33 +244,56 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 {
     if (self = [super init]) {
         _stack = stack;
-        _managedObjectModel = stack.persistentStoreCoordinator.managedObjectModel;
-
-        NSMutableArray<CBREntityDescription *> *result = [NSMutableArray array];
-
-        for (NSEntityDescription *entity in self.managedObjectModel.entities) {
-            if (entity.managedObjectClassName.length == 0 || [entity.managedObjectClassName isEqualToString:NSStringFromClass(NSManagedObject.class)]) {
-                continue;
+        // the store is opened lazily or by -[CBRCoreDataStack loadPersistentStoreWithCompletionHandler:]
+        _managedObjectModel = stack.managedObjectModel;
+
+        NSString *schemaCacheKey = [self _schemaCacheKey];
+        NSArray<CBREntityDescription *> *cachedEntities = [CBREntityDescription cachedEntitiesForKey:schemaCacheKey interface:self];
+
+        if (cachedEntities != nil) {
+            _entities = cachedEntities;
+        } else {
+            NSMutableArray<CBREntityDescription *> *result = [NSMutableArray array];
+
+            for (NSEntityDescription *entity in self.managedObjectModel.entities) {
+                if (entity.managedObjectClassName.length == 0 || [entity.managedObjectClassName isEqualToString:NSStringFromClass(NSManagedObject.class)]) {
+                    continue;
+                }
+
+                assert(entity.managedObjectClassName != nil);
+                assert(NSClassFromString(entity.managedObjectClassName) != [NSManagedObject class]);
+                assert([NSClassFromString(entity.managedObjectClassName) isSubclassOfClass:[NSManagedObject class]]);
+                [result addObject:[[CBREntityDescription alloc] initWithInterface:self coreDataEntityDescription:entity]];
             }
 
-            assert(entity.managedObjectClassName != nil);
-            assert(NSClassFromString(entity.managedObjectClassName) != [NSManagedObject class]);
-            assert([NSClassFromString(entity.managedObjectClassName) isSubclassOfClass:[NSManagedObject class]]);
-            [result addObject:[[CBREntityDescription alloc] initWithInterface:self coreDataEntityDescription:entity]];
+            _entities = result.copy;
+            [CBREntityDescription cacheEntities:_entities forKey:schemaCacheKey];
         }
 
-        _entities = result.copy;
-
         NSMutableDictionary<NSString *, CBREntityDescription *> *entitiesByName = [NSMutableDictionary dictionary];
         for (CBREntityDescription *description in _entities) {
             entitiesByName[description.name] = description;
         }
 
         _entitiesByName = entitiesByName.copy;
+        [_entities makeObjectsPerformSelector:@selector(freeze)];
+
+        _persistentObjectIndex = [[CBRPersistentObjectIndex alloc] init];
+        _primaryKeyFilters = [NSMutableDictionary dictionary];
+        _seedingPrimaryKeyFilters = [NSMutableDictionary dictionary];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_managedObjectContextObjectsDidChangeNotificationCallback:) name:NSManagedObjectContextObjectsDidChangeNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_managedObjectContextWillSaveNotificationCallback:) name:NSManagedObjectContextWillSaveNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_managedObjectContextDidSaveNotificationCallback:) name:NSManagedObjectContextDidSaveNotification object:nil];
     }
     return self;
 }
 
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 - (CBRPersistentObjectCache *)cacheForManagedObjectContext:(NSManagedObjectContext *)context
 {
     @synchronized (context) {
@@ -237,6 +307,153 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
     }
 }
 
+- (void)restorePersistentObjectIndexFromDirectory:(NSURL *)directoryURL completionHandler:(dispatch_block_t)completionHandler
+{
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = self.stack.persistentStoreCoordinator;
+
+    NSData *(^encoder)(id reference) = ^NSData *(NSManagedObjectID *reference) {
+        if (reference.isTemporaryID) {
+            return nil;
+        }
+
+        return [reference.URIRepresentation.absoluteString dataUsingEncoding:NSUTF8StringEncoding];
+    };
+
+    id(^decoder)(NSData *data) = ^id(NSData *data) {
+        NSString *absoluteString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+        NSURL *URL = absoluteString ? [NSURL URLWithString:absoluteString] : nil;
+
+        return URL ? [persistentStoreCoordinator managedObjectIDForURIRepresentation:URL] : nil;
+    };
+
+    NSSet *(^validation)(NSString *entity, NSSet *references) = ^NSSet *(NSString *entity, NSSet *references) {
+        if (!persistentStoreCoordinator.managedObjectModel.entitiesByName[entity]) {
+            return [NSSet set];
+        }
+
+        NSManagedObjectContext *context = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+        context.persistentStoreCoordinator = persistentStoreCoordinator;
+
+        __block NSArray<NSManagedObjectID *> *objectIDs = nil;
+        [context performBlockAndWait:^{
+            NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entity];
+            fetchRequest.predicate = [NSPredicate predicateWithFormat:@"self IN %@", references];
+            fetchRequest.resultType = NSManagedObjectIDResultType;
+
+            objectIDs = [context executeFetchRequest:fetchRequest error:NULL];
+        }];
+
+        return [NSSet setWithArray:objectIDs ?: @[]];
+    };
+
+    [self.persistentObjectIndex restoreFromDirectory:directoryURL encoder:encoder decoder:decoder validation:validation completionHandler:completionHandler];
+}
+
+#pragma mark - CBRPersistentObjectIndex
+
+- (id)indexReferenceForPersistentObject:(NSManagedObject *)persistentObject
+{
+    NSManagedObjectID *objectID = persistentObject.objectID;
+    return objectID.isTemporaryID ? nil : objectID;
+}
+
+- (id)persistentObjectForIndexReference:(NSManagedObjectID *)reference
+{
+    NSManagedObjectContext *context = [NSThread currentThread].isMainThread ? self.stack.mainThreadManagedObjectContext : self.stack.backgroundThreadManagedObjectContext;
+    NSManagedObject *managedObject = [context existingObjectWithID:reference error:NULL];
+
+    // the row is gone, e.g. deleted by a batch request or another coordinator
+    if (!managedObject) {
+        [self.persistentObjectIndex removeReference:reference];
+        return nil;
+    }
+
+    return managedObject.isDeleted ? nil : managedObject;
+}
+
+- (CBRPrimaryKeyFilter *)primaryKeyFilterForEntity:(NSString *)entity attribute:(NSString *)attribute
+{
+    CBREntityDescription *entityDescription = self.entitiesByName[entity];
+    if (!entityDescription || ![attribute isEqualToString:[self _primaryKeyOfEntity:entityDescription]]) {
+        return nil;
+    }
+
+    NSManagedObjectContext *context = [NSThread currentThread].isMainThread ? self.stack.mainThreadManagedObjectContext : self.stack.backgroundThreadManagedObjectContext;
+
+    NSUInteger minimumCapacity = 1024;
+
+    // posts the primary keys of objects inserted since the last lookup to the filters
+    [context processPendingChanges];
+
+    @synchronized (self.primaryKeyFilters) {
+        CBRPrimaryKeyFilter *filter = self.primaryKeyFilters[entity];
+        if (filter && !filter.isSaturated) {
+            return filter;
+        }
+
+        if (self.seedingPrimaryKeyFilters[entity]) {
+            return nil;
+        }
+
+        // grows geometrically, so that an import which keeps saturating the filter only rebuilds it a logarithmic number of times
+        if (filter) {
+            minimumCapacity = MAX(minimumCapacity, 2 * filter.capacity);
+        }
+    }
+
+    NSEntityDescription *managedEntityDescription = self.managedObjectModel.entitiesByName[entity];
+    NSUInteger numberOfInsertedObjects = 0;
+    for (NSManagedObject *managedObject in context.insertedObjects) {
+        if ([managedObject.entity isKindOfEntity:managedEntityDescription]) {
+            numberOfInsertedObjects++;
+        }
+    }
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entity];
+    fetchRequest.includesPendingChanges = NO;
+
+    NSUInteger count = [context countForFetchRequest:fetchRequest error:NULL];
+    count = (count == NSNotFound ? 0 : count) + numberOfInsertedObjects;
+
+    CBRPrimaryKeyFilter *filter = [[CBRPrimaryKeyFilter alloc] initWithCapacity:MAX(2 * count, minimumCapacity)];
+
+    @synchronized (self.primaryKeyFilters) {
+        if (self.seedingPrimaryKeyFilters[entity]) {
+            return nil;
+        }
+
+        // values saved while seeding are added to the new filter as well
+        [self.primaryKeyFilters removeObjectForKey:entity];
+        self.seedingPrimaryKeyFilters[entity] = filter;
+    }
+
+    fetchRequest.resultType = NSDictionaryResultType;
+    fetchRequest.propertiesToFetch = @[ attribute ];
+
+    NSError *error = nil;
+    NSArray<NSDictionary *> *results = [context executeFetchRequest:fetchRequest error:&error];
+
+    if (results) {
+        [filter addValues:[results valueForKey:attribute]];
+
+        // dictionary results do not include pending changes
+        for (NSSet<NSManagedObject *> *objects in @[ context.insertedObjects, context.updatedObjects ]) {
+            for (NSManagedObject *managedObject in objects) {
+                if ([managedObject.entity isKindOfEntity:managedEntityDescription]) {
+                    [filter addValue:[managedObject valueForKey:attribute]];
+                }
+            }
+        }
+    }
+
+    @synchronized (self.primaryKeyFilters) {
+        [self.seedingPrimaryKeyFilters removeObjectForKey:entity];
+        self.primaryKeyFilters[entity] = results ? filter : nil;
+    }
+
+    return results ? filter : nil;
+}
+
 #pragma mark - _CBRPersistentStoreInterfaceInternal
 
 - (BOOL)hasPersistedObjects:(NSArray<NSManagedObject *> *)persistentObjects
@@ -269,6 +486,13 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
     return [[_CBRFetchedResultsControllerObserver alloc] initWithController:controller observer:block];
 }
 
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest coalescingInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
+{
+    return [[CBRCoalescedNotificationToken alloc] initWithInterval:interval block:block observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        return [self changesWithFetchRequest:fetchRequest block:observer];
+    }];
+}
+
 - (CBRPersistentObjectCache *)persistentObjectCacheOnCurrentThreadForEntity:(CBREntityDescription *)entityDescription
 {
     NSManagedObjectContext *context = [NSThread currentThread].isMainThread ? self.stack.mainThreadManagedObjectContext : self.stack.backgroundThreadManagedObjectContext;
@@ -280,6 +504,12 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 }
 
+- (void)rollbackWriteTransaction
+{
+    NSManagedObjectContext *context = [NSThread currentThread].isMainThread ? self.stack.mainThreadManagedObjectContext : self.stack.backgroundThreadManagedObjectContext;
+    [context rollback];
+}
+
 - (BOOL)commitWriteTransaction:(NSError * _Nullable __autoreleasing *)error
 {
     NSManagedObjectContext *context = [NSThread currentThread].isMainThread ? self.stack.mainThreadManagedObjectContext : self.stack.backgroundThreadManagedObjectContext;
@@ -322,4 +552,255 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
     }
 }
 
+- (BOOL)compactStoreIfFragmentationExceeds:(double)threshold error:(NSError **)error
+{
+    if (![self.stack.storeType isEqualToString:NSSQLiteStoreType] || !self.stack.isPersistentStoreLoaded) {
+        return NO;
+    }
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = self.stack.persistentStoreCoordinator;
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator persistentStoreForURL:self.stack.storeLocation];
+    NSURL *storeLocation = self.stack.storeLocation;
+
+    __block BOOL compacted = NO;
+    __block NSError *compactionError = nil;
+
+    // the stack's contexts reach the store only through its coordinator, blocking it keeps them from holding locks while the store is vacuumed
+    [persistentStoreCoordinator performBlockAndWait:^{
+        // pages freed since the last checkpoint only show up in the file header once the WAL is written back
+        NSMutableDictionary *checkpointOptions = [NSMutableDictionary dictionaryWithDictionary:persistentStore.options];
+        NSMutableDictionary *pragmas = [NSMutableDictionary dictionaryWithDictionary:checkpointOptions[NSSQLitePragmasOption] ?: @{}];
+        pragmas[@"wal_checkpoint"] = @"TRUNCATE";
+        checkpointOptions[NSSQLitePragmasOption] = pragmas;
+
+        NSError *localError = nil;
+        if (![self _addPersistentStoreAtURL:storeLocation options:checkpointOptions error:&localError]) {
+            compactionError = localError;
+            return;
+        }
+
+        if (CBRSQLiteFragmentationOfDatabaseAtURL(storeLocation) <= threshold) {
+            return;
+        }
+
+        NSMutableDictionary *vacuumOptions = [NSMutableDictionary dictionaryWithDictionary:persistentStore.options];
+        vacuumOptions[NSSQLiteManualVacuumOption] = @YES;
+
+        compacted = [self _addPersistentStoreAtURL:storeLocation options:vacuumOptions error:&localError];
+        compactionError = localError;
+    }];
+
+    if (!compacted && error) {
+        *error = compactionError;
+    }
+
+    return compacted;
+}
+
+#pragma mark - Private category implementation ()
+
+/**
+ Opens and closes the store at `URL` with a second coordinator, Core Data applies pragmas and vacuums while adding a store. Objects of the stack stay valid, VACUUM keeps the Z_PK row ids.
+ */
+- (BOOL)_addPersistentStoreAtURL:(NSURL *)URL options:(NSDictionary *)options error:(NSError **)error
+{
+    NSPersistentStoreCoordinator *coordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self.stack.persistentStoreCoordinator.managedObjectModel];
+    NSPersistentStore *store = [coordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:URL options:options error:error];
+
+    if (!store) {
+        return NO;
+    }
+
+    [coordinator removePersistentStore:store error:NULL];
+    return YES;
+}
+
+- (void)_managedObjectContextWillSaveNotificationCallback:(NSNotification *)notification
+{
+    NSManagedObjectContext *context = notification.object;
+    // saves of unrelated contexts must not open the store, none of ours can save before it is loaded
+    if (!self.stack.isPersistentStoreLoaded || context.parentContext != nil || context.persistentStoreCoordinator != self.stack.persistentStoreCoordinator) {
+        return;
+    }
+
+    NSMutableArray<NSArray *> *insertedPrimaryKeys = [NSMutableArray array];
+    NSMutableArray<NSArray *> *deletedPrimaryKeys = [NSMutableArray array];
+
+    for (NSManagedObject *managedObject in context.insertedObjects) {
+        NSString *attribute = [self _primaryKeyOfEntity:self.entitiesByName[managedObject.entity.name]];
+        id value = attribute ? [managedObject valueForKey:attribute] : nil;
+
+        if (value) {
+            [insertedPrimaryKeys addObject:@[ managedObject.entity, value ]];
+        }
+    }
+
+    for (NSManagedObject *managedObject in context.updatedObjects) {
+        NSString *attribute = [self _primaryKeyOfEntity:self.entitiesByName[managedObject.entity.name]];
+        id value = attribute ? managedObject.changedValues[attribute] : nil;
+
+        if (value && value != [NSNull null]) {
+            [insertedPrimaryKeys addObject:@[ managedObject.entity, value ]];
+        }
+    }
+
+    for (NSManagedObject *managedObject in context.deletedObjects) {
+        NSString *attribute = [self _primaryKeyOfEntity:self.entitiesByName[managedObject.entity.name]];
+        id value = attribute && !managedObject.objectID.isTemporaryID ? [managedObject committedValuesForKeys:@[ attribute ]][attribute] : nil;
+
+        if (value && value != [NSNull null]) {
+            [deletedPrimaryKeys addObject:@[ managedObject.entity, value ]];
+        }
+    }
+
+    // inserted values are added before the store is written, so that other contexts find them before the did save notification
+    [self _updatePrimaryKeyFiltersWithInsertedPrimaryKeys:insertedPrimaryKeys deletedPrimaryKeys:@[] filters:@{}];
+
+    // deletions are only applied to filters which already contained the deleted values
+    NSDictionary<NSString *, CBRPrimaryKeyFilter *> *primaryKeyFilters = nil;
+    @synchronized (self.primaryKeyFilters) {
+        primaryKeyFilters = self.primaryKeyFilters.copy;
+    }
+
+    objc_setAssociatedObject(context, @selector(_updatePrimaryKeyFiltersWithInsertedPrimaryKeys:deletedPrimaryKeys:filters:), @[ deletedPrimaryKeys, primaryKeyFilters ], OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (void)_managedObjectContextObjectsDidChangeNotificationCallback:(NSNotification *)notification
+{
+    NSManagedObjectContext *context = notification.object;
+    if (!self.stack.isPersistentStoreLoaded || context.parentContext != nil || context.persistentStoreCoordinator != self.stack.persistentStoreCoordinator) {
+        return;
+    }
+
+    // unsaved objects are found by fetches, so the filters must not rule out their values
+    NSMutableArray<NSArray *> *insertedPrimaryKeys = [NSMutableArray array];
+
+    for (NSManagedObject *managedObject in notification.userInfo[NSInsertedObjectsKey]) {
+        NSString *attribute = [self _primaryKeyOfEntity:self.entitiesByName[managedObject.entity.name]];
+        id value = attribute ? [managedObject valueForKey:attribute] : nil;
+
+        if (value) {
+            [insertedPrimaryKeys addObject:@[ managedObject.entity, value ]];
+        }
+    }
+
+    for (NSManagedObject *managedObject in notification.userInfo[NSUpdatedObjectsKey]) {
+        NSString *attribute = [self _primaryKeyOfEntity:self.entitiesByName[managedObject.entity.name]];
+        id value = attribute ? managedObject.changedValuesForCurrentEvent[attribute] : nil;
+
+        if (value && value != [NSNull null]) {
+            [insertedPrimaryKeys addObject:@[ managedObject.entity, value ]];
+        }
+    }
+
+    if (insertedPrimaryKeys.count > 0) {
+        [self _updatePrimaryKeyFiltersWithInsertedPrimaryKeys:insertedPrimaryKeys deletedPrimaryKeys:@[] filters:@{}];
+    }
+}
+
+- (NSString *)_schemaCacheKey
+{
+    // userInfo is not part of the version hashes, a changed model file invalidates it
+    NSDate *modificationDate = nil;
+    [self.stack.managedObjectModelURL getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:NULL];
+
+    NSMutableArray<NSString *> *components = [NSMutableArray arrayWithObjects:@"CoreData", @(modificationDate.timeIntervalSince1970).stringValue, nil];
+    NSDictionary<NSString *, NSData *> *versionHashes = self.managedObjectModel.entityVersionHashesByName;
+
+    for (NSString *entityName in [versionHashes.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        [components addObject:[NSString stringWithFormat:@"%@=%@", entityName, [versionHashes[entityName] base64EncodedStringWithOptions:0]]];
+    }
+
+    return [CBREntityDescription schemaCacheKeyWithComponents:components];
+}
+
+- (void)_managedObjectContextDidSaveNotificationCallback:(NSNotification *)notification
+{
+    NSManagedObjectContext *context = notification.object;
+    if (!self.stack.isPersistentStoreLoaded || context.parentContext != nil || context.persistentStoreCoordinator != self.stack.persistentStoreCoordinator) {
+        return;
+    }
+
+    NSArray *primaryKeyChanges = objc_getAssociatedObject(context, @selector(_updatePrimaryKeyFiltersWithInsertedPrimaryKeys:deletedPrimaryKeys:filters:));
+    objc_setAssociatedObject(context, @selector(_updatePrimaryKeyFiltersWithInsertedPrimaryKeys:deletedPrimaryKeys:filters:), nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+
+    if (primaryKeyChanges) {
+        [self _updatePrimaryKeyFiltersWithInsertedPrimaryKeys:@[] deletedPrimaryKeys:primaryKeyChanges[0] filters:primaryKeyChanges[1]];
+    }
+
+    for (NSManagedObject *managedObject in notification.userInfo[NSDeletedObjectsKey]) {
+        [self.persistentObjectIndex removeReference:managedObject.objectID];
+    }
+
+    NSMutableSet<NSManagedObject *> *changedObjects = [NSMutableSet set];
+    [changedObjects unionSet:notification.userInfo[NSInsertedObjectsKey] ?: [NSSet set]];
+    [changedObjects unionSet:notification.userInfo[NSUpdatedObjectsKey] ?: [NSSet set]];
+
+    for (NSManagedObject *managedObject in changedObjects) {
+        [self _indexManagedObject:managedObject];
+    }
+
+    [self.persistentObjectIndex synchronize];
+}
+
+- (void)_indexManagedObject:(NSManagedObject *)managedObject
+{
+    CBREntityDescription *entityDescription = self.entitiesByName[managedObject.entity.name];
+    if (!entityDescription || managedObject.objectID.isTemporaryID) {
+        return;
+    }
+
+    NSString *attribute = [self _primaryKeyOfEntity:entityDescription];
+    id value = attribute ? [managedObject valueForKey:attribute] : nil;
+
+    if (value && [[self.persistentObjectIndex referenceForEntity:managedObject.entity.name value:value] isEqual:managedObject.objectID]) {
+        return;
+    }
+
+    [self.persistentObjectIndex removeReference:managedObject.objectID];
+
+    if (!value) {
+        return;
+    }
+
+    for (NSEntityDescription *entity = managedObject.entity; entity != nil; entity = entity.superentity) {
+        [self.persistentObjectIndex setReference:managedObject.objectID forEntity:entity.name value:value];
+    }
+}
+
+- (void)_updatePrimaryKeyFiltersWithInsertedPrimaryKeys:(NSArray<NSArray *> *)insertedPrimaryKeys deletedPrimaryKeys:(NSArray<NSArray *> *)deletedPrimaryKeys filters:(NSDictionary<NSString *, CBRPrimaryKeyFilter *> *)filters
+{
+    @synchronized (self.primaryKeyFilters) {
+        if (self.primaryKeyFilters.count == 0 && self.seedingPrimaryKeyFilters.count == 0) {
+            return;
+        }
+
+        for (NSArray *primaryKey in insertedPrimaryKeys) {
+            for (NSEntityDescription *entity = primaryKey[0]; entity != nil; entity = entity.superentity) {
+                [self.primaryKeyFilters[entity.name] addValue:primaryKey[1]];
+                [self.seedingPrimaryKeyFilters[entity.name] addValue:primaryKey[1]];
+            }
+        }
+
+        for (NSArray *primaryKey in deletedPrimaryKeys) {
+            for (NSEntityDescription *entity = primaryKey[0]; entity != nil; entity = entity.superentity) {
+                CBRPrimaryKeyFilter *filter = self.primaryKeyFilters[entity.name];
+
+                if (filter != nil && filter == filters[entity.name]) {
+                    [filter removeValue:primaryKey[1]];
+                }
+            }
+        }
+    }
+}
+
+- (NSString *)_primaryKeyOfEntity:(CBREntityDescription *)entityDescription
+{
+    if (!entityDescription) {
+        return nil;
+    }
+
+    return [[NSClassFromString(entityDescription.name) cloudBridge].cloudConnection.objectTransformer primaryKeyOfEntitiyDescription:entityDescription];
+}
+
 @end
@@ -36,8 +36,17 @@ enum {
 typedef NS_ENUM(NSInteger, CBRCoreDataStackType) {
     CBRCoreDataStackTypeParallel,
     CBRCoreDataStackTypeVertical,
+    /**
+     Parallel contexts on a SQLite store with persistent history tracking. Background saves are merged into the main context asynchronously and in batches, refreshing only objects registered in the main context. Behaves like `CBRCoreDataStackTypeParallel` before iOS 11.
+     */
+    CBRCoreDataStackTypePersistentHistory,
 };
 
+/**
+ `step` of `numberOfSteps` in the precomputed migration chain is running, `progress` covers the whole migration and ranges from 0 to 1.
+ */
+typedef void(^CBRCoreDataStackMigrationProgressHandler)(NSUInteger step, NSUInteger numberOfSteps, float progress);
+
 __attribute__((objc_subclassing_restricted))
 @interface CBRCoreDataStack : NSObject
 
@@ -51,6 +60,11 @@ __attribute__((objc_subclassing_restricted))
 @property (nonatomic, readonly) NSManagedObjectModel *managedObjectModel;
 @property (nonatomic, readonly) NSPersistentStoreCoordinator *persistentStoreCoordinator;
 
+/**
+ `YES` once the persistent store has been opened and migrated. Accessing `persistentStoreCoordinator` or any context before that opens the store synchronously.
+ */
+@property (nonatomic, readonly, getter=isPersistentStoreLoaded) BOOL persistentStoreLoaded;
+
 @property (nonatomic, nullable, readonly) NSManagedObjectContext *persistentManagedObjectContext;
 
 @property (nonatomic, readonly) NSManagedObjectContext *mainThreadManagedObjectContext;
@@ -62,6 +76,16 @@ __attribute__((objc_subclassing_restricted))
 + (instancetype)newConvenientSQLiteStackWithModel:(NSString *)model inBundle:(NSBundle *)bundle DEPRECATED_ATTRIBUTE;
 + (instancetype)buildConvenientSQLiteStackWithModel:(NSString *)model inBundle:(NSBundle *)bundle;
 
+/**
+ Opens and migrates the persistent store on a background queue, so that launching does not wait for it. `completionHandler` is called on the main queue.
+ */
+- (void)loadPersistentStoreWithCompletionHandler:(nullable dispatch_block_t)completionHandler;
+
+/**
+ Called on the migrating thread whenever a migration of the persistent store makes progress, also while the store is being opened.
+ */
+@property (nonatomic, copy, nullable) CBRCoreDataStackMigrationProgressHandler migrationProgressHandler;
+
 @end
 
 
@@ -69,6 +93,10 @@ __attribute__((objc_subclassing_restricted))
 @interface CBRCoreDataStack (Migration)
 
 @property (nonatomic, readonly) BOOL requiresMigration;
+
+/**
+ Migrates the persistent store along the versions of the model at `managedObjectModelURL`, mapping models are looked up in `bundle`. Steps without a mapping model are migrated lightweight and in place. Steps with a mapping model are migrated in several passes, one per group of related entities, and resume after the last completed pass if the process was terminated. Every pass holds all instances of its group in memory, a model whose entities are all connected through relationships is migrated in a single pass.
+ */
 - (BOOL)migrateDataStore:(NSError **)error;
 
 @end
@@ -24,19 +24,141 @@
 #import "CBRCoreDataStack.h"
 #import <objc/runtime.h>
 #import <objc/message.h>
-#import <libkern/OSAtomic.h>
+#import <stdatomic.h>
 
 NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
 
-@interface CBRCoreDataStack ()
+static NSString *const CBRCoreDataStackMainContextName = @"main context";
+
+static NSString *const CBRCoreDataStackMigrationCheckpointSourceKey = @"source";
+static NSString *const CBRCoreDataStackMigrationCheckpointDestinationKey = @"destination";
+static NSString *const CBRCoreDataStackMigrationCheckpointPassesKey = @"passes";
+
+static void *CBRCoreDataStackMigrationProgressContext = &CBRCoreDataStackMigrationProgressContext;
+
+@interface _CBRCoreDataStackModelVersion : NSObject
+
+@property (nonatomic, readonly) NSString *name;
+@property (nonatomic, readonly) NSURL *URL;
+@property (nonatomic, readonly) NSDictionary<NSString *, NSData *> *versionHashes;
+@property (nonatomic, readonly) NSManagedObjectModel *managedObjectModel;
+
+/**
+ Version identifier of the model, its name if it has none.
+ */
+@property (nonatomic, readonly) NSString *versionIdentifier;
+
+/**
+ Mapping model shipped in the bundle for the step to the next version of the current migration chain.
+ */
+@property (nonatomic, nullable, strong) NSMappingModel *mappingModel;
+
+- (instancetype)initWithName:(NSString *)name URL:(nullable NSURL *)URL versionHashes:(nullable NSDictionary<NSString *, NSData *> *)versionHashes managedObjectModel:(nullable NSManagedObjectModel *)managedObjectModel;
+
+@end
+
+@implementation _CBRCoreDataStackModelVersion
+
+- (instancetype)initWithName:(NSString *)name URL:(NSURL *)URL versionHashes:(NSDictionary<NSString *, NSData *> *)versionHashes managedObjectModel:(NSManagedObjectModel *)managedObjectModel
+{
+    if (self = [super init]) {
+        _name = name;
+        _URL = URL;
+        _versionHashes = versionHashes;
+        _managedObjectModel = managedObjectModel;
+    }
+    return self;
+}
+
+- (NSManagedObjectModel *)managedObjectModel
+{
+    if (!_managedObjectModel) {
+        _managedObjectModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:self.URL];
+    }
+
+    return _managedObjectModel;
+}
+
+- (NSString *)versionIdentifier
+{
+    NSArray<NSString *> *versionIdentifiers = [self.managedObjectModel.versionIdentifiers.allObjects valueForKey:NSStringFromSelector(@selector(description))];
+    return [versionIdentifiers sortedArrayUsingSelector:@selector(localizedStandardCompare:)].lastObject ?: self.name;
+}
+
+- (NSDictionary<NSString *, NSData *> *)versionHashes
+{
+    if (!_versionHashes) {
+        _versionHashes = self.managedObjectModel.entityVersionHashesByName;
+    }
+
+    return _versionHashes;
+}
+
+@end
+
+
+
+@interface _CBRCoreDataStackMigrationProgressObserver : NSObject
+
+@property (nonatomic, readonly) NSMigrationManager *migrationManager;
+@property (nonatomic, readonly) void(^handler)(float migrationProgress);
+
+- (instancetype)initWithMigrationManager:(NSMigrationManager *)migrationManager handler:(void(^)(float migrationProgress))handler;
+- (void)invalidate;
+
+@end
+
+@implementation _CBRCoreDataStackMigrationProgressObserver
+
+- (instancetype)initWithMigrationManager:(NSMigrationManager *)migrationManager handler:(void(^)(float migrationProgress))handler
+{
+    if (self = [super init]) {
+        _migrationManager = migrationManager;
+        _handler = [handler copy];
+
+        [_migrationManager addObserver:self forKeyPath:NSStringFromSelector(@selector(migrationProgress)) options:0 context:CBRCoreDataStackMigrationProgressContext];
+    }
+    return self;
+}
+
+- (void)invalidate
+{
+    [self.migrationManager removeObserver:self forKeyPath:NSStringFromSelector(@selector(migrationProgress)) context:CBRCoreDataStackMigrationProgressContext];
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSKeyValueChangeKey, id> *)change context:(void *)context
+{
+    if (context == CBRCoreDataStackMigrationProgressContext) {
+        self.handler(self.migrationManager.migrationProgress);
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+@end
+
+
+
+@interface CBRCoreDataStack () {
+    atomic_bool _persistentStoreLoaded;
+}
 
 @property (nonatomic, readonly) NSLock *migrationLock;
+@property (nonatomic, readonly) NSLock *modelLock;
+@property (nonatomic, readonly) NSRecursiveLock *persistentStoreLock;
+@property (nonatomic, nullable, strong) NSArray<_CBRCoreDataStackModelVersion *> *modelVersions;
+
+@property (nonatomic, nullable, readonly) NSManagedObjectContext *persistentHistoryManagedObjectContext;
+@property (nonatomic, nullable, strong) NSPersistentHistoryToken *persistentHistoryToken API_AVAILABLE(ios(11.0));
+@property (nonatomic, assign) BOOL persistentHistoryMergeScheduled;
+
+- (void)_schedulePersistentHistoryMerge API_AVAILABLE(ios(11.0));
 
 @end
 
 
 @implementation CBRCoreDataStack
-@synthesize mainThreadManagedObjectContext = _mainThreadManagedObjectContext, backgroundThreadManagedObjectContext = _backgroundThreadManagedObjectContext, managedObjectModel = _managedObjectModel, persistentStoreCoordinator = _persistentStoreCoordinator, persistentManagedObjectContext = _persistentManagedObjectContext;
+@synthesize mainThreadManagedObjectContext = _mainThreadManagedObjectContext, backgroundThreadManagedObjectContext = _backgroundThreadManagedObjectContext, managedObjectModel = _managedObjectModel, persistentStoreCoordinator = _persistentStoreCoordinator, persistentManagedObjectContext = _persistentManagedObjectContext, persistentHistoryManagedObjectContext = _persistentHistoryManagedObjectContext;
 
 #pragma mark - setters and getters
 
@@ -87,6 +209,8 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
         _bundle = bundle;
         _type = type;
         _migrationLock = [[NSLock alloc] init];
+        _modelLock = [[NSLock alloc] init];
+        _persistentStoreLock = [[NSRecursiveLock alloc] init];
 
         NSString *parentDirectory = storeLocation.URLByDeletingLastPathComponent.path;
         if (![[NSFileManager defaultManager] fileExistsAtPath:parentDirectory isDirectory:NULL]) {
@@ -111,17 +235,21 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
 
 - (NSManagedObjectModel *)managedObjectModel
 {
+    // not guarded by the persistent store lock, the model is needed by readers while the store is being opened
+    [self.modelLock lock];
     if (!_managedObjectModel) {
         _managedObjectModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:self.managedObjectModelURL];
         NSParameterAssert(_managedObjectModel);
     }
+    NSManagedObjectModel *managedObjectModel = _managedObjectModel;
+    [self.modelLock unlock];
 
-    return _managedObjectModel;
+    return managedObjectModel;
 }
 
 - (NSManagedObjectContext *)persistentManagedObjectContext
 {
-    if (self.type == CBRCoreDataStackTypeParallel) {
+    if (self.type != CBRCoreDataStackTypeVertical) {
         return nil;
     }
 
@@ -142,9 +270,9 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
     if (!_mainThreadManagedObjectContext) {
         _mainThreadManagedObjectContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSMainQueueConcurrencyType];
         _mainThreadManagedObjectContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
-        _mainThreadManagedObjectContext.name = @"main context";
+        _mainThreadManagedObjectContext.name = CBRCoreDataStackMainContextName;
 
-        if (self.type == CBRCoreDataStackTypeParallel) {
+        if (self.type != CBRCoreDataStackTypeVertical) {
             _mainThreadManagedObjectContext.persistentStoreCoordinator = self.persistentStoreCoordinator;
         } else {
             _mainThreadManagedObjectContext.parentContext = self.persistentManagedObjectContext;
@@ -167,7 +295,7 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
         _backgroundThreadManagedObjectContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
         _backgroundThreadManagedObjectContext.name = @"background context";
 
-        if (self.type == CBRCoreDataStackTypeParallel) {
+        if (self.type != CBRCoreDataStackTypeVertical) {
             _backgroundThreadManagedObjectContext.persistentStoreCoordinator = self.persistentStoreCoordinator;
         } else {
             _backgroundThreadManagedObjectContext.parentContext = self.mainThreadManagedObjectContext;
@@ -183,7 +311,60 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
     return _backgroundThreadManagedObjectContext;
 }
 
+- (NSManagedObjectContext *)persistentHistoryManagedObjectContext
+{
+    if (self.type != CBRCoreDataStackTypePersistentHistory) {
+        return nil;
+    }
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = self.persistentStoreCoordinator;
+
+    @synchronized(self) {
+        if (!_persistentHistoryManagedObjectContext) {
+            _persistentHistoryManagedObjectContext = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+            _persistentHistoryManagedObjectContext.persistentStoreCoordinator = persistentStoreCoordinator;
+            _persistentHistoryManagedObjectContext.name = @"persistent history context";
+        }
+    }
+
+    return _persistentHistoryManagedObjectContext;
+}
+
 - (NSPersistentStoreCoordinator *)persistentStoreCoordinator
+{
+    // a background load started by loadPersistentStoreWithCompletionHandler: finishes first
+    if (!atomic_load(&_persistentStoreLoaded)) {
+        [self.persistentStoreLock lock];
+        [self _loadPersistentStoreCoordinator];
+        [self.persistentStoreLock unlock];
+    }
+
+#ifdef DEBUG
+    [self _enableCoreDataThreadDebugging];
+#endif
+
+    return _persistentStoreCoordinator;
+}
+
+- (BOOL)isPersistentStoreLoaded
+{
+    return atomic_load(&_persistentStoreLoaded);
+}
+
+- (void)loadPersistentStoreWithCompletionHandler:(dispatch_block_t)completionHandler
+{
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        [self persistentStoreCoordinator];
+
+        if (completionHandler != nil) {
+            dispatch_async(dispatch_get_main_queue(), completionHandler);
+        }
+    });
+}
+
+#pragma mark - private implementation ()
+
+- (void)_loadPersistentStoreCoordinator
 {
     if (!_persistentStoreCoordinator) {
         NSURL *storeURL = self.storeLocation;
@@ -196,10 +377,16 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
             }
         }
 
-        NSDictionary *options = @{
-                                  NSMigratePersistentStoresAutomaticallyOption: @YES,
-                                  NSInferMappingModelAutomaticallyOption: @YES
-                                  };
+        NSMutableDictionary *options = [@{
+                                          NSMigratePersistentStoresAutomaticallyOption: @YES,
+                                          NSInferMappingModelAutomaticallyOption: @YES
+                                          } mutableCopy];
+
+        if (@available(iOS 11.0, *)) {
+            if (self.type == CBRCoreDataStackTypePersistentHistory) {
+                options[NSPersistentHistoryTrackingKey] = @YES;
+            }
+        }
 
         NSError *error = nil;
         _persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:managedObjectModel];
@@ -216,22 +403,46 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
                 abort();
             }
         }
-    }
 
-#ifdef DEBUG
-    [self _enableCoreDataThreadDebugging];
-#endif
+        if (@available(iOS 11.0, *)) {
+            if (self.type == CBRCoreDataStackTypePersistentHistory) {
+                // history of previous launches has nothing left to merge
+                _persistentHistoryToken = [_persistentStoreCoordinator currentPersistentHistoryTokenFromStores:nil];
 
-    return _persistentStoreCoordinator;
-}
+                if (_persistentHistoryToken != nil) {
+                    NSManagedObjectContext *historyContext = self.persistentHistoryManagedObjectContext;
+                    NSPersistentHistoryToken *token = _persistentHistoryToken;
 
-#pragma mark - private implementation ()
+                    [historyContext performBlock:^{
+                        [historyContext executeRequest:[NSPersistentHistoryChangeRequest deleteHistoryBeforeToken:token] error:NULL];
+                    }];
+                }
+            }
+        }
+
+        // readers no longer take the persistent store lock from now on
+        atomic_store(&_persistentStoreLoaded, true);
+    }
+}
 
 - (void)_managedObjectContextDidSaveNotificationCallback:(NSNotification *)notification
 {
     NSManagedObjectContext *changedContext = notification.object;
 
     switch (self.type) {
+        case CBRCoreDataStackTypePersistentHistory:
+            if (@available(iOS 11.0, *)) {
+                if (changedContext == self.backgroundThreadManagedObjectContext) {
+                    [self _schedulePersistentHistoryMerge];
+                } else if (changedContext == self.mainThreadManagedObjectContext) {
+                    [self.backgroundThreadManagedObjectContext performBlock:^{
+                        [self.backgroundThreadManagedObjectContext mergeChangesFromContextDidSaveNotification:notification];
+                    }];
+                }
+                break;
+            }
+            // merges like a parallel stack before iOS 11
+
         case CBRCoreDataStackTypeParallel:
             if (changedContext == self.backgroundThreadManagedObjectContext) {
                 [self.mainThreadManagedObjectContext performBlockAndWait:^{
@@ -274,6 +485,101 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
     }
 }
 
+- (void)_schedulePersistentHistoryMerge
+{
+    @synchronized(self) {
+        if (self.persistentHistoryMergeScheduled) {
+            return;
+        }
+        self.persistentHistoryMergeScheduled = YES;
+    }
+
+    NSManagedObjectContext *historyContext = self.persistentHistoryManagedObjectContext;
+    NSManagedObjectContext *mainContext = self.mainThreadManagedObjectContext;
+
+    [historyContext performBlock:^{
+        // saves from now on need another pass, all earlier ones are part of this batch
+        @synchronized(self) {
+            self.persistentHistoryMergeScheduled = NO;
+        }
+
+        NSPersistentHistoryChangeRequest *request = [NSPersistentHistoryChangeRequest fetchHistoryAfterToken:self.persistentHistoryToken];
+        request.resultType = NSPersistentHistoryResultTypeTransactionsAndChanges;
+
+        NSError *error = nil;
+        NSPersistentHistoryResult *result = [historyContext executeRequest:request error:&error];
+        NSArray<NSPersistentHistoryTransaction *> *transactions = result.result;
+
+        if (error != nil) {
+            NSLog(@"[CBRCoreDataStack] fetching persistent history failed: %@", error);
+        }
+
+        if (transactions.count == 0) {
+            return;
+        }
+
+        NSMutableSet<NSManagedObjectID *> *insertedObjectIDs = [NSMutableSet set];
+        NSMutableSet<NSManagedObjectID *> *updatedObjectIDs = [NSMutableSet set];
+        NSMutableSet<NSManagedObjectID *> *deletedObjectIDs = [NSMutableSet set];
+
+        for (NSPersistentHistoryTransaction *transaction in transactions) {
+            if ([transaction.contextName isEqualToString:CBRCoreDataStackMainContextName]) {
+                continue;
+            }
+
+            for (NSPersistentHistoryChange *change in transaction.changes) {
+                switch (change.changeType) {
+                    case NSPersistentHistoryChangeTypeInsert:
+                        [insertedObjectIDs addObject:change.changedObjectID];
+                        break;
+                    case NSPersistentHistoryChangeTypeUpdate:
+                        [updatedObjectIDs addObject:change.changedObjectID];
+                        break;
+                    case NSPersistentHistoryChangeTypeDelete:
+                        [deletedObjectIDs addObject:change.changedObjectID];
+                        break;
+                }
+            }
+        }
+
+        // an object inserted or updated and deleted again within this batch no longer exists, an object inserted within this batch is new to the main context
+        [insertedObjectIDs minusSet:deletedObjectIDs];
+        [updatedObjectIDs minusSet:deletedObjectIDs];
+        [updatedObjectIDs minusSet:insertedObjectIDs];
+
+        self.persistentHistoryToken = transactions.lastObject.token;
+        [historyContext executeRequest:[NSPersistentHistoryChangeRequest deleteHistoryBeforeToken:self.persistentHistoryToken] error:NULL];
+
+        if (insertedObjectIDs.count + updatedObjectIDs.count + deletedObjectIDs.count == 0) {
+            return;
+        }
+
+        [mainContext performBlock:^{
+            // inserts are kept for fetched results controllers, everything else only matters if the main context knows the object
+            NSMutableArray<NSManagedObjectID *> *updatedRegisteredObjectIDs = [NSMutableArray array];
+            for (NSManagedObjectID *objectID in updatedObjectIDs) {
+                if ([mainContext objectRegisteredForID:objectID] != nil) {
+                    [updatedRegisteredObjectIDs addObject:objectID];
+                }
+            }
+
+            NSMutableArray<NSManagedObjectID *> *deletedRegisteredObjectIDs = [NSMutableArray array];
+            for (NSManagedObjectID *objectID in deletedObjectIDs) {
+                if ([mainContext objectRegisteredForID:objectID] != nil) {
+                    [deletedRegisteredObjectIDs addObject:objectID];
+                }
+            }
+
+            NSDictionary *changes = @{
+                                      NSInsertedObjectsKey: insertedObjectIDs.allObjects,
+                                      NSUpdatedObjectsKey: updatedRegisteredObjectIDs,
+                                      NSDeletedObjectsKey: deletedRegisteredObjectIDs,
+                                      };
+            [NSManagedObjectContext mergeChangesFromRemoteContextSave:changes intoContexts:@[ mainContext ]];
+        }];
+    }];
+}
+
 - (void)_enableCoreDataThreadDebugging
 {
     @synchronized(self) {
@@ -313,6 +619,26 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
 
 
 
+static NSEntityDescription *CBRRootEntity(NSEntityDescription *entity)
+{
+    while (entity.superentity != nil) {
+        entity = entity.superentity;
+    }
+
+    return entity;
+}
+
+static NSString *CBRMigrationGroupOfEntityName(NSDictionary<NSString *, NSString *> *groups, NSString *entityName)
+{
+    NSString *group = entityName;
+
+    while (groups[group] != nil) {
+        group = groups[group];
+    }
+
+    return group;
+}
+
 @implementation CBRCoreDataStack (Migration)
 
 - (BOOL)requiresMigration
@@ -339,21 +665,26 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
 {
     [self.migrationLock lock];
 
-    NSDictionary *options = @{
-                              NSMigratePersistentStoresAutomaticallyOption: @YES,
-                              NSInferMappingModelAutomaticallyOption: @YES
-                              };
+    // an interrupted migration continues with its remaining passes instead of starting over
+    BOOL resumesMigration = [[NSFileManager defaultManager] fileExistsAtPath:[self _migrationCheckpointURL].path];
 
-    NSError *addStoreError = nil;
-    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self.managedObjectModel];
+    if (!resumesMigration) {
+        NSDictionary *options = @{
+                                  NSMigratePersistentStoresAutomaticallyOption: @YES,
+                                  NSInferMappingModelAutomaticallyOption: @YES
+                                  };
 
-    if ([persistentStoreCoordinator addPersistentStoreWithType:self.storeType configuration:nil URL:self.storeLocation options:options error:&addStoreError]) {
-        NSLog(@"[CBRCoreDataStack] automatic persistent store migration completed %@", options);
-        [self.migrationLock unlock];
-        return YES;
-    } else {
-        NSLog(@"[CBRCoreDataStack] could not automatic migrate persistent store with %@", options);
-        NSLog(@"[CBRCoreDataStack] addStoreError = %@", addStoreError);
+        NSError *addStoreError = nil;
+        NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:self.managedObjectModel];
+
+        if ([persistentStoreCoordinator addPersistentStoreWithType:self.storeType configuration:nil URL:self.storeLocation options:options error:&addStoreError]) {
+            NSLog(@"[CBRCoreDataStack] automatic persistent store migration completed %@", options);
+            [self.migrationLock unlock];
+            return YES;
+        } else {
+            NSLog(@"[CBRCoreDataStack] could not automatic migrate persistent store with %@", options);
+            NSLog(@"[CBRCoreDataStack] addStoreError = %@", addStoreError);
+        }
     }
 
     BOOL success = [self _performMigrationFromDataStoreAtURL:self.storeLocation toDestinationModel:self.managedObjectModel error:error];
@@ -366,17 +697,6 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
                          toDestinationModel:(NSManagedObjectModel *)destinationModel
                                       error:(NSError * __autoreleasing *)error
 {
-    BOOL(^updateError)(NSInteger errorCode, NSString *description) = ^BOOL(NSInteger errorCode, NSString *description) {
-        if (!error) {
-            return NO;
-        }
-
-        NSDictionary *userInfo = @{ NSLocalizedDescriptionKey: description };
-        *error = [NSError errorWithDomain:CBRCoreDataStackErrorDomain code:errorCode userInfo:userInfo];
-
-        return NO;
-    };
-
 #if __IPHONE_OS_VERSION_MIN_REQUIRED >= 90000
     NSDictionary *options = @{
                               NSMigratePersistentStoresAutomaticallyOption: @YES,
@@ -396,78 +716,411 @@ NSString *const CBRCoreDataStackErrorDomain = @"CBRCoreDataStackErrorDomain";
         return YES;
     }
 
-    NSArray *bundles = @[ self.bundle ];
-    NSManagedObjectModel *sourceModel = [NSManagedObjectModel mergedModelFromBundles:bundles
-                                                                    forStoreMetadata:sourceStoreMetadata];
+    NSArray<_CBRCoreDataStackModelVersion *> *chain = [self _migrationChainFromStoreMetadata:sourceStoreMetadata toDestinationModel:destinationModel error:error];
 
-    if (!sourceModel) {
-        return updateError(CBRCoreDataStackManagedObjectModelNotFound, [NSString stringWithFormat:@"Unable to find NSManagedObjectModel for store metadata %@", sourceStoreMetadata]);
+    if (!chain) {
+        return NO;
     }
 
-    NSMutableArray *objectModelPaths = [NSMutableArray array];
-    NSArray *allManagedObjectModels = [self.bundle pathsForResourcesOfType:@"momd"
-                                                               inDirectory:nil];
+    NSArray<NSValue *> *steps = [self _migrationStepsAlongChain:chain];
+    CBRCoreDataStackMigrationProgressHandler progressHandler = self.migrationProgressHandler;
+
+    for (NSUInteger step = 0; step < steps.count; step++) {
+        NSRange range = steps[step].rangeValue;
+        NSArray<_CBRCoreDataStackModelVersion *> *versions = [chain subarrayWithRange:NSMakeRange(range.location, range.length + 1)];
+
+        void(^stepProgressHandler)(float progress) = ^(float progress) {
+            if (progressHandler != nil) {
+                progressHandler(step, steps.count, (step + progress) / steps.count);
+            }
+        };
 
-    for (NSString *managedObjectModelPath in allManagedObjectModels) {
-        NSArray *array = [self.bundle pathsForResourcesOfType:@"mom"
-                                                  inDirectory:managedObjectModelPath.lastPathComponent];
+        NSLog(@"[CBRCoreDataStack] migrating persistent store from %@ to %@, step %lu of %lu", versions.firstObject.name, versions.lastObject.name, (unsigned long)step + 1, (unsigned long)steps.count);
+        stepProgressHandler(0.0);
 
-        [objectModelPaths addObjectsFromArray:array];
+        BOOL success = NO;
+        if (versions.firstObject.mappingModel != nil) {
+            success = [self _performMigrationFromDataStoreAtURL:dataStoreURL fromVersion:versions.firstObject toVersion:versions.lastObject progressHandler:stepProgressHandler error:error];
+        } else {
+            success = [self _performLightweightMigrationFromDataStoreAtURL:dataStoreURL alongVersions:versions error:error];
+        }
+
+        if (!success) {
+            return NO;
+        }
+
+        stepProgressHandler(1.0);
     }
 
-    NSArray *otherModels = [self.bundle pathsForResourcesOfType:@"mom" inDirectory:nil];
-    [objectModelPaths addObjectsFromArray:otherModels];
+    return YES;
+}
 
-    if (objectModelPaths.count == 0) {
-        return updateError(CBRCoreDataStackManagedObjectModelNotFound, [NSString stringWithFormat:@"No NSManagedObjectModel found in bundle %@", self.bundle]);
+- (BOOL)_updateError:(NSError * __autoreleasing *)error code:(NSInteger)errorCode description:(NSString *)description underlyingError:(nullable NSError *)underlyingError
+{
+    if (!error) {
+        return NO;
     }
 
-    NSMappingModel *mappingModel = nil;
-    NSManagedObjectModel *targetModel = nil;
-    NSString *modelPath = nil;
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    userInfo[NSUnderlyingErrorKey] = underlyingError;
 
-    for (modelPath in objectModelPaths.reverseObjectEnumerator) {
-        NSURL *modelURL = [NSURL fileURLWithPath:modelPath];
-        targetModel = [[NSManagedObjectModel alloc] initWithContentsOfURL:modelURL];
-        mappingModel = [NSMappingModel mappingModelFromBundles:bundles
-                                                forSourceModel:sourceModel
-                                              destinationModel:targetModel];
+    *error = [NSError errorWithDomain:CBRCoreDataStackErrorDomain code:errorCode userInfo:userInfo];
+    return NO;
+}
 
-        if (mappingModel) {
-            break;
+/**
+ All versions of the `momd` containing `managedObjectModelURL`, oldest first. The current version of its `VersionInfo.plist` is the newest one, all others are ordered by their version identifier. Hashes are read from `VersionInfo.plist` as well.
+ */
+- (NSArray<_CBRCoreDataStackModelVersion *> *)_modelVersions
+{
+    if (self.modelVersions) {
+        return self.modelVersions;
+    }
+
+    NSURL *managedObjectModelURL = self.managedObjectModelURL;
+    NSURL *versionedModelURL = nil;
+
+    if ([managedObjectModelURL.pathExtension isEqualToString:@"momd"]) {
+        versionedModelURL = managedObjectModelURL;
+    } else if ([managedObjectModelURL.URLByDeletingLastPathComponent.pathExtension isEqualToString:@"momd"]) {
+        versionedModelURL = managedObjectModelURL.URLByDeletingLastPathComponent;
+    }
+
+    NSMutableArray<_CBRCoreDataStackModelVersion *> *modelVersions = [NSMutableArray array];
+
+    if (!versionedModelURL) {
+        [modelVersions addObject:[[_CBRCoreDataStackModelVersion alloc] initWithName:managedObjectModelURL.lastPathComponent.stringByDeletingPathExtension URL:managedObjectModelURL versionHashes:nil managedObjectModel:nil]];
+
+        self.modelVersions = modelVersions;
+        return modelVersions;
+    }
+
+    NSDictionary *versionInfo = [NSDictionary dictionaryWithContentsOfURL:[versionedModelURL URLByAppendingPathComponent:@"VersionInfo.plist"]];
+    NSDictionary *versionHashes = versionInfo[@"NSManagedObjectModel_VersionHashes"];
+    NSString *currentVersionName = versionInfo[@"NSManagedObjectModel_CurrentVersionName"];
+
+    for (NSURL *modelURL in [[NSFileManager defaultManager] contentsOfDirectoryAtURL:versionedModelURL includingPropertiesForKeys:nil options:0 error:NULL]) {
+        if (![modelURL.pathExtension isEqualToString:@"mom"]) {
+            continue;
+        }
+
+        NSString *name = modelURL.lastPathComponent.stringByDeletingPathExtension;
+        [modelVersions addObject:[[_CBRCoreDataStackModelVersion alloc] initWithName:name URL:modelURL versionHashes:versionHashes[name] managedObjectModel:nil]];
+    }
+
+    [modelVersions sortUsingComparator:^NSComparisonResult(_CBRCoreDataStackModelVersion *lhs, _CBRCoreDataStackModelVersion *rhs) {
+        BOOL lhsIsCurrent = [lhs.name isEqualToString:currentVersionName];
+        BOOL rhsIsCurrent = [rhs.name isEqualToString:currentVersionName];
+
+        if (lhsIsCurrent != rhsIsCurrent) {
+            return lhsIsCurrent ? NSOrderedDescending : NSOrderedAscending;
         }
+
+        return [lhs.versionIdentifier compare:rhs.versionIdentifier options:NSNumericSearch];
+    }];
+
+    self.modelVersions = modelVersions;
+    return modelVersions;
+}
+
+/**
+ Versions from the one matching the store up to `destinationModel`, with the bundled mapping model of every step looked up once.
+ */
+- (nullable NSArray<_CBRCoreDataStackModelVersion *> *)_migrationChainFromStoreMetadata:(NSDictionary *)sourceStoreMetadata
+                                                                     toDestinationModel:(NSManagedObjectModel *)destinationModel
+                                                                                  error:(NSError * __autoreleasing *)error
+{
+    NSArray<_CBRCoreDataStackModelVersion *> *modelVersions = [self _modelVersions];
+
+    if (modelVersions.count == 0) {
+        [self _updateError:error code:CBRCoreDataStackManagedObjectModelNotFound description:[NSString stringWithFormat:@"No NSManagedObjectModel found in bundle %@", self.bundle] underlyingError:nil];
+        return nil;
     }
 
-    if (!mappingModel) {
-        return updateError(CBRCoreDataStackMappingModelNotFound, [NSString stringWithFormat:@"Unable to find NSMappingModel for store at URL %@", dataStoreURL]);
+    NSDictionary *sourceVersionHashes = sourceStoreMetadata[NSStoreModelVersionHashesKey];
+    NSUInteger sourceIndex = [modelVersions indexOfObjectPassingTest:^BOOL(_CBRCoreDataStackModelVersion *version, NSUInteger index, BOOL *stop) {
+        return [version.versionHashes isEqualToDictionary:sourceVersionHashes];
+    }];
+
+    if (sourceIndex == NSNotFound) {
+        sourceIndex = [modelVersions indexOfObjectPassingTest:^BOOL(_CBRCoreDataStackModelVersion *version, NSUInteger index, BOOL *stop) {
+            return [version.managedObjectModel isConfiguration:nil compatibleWithStoreMetadata:sourceStoreMetadata];
+        }];
     }
 
-    NSMigrationManager *migrationManager = [[NSMigrationManager alloc] initWithSourceModel:sourceModel
-                                                                          destinationModel:targetModel];
+    if (sourceIndex == NSNotFound) {
+        [self _updateError:error code:CBRCoreDataStackManagedObjectModelNotFound description:[NSString stringWithFormat:@"Unable to find NSManagedObjectModel for store metadata %@", sourceStoreMetadata] underlyingError:nil];
+        return nil;
+    }
 
-    NSString *modelName = modelPath.lastPathComponent.stringByDeletingPathExtension;
-    NSString *storeExtension = dataStoreURL.path.pathExtension;
+    NSDictionary *destinationVersionHashes = destinationModel.entityVersionHashesByName;
+    NSUInteger destinationIndex = [modelVersions indexOfObjectWithOptions:NSEnumerationReverse passingTest:^BOOL(_CBRCoreDataStackModelVersion *version, NSUInteger index, BOOL *stop) {
+        return [version.versionHashes isEqualToDictionary:destinationVersionHashes];
+    }];
+
+    if (destinationIndex != NSNotFound && destinationIndex < sourceIndex) {
+        [self _updateError:error code:CBRCoreDataStackManagedObjectModelNotFound description:[NSString stringWithFormat:@"Store at URL %@ was created by the newer model %@", self.storeLocation, modelVersions[sourceIndex].name] underlyingError:nil];
+        return nil;
+    }
+
+    NSMutableArray<_CBRCoreDataStackModelVersion *> *chain = [NSMutableArray array];
+    NSUInteger lastIndex = destinationIndex != NSNotFound ? destinationIndex : modelVersions.count - 1;
+
+    for (NSUInteger index = sourceIndex; index <= lastIndex; index++) {
+        _CBRCoreDataStackModelVersion *version = modelVersions[index];
+
+        if (chain.count > 0 && [chain.lastObject.versionHashes isEqualToDictionary:version.versionHashes]) {
+            continue;
+        }
+
+        [chain addObject:version];
+    }
+
+    if (destinationIndex == NSNotFound) {
+        // a model outside of the bundled versions, e.g. a merged one, is migrated to last
+        [chain addObject:[[_CBRCoreDataStackModelVersion alloc] initWithName:self.managedObjectModelURL.lastPathComponent.stringByDeletingPathExtension URL:self.managedObjectModelURL versionHashes:destinationVersionHashes managedObjectModel:destinationModel]];
+    }
+
+    for (NSUInteger index = 0; index < chain.count; index++) {
+        chain[index].mappingModel = index + 1 < chain.count ? [NSMappingModel mappingModelFromBundles:@[ self.bundle ] forSourceModel:chain[index].managedObjectModel destinationModel:chain[index + 1].managedObjectModel] : nil;
+    }
+
+    return chain;
+}
+
+/**
+ Ranges into `chain`, each one being a step. Consecutive versions without a mapping model are collapsed into one lightweight step.
+ */
+- (NSArray<NSValue *> *)_migrationStepsAlongChain:(NSArray<_CBRCoreDataStackModelVersion *> *)chain
+{
+    NSMutableArray<NSValue *> *steps = [NSMutableArray array];
+    NSUInteger location = 0;
+
+    while (location + 1 < chain.count) {
+        NSUInteger length = 1;
+
+        if (chain[location].mappingModel == nil) {
+            while (location + length + 1 < chain.count && chain[location + length].mappingModel == nil) {
+                length++;
+            }
+        }
+
+        [steps addObject:[NSValue valueWithRange:NSMakeRange(location, length)]];
+        location += length;
+    }
+
+    return steps;
+}
 
+- (BOOL)_performLightweightMigrationFromDataStoreAtURL:(NSURL *)dataStoreURL
+                                         alongVersions:(NSArray<_CBRCoreDataStackModelVersion *> *)versions
+                                                 error:(NSError * __autoreleasing *)error
+{
+    NSError *migrationError = nil;
+    if ([self _performLightweightMigrationFromDataStoreAtURL:dataStoreURL toDestinationModel:versions.lastObject.managedObjectModel error:&migrationError]) {
+        return YES;
+    }
+
+    if (versions.count > 2) {
+        // mappings are not always inferable across several versions at once
+        BOOL success = YES;
+        for (NSUInteger index = 1; index < versions.count && success; index++) {
+            success = [self _performLightweightMigrationFromDataStoreAtURL:dataStoreURL toDestinationModel:versions[index].managedObjectModel error:&migrationError];
+        }
+
+        if (success) {
+            return YES;
+        }
+    }
+
+    return [self _updateError:error code:CBRCoreDataStackMappingModelNotFound description:[NSString stringWithFormat:@"Unable to find NSMappingModel from %@ to %@ for store at URL %@", versions.firstObject.name, versions.lastObject.name, dataStoreURL] underlyingError:migrationError];
+}
+
+- (BOOL)_performLightweightMigrationFromDataStoreAtURL:(NSURL *)dataStoreURL
+                                    toDestinationModel:(NSManagedObjectModel *)destinationModel
+                                                 error:(NSError * __autoreleasing *)error
+{
+    NSDictionary *options = @{
+                              NSMigratePersistentStoresAutomaticallyOption: @YES,
+                              NSInferMappingModelAutomaticallyOption: @YES
+                              };
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:destinationModel];
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator addPersistentStoreWithType:self.storeType configuration:nil URL:dataStoreURL options:options error:error];
+
+    if (!persistentStore) {
+        return NO;
+    }
+
+    return [persistentStoreCoordinator removePersistentStore:persistentStore error:error];
+}
+
+- (BOOL)_performMigrationFromDataStoreAtURL:(NSURL *)dataStoreURL
+                                fromVersion:(_CBRCoreDataStackModelVersion *)sourceVersion
+                                  toVersion:(_CBRCoreDataStackModelVersion *)destinationVersion
+                            progressHandler:(void(^)(float progress))progressHandler
+                                      error:(NSError * __autoreleasing *)error
+{
+    NSString *storeExtension = dataStoreURL.path.pathExtension;
     NSString *storePath = dataStoreURL.path.stringByDeletingPathExtension;
 
-    NSString *destinationPath = [NSString stringWithFormat:@"%@.%@.%@", storePath, modelName, storeExtension];
+    NSString *destinationPath = [NSString stringWithFormat:@"%@.%@.%@", storePath, destinationVersion.name, storeExtension];
     NSURL *destinationURL = [NSURL fileURLWithPath:destinationPath];
 
-    if (![migrationManager migrateStoreFromURL:dataStoreURL type:self.storeType options:nil withMappingModel:mappingModel toDestinationURL:destinationURL destinationType:self.storeType destinationOptions:nil error:error]) {
-        return NO;
+    NSURL *checkpointURL = [self _migrationCheckpointURL];
+    NSDictionary *checkpoint = [NSDictionary dictionaryWithContentsOfURL:checkpointURL];
+
+    NSUInteger completedPasses = 0;
+    BOOL resumesMigration = [checkpoint[CBRCoreDataStackMigrationCheckpointSourceKey] isEqual:sourceVersion.name] && [checkpoint[CBRCoreDataStackMigrationCheckpointDestinationKey] isEqual:destinationVersion.name] && [[NSFileManager defaultManager] fileExistsAtPath:destinationPath];
+
+    if (resumesMigration) {
+        completedPasses = [checkpoint[CBRCoreDataStackMigrationCheckpointPassesKey] unsignedIntegerValue];
+        NSLog(@"[CBRCoreDataStack] resuming migration to %@ after %lu completed passes", destinationVersion.name, (unsigned long)completedPasses);
+    } else {
+        NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:destinationVersion.managedObjectModel];
+        [persistentStoreCoordinator destroyPersistentStoreAtURL:destinationURL withType:self.storeType options:nil error:NULL];
     }
 
-    if (![[NSFileManager defaultManager] removeItemAtURL:dataStoreURL error:error]) {
+    NSArray<NSMappingModel *> *passes = [self _migrationPassesForMappingModel:sourceVersion.mappingModel destinationModel:destinationVersion.managedObjectModel];
+
+    for (NSUInteger pass = completedPasses; pass < passes.count; pass++) {
+        // a pass that was saved right before termination but not yet checkpointed must not be migrated twice
+        if (resumesMigration && pass == completedPasses && [self _persistentStoreAtURL:destinationURL model:destinationVersion.managedObjectModel containsDestinationInstancesOfMappingModel:passes[pass]]) {
+            continue;
+        }
+
+        NSDictionary *passCheckpoint = @{
+                                         CBRCoreDataStackMigrationCheckpointSourceKey: sourceVersion.name,
+                                         CBRCoreDataStackMigrationCheckpointDestinationKey: destinationVersion.name,
+                                         CBRCoreDataStackMigrationCheckpointPassesKey: @(pass),
+                                         };
+        [passCheckpoint writeToURL:checkpointURL atomically:YES];
+
+        NSMigrationManager *migrationManager = [[NSMigrationManager alloc] initWithSourceModel:sourceVersion.managedObjectModel destinationModel:destinationVersion.managedObjectModel];
+        _CBRCoreDataStackMigrationProgressObserver *observer = [[_CBRCoreDataStackMigrationProgressObserver alloc] initWithMigrationManager:migrationManager handler:^(float migrationProgress) {
+            progressHandler((pass + migrationProgress) / passes.count);
+        }];
+
+        BOOL success = NO;
+        @autoreleasepool {
+            success = [migrationManager migrateStoreFromURL:dataStoreURL type:self.storeType options:nil withMappingModel:passes[pass] toDestinationURL:destinationURL destinationType:self.storeType destinationOptions:nil error:error];
+        }
+
+        [observer invalidate];
+
+        if (!success) {
+            return NO;
+        }
+    }
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:destinationVersion.managedObjectModel];
+
+    if (![persistentStoreCoordinator replacePersistentStoreAtURL:dataStoreURL destinationOptions:nil withPersistentStoreFromURL:destinationURL sourceOptions:nil storeType:self.storeType error:error]) {
         return NO;
     }
 
-    if (![[NSFileManager defaultManager] moveItemAtURL:destinationURL toURL:dataStoreURL error:error]) {
+    [persistentStoreCoordinator destroyPersistentStoreAtURL:destinationURL withType:self.storeType options:nil error:NULL];
+    [[NSFileManager defaultManager] removeItemAtURL:checkpointURL error:NULL];
+
+    return YES;
+}
+
+/**
+ Splits `mappingModel` into one mapping model per group of entities connected through relationships. Relationships are only restored between instances migrated in the same pass, which bounds the memory of each pass by the largest group instead of the whole store. Groups are not split any further, a fully connected model results in a single pass.
+ */
+- (NSArray<NSMappingModel *> *)_migrationPassesForMappingModel:(NSMappingModel *)mappingModel destinationModel:(NSManagedObjectModel *)destinationModel
+{
+    NSMutableDictionary<NSString *, NSString *> *groups = [NSMutableDictionary dictionary];
+
+    for (NSEntityDescription *entity in destinationModel.entities) {
+        for (NSRelationshipDescription *relationship in entity.relationshipsByName.allValues) {
+            NSString *group = CBRMigrationGroupOfEntityName(groups, CBRRootEntity(entity).name);
+            NSString *destinationGroup = CBRMigrationGroupOfEntityName(groups, CBRRootEntity(relationship.destinationEntity).name);
+
+            if (![group isEqualToString:destinationGroup]) {
+                groups[destinationGroup] = group;
+            }
+        }
+    }
+
+    NSMutableArray<NSString *> *passGroups = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSMutableArray<NSEntityMapping *> *> *entityMappingsByGroup = [NSMutableDictionary dictionary];
+    NSMutableArray<NSEntityMapping *> *removedEntityMappings = [NSMutableArray array];
+
+    for (NSEntityMapping *entityMapping in mappingModel.entityMappings) {
+        NSEntityDescription *entity = entityMapping.destinationEntityName != nil ? destinationModel.entitiesByName[entityMapping.destinationEntityName] : nil;
+
+        if (!entity) {
+            [removedEntityMappings addObject:entityMapping];
+            continue;
+        }
+
+        NSString *group = CBRMigrationGroupOfEntityName(groups, CBRRootEntity(entity).name);
+        if (!entityMappingsByGroup[group]) {
+            entityMappingsByGroup[group] = [NSMutableArray array];
+            [passGroups addObject:group];
+        }
+
+        [entityMappingsByGroup[group] addObject:entityMapping];
+    }
+
+    if (passGroups.count <= 1) {
+        return @[ mappingModel ];
+    }
+
+    NSMutableArray<NSMappingModel *> *passes = [NSMutableArray array];
+    for (NSString *group in passGroups) {
+        NSMutableArray<NSEntityMapping *> *entityMappings = entityMappingsByGroup[group];
+
+        if (passes.count == 0) {
+            [entityMappings addObjectsFromArray:removedEntityMappings];
+        }
+
+        NSMappingModel *pass = [[NSMappingModel alloc] init];
+        pass.entityMappings = entityMappings;
+        [passes addObject:pass];
+    }
+
+    return passes;
+}
+
+- (BOOL)_persistentStoreAtURL:(NSURL *)URL model:(NSManagedObjectModel *)model containsDestinationInstancesOfMappingModel:(NSMappingModel *)mappingModel
+{
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator addPersistentStoreWithType:self.storeType configuration:nil URL:URL options:nil error:NULL];
+
+    if (!persistentStore) {
         return NO;
     }
 
-    return [self _performMigrationFromDataStoreAtURL:dataStoreURL
-                                  toDestinationModel:destinationModel
-                                               error:error];
+    NSManagedObjectContext *context = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+    context.persistentStoreCoordinator = persistentStoreCoordinator;
+
+    __block BOOL containsInstances = NO;
+    [context performBlockAndWait:^{
+        for (NSEntityMapping *entityMapping in mappingModel.entityMappings) {
+            if (entityMapping.destinationEntityName == nil) {
+                continue;
+            }
+
+            NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:entityMapping.destinationEntityName];
+            fetchRequest.includesSubentities = NO;
+            fetchRequest.fetchLimit = 1;
+
+            if ([context countForFetchRequest:fetchRequest error:NULL] > 0) {
+                containsInstances = YES;
+                break;
+            }
+        }
+    }];
+
+    [persistentStoreCoordinator removePersistentStore:persistentStore error:NULL];
+    return containsInstances;
+}
+
+- (NSURL *)_migrationCheckpointURL
+{
+    return [NSURL fileURLWithPath:[self.storeLocation.path stringByAppendingString:@".migration.plist"]];
 }
 
 @end
@@ -0,0 +1,472 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <malloc/malloc.h>
+#import <sys/resource.h>
+
+#import <CloudBridge/CloudBridge.h>
+#import <CloudBridge/CBRRESTConnection.h>
+
+#import "CBRTestDataStore.h"
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+static NSUInteger const CBRBenchmarkObjectCount = 200;
+
+
+
+@interface CBRBenchmarkJSONObject : CBRJSONObject
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSString *otherName;
+@property (nonatomic, strong) NSArray<NSString *> *tags;
+@end
+
+@implementation CBRBenchmarkJSONObject @end
+
+
+
+/**
+ Measures the mapping, cache, property mapping, JSON, threading and startup hot paths against an in-memory store. Every benchmark reports its wall clock time to XCTest for baselines and logs throughput, live allocations per operation and the peak resident size of the process.
+
+ Benchmarks only run if the `CBR_BENCHMARKS` environment variable is set, e.g. in a dedicated scheme.
+ */
+@interface CBRBenchmarkTests : XCTestCase
+@property (nonatomic, strong) CBRCoreDataStack *stack;
+@property (nonatomic, strong) CBRCoreDataInterface *adapter;
+@property (nonatomic, strong) CBRThreadingEnvironment *environment;
+@property (nonatomic, strong) CBRUnderscoredPropertyMapping *propertyMapping;
+@property (nonatomic, strong) CBRJSONDictionaryTransformer *transformer;
+@property (nonatomic, strong) CBRCloudBridge *cloudBridge;
+@property (nonatomic, assign) NSUInteger nextIdentifier;
+@end
+
+
+
+@implementation CBRBenchmarkTests
+
++ (XCTestSuite *)defaultTestSuite
+{
+    if ([NSProcessInfo processInfo].environment[@"CBR_BENCHMARKS"].length == 0) {
+        return [[XCTestSuite alloc] initWithName:NSStringFromClass(self)];
+    }
+
+    return [super defaultTestSuite];
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    NSBundle *bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    NSURL *modelURL = [bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+    NSURL *location = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"CBRBenchmark.store"];
+
+    self.stack = [[CBRCoreDataStack alloc] initWithType:NSInMemoryStoreType location:location model:modelURL inBundle:bundle type:CBRCoreDataStackTypeParallel];
+
+    self.propertyMapping = [[CBRUnderscoredPropertyMapping alloc] init];
+    [self.propertyMapping registerObjcNamingConvention:@"identifier" forJSONNamingConvention:@"id"];
+
+    AFHTTPSessionManager *sessionManager = [[AFHTTPSessionManager alloc] initWithBaseURL:[NSURL URLWithString:@"http://localhost"]];
+    CBRRESTConnection *connection = [[CBRRESTConnection alloc] initWithPropertyMapping:self.propertyMapping sessionManager:sessionManager];
+
+    self.transformer = connection.objectTransformer;
+    self.adapter = [[CBRCoreDataInterface alloc] initWithStack:self.stack];
+    self.environment = [[CBRThreadingEnvironment alloc] initWithCoreDataAdapter:self.adapter];
+    self.cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:connection interface:self.adapter threadingEnvironment:self.environment];
+
+    [NSManagedObject setCloudBridge:self.cloudBridge];
+    [CBRJSONObject setRestConnection:connection];
+}
+
+- (void)tearDown
+{
+    [self.stack.mainThreadManagedObjectContext reset];
+
+    [super tearDown];
+}
+
+#pragma mark - CBRJSONDictionaryTransformer
+
+- (void)testMappingFlatPayloads
+{
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+
+    // every run maps fresh identifiers so that objects are inserted, payloads are built before measuring
+    [self _benchmark:@"mapping.flat" operations:CBRBenchmarkObjectCount input:^id{
+        return [self _flatPayloads];
+    } block:^(NSArray<NSDictionary *> *payloads) {
+        for (NSDictionary *cloudObject in payloads) {
+            [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+        }
+    }];
+}
+
+- (void)testMappingWidePayloads
+{
+    CBREntityDescription *entityDescription = [SLEntity5 cloudBridgeEntityDescription];
+
+    [self _benchmark:@"mapping.wide" operations:CBRBenchmarkObjectCount input:^id{
+        return [self _widePayloadsWithSTIValue:nil];
+    } block:^(NSArray<NSDictionary *> *payloads) {
+        for (NSDictionary *cloudObject in payloads) {
+            [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+        }
+    }];
+}
+
+- (void)testMappingNestedPayloads
+{
+    CBREntityDescription *entityDescription = [SLEntity5 cloudBridgeEntityDescription];
+
+    [self _benchmark:@"mapping.nested" operations:CBRBenchmarkObjectCount input:^id{
+        return [self _nestedPayloads];
+    } block:^(NSArray<NSDictionary *> *payloads) {
+        for (NSDictionary *cloudObject in payloads) {
+            [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+        }
+    }];
+}
+
+- (void)testMappingSTIPayloads
+{
+    CBREntityDescription *entityDescription = [SLEntity5 cloudBridgeEntityDescription];
+
+    [self _benchmark:@"mapping.sti" operations:CBRBenchmarkObjectCount input:^id{
+        return [self _widePayloadsWithSTIValue:@13371338];
+    } block:^(NSArray<NSDictionary *> *payloads) {
+        for (NSDictionary *cloudObject in payloads) {
+            [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+        }
+    }];
+}
+
+- (void)testSerializingPersistentObjects
+{
+    CBREntityDescription *entityDescription = [SLEntity5 cloudBridgeEntityDescription];
+    NSMutableArray *persistentObjects = [NSMutableArray array];
+
+    for (NSDictionary *cloudObject in [self _widePayloadsWithSTIValue:nil]) {
+        [persistentObjects addObject:[self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription]];
+    }
+
+    [self _benchmark:@"serializing.wide" operations:persistentObjects.count block:^{
+        for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+            [self.transformer cloudObjectFromPersistentObject:persistentObject];
+        }
+    }];
+}
+
+#pragma mark - CBRPersistentObjectCache
+
+- (void)testCacheLookups
+{
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    NSArray<NSDictionary *> *payloads = [self _flatPayloads];
+
+    for (NSDictionary *cloudObject in payloads) {
+        [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+    }
+    [self.stack.mainThreadManagedObjectContext save:NULL];
+
+    NSArray *identifiers = [payloads valueForKey:@"id"];
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+
+    [self _benchmark:@"cache.lookup" operations:identifiers.count block:^{
+        for (id identifier in identifiers) {
+            [databaseAdapter persistentObjectOfType:entityDescription withPrimaryKey:identifier];
+        }
+    }];
+}
+
+- (void)testIndexedCacheLookups
+{
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    NSArray<NSDictionary *> *payloads = [self _flatPayloads];
+
+    for (NSDictionary *cloudObject in payloads) {
+        [self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription];
+    }
+    [self.stack.mainThreadManagedObjectContext save:NULL];
+
+    NSSet *identifiers = [NSSet setWithArray:[payloads valueForKey:@"id"]];
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+
+    [self _benchmark:@"cache.indexed" operations:identifiers.count block:^{
+        [databaseAdapter indexedObjectsOfType:entityDescription withValues:identifiers forAttribute:@"identifier"];
+    }];
+}
+
+#pragma mark - CBRUnderscoredPropertyMapping
+
+- (void)testPropertyMappingConversions
+{
+    NSArray<NSString *> *properties = @[ @"identifier", @"floatNumber", @"otherString", @"camelizedChilds", @"differentChilds", @"otherToManyChilds", @"parentIdentifier" ];
+    NSUInteger rounds = CBRBenchmarkObjectCount;
+
+    [self _benchmark:@"propertyMapping" operations:rounds * properties.count * 2 block:^{
+        for (NSUInteger i = 0; i < rounds; i++) {
+            for (NSString *property in properties) {
+                NSString *keyPath = [self.propertyMapping cloudKeyPathFromPersistentObjectProperty:property];
+                [self.propertyMapping persistentObjectPropertyFromCloudKeyPath:keyPath];
+            }
+        }
+    }];
+}
+
+#pragma mark - CBRJSONObject
+
+- (void)testJSONObjectParsing
+{
+    NSData *data = [NSJSONSerialization dataWithJSONObject:[self _JSONObjectPayloads] options:kNilOptions error:NULL];
+
+    [self _benchmark:@"jsonObject.parse" operations:CBRBenchmarkObjectCount block:^{
+        NSArray *objects = [CBRBenchmarkJSONObject parse:data error:NULL];
+        NSParameterAssert(objects.count == CBRBenchmarkObjectCount);
+    }];
+}
+
+- (void)testJSONObjectEncoding
+{
+    NSArray<CBRBenchmarkJSONObject *> *objects = [CBRBenchmarkJSONObject parse:[self _JSONObjectPayloads] error:NULL];
+
+    [self _benchmark:@"jsonObject.encode" operations:objects.count block:^{
+        for (CBRBenchmarkJSONObject *object in objects) {
+            [object jsonRepresentation];
+        }
+    }];
+}
+
+#pragma mark - CBRThreadingEnvironment
+
+- (void)testThreadTransfers
+{
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    NSMutableArray *persistentObjects = [NSMutableArray array];
+
+    for (NSDictionary *cloudObject in [self _flatPayloads]) {
+        [persistentObjects addObject:[self.transformer persistentObjectFromCloudObject:cloudObject forEntity:entityDescription]];
+    }
+    [self.stack.mainThreadManagedObjectContext save:NULL];
+
+    [self _benchmark:@"threading.roundtrip" operations:persistentObjects.count block:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"roundtrip"];
+
+        [self.environment moveObject:persistentObjects toThread:CBRThreadBackground completion:^(id object, NSError *error) {
+            [self.environment moveObject:object toThread:CBRThreadMain completion:^(id object, NSError *error) {
+                [expectation fulfill];
+            }];
+        }];
+
+        [self waitForExpectationsWithTimeout:10.0 handler:nil];
+    }];
+}
+
+#pragma mark - Startup
+
+- (void)testStartupCoreDataInterface
+{
+    NSBundle *bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    NSURL *modelURL = [bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+    NSURL *location = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"CBRStartup.store"];
+
+    // until the first frame: the store stays closed, entities are derived from the model
+    [self _benchmark:@"startup.coredata.interface" operations:1 input:^id{
+        [CBREntityDescription removeAllCachedEntities];
+        return nil;
+    } block:^(id input) {
+        CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSInMemoryStoreType location:location model:modelURL inBundle:bundle type:CBRCoreDataStackTypeParallel];
+        CBRCoreDataInterface *interface = [[CBRCoreDataInterface alloc] initWithStack:stack];
+        XCTAssertFalse(stack.isPersistentStoreLoaded);
+        XCTAssertGreaterThan(interface.entities.count, 0);
+    }];
+}
+
+- (void)testStartupCoreDataStore
+{
+    NSBundle *bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    NSURL *modelURL = [bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+    NSURL *location = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"CBRStartup.store"];
+
+    [self _benchmark:@"startup.coredata.store" operations:1 input:^id{
+        [CBREntityDescription removeAllCachedEntities];
+        return nil;
+    } block:^(id input) {
+        CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSInMemoryStoreType location:location model:modelURL inBundle:bundle type:CBRCoreDataStackTypeParallel];
+        CBRCoreDataInterface *interface = [[CBRCoreDataInterface alloc] initWithStack:stack];
+        XCTAssertNotNil(interface.stack.mainThreadManagedObjectContext);
+    }];
+}
+
+- (void)testStartupRealmInterface
+{
+    RLMRealmConfiguration *configuration = [RLMRealmConfiguration defaultConfiguration];
+    configuration.inMemoryIdentifier = @"CBRStartup";
+    configuration.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    [self _benchmark:@"startup.realm.interface" operations:1 input:^id{
+        [CBREntityDescription removeAllCachedEntities];
+        return nil;
+    } block:^(id input) {
+        CBRRealmInterface *interface = [[CBRRealmInterface alloc] initWithConfiguration:configuration];
+        XCTAssertGreaterThan(interface.entities.count, 0);
+    }];
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_benchmark:(NSString *)name operations:(NSUInteger)operations block:(dispatch_block_t)block
+{
+    [self _benchmark:name operations:operations input:nil block:^(id input) {
+        block();
+    }];
+}
+
+/**
+ `input` runs before every measured run and its result is passed to `block`, only `block` is measured.
+ */
+- (void)_benchmark:(NSString *)name operations:(NSUInteger)operations input:(id(^)(void))input block:(void(^)(id input))block
+{
+    __block NSTimeInterval duration = 0.0;
+    __block double allocatedBlocks = 0.0;
+    __block double allocatedBytes = 0.0;
+    __block NSUInteger runs = 0;
+
+    [self measureMetrics:[self.class defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        @autoreleasepool {
+            id inputValue = input ? input() : nil;
+
+            malloc_statistics_t before, after;
+            malloc_zone_statistics(NULL, &before);
+            [self startMeasuring];
+            NSTimeInterval start = CBRInstrumentationTimestamp();
+
+            block(inputValue);
+
+            duration += CBRInstrumentationTimestamp() - start;
+            [self stopMeasuring];
+            malloc_zone_statistics(NULL, &after);
+
+            allocatedBlocks += (double)after.blocks_in_use - (double)before.blocks_in_use;
+            allocatedBytes += (double)after.size_in_use - (double)before.size_in_use;
+            runs++;
+        }
+    }];
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    double totalOperations = (double)operations * runs;
+    NSLog(@"[CBRBenchmark] %@: %.0f ops/s, %.1f allocations/op, %.0f bytes/op, peak memory %.1f MB",
+          name,
+          totalOperations / MAX(duration, DBL_EPSILON),
+          MAX(allocatedBlocks, 0.0) / totalOperations,
+          MAX(allocatedBytes, 0.0) / totalOperations,
+          usage.ru_maxrss / 1024.0 / 1024.0);
+}
+
+- (NSArray<NSNumber *> *)_nextIdentifiers:(NSUInteger)count
+{
+    NSMutableArray *identifiers = [NSMutableArray arrayWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        [identifiers addObject:@(++self.nextIdentifier)];
+    }
+
+    return identifiers;
+}
+
+- (NSArray<NSDictionary *> *)_flatPayloads
+{
+    NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:CBRBenchmarkObjectCount];
+
+    for (NSNumber *identifier in [self _nextIdentifiers:CBRBenchmarkObjectCount]) {
+        [payloads addObject:@{ @"id": identifier, @"name": [NSString stringWithFormat:@"name %@", identifier] }];
+    }
+
+    return payloads;
+}
+
+- (NSArray<NSDictionary *> *)_widePayloadsWithSTIValue:(NSNumber *)STIValue
+{
+    NSString *date = [self.transformer.dateFormatter stringFromDate:[NSDate date]];
+    NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:CBRBenchmarkObjectCount];
+
+    for (NSNumber *identifier in [self _nextIdentifiers:CBRBenchmarkObjectCount]) {
+        BOOL subclass = STIValue != nil && identifier.unsignedIntegerValue % 2 == 0;
+
+        [payloads addObject:@{
+                              @"id": identifier,
+                              @"float_number": subclass ? STIValue : identifier,
+                              @"string": [NSString stringWithFormat:@"string %@", identifier],
+                              @"other_string": [NSString stringWithFormat:@"other string %@", identifier],
+                              @"date": date,
+                              @"dictionary": @{ @"key": @"value", @"identifier": identifier },
+                              }];
+    }
+
+    return payloads;
+}
+
+- (NSArray<NSDictionary *> *)_nestedPayloads
+{
+    NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:CBRBenchmarkObjectCount];
+
+    for (NSNumber *identifier in [self _nextIdentifiers:CBRBenchmarkObjectCount]) {
+        NSMutableArray *toManyChilds = [NSMutableArray array];
+        for (NSNumber *childIdentifier in [self _nextIdentifiers:4]) {
+            [toManyChilds addObject:@{ @"id": childIdentifier }];
+        }
+
+        [payloads addObject:@{
+                              @"id": identifier,
+                              @"string": [NSString stringWithFormat:@"string %@", identifier],
+                              @"child": @{ @"id": [self _nextIdentifiers:1].firstObject },
+                              @"to_many_childs": toManyChilds,
+                              @"camelizedChilds": @[ @{ @"id": [self _nextIdentifiers:1].firstObject } ],
+                              }];
+    }
+
+    return payloads;
+}
+
+- (NSArray<NSDictionary *> *)_JSONObjectPayloads
+{
+    NSMutableArray *payloads = [NSMutableArray arrayWithCapacity:CBRBenchmarkObjectCount];
+
+    for (NSNumber *identifier in [self _nextIdentifiers:CBRBenchmarkObjectCount]) {
+        [payloads addObject:@{
+                              @"id": identifier,
+                              @"name": [NSString stringWithFormat:@"name %@", identifier],
+                              @"other_name": [NSString stringWithFormat:@"other name %@", identifier],
+                              @"tags": @[ @"a", @"b", @"c" ],
+                              }];
+    }
+
+    return payloads;
+}
+
+@end
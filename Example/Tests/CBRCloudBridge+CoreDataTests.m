@@ -47,6 +47,17 @@
     expect(child.relationshipsByName[@"parent"].inverseRelationship.name).to.equal(@"children");
 }
 
+- (void)testThatEntityDescriptionsAreFrozen
+{
+    CBREntityDescription *parent = self.adapter.entitiesByName[NSStringFromClass([SLEntity6 class])];
+    CBRRelationshipDescription *children = parent.relationshipsByName[@"children"];
+
+    expect(parent.isFrozen).to.beTruthy();
+    expect(parent.attributesByName == parent.attributesByName).to.beTruthy();
+    expect(children.inverseRelationship == children.inverseRelationship).to.beTruthy();
+    expect(children.destinationEntity).to.equal(self.adapter.entitiesByName[NSStringFromClass([SLEntity6Child class])]);
+}
+
 - (void)testThatManagedObjectReturnsGlobalCloudBridge
 {
     expect([NSManagedObject cloudBridge]).to.equal(self.cloudBridge);
@@ -122,6 +133,118 @@
     expect(entity.isDeleted).will.beTruthy();
 }
 
+- (void)testThatPersistentObjectIndexResolvesSavedObjectsInOtherContexts
+{
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+    entity.identifier = @7;
+    [self.context save:NULL];
+
+    NSManagedObjectID *objectID = entity.objectID;
+    expect([self.adapter.persistentObjectIndex referenceForEntity:entityName value:@7]).to.equal(objectID);
+
+    __block NSManagedObjectID *resolvedObjectID = nil;
+    [self.cloudBridge.databaseAdapter transactionWithBlock:^{
+        NSManagedObject *managedObject = [self.cloudBridge.databaseAdapter persistentObjectOfType:[SLEntity6 cloudBridgeEntityDescription] withPrimaryKey:@7];
+        resolvedObjectID = managedObject.objectID;
+    }];
+    expect(resolvedObjectID).will.equal(objectID);
+
+    [self.context deleteObject:entity];
+    [self.context save:NULL];
+    expect([self.adapter.persistentObjectIndex referenceForEntity:entityName value:@7]).to.beNil();
+}
+
+- (void)testThatPersistentObjectIndexIsRestoredFromJournal
+{
+    NSURL *directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+
+    __block BOOL restored = NO;
+    [self.adapter restorePersistentObjectIndexFromDirectory:directoryURL completionHandler:^{
+        restored = YES;
+    }];
+    expect(restored).will.beTruthy();
+
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+    entity.identifier = @7;
+    [self.context save:NULL];
+
+    NSString *journalPath = [directoryURL URLByAppendingPathComponent:[entityName stringByAppendingPathExtension:@"cbrindex"]].path;
+    expect([[NSFileManager defaultManager] fileExistsAtPath:journalPath]).will.beTruthy();
+
+    CBRCoreDataInterface *adapter = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+    expect([adapter.persistentObjectIndex referenceForEntity:entityName value:@7]).to.beNil();
+
+    restored = NO;
+    [adapter restorePersistentObjectIndexFromDirectory:directoryURL completionHandler:^{
+        restored = YES;
+    }];
+    expect(restored).will.beTruthy();
+    expect([adapter.persistentObjectIndex referenceForEntity:entityName value:@7]).to.equal(entity.objectID);
+
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+}
+
+- (void)testThatCorruptedJournalRecordsAreNotReplayed
+{
+    NSURL *directoryURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+
+    __block BOOL restored = NO;
+    [self.adapter restorePersistentObjectIndexFromDirectory:directoryURL completionHandler:^{
+        restored = YES;
+    }];
+    expect(restored).will.beTruthy();
+
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+    entity.identifier = @7;
+    [self.context save:NULL];
+
+    NSString *journalPath = [directoryURL URLByAppendingPathComponent:[entityName stringByAppendingPathExtension:@"cbrindex"]].path;
+    expect([[NSFileManager defaultManager] fileExistsAtPath:journalPath]).will.beTruthy();
+    unsigned long long length = [[NSFileManager defaultManager] attributesOfItemAtPath:journalPath error:NULL].fileSize;
+
+    SLEntity6 *otherEntity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+    otherEntity.identifier = @8;
+    [self.context save:NULL];
+    expect([[NSFileManager defaultManager] attributesOfItemAtPath:journalPath error:NULL].fileSize).will.beGreaterThan(length);
+
+    // flips the checksum of the last record like a torn write would
+    NSMutableData *journal = [NSMutableData dataWithContentsOfFile:journalPath];
+    ((uint8_t *)journal.mutableBytes)[journal.length - 1] ^= 0xFF;
+    [journal writeToFile:journalPath atomically:YES];
+
+    CBRCoreDataInterface *adapter = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+
+    restored = NO;
+    [adapter restorePersistentObjectIndexFromDirectory:directoryURL completionHandler:^{
+        restored = YES;
+    }];
+    expect(restored).will.beTruthy();
+    expect([adapter.persistentObjectIndex referenceForEntity:entityName value:@7]).to.equal(entity.objectID);
+    expect([adapter.persistentObjectIndex referenceForEntity:entityName value:@8]).to.beNil();
+
+    [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:NULL];
+}
+
+- (void)testThatStaleIndexReferencesAreRemoved
+{
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+    entity.identifier = @7;
+    [self.context save:NULL];
+
+    NSManagedObjectID *objectID = entity.objectID;
+    [self.context deleteObject:entity];
+    [self.context save:NULL];
+
+    [self.adapter.persistentObjectIndex setReference:objectID forEntity:entityName value:@8];
+
+    expect([self.adapter persistentObjectForIndexReference:objectID]).to.beNil();
+    expect([self.adapter.persistentObjectIndex referenceForEntity:entityName value:@8]).to.beNil();
+}
+
 - (void)testThatConnectionFetchesObjectsForRelationship
 {
     SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
@@ -178,4 +301,27 @@
     expect(child.isDeleted).to.beFalsy();
 }
 
+- (void)testThatConnectionFetchesObjectsForRelationshipOfMultipleObjects
+{
+    SLEntity6 *entity1 = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity1.identifier = @5;
+
+    SLEntity6 *entity2 = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity2.identifier = @6;
+
+    SLEntity6Child *child = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6Child class]) inManagedObjectContext:self.context];
+    child.identifier = @7;
+    child.parent = entity2;
+
+    [self.context save:NULL];
+
+    self.connection.objectsToReturn = @[ @{ @"identifier": @1, @"parentIdentifier": @5 }, @{ @"identifier": @2, @"parentIdentifier": @5 }, @{ @"identifier": @3, @"parentIdentifier": @6 } ];
+    [SLEntity6 fetchObjectsForRelationship:@"children" ofObjects:@[ entity1, entity2 ] withCompletionHandler:NULL];
+
+    expect(entity1.children).will.haveCountOf(2);
+    expect(entity2.children).will.haveCountOf(1);
+    expect(entity2.children).toNot.contain(child);
+    expect(child.isDeleted).to.beTruthy();
+}
+
 @end
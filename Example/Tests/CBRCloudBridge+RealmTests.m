@@ -196,4 +196,26 @@
     expect(child.invalidated).to.beFalsy();
 }
 
+- (void)testThatRealmAndCacheAreReusedPerThread
+{
+    RLMRealm *realm = self.adapter.realm;
+    CBREntityDescription *entity = self.adapter.entitiesByName[NSStringFromClass([RLMEntity6 class])];
+
+    expect(self.adapter.realm).to.beIdenticalTo(realm);
+    expect([self.adapter persistentObjectCacheOnCurrentThreadForEntity:entity]).to.beIdenticalTo([self.adapter cacheForRealm:realm]);
+
+    CBRRealmInterface *otherAdapter = [[CBRRealmInterface alloc] initWithConfiguration:self.adapter.configuration];
+    expect([otherAdapter persistentObjectCacheOnCurrentThreadForEntity:entity]).toNot.beIdenticalTo([self.adapter persistentObjectCacheOnCurrentThreadForEntity:entity]);
+
+    __block RLMRealm *backgroundRealm = nil;
+    __block CBRPersistentObjectCache *backgroundCache = nil;
+    dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        backgroundRealm = self.adapter.realm;
+        backgroundCache = [self.adapter persistentObjectCacheOnCurrentThreadForEntity:entity];
+    });
+
+    expect(backgroundRealm).toNot.beIdenticalTo(realm);
+    expect(backgroundCache).toNot.beIdenticalTo([self.adapter cacheForRealm:realm]);
+}
+
 @end
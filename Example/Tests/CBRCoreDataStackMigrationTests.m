@@ -0,0 +1,369 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+
+@interface CBRCoreDataStackMigrationTests : CBRTestCase
+@property (nonatomic, strong) NSBundle *bundle;
+@property (nonatomic, strong) NSURL *modelURL;
+@property (nonatomic, strong) NSURL *location;
+
+@property (nonatomic, strong) NSBundle *migrationBundle;
+@property (nonatomic, strong) NSDictionary<NSString *, NSManagedObjectModel *> *migrationModels;
+@end
+
+@implementation CBRCoreDataStackMigrationTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    self.modelURL = [self.bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [self.bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+
+    NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    self.location = [[NSURL fileURLWithPath:directory] URLByAppendingPathComponent:@"CBRMigration.sqlite"];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtURL:self.location.URLByDeletingLastPathComponent error:NULL];
+    [super tearDown];
+}
+
+- (void)testThatCompatibleStoresAreNotMigrated
+{
+    CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:self.modelURL inBundle:self.bundle type:CBRCoreDataStackTypeParallel];
+    expect(stack.persistentStoreCoordinator.persistentStores).to.haveCountOf(1);
+
+    CBRCoreDataStack *reopenedStack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:self.modelURL inBundle:self.bundle type:CBRCoreDataStackTypeParallel];
+
+    __block NSInteger progressCount = 0;
+    reopenedStack.migrationProgressHandler = ^(NSUInteger step, NSUInteger numberOfSteps, float progress) {
+        progressCount++;
+    };
+
+    NSError *error = nil;
+    expect(reopenedStack.requiresMigration).to.beFalsy();
+    expect([reopenedStack migrateDataStore:&error]).to.beTruthy();
+    expect(error).to.beNil();
+    expect(progressCount).to.equal(0);
+}
+
+- (void)testThatStoresOfUnknownModelsFailWithoutLeavingACheckpoint
+{
+    NSAttributeDescription *attribute = [[NSAttributeDescription alloc] init];
+    attribute.name = @"identifier";
+    attribute.attributeType = NSInteger64AttributeType;
+
+    NSEntityDescription *entity = [[NSEntityDescription alloc] init];
+    entity.name = @"UnknownEntity";
+    entity.properties = @[ attribute ];
+
+    NSManagedObjectModel *unknownModel = [[NSManagedObjectModel alloc] init];
+    unknownModel.entities = @[ entity ];
+
+    [[NSFileManager defaultManager] createDirectoryAtURL:self.location.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:unknownModel];
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.location options:nil error:NULL];
+    expect(persistentStore).toNot.beNil();
+    expect([persistentStoreCoordinator removePersistentStore:persistentStore error:NULL]).to.beTruthy();
+
+    CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:self.modelURL inBundle:self.bundle type:CBRCoreDataStackTypeParallel];
+
+    NSError *error = nil;
+    expect(stack.requiresMigration).to.beTruthy();
+    expect([stack migrateDataStore:&error]).to.beFalsy();
+    expect(error.domain).to.equal(CBRCoreDataStackErrorDomain);
+    expect(error.code).to.equal(CBRCoreDataStackManagedObjectModelNotFound);
+
+    NSString *checkpointPath = [self.location.path stringByAppendingString:@".migration.plist"];
+    expect([[NSFileManager defaultManager] fileExistsAtPath:checkpointPath]).to.beFalsy();
+}
+
+- (void)testThatStoresAreMigratedAlongAllModelVersions
+{
+    [self _writeMigrationBundle];
+    [self _createStoreWithModel:self.migrationModels[@"Initial"]];
+
+    NSURL *modelURL = [self.migrationBundle URLForResource:@"CBRMigrationTestsModel" withExtension:@"momd"];
+    CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:modelURL inBundle:self.migrationBundle type:CBRCoreDataStackTypeParallel];
+
+    NSMutableArray<NSArray<NSNumber *> *> *progress = [NSMutableArray array];
+    stack.migrationProgressHandler = ^(NSUInteger step, NSUInteger numberOfSteps, float migrationProgress) {
+        [progress addObject:@[ @(step), @(numberOfSteps), @(migrationProgress) ]];
+    };
+
+    // version names do not sort like the versions, a chain ordered by name misses the mapping model
+    NSError *error = nil;
+    expect(stack.requiresMigration).to.beTruthy();
+    expect([stack migrateDataStore:&error]).to.beTruthy();
+    expect(error).to.beNil();
+
+    NSMutableSet<NSNumber *> *steps = [NSMutableSet set];
+    for (NSArray<NSNumber *> *update in progress) {
+        [steps addObject:update[0]];
+        expect(update[1]).to.equal(@2);
+    }
+
+    expect(steps).to.equal([NSSet setWithArray:@[ @0, @1 ]]);
+    expect(progress.lastObject[2]).to.equal(@1.0);
+
+    [self _expectMigratedStoreOfStack:stack];
+}
+
+- (void)testThatMigrationsResumeAfterTheLastCheckpointedPass
+{
+    [self _writeMigrationBundle];
+    [self _createStoreWithModel:self.migrationModels[@"Biography"]];
+    [self _migrateFirstPassWithCheckpointedPasses:1];
+
+    NSURL *modelURL = [self.migrationBundle URLForResource:@"CBRMigrationTestsModel" withExtension:@"momd"];
+    CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:modelURL inBundle:self.migrationBundle type:CBRCoreDataStackTypeParallel];
+
+    NSMutableArray<NSNumber *> *progress = [NSMutableArray array];
+    NSMutableSet<NSNumber *> *numberOfSteps = [NSMutableSet set];
+    stack.migrationProgressHandler = ^(NSUInteger step, NSUInteger stepCount, float migrationProgress) {
+        [numberOfSteps addObject:@(stepCount)];
+        [progress addObject:@(migrationProgress)];
+    };
+
+    NSError *error = nil;
+    expect([stack migrateDataStore:&error]).to.beTruthy();
+    expect(error).to.beNil();
+    expect(numberOfSteps).to.equal([NSSet setWithObject:@1]);
+    expect(progress.lastObject).to.equal(@1.0);
+
+    [self _expectMigratedStoreOfStack:stack];
+}
+
+- (void)testThatPassesSavedBeforeTheirCheckpointAreNotMigratedTwice
+{
+    [self _writeMigrationBundle];
+    [self _createStoreWithModel:self.migrationModels[@"Biography"]];
+
+    // terminated after saving the first pass but before checkpointing the second one
+    [self _migrateFirstPassWithCheckpointedPasses:0];
+
+    NSURL *modelURL = [self.migrationBundle URLForResource:@"CBRMigrationTestsModel" withExtension:@"momd"];
+    CBRCoreDataStack *stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:modelURL inBundle:self.migrationBundle type:CBRCoreDataStackTypeParallel];
+
+    NSError *error = nil;
+    expect([stack migrateDataStore:&error]).to.beTruthy();
+    expect(error).to.beNil();
+
+    [self _expectMigratedStoreOfStack:stack];
+}
+
+#pragma mark - Private category implementation ()
+
+/**
+ Writes a versioned model with the versions Initial, Biography (adds an attribute) and Rank (changes the type of an attribute, needs a mapping model) and the mapping model from Biography to Rank into a bundle.
+ */
+- (void)_writeMigrationBundle
+{
+    NSURL *bundleURL = [self.location.URLByDeletingLastPathComponent URLByAppendingPathComponent:@"CBRMigrationTests.bundle" isDirectory:YES];
+    NSURL *modelURL = [bundleURL URLByAppendingPathComponent:@"CBRMigrationTestsModel.momd" isDirectory:YES];
+    expect([[NSFileManager defaultManager] createDirectoryAtURL:modelURL withIntermediateDirectories:YES attributes:nil error:NULL]).to.beTruthy();
+
+    self.migrationModels = @{
+                             @"Initial": [self _modelWithVersionIdentifier:@"1" biography:NO numericRank:NO],
+                             @"Biography": [self _modelWithVersionIdentifier:@"2" biography:YES numericRank:NO],
+                             @"Rank": [self _modelWithVersionIdentifier:@"3" biography:YES numericRank:YES],
+                             };
+
+    NSMutableDictionary<NSString *, NSDictionary *> *versionHashes = [NSMutableDictionary dictionary];
+    [self.migrationModels enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSManagedObjectModel *model, BOOL *stop) {
+        NSURL *URL = [modelURL URLByAppendingPathComponent:[name stringByAppendingPathExtension:@"mom"]];
+        expect([[NSKeyedArchiver archivedDataWithRootObject:model] writeToURL:URL atomically:YES]).to.beTruthy();
+
+        versionHashes[name] = model.entityVersionHashesByName;
+    }];
+
+    NSDictionary *versionInfo = @{
+                                  @"NSManagedObjectModel_CurrentVersionName": @"Rank",
+                                  @"NSManagedObjectModel_VersionHashes": versionHashes,
+                                  };
+    expect([versionInfo writeToURL:[modelURL URLByAppendingPathComponent:@"VersionInfo.plist"] atomically:YES]).to.beTruthy();
+
+    NSMappingModel *mappingModel = [self _mappingModelFromModel:self.migrationModels[@"Biography"] toModel:self.migrationModels[@"Rank"]];
+    expect([[NSKeyedArchiver archivedDataWithRootObject:mappingModel] writeToURL:[bundleURL URLByAppendingPathComponent:@"BiographyToRank.cdm"] atomically:YES]).to.beTruthy();
+
+    self.migrationBundle = [NSBundle bundleWithURL:bundleURL];
+}
+
+- (NSManagedObjectModel *)_modelWithVersionIdentifier:(NSString *)versionIdentifier biography:(BOOL)biography numericRank:(BOOL)numericRank
+{
+    NSAttributeDescription *(^attribute)(NSString *, NSAttributeType) = ^(NSString *name, NSAttributeType type) {
+        NSAttributeDescription *attribute = [[NSAttributeDescription alloc] init];
+        attribute.name = name;
+        attribute.attributeType = type;
+        attribute.optional = YES;
+        return attribute;
+    };
+
+    NSMutableArray<NSAttributeDescription *> *authorAttributes = [NSMutableArray arrayWithObjects:attribute(@"identifier", NSInteger64AttributeType), attribute(@"rank", numericRank ? NSInteger64AttributeType : NSStringAttributeType), nil];
+    if (biography) {
+        [authorAttributes addObject:attribute(@"biography", NSStringAttributeType)];
+    }
+
+    NSEntityDescription *author = [[NSEntityDescription alloc] init];
+    author.name = @"Author";
+    author.properties = authorAttributes;
+
+    // not related to authors, both are migrated in separate passes
+    NSEntityDescription *tag = [[NSEntityDescription alloc] init];
+    tag.name = @"Tag";
+    tag.properties = @[ attribute(@"identifier", NSInteger64AttributeType), attribute(@"name", NSStringAttributeType) ];
+
+    NSManagedObjectModel *model = [[NSManagedObjectModel alloc] init];
+    model.entities = @[ author, tag ];
+    model.versionIdentifiers = [NSSet setWithObject:versionIdentifier];
+
+    return model;
+}
+
+- (NSMappingModel *)_mappingModelFromModel:(NSManagedObjectModel *)sourceModel toModel:(NSManagedObjectModel *)destinationModel
+{
+    NSMutableArray<NSEntityMapping *> *entityMappings = [NSMutableArray array];
+
+    for (NSString *entityName in @[ @"Author", @"Tag" ]) {
+        NSEntityDescription *sourceEntity = sourceModel.entitiesByName[entityName];
+        NSEntityDescription *destinationEntity = destinationModel.entitiesByName[entityName];
+
+        NSMutableArray<NSPropertyMapping *> *attributeMappings = [NSMutableArray array];
+        for (NSString *attributeName in destinationEntity.attributesByName) {
+            NSPropertyMapping *attributeMapping = [[NSPropertyMapping alloc] init];
+            attributeMapping.name = attributeName;
+
+            if ([attributeName isEqualToString:@"rank"]) {
+                attributeMapping.valueExpression = [NSExpression expressionWithFormat:@"$source.rank.integerValue"];
+            } else {
+                attributeMapping.valueExpression = [NSExpression expressionWithFormat:@"$source.%K", attributeName];
+            }
+
+            [attributeMappings addObject:attributeMapping];
+        }
+
+        NSEntityMapping *entityMapping = [[NSEntityMapping alloc] init];
+        entityMapping.name = [NSString stringWithFormat:@"%@To%@", entityName, entityName];
+        entityMapping.mappingType = NSTransformEntityMappingType;
+        entityMapping.sourceEntityName = entityName;
+        entityMapping.sourceEntityVersionHash = sourceEntity.versionHash;
+        entityMapping.destinationEntityName = entityName;
+        entityMapping.destinationEntityVersionHash = destinationEntity.versionHash;
+        entityMapping.entityMigrationPolicyClassName = NSStringFromClass([NSEntityMigrationPolicy class]);
+        entityMapping.sourceExpression = [NSExpression expressionWithFormat:@"FETCH(FUNCTION($manager, \"fetchRequestForSourceEntityNamed:predicateString:\", %@, \"TRUEPREDICATE\"), $manager.sourceContext, NO)", entityName];
+        entityMapping.attributeMappings = attributeMappings;
+
+        [entityMappings addObject:entityMapping];
+    }
+
+    NSMappingModel *mappingModel = [[NSMappingModel alloc] init];
+    mappingModel.entityMappings = entityMappings;
+
+    return mappingModel;
+}
+
+- (void)_createStoreWithModel:(NSManagedObjectModel *)model
+{
+    [[NSFileManager defaultManager] createDirectoryAtURL:self.location.URLByDeletingLastPathComponent withIntermediateDirectories:YES attributes:nil error:NULL];
+
+    NSPersistentStoreCoordinator *persistentStoreCoordinator = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+    NSPersistentStore *persistentStore = [persistentStoreCoordinator addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.location options:nil error:NULL];
+    expect(persistentStore).toNot.beNil();
+
+    NSManagedObjectContext *context = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+    context.persistentStoreCoordinator = persistentStoreCoordinator;
+
+    [context performBlockAndWait:^{
+        for (NSInteger identifier = 1; identifier <= 3; identifier++) {
+            NSManagedObject *author = [NSEntityDescription insertNewObjectForEntityForName:@"Author" inManagedObjectContext:context];
+            [author setValue:@(identifier) forKey:@"identifier"];
+            [author setValue:@(identifier).stringValue forKey:@"rank"];
+        }
+
+        for (NSInteger identifier = 1; identifier <= 2; identifier++) {
+            NSManagedObject *tag = [NSEntityDescription insertNewObjectForEntityForName:@"Tag" inManagedObjectContext:context];
+            [tag setValue:@(identifier) forKey:@"identifier"];
+            [tag setValue:[NSString stringWithFormat:@"tag %ld", (long)identifier] forKey:@"name"];
+        }
+
+        expect([context save:NULL]).to.beTruthy();
+    }];
+
+    expect([persistentStoreCoordinator removePersistentStore:persistentStore error:NULL]).to.beTruthy();
+}
+
+/**
+ Leaves the store like a migration from Biography to Rank that was terminated after its first pass, which migrates all authors.
+ */
+- (void)_migrateFirstPassWithCheckpointedPasses:(NSUInteger)checkpointedPasses
+{
+    NSString *destinationPath = [NSString stringWithFormat:@"%@.Rank.%@", self.location.path.stringByDeletingPathExtension, self.location.pathExtension];
+
+    NSMappingModel *mappingModel = [NSMappingModel mappingModelFromBundles:@[ self.migrationBundle ] forSourceModel:self.migrationModels[@"Biography"] destinationModel:self.migrationModels[@"Rank"]];
+    expect(mappingModel).toNot.beNil();
+
+    NSMappingModel *firstPass = [[NSMappingModel alloc] init];
+    firstPass.entityMappings = @[ mappingModel.entityMappings.firstObject ];
+    expect(firstPass.entityMappings.firstObject.destinationEntityName).to.equal(@"Author");
+
+    NSMigrationManager *migrationManager = [[NSMigrationManager alloc] initWithSourceModel:self.migrationModels[@"Biography"] destinationModel:self.migrationModels[@"Rank"]];
+    expect([migrationManager migrateStoreFromURL:self.location type:NSSQLiteStoreType options:nil withMappingModel:firstPass toDestinationURL:[NSURL fileURLWithPath:destinationPath] destinationType:NSSQLiteStoreType destinationOptions:nil error:NULL]).to.beTruthy();
+
+    NSDictionary *checkpoint = @{
+                                 @"source": @"Biography",
+                                 @"destination": @"Rank",
+                                 @"passes": @(checkpointedPasses),
+                                 };
+    expect([checkpoint writeToFile:[self.location.path stringByAppendingString:@".migration.plist"] atomically:YES]).to.beTruthy();
+}
+
+- (void)_expectMigratedStoreOfStack:(CBRCoreDataStack *)stack
+{
+    NSString *checkpointPath = [self.location.path stringByAppendingString:@".migration.plist"];
+    expect([[NSFileManager defaultManager] fileExistsAtPath:checkpointPath]).to.beFalsy();
+    expect(stack.requiresMigration).to.beFalsy();
+
+    NSManagedObjectContext *context = stack.mainThreadManagedObjectContext;
+
+    NSFetchRequest *authorsRequest = [NSFetchRequest fetchRequestWithEntityName:@"Author"];
+    authorsRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"identifier" ascending:YES] ];
+
+    NSArray<NSManagedObject *> *authors = [context executeFetchRequest:authorsRequest error:NULL];
+    expect([authors valueForKey:@"identifier"]).to.equal(@[ @1, @2, @3 ]);
+    expect([authors valueForKey:@"rank"]).to.equal(@[ @1, @2, @3 ]);
+
+    NSFetchRequest *tagsRequest = [NSFetchRequest fetchRequestWithEntityName:@"Tag"];
+    expect([context countForFetchRequest:tagsRequest error:NULL]).to.equal(2);
+}
+
+@end
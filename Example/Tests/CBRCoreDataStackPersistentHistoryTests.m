@@ -0,0 +1,138 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+
+@interface CBRCoreDataStack (CBRCoreDataStackPersistentHistoryTests)
+@property (nonatomic, nullable, readonly) NSManagedObjectContext *persistentHistoryManagedObjectContext;
+@end
+
+
+
+@interface CBRCoreDataStackPersistentHistoryTests : CBRTestCase
+@property (nonatomic, strong) CBRCoreDataStack *stack;
+@property (nonatomic, strong) NSURL *location;
+@end
+
+@implementation CBRCoreDataStackPersistentHistoryTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    NSBundle *bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    NSURL *modelURL = [bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+    NSString *directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+
+    self.location = [[NSURL fileURLWithPath:directory] URLByAppendingPathComponent:@"CBRPersistentHistory.sqlite"];
+    self.stack = [[CBRCoreDataStack alloc] initWithType:NSSQLiteStoreType location:self.location model:modelURL inBundle:bundle type:CBRCoreDataStackTypePersistentHistory];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtURL:self.location.URLByDeletingLastPathComponent error:NULL];
+    [super tearDown];
+}
+
+- (void)testThatBackgroundSavesAreMergedIntoRegisteredObjects
+{
+    NSManagedObjectContext *mainContext = self.stack.mainThreadManagedObjectContext;
+    NSManagedObjectContext *backgroundContext = self.stack.backgroundThreadManagedObjectContext;
+
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:mainContext];
+    entity.name = @"main";
+    expect([mainContext save:NULL]).to.beTruthy();
+
+    NSManagedObjectID *objectID = entity.objectID;
+    [backgroundContext performBlockAndWait:^{
+        SLEntity6 *backgroundEntity = [backgroundContext existingObjectWithID:objectID error:NULL];
+        backgroundEntity.name = @"background";
+
+        SLEntity6 *insertedEntity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:backgroundContext];
+        insertedEntity.name = @"inserted";
+
+        [backgroundContext save:NULL];
+    }];
+
+    expect(entity.name).will.equal(@"background");
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([SLEntity6 class])];
+    expect([mainContext countForFetchRequest:fetchRequest error:NULL]).to.equal(2);
+}
+
+- (void)testThatObjectsInsertedAndDeletedInOneBatchAreNotMerged
+{
+    NSManagedObjectContext *mainContext = self.stack.mainThreadManagedObjectContext;
+    NSManagedObjectContext *backgroundContext = self.stack.backgroundThreadManagedObjectContext;
+
+    NSMutableArray<NSNotification *> *notifications = [NSMutableArray array];
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:NSManagedObjectContextObjectsDidChangeNotification object:mainContext queue:nil usingBlock:^(NSNotification *notification) {
+        [notifications addObject:notification];
+    }];
+
+    // holds back the history merge until both saves are part of the same batch
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [self.stack.persistentHistoryManagedObjectContext performBlock:^{
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    }];
+
+    __block NSManagedObjectID *deletedObjectID = nil;
+    __block NSManagedObjectID *insertedObjectID = nil;
+    [backgroundContext performBlockAndWait:^{
+        SLEntity6 *deletedEntity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:backgroundContext];
+        deletedEntity.name = @"deleted";
+
+        SLEntity6 *insertedEntity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:backgroundContext];
+        insertedEntity.name = @"inserted";
+
+        [backgroundContext save:NULL];
+        deletedObjectID = deletedEntity.objectID;
+        insertedObjectID = insertedEntity.objectID;
+
+        deletedEntity.name = @"updated";
+        [backgroundContext save:NULL];
+
+        [backgroundContext deleteObject:deletedEntity];
+        [backgroundContext save:NULL];
+    }];
+
+    dispatch_semaphore_signal(semaphore);
+
+    expect(notifications.count).will.beGreaterThan(0);
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+    NSSet *insertedObjectIDs = [notifications.firstObject.userInfo[NSInsertedObjectsKey] valueForKey:@"objectID"];
+    expect(insertedObjectIDs).to.equal([NSSet setWithObject:insertedObjectID]);
+    expect([mainContext objectRegisteredForID:deletedObjectID]).to.beNil();
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([SLEntity6 class])];
+    expect([mainContext countForFetchRequest:fetchRequest error:NULL]).to.equal(1);
+}
+
+@end
@@ -0,0 +1,106 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+#import <CloudBridge/CBRRESTConnection.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+#import "CBRTestDataStoreEntityMappers.h"
+
+@interface CBREntityMapperTests : CBRTestCase
+@property (nonatomic, strong) CBRCoreDataInterface *adapter;
+@property (nonatomic, strong) CBRJSONDictionaryTransformer *genericTransformer;
+@property (nonatomic, strong) CBRJSONDictionaryTransformer *generatedTransformer;
+@end
+
+@implementation CBREntityMapperTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    CBRUnderscoredPropertyMapping *propertyMapping = [[CBRUnderscoredPropertyMapping alloc] init];
+    [propertyMapping registerObjcNamingConvention:@"identifier" forJSONNamingConvention:@"id"];
+
+    self.adapter = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+    self.genericTransformer = [[CBRJSONDictionaryTransformer alloc] initWithPropertyMapping:propertyMapping];
+    self.generatedTransformer = [[CBRJSONDictionaryTransformer alloc] initWithPropertyMapping:propertyMapping];
+
+    expect(CBRTestDataStoreRegisterEntityMappers(self.generatedTransformer, self.adapter.entitiesByName)).to.beGreaterThan(0);
+}
+
+- (JSONEntity1 *)_entityUpdatedWithCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    JSONEntity1 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([JSONEntity1 class]) inManagedObjectContext:self.context];
+    entity.string = @"previous";
+    entity.floatNumber = @1.5;
+
+    [transformer updatePersistentObject:entity withPropertiesFromCloudObject:cloudObject];
+    return entity;
+}
+
+- (void)testThatMappersGeneratedForAnotherPropertyMappingAreRejected
+{
+    CBRJSONDictionaryTransformer *transformer = [[CBRJSONDictionaryTransformer alloc] initWithPropertyMapping:[[CBRIdentityPropertyMapping alloc] init]];
+    expect(CBRTestDataStoreRegisterEntityMappers(transformer, self.adapter.entitiesByName)).to.equal(0);
+}
+
+- (void)testThatGeneratedMappersUpdatePersistentObjectsLikeTheGenericTransformer
+{
+    NSString *dateString = @"2026-10-19T12:00:00Z";
+    NSArray<NSDictionary *> *cloudObjects = @[
+        @{ @"id": @1, @"string": @"string", @"date": dateString, @"float_number": @3.5, @"dictionary": @{ @"key": @"value" }, @"some_dictionary": @{ @"string_value": @"other" } },
+        @{ @"id": @2, @"string": [NSNull null], @"float_number": @"not a number", @"date": @5 },
+        @{ @"id": [NSNull null], @"string": @"previous" },
+    ];
+
+    NSArray *attributes = @[ @"identifier", @"string", @"date", @"floatNumber", @"dictionary", @"otherString" ];
+    for (NSDictionary *cloudObject in cloudObjects) {
+        JSONEntity1 *genericEntity = [self _entityUpdatedWithCloudObject:cloudObject transformer:self.genericTransformer];
+        JSONEntity1 *generatedEntity = [self _entityUpdatedWithCloudObject:cloudObject transformer:self.generatedTransformer];
+
+        expect([generatedEntity dictionaryWithValuesForKeys:attributes]).to.equal([genericEntity dictionaryWithValuesForKeys:attributes]);
+        expect(generatedEntity.changedValues.allKeys.count).to.equal(genericEntity.changedValues.allKeys.count);
+    }
+}
+
+- (void)testThatGeneratedMappersCreateCloudObjectsLikeTheGenericTransformer
+{
+    JSONEntity1 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([JSONEntity1 class]) inManagedObjectContext:self.context];
+    entity.identifier = @1;
+    entity.string = @"string";
+    entity.date = [NSDate dateWithTimeIntervalSince1970:0.0];
+    entity.floatNumber = @3.5;
+    entity.dictionary = @{ @"key": @"value" };
+    entity.otherString = @"other";
+
+    NSDictionary *cloudObject = [self.generatedTransformer cloudObjectFromPersistentObject:entity];
+    expect(cloudObject).to.equal([self.genericTransformer cloudObjectFromPersistentObject:entity]);
+    expect([cloudObject valueForKeyPath:@"some_dictionary.string_value"]).to.equal(@"other");
+}
+
+@end
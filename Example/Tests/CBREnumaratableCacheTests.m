@@ -0,0 +1,124 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+#import <CloudBridge/CBREnumaratableCache.h>
+
+@interface CBREnumaratableCacheTests : XCTestCase
+@property (nonatomic, strong) CBREnumaratableCache<NSString *, id> *cache;
+@end
+
+@implementation CBREnumaratableCacheTests
+
+- (void)setUp
+{
+    [super setUp];
+    self.cache = [[CBREnumaratableCache alloc] init];
+}
+
+- (void)testThatCacheEvictsLeastRecentlyUsedObjects
+{
+    NSMutableArray *evictedKeys = [NSMutableArray array];
+    self.cache.countLimit = 2;
+    self.cache.evictionHandler = ^(NSString *key, id object) {
+        [evictedKeys addObject:key];
+    };
+
+    [self.cache setObject:@1 forKey:@"a"];
+    [self.cache setObject:@2 forKey:@"b"];
+    [self.cache objectForKey:@"a"];
+    [self.cache setObject:@3 forKey:@"c"];
+
+    expect(evictedKeys).to.equal(@[ @"b" ]);
+    expect([self.cache objectForKey:@"a"]).to.equal(@1);
+    expect([self.cache objectForKey:@"b"]).to.beNil();
+    expect(self.cache.count).to.equal(2);
+    expect(self.cache.evictions).to.equal(1);
+    expect(self.cache.hits).to.equal(2);
+    expect(self.cache.misses).to.equal(1);
+}
+
+- (void)testThatCacheAccountsCostsPerGroup
+{
+    self.cache.totalCostLimit = 5;
+
+    [self.cache setObject:@1 forKey:@"a" cost:2 group:@"Entity1"];
+    [self.cache setObject:@2 forKey:@"b" cost:2 group:@"Entity2"];
+    expect([self.cache totalCostOfGroup:@"Entity1"]).to.equal(2);
+
+    [self.cache setObject:@3 forKey:@"c" cost:2 group:@"Entity2"];
+    expect(self.cache.totalCost).to.equal(4);
+    expect([self.cache totalCostOfGroup:@"Entity1"]).to.equal(0);
+    expect([self.cache totalCostOfGroup:@"Entity2"]).to.equal(4);
+}
+
+- (void)testThatRemovingAnObjectRemovesAllItsKeys
+{
+    NSObject *object = [[NSObject alloc] init];
+
+    [self.cache setObject:object forKey:@"Entity1#1"];
+    [self.cache setObject:object forKey:@"Entity2#1"];
+    [self.cache setObject:@2 forKey:@"Entity1#2"];
+
+    [self.cache removeObject:object];
+
+    NSMutableArray *keys = [NSMutableArray array];
+    for (NSString *key in self.cache) {
+        [keys addObject:key];
+    }
+
+    expect(keys).to.equal(@[ @"Entity1#2" ]);
+}
+
+- (void)testThatEvictedKeysAreNotEnumerated
+{
+    self.cache.countLimit = 100;
+
+    for (NSInteger i = 0; i < 1000; i++) {
+        [self.cache setObject:@(i) forKey:@(i).stringValue];
+    }
+
+    NSUInteger count = 0;
+    for (__unused NSString *key in self.cache) {
+        count++;
+    }
+
+    expect(count).to.equal(100);
+}
+
+- (void)testThatTrimmingEvictsObjects
+{
+    for (NSInteger i = 0; i < 10; i++) {
+        [self.cache setObject:@(i) forKey:@(i).stringValue];
+    }
+
+    [self.cache trimToFraction:0.5];
+    expect(self.cache.count).to.equal(5);
+    expect([self.cache objectForKey:@"9"]).to.equal(@9);
+    expect([self.cache objectForKey:@"0"]).to.beNil();
+}
+
+@end
@@ -0,0 +1,285 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestConnection.h"
+
+@interface IMEntity : CBRInMemoryObject
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSArray *children;
+@end
+
+@implementation IMEntity
+@dynamic identifier, name, children;
+@end
+
+@interface IMEntityChild : CBRInMemoryObject
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) IMEntity *parent;
+@end
+
+@implementation IMEntityChild
+@dynamic identifier, parent;
+@end
+
+
+
+@interface CBRInMemoryInterfaceTests : CBRTestCase
+@property (nonatomic, strong) CBRInMemoryInterface *adapter;
+@property (nonatomic, strong) CBREntityDescription *entity;
+@property (nonatomic, strong) CBREntityDescription *childEntity;
+@end
+
+@implementation CBRInMemoryInterfaceTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    NSArray *schema = @[
+                        @{
+                            @"name": @"IMEntity",
+                            @"userInfo": @{ @"cloudBridgeIndexedAttributes": @"identifier, name" },
+                            @"attributes": @[
+                                    @{ @"name": @"identifier", @"type": @(CBRAttributeTypeInteger) },
+                                    @{ @"name": @"name", @"type": @(CBRAttributeTypeString) },
+                                    ],
+                            @"relationships": @[
+                                    @{ @"entityName": @"IMEntity", @"name": @"children", @"toMany": @YES, @"destinationEntityName": @"IMEntityChild" },
+                                    ],
+                            },
+                        @{
+                            @"name": @"IMEntityChild",
+                            @"attributes": @[
+                                    @{ @"name": @"identifier", @"type": @(CBRAttributeTypeInteger) },
+                                    ],
+                            @"relationships": @[
+                                    @{ @"entityName": @"IMEntityChild", @"name": @"parent", @"toMany": @NO, @"destinationEntityName": @"IMEntity" },
+                                    ],
+                            },
+                        ];
+
+    self.adapter = [[CBRInMemoryInterface alloc] initWithSchemaRepresentations:schema];
+    self.entity = self.adapter.entitiesByName[@"IMEntity"];
+    self.childEntity = self.adapter.entitiesByName[@"IMEntityChild"];
+}
+
+- (void)testInverseRelationship
+{
+    expect(self.entity.relationshipsByName[@"children"].inverseRelationship.name).to.equal(@"parent");
+    expect(self.childEntity.relationshipsByName[@"parent"].inverseRelationship.name).to.equal(@"children");
+}
+
+- (void)testThatFetchesEvaluatePredicatesSortDescriptorsAndLimits
+{
+    [self.adapter beginWriteTransaction];
+    for (NSInteger i = 0; i < 10; i++) {
+        IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        entity.identifier = @(i);
+        entity.name = i % 2 == 0 ? @"even" : @"odd";
+    }
+    [self.adapter commitWriteTransaction:NULL];
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K == %@", @"identifier", @5];
+    fetchRequest.fetchLimit = 1;
+    expect([[self.adapter executeFetchRequest:fetchRequest error:NULL] valueForKey:@"identifier"]).to.equal(@[ @5 ]);
+
+    fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"name == %@ AND identifier > 2", @"even"];
+    fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"identifier" ascending:NO] ];
+    fetchRequest.fetchOffset = 1;
+    fetchRequest.fetchLimit = 2;
+    expect([[self.adapter executeFetchRequest:fetchRequest error:NULL] valueForKey:@"identifier"]).to.equal(@[ @6, @4 ]);
+
+    fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"%K IN %@", @"identifier", [NSSet setWithObjects:@1, @3, @42, nil]];
+    expect([[self.adapter executeFetchRequest:fetchRequest error:NULL] valueForKey:@"identifier"]).to.equal(@[ @1, @3 ]);
+}
+
+- (void)testThatIndexesFollowChangesAndDeletions
+{
+    [self.adapter beginWriteTransaction];
+    IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+    entity.identifier = @1;
+    entity.name = @"before";
+    [self.adapter commitWriteTransaction:NULL];
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"name == %@", @"after"];
+
+    [self.adapter beginWriteTransaction];
+    entity.name = @"after";
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL]).to.equal(@[ entity ]);
+    [self.adapter commitWriteTransaction:NULL];
+
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL]).to.equal(@[ entity ]);
+
+    [self.adapter beginWriteTransaction];
+    [self.adapter deletePersistentObjects:@[ entity ]];
+    [self.adapter commitWriteTransaction:NULL];
+
+    expect(entity.invalidated).to.beTruthy();
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL]).to.haveCountOf(0);
+}
+
+- (void)testThatToManyRelationshipsAreDerivedFromTheirInverse
+{
+    [self.adapter beginWriteTransaction];
+    IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+
+    IMEntityChild *child1 = [self.adapter newMutablePersistentObjectOfType:self.childEntity];
+    child1.parent = entity;
+
+    IMEntityChild *child2 = [self.adapter newMutablePersistentObjectOfType:self.childEntity];
+    [entity setValue:@[ child1, child2 ] forKey:@"children"];
+    [self.adapter commitWriteTransaction:NULL];
+
+    expect(entity.children).to.equal(@[ child1, child2 ]);
+    expect(child2.parent).to.equal(entity);
+
+    [self.adapter beginWriteTransaction];
+    entity.children = @[ child2 ];
+    [self.adapter commitWriteTransaction:NULL];
+
+    expect(child1.parent).to.beNil();
+    expect(entity.children).to.equal(@[ child2 ]);
+}
+
+- (void)testThatUncommittedChangesAreOnlyVisibleOnTheirThread
+{
+    [self.adapter beginWriteTransaction];
+    IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+    entity.identifier = @1;
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL]).to.haveCountOf(1);
+
+    dispatch_queue_t queue = dispatch_queue_create("background", DISPATCH_QUEUE_SERIAL);
+
+    __block NSNumber *backgroundCount = nil;
+    dispatch_async(queue, ^{
+        backgroundCount = @([self.adapter executeFetchRequest:fetchRequest error:NULL].count);
+    });
+    expect(backgroundCount).will.equal(@0);
+
+    [self.adapter commitWriteTransaction:NULL];
+
+    backgroundCount = nil;
+    dispatch_async(queue, ^{
+        backgroundCount = @([self.adapter executeFetchRequest:fetchRequest error:NULL].count);
+    });
+    expect(backgroundCount).will.equal(@1);
+}
+
+- (void)testThatConcurrentCommitsAreNotLost
+{
+    uint64_t version = self.adapter.version;
+
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (NSInteger i = 0; i < 25; i++) {
+            [self.adapter beginWriteTransaction];
+            IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+            entity.identifier = @(iteration * 100 + i);
+            [self.adapter commitWriteTransaction:NULL];
+        }
+    });
+
+    [self.adapter refresh];
+    expect(self.adapter.version).to.equal(version + 8 * 25);
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL]).to.haveCountOf(8 * 25);
+}
+
+- (void)testThatObserversReceiveChangesOfOtherThreads
+{
+    [self.adapter beginWriteTransaction];
+    for (NSInteger i = 0; i < 3; i++) {
+        IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        entity.identifier = @(i);
+    }
+    [self.adapter commitWriteTransaction:NULL];
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+    fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"identifier" ascending:YES] ];
+
+    __block CBRPersistentObjectChange *change = nil;
+    id<CBRNotificationToken> token = [self.adapter changesWithFetchRequest:fetchRequest block:^(NSArray *objects, CBRPersistentObjectChange *newChange) {
+        change = newChange;
+    }];
+    expect(token.count).to.equal(3);
+
+    dispatch_async(dispatch_queue_create("background", DISPATCH_QUEUE_SERIAL), ^{
+        [self.adapter beginWriteTransaction];
+
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:@"IMEntity"];
+        NSArray<IMEntity *> *entities = [self.adapter executeFetchRequest:fetchRequest error:NULL];
+
+        entities[1].name = @"updated";
+        [self.adapter deletePersistentObjects:@[ entities[0] ]];
+
+        IMEntity *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        entity.identifier = @3;
+
+        [self.adapter commitWriteTransaction:NULL];
+    });
+
+    expect(change).willNot.beNil();
+    expect(change.deletions).to.equal(@[ @0 ]);
+    expect(change.insertions).to.equal(@[ @2 ]);
+    expect(change.updates).to.equal(@[ @1 ]);
+    expect([token.allObjects valueForKey:@"identifier"]).to.equal(@[ @1, @2, @3 ]);
+
+    [token invalidate];
+}
+
+- (void)testThatCloudBridgeMapsIntoTheStore
+{
+    CBRTestConnection *connection = [[CBRTestConnection alloc] init];
+    CBRThreadingEnvironment *environment = [[CBRThreadingEnvironment alloc] initWithQueue:dispatch_queue_create("background", DISPATCH_QUEUE_SERIAL)];
+    CBRCloudBridge *cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:connection interface:self.adapter threadingEnvironment:environment];
+
+    [IMEntity setCloudBridge:cloudBridge];
+
+    connection.objectsToReturn = @[ @{ @"identifier": @1, @"name": @"first" }, @{ @"identifier": @2, @"name": @"second" } ];
+
+    __block NSArray *fetchedObjects = nil;
+    [cloudBridge fetchPersistentObjectsOfClass:[IMEntity class] withPredicate:nil completionHandler:^(NSArray *objects, NSError *error) {
+        fetchedObjects = objects;
+    }];
+
+    expect(fetchedObjects).willNot.beNil();
+    expect([fetchedObjects valueForKey:@"name"]).to.equal(@[ @"first", @"second" ]);
+    expect([IMEntity objectWithRemoteIdentifier:@2]).to.equal(fetchedObjects.lastObject);
+
+    [IMEntity setCloudBridge:nil];
+}
+
+@end
@@ -0,0 +1,196 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+#import "CBRTestConnection.h"
+
+@interface CBRInstrumentationTests : CBRTestCase
+@property (nonatomic, strong) CBRInstrumentationAggregator *aggregator;
+@end
+
+
+
+@implementation CBRInstrumentationTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.aggregator = [[CBRInstrumentationAggregator alloc] init];
+}
+
+- (void)tearDown
+{
+    CBRInstrumentationSetCurrent(nil);
+
+    [super tearDown];
+}
+
+- (void)testThatAggregatorSumsCounters
+{
+    [self.aggregator incrementCounter:CBRCounterCacheHits by:2];
+    [self.aggregator incrementCounter:CBRCounterCacheHits by:3];
+    [self.aggregator incrementCounter:CBRCounterCacheMisses by:1];
+
+    NSDictionary *counters = self.aggregator.snapshot[@"counters"];
+    expect(counters[CBRCounterCacheHits]).to.equal(5);
+    expect(counters[CBRCounterCacheMisses]).to.equal(1);
+}
+
+- (void)testThatAggregatorMergesCountersOfAllThreads
+{
+    dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t iteration) {
+        for (NSInteger i = 0; i < 1000; i++) {
+            [self.aggregator incrementCounter:CBRCounterCacheHits by:1];
+            [self.aggregator recordValue:1.0 forMetric:CBRMetricMappingDuration];
+        }
+    });
+
+    NSDictionary *snapshot = self.aggregator.snapshot;
+    expect(snapshot[@"counters"][CBRCounterCacheHits]).to.equal(8000);
+    expect(snapshot[@"metrics"][CBRMetricMappingDuration][@"count"]).to.equal(8000);
+}
+
+- (void)testThatAggregatorComputesPercentilesWithinBucketPrecision
+{
+    for (NSInteger i = 1; i <= 1000; i++) {
+        [self.aggregator recordValue:i / 1000.0 forMetric:CBRMetricRequestDuration];
+    }
+
+    NSDictionary *metric = self.aggregator.snapshot[@"metrics"][CBRMetricRequestDuration];
+    expect(metric[@"count"]).to.equal(1000);
+    expect([metric[@"min"] doubleValue]).to.beCloseToWithin(0.001, 0.0001);
+    expect([metric[@"max"] doubleValue]).to.beCloseToWithin(1.0, 0.0001);
+    expect([metric[@"mean"] doubleValue]).to.beCloseToWithin(0.5005, 0.0001);
+    expect([metric[@"p50"] doubleValue]).to.beCloseToWithin(0.5, 0.5 / 8.0);
+    expect([metric[@"p90"] doubleValue]).to.beCloseToWithin(0.9, 0.9 / 8.0);
+    expect([metric[@"p99"] doubleValue]).to.beCloseToWithin(0.99, 0.99 / 8.0);
+}
+
+- (void)testThatAggregatorResets
+{
+    [self.aggregator recordValue:1.0 forMetric:CBRMetricTransactionDuration];
+    [self.aggregator incrementCounter:CBRCounterObjectsInserted by:1];
+    [self.aggregator reset];
+
+    expect(self.aggregator.snapshot[@"metrics"]).to.haveCountOf(0);
+    expect(self.aggregator.snapshot[@"counters"]).to.haveCountOf(0);
+}
+
+- (void)testThatAggregatorExportsJSON
+{
+    [self.aggregator recordValue:0.25 forMetric:CBRMetricTransactionDuration];
+
+    NSError *error = nil;
+    NSData *data = [self.aggregator JSONSnapshotWithError:&error];
+    expect(error).to.beNil();
+
+    NSDictionary *JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+    expect(JSONObject[@"metrics"][CBRMetricTransactionDuration][@"p50"]).to.equal(0.25);
+}
+
+- (void)testThatAggregatorIgnoresNonFiniteValues
+{
+    [self.aggregator recordValue:0.25 forMetric:CBRMetricTransactionDuration];
+    [self.aggregator recordValue:NAN forMetric:CBRMetricTransactionDuration];
+    [self.aggregator recordValue:INFINITY forMetric:CBRMetricTransactionDuration];
+
+    NSError *error = nil;
+    NSData *data = [self.aggregator JSONSnapshotWithError:&error];
+    expect(data).toNot.beNil();
+    expect(error).to.beNil();
+
+    NSDictionary *JSONObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL];
+    expect(JSONObject[@"metrics"][CBRMetricTransactionDuration][@"count"]).to.equal(1);
+    expect(JSONObject[@"metrics"][CBRMetricTransactionDuration][@"sum"]).to.equal(0.25);
+}
+
+- (void)testThatCurrentInstrumentationIsReplacedOnAllThreads
+{
+    CBRInstrumentationAggregator *aggregator = [[CBRInstrumentationAggregator alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("background", DISPATCH_QUEUE_SERIAL);
+
+    __block id<CBRInstrumentation> instrumentation = nil;
+    dispatch_block_t block = ^{
+        instrumentation = CBRInstrumentationGetCurrent();
+    };
+
+    CBRInstrumentationSetCurrent(self.aggregator);
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_async(group, queue, block);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    expect(instrumentation).to.beIdenticalTo(self.aggregator);
+
+    CBRInstrumentationSetCurrent(aggregator);
+    dispatch_group_async(group, queue, block);
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    expect(instrumentation).to.beIdenticalTo(aggregator);
+}
+
+- (void)testThatCloudBridgeReportsMetricsOfFetches
+{
+    CBRTestConnection *connection = [[CBRTestConnection alloc] init];
+    CBRCoreDataInterface *interface = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+    CBRThreadingEnvironment *environment = [[CBRThreadingEnvironment alloc] initWithCoreDataAdapter:interface];
+    CBRCloudBridge *cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:connection interface:interface threadingEnvironment:environment];
+    [NSManagedObject setCloudBridge:cloudBridge];
+
+    CBRInstrumentationSetCurrent(self.aggregator);
+
+    connection.objectsToReturn = @[ @{ @"identifier": @1 }, @{ @"identifier": @2 } ];
+
+    __block BOOL finished = NO;
+    [cloudBridge fetchPersistentObjectsOfClass:[SLEntity6Child class] withPredicate:nil completionHandler:^(NSArray *fetchedObjects, NSError *error) {
+        finished = YES;
+    }];
+    expect(finished).will.beTruthy();
+
+    NSDictionary *snapshot = self.aggregator.snapshot;
+    NSString *mappingMetric = [NSString stringWithFormat:@"%@.%@", CBRMetricMappingDuration, NSStringFromClass([SLEntity6Child class])];
+
+    expect(snapshot[@"counters"][CBRCounterObjectsInserted]).to.equal(2);
+    expect(snapshot[@"counters"][CBRCounterObjectsUpdated]).to.beNil();
+    expect(snapshot[@"metrics"][mappingMetric][@"count"]).to.equal(1);
+    expect(snapshot[@"metrics"][CBRMetricTransactionDuration][@"count"]).to.equal(1);
+    expect(snapshot[@"metrics"][CBRMetricMainThreadHandoffDuration][@"count"]).to.beGreaterThan(0);
+
+    connection.objectsToReturn = @[ @{ @"identifier": @1 }, @{ @"identifier": @2 }, @{ @"identifier": @3 } ];
+
+    finished = NO;
+    [cloudBridge fetchPersistentObjectsOfClass:[SLEntity6Child class] withPredicate:nil completionHandler:^(NSArray *fetchedObjects, NSError *error) {
+        finished = YES;
+    }];
+    expect(finished).will.beTruthy();
+
+    snapshot = self.aggregator.snapshot;
+    expect(snapshot[@"counters"][CBRCounterObjectsInserted]).to.equal(3);
+    expect(snapshot[@"counters"][CBRCounterObjectsUpdated]).to.equal(2);
+}
+
+@end
@@ -455,6 +455,111 @@
     expect(entity.differentChilds).to.contain(child1);
 }
 
+- (void)testThatToManyRelationDoesntChangeWhenJSONObjectContainsTheSameObjects
+{
+    NSDictionary *dictionary = @{
+                                 @"id": @1,
+                                 @"children": @[ @{ @"id": @1 }, @{ @"id": @2 } ]
+                                 };
+
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    SLEntity6 *entity = (id)[self.transformer persistentObjectFromCloudObject:dictionary forEntity:entityDescription];
+
+    NSError *saveError = nil;
+    [self.context save:&saveError];
+    NSAssert(saveError == nil, @"error saving NSManagedObjectContext: %@", saveError);
+
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:dictionary];
+
+    expect(entity.children).to.haveCountOf(2);
+    expect(self.context.hasChanges).to.beFalsy();
+}
+
+- (void)testThatToManyRelationOnlyDetachesRemovedObjects
+{
+    NSDictionary *dictionary = @{
+                                 @"id": @1,
+                                 @"children": @[ @{ @"id": @1 }, @{ @"id": @2 } ]
+                                 };
+
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    SLEntity6 *entity = (id)[self.transformer persistentObjectFromCloudObject:dictionary forEntity:entityDescription];
+    SLEntity6Child *removedChild = [[entity.children filteredSetUsingPredicate:[NSPredicate predicateWithFormat:@"identifier == 1"]] anyObject];
+
+    NSError *saveError = nil;
+    [self.context save:&saveError];
+    NSAssert(saveError == nil, @"error saving NSManagedObjectContext: %@", saveError);
+
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:@{ @"id": @1, @"children": @[ @{ @"id": @2 }, @{ @"id": @3 } ] }];
+
+    expect(entity.children).to.haveCountOf(2);
+    expect(entity.children).toNot.contain(removedChild);
+    expect(removedChild.parent).to.beNil();
+    expect([entity.children valueForKey:@"identifier"]).to.equal([NSSet setWithArray:@[ @2, @3 ]]);
+}
+
+- (void)testThatUnchangedCloudObjectIsSkippedWithFingerprints
+{
+    self.transformer.fingerprintsCloudObjects = YES;
+
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    SLEntity6 *entity = (id)[self.transformer persistentObjectFromCloudObject:@{ @"id": @1, @"name": @"foo" } forEntity:entityDescription];
+    expect(entity.name).to.equal(@"foo");
+
+    NSError *saveError = nil;
+    [self.context save:&saveError];
+    NSAssert(saveError == nil, @"error saving NSManagedObjectContext: %@", saveError);
+
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:@{ @"name": @"foo", @"id": @1 }];
+    expect(entity.name).to.equal(@"foo");
+    expect(self.context.hasChanges).to.beFalsy();
+
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:@{ @"id": @1, @"name": @"bar" }];
+    expect(entity.name).to.equal(@"bar");
+}
+
+- (void)testThatLocallyChangedObjectIsUpdatedWithFingerprints
+{
+    self.transformer.fingerprintsCloudObjects = YES;
+
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+    SLEntity6 *entity = (id)[self.transformer persistentObjectFromCloudObject:@{ @"id": @1, @"name": @"foo" } forEntity:entityDescription];
+    expect(entity.name).to.equal(@"foo");
+
+    entity.name = @"local";
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:@{ @"name": @"foo", @"id": @1 }];
+    expect(entity.name).to.equal(@"foo");
+}
+
+- (void)testThatUnresolvedReferencesAreRetriedWithFingerprints
+{
+    self.transformer.fingerprintsCloudObjects = YES;
+
+    NSDictionary *dictionary = @{
+                                 @"id": @1,
+                                 @"parent_id": @5
+                                 };
+
+    CBREntityDescription *entityDescription = [SLEntity5Child3 cloudBridgeEntityDescription];
+    SLEntity5Child3 *entity = (id)[self.transformer persistentObjectFromCloudObject:dictionary forEntity:entityDescription];
+    expect(entity.parent).to.beNil();
+
+    SLEntity5 *parent = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity5 class])
+                                                      inManagedObjectContext:self.context];
+    parent.identifier = @5;
+
+    NSError *saveError = nil;
+    [self.context save:&saveError];
+    NSAssert(saveError == nil, @"error saving NSManagedObjectContext: %@", saveError);
+
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:dictionary];
+    expect(entity.parent).to.equal(parent);
+
+    entity.parent = nil;
+    [self.transformer updatePersistentObject:entity withPropertiesFromCloudObject:dictionary];
+    expect(entity.parent).to.equal(parent);
+}
+
 - (void)testThatUpdatedObjectHasSTICorrectSubclass
 {
     NSDictionary *dictionary = @{
@@ -514,4 +619,37 @@
     expect(result[@"camelizedChilds"]).to.equal(dictionary[@"camelizedChilds"]);
 }
 
+- (void)testThatCompoundDocumentMapsIncludedObjectsAndResolvesReferences
+{
+    NSDictionary *document = @{
+                               @"data": @[ @{ @"id": @1, @"parent_id": @5 }, @{ @"id": @2, @"parent_id": @5 } ],
+                               @"included": @{
+                                       @"SLEntity5": @[ @{ @"id": @5, @"string": @"parent" } ]
+                                       }
+                               };
+
+    CBREntityDescription *entityDescription = [SLEntity5Child3 cloudBridgeEntityDescription];
+    NSArray<SLEntity5Child3 *> *entities = (id)[self.transformer persistentObjectsFromCloudObjects:@[ document ] forEntity:entityDescription];
+
+    expect(entities).to.haveCountOf(2);
+    expect(entities.firstObject.parent.identifier).to.equal(5);
+    expect(entities.firstObject.parent.string).to.equal(@"parent");
+    expect(entities.firstObject.parent.toManyChilds).to.haveCountOf(2);
+}
+
+- (void)testThatEveryCompoundDocumentOfAResponseIsMapped
+{
+    NSArray *documents = @[
+                           @{ @"data": @[ @{ @"id": @1, @"parent_id": @5 } ], @"included": @{ @"SLEntity5": @[ @{ @"id": @5 } ] } },
+                           @{ @"data": @{ @"id": @2, @"parent_id": @6 }, @"included": @{ @"SLEntity5": @[ @{ @"id": @6 } ] } },
+                           @{ @"id": @3, @"parent_id": @5 }
+                           ];
+
+    CBREntityDescription *entityDescription = [SLEntity5Child3 cloudBridgeEntityDescription];
+    NSArray<SLEntity5Child3 *> *entities = (id)[self.transformer persistentObjectsFromCloudObjects:documents forEntity:entityDescription];
+
+    expect([entities valueForKey:@"identifier"]).to.equal(@[ @1, @2, @3 ]);
+    expect([entities valueForKeyPath:@"parent.identifier"]).to.equal(@[ @5, @6, @5 ]);
+}
+
 @end
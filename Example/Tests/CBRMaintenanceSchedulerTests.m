@@ -0,0 +1,143 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestConnection.h"
+
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+@interface CBRMaintenanceSchedulerTests : CBRTestCase
+@property (nonatomic, strong) CBRRealmInterface *adapter;
+@property (nonatomic, strong) CBRCloudBridge *cloudBridge;
+@property (nonatomic, strong) CBRTestConnection *connection;
+@property (nonatomic, strong) CBRThreadingEnvironment *environment;
+@property (nonatomic, strong) CBRMaintenanceScheduler *scheduler;
+@end
+
+@implementation CBRMaintenanceSchedulerTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.inMemoryIdentifier = self.testRun.test.name;
+    config.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    self.connection = [[CBRTestConnection alloc] init];
+    self.adapter = [[CBRRealmInterface alloc] initWithConfiguration:config];
+    self.environment = [[CBRThreadingEnvironment alloc] initWithRealmAdapter:self.adapter];
+    self.cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:self.connection interface:self.adapter threadingEnvironment:self.environment];
+
+    [CBRRealmObject setCloudBridge:self.cloudBridge];
+
+    CBREntityDescription *entityDescription = self.adapter.entitiesByName[NSStringFromClass([RLMEntity4 class])];
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:entityDescription.userInfo];
+    userInfo[@"cloudBridgeSyncDateAttribute"] = @"date";
+    userInfo[@"cloudBridgeTimeToLive"] = @"600";
+    userInfo[@"cloudBridgeCountLimit"] = @"2";
+    entityDescription.userInfo = userInfo;
+
+    self.scheduler = [[CBRMaintenanceScheduler alloc] initWithCloudBridge:self.cloudBridge];
+    self.scheduler.batchSize = 1;
+}
+
+- (void)tearDown
+{
+    [self.scheduler stop];
+    [super tearDown];
+}
+
+- (void)testThatEntitiesDeclareRetentionPolicies
+{
+    CBREntityDescription *entityDescription = self.adapter.entitiesByName[NSStringFromClass([RLMEntity4 class])];
+
+    expect(entityDescription.syncDateAttribute).to.equal(@"date");
+    expect(entityDescription.timeToLive).to.equal(600.0);
+    expect(entityDescription.countLimit).to.equal(2);
+
+    CBREntityDescription *otherEntityDescription = self.adapter.entitiesByName[NSStringFromClass([RLMEntity6 class])];
+    expect(otherEntityDescription.syncDateAttribute).to.beNil();
+    expect(otherEntityDescription.timeToLive).to.equal(0.0);
+    expect(otherEntityDescription.countLimit).to.equal(0);
+}
+
+- (void)testThatExpiredAndExcessObjectsAreEvictedInBatches
+{
+    RLMRealm *realm = self.adapter.realm;
+    NSDate *now = [NSDate date];
+    NSArray<NSNumber *> *ages = @[ @3600, @60, @30, @10 ];
+
+    [realm transactionWithBlock:^{
+        [ages enumerateObjectsUsingBlock:^(NSNumber *age, NSUInteger index, BOOL *stop) {
+            RLMEntity4 *entity = [[RLMEntity4 alloc] init];
+            entity.identifier = @(index);
+            entity.date = [now dateByAddingTimeInterval:-age.doubleValue];
+            [realm addObject:entity];
+        }];
+    }];
+
+    CBRPersistentObjectCache *cache = [self.adapter cacheForRealm:realm];
+    expect([cache objectOfType:NSStringFromClass([RLMEntity4 class]) withValue:@0 forAttribute:@"identifier"]).toNot.beNil();
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"maintenance"];
+
+    __block NSUInteger numberOfEvictedObjects = 0;
+    [self.scheduler runWithCompletionHandler:^(NSUInteger count) {
+        numberOfEvictedObjects = count;
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:5.0 handler:NULL];
+    [realm refresh];
+
+    expect(numberOfEvictedObjects).to.equal(2);
+    expect([[RLMEntity4 allObjectsInRealm:realm] valueForKey:@"identifier"]).to.contain(@2);
+    expect([[RLMEntity4 allObjectsInRealm:realm] valueForKey:@"identifier"]).to.contain(@3);
+    expect([RLMEntity4 allObjectsInRealm:realm].count).to.equal(2);
+
+    expect([cache objectOfType:NSStringFromClass([RLMEntity4 class]) withValue:@0 forAttribute:@"identifier"]).to.beNil();
+    expect([cache objectOfType:NSStringFromClass([RLMEntity4 class]) withValue:@1 forAttribute:@"identifier"]).to.beNil();
+}
+
+- (void)testThatFetchedObjectsAreMarkedAsSynced
+{
+    NSDate *start = [NSDate date];
+    self.connection.objectsToReturn = @[ @{ @"identifier": @1, @"string": @"synced" } ];
+
+    __block RLMEntity4 *entity = nil;
+    [self.cloudBridge fetchPersistentObjectsOfClass:[RLMEntity4 class] completionHandler:^(NSArray *fetchedObjects, NSError *error) {
+        entity = fetchedObjects.firstObject;
+    }];
+
+    expect(entity).will.beTruthy();
+    expect([entity.date timeIntervalSinceDate:start]).to.beGreaterThanOrEqualTo(0.0);
+}
+
+@end
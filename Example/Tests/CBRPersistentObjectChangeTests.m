@@ -0,0 +1,171 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+
+@interface CBRTestNotificationToken : NSObject <CBRNotificationToken>
+@property (nonatomic, copy) void(^observer)(NSArray *objects, CBRPersistentObjectChange *change);
+@property (nonatomic, copy) NSArray *objects;
+@property (nonatomic, assign) BOOL invalidated;
+@end
+
+@implementation CBRTestNotificationToken
+
+- (NSInteger)count
+{
+    return self.objects.count;
+}
+
+- (NSArray *)allObjects
+{
+    return self.objects ?: @[];
+}
+
+- (id)objectAtIndexedSubscript:(NSUInteger)idx
+{
+    return self.objects[idx];
+}
+
+- (void)invalidate
+{
+    self.invalidated = YES;
+}
+
+@end
+
+
+
+@interface CBRPersistentObjectChangeTests : CBRTestCase
+
+@end
+
+@implementation CBRPersistentObjectChangeTests
+
+- (void)testThatChangesAreBackedByIndexSets
+{
+    CBRPersistentObjectChange *change = [[CBRPersistentObjectChange alloc] initWithDeletions:@[ @3, @1, @2 ] insertions:@[ @0 ] updates:@[]];
+
+    expect(change.deletedIndexes).to.equal([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(1, 3)]);
+    expect(change.count).to.equal(4);
+    expect([change insertionsWithSection:2]).to.equal(@[ [NSIndexPath indexPathForRow:0 inSection:2] ]);
+}
+
+- (void)testThatAppendedChangesAreMerged
+{
+    // [a, b, c, d] -> [x, a, c, d] -> [a, y, c]
+    NSMutableIndexSet *deletions = [NSMutableIndexSet indexSetWithIndex:0];
+    [deletions addIndex:3];
+
+    CBRPersistentObjectChange *first = [[CBRPersistentObjectChange alloc] initWithDeletedIndexes:[NSIndexSet indexSetWithIndex:1] insertedIndexes:[NSIndexSet indexSetWithIndex:0] updatedIndexes:[NSIndexSet indexSetWithIndex:2]];
+    CBRPersistentObjectChange *second = [[CBRPersistentObjectChange alloc] initWithDeletedIndexes:deletions insertedIndexes:[NSIndexSet indexSetWithIndex:1] updatedIndexes:[NSIndexSet indexSetWithIndex:1]];
+
+    CBRPersistentObjectChange *change = [first changeByAppendingChange:second];
+
+    NSMutableIndexSet *expectedDeletions = [NSMutableIndexSet indexSetWithIndex:1];
+    [expectedDeletions addIndex:3];
+    NSMutableIndexSet *expectedUpdates = [NSMutableIndexSet indexSetWithIndex:0];
+    [expectedUpdates addIndex:2];
+
+    expect(change.deletedIndexes).to.equal(expectedDeletions);
+    expect(change.insertedIndexes).to.equal([NSIndexSet indexSetWithIndex:1]);
+    expect(change.updatedIndexes).to.equal(expectedUpdates);
+}
+
+- (void)testThatCoalescedTokenDeliversOneMergedChange
+{
+    CBRTestNotificationToken *testToken = [[CBRTestNotificationToken alloc] init];
+
+    __block NSInteger deliveries = 0;
+    __block CBRPersistentObjectChange *deliveredChange = nil;
+    CBRCoalescedNotificationToken *token = [[CBRCoalescedNotificationToken alloc] initWithInterval:60.0 block:^(NSArray *objects, CBRPersistentObjectChange *change) {
+        deliveries++;
+        deliveredChange = change;
+    } observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        testToken.observer = observer;
+        return testToken;
+    }];
+
+    testToken.observer(@[], [[CBRPersistentObjectChange alloc] initWithDeletions:@[] insertions:@[ @0 ] updates:@[]]);
+    testToken.observer(@[], [[CBRPersistentObjectChange alloc] initWithDeletions:@[] insertions:@[ @0 ] updates:@[]]);
+    expect(deliveries).to.equal(0);
+
+    [token flush];
+    expect(deliveries).to.equal(1);
+    expect(deliveredChange.insertedIndexes).to.equal([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 2)]);
+
+    [token invalidate];
+    expect(testToken.invalidated).to.beTruthy();
+}
+
+- (void)testThatCoalescedTokenServesObjectsOfTheLastDeliveredChange
+{
+    CBRTestNotificationToken *testToken = [[CBRTestNotificationToken alloc] init];
+    testToken.objects = @[ @"first" ];
+
+    CBRCoalescedNotificationToken *token = [[CBRCoalescedNotificationToken alloc] initWithInterval:60.0 block:^(NSArray *objects, CBRPersistentObjectChange *change) {
+
+    } observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        testToken.observer = observer;
+        return testToken;
+    }];
+
+    testToken.objects = @[ @"second", @"first" ];
+    testToken.observer(testToken.objects, [[CBRPersistentObjectChange alloc] initWithDeletions:@[] insertions:@[ @0 ] updates:@[]]);
+
+    expect(token.count).to.equal(1);
+    expect(token.allObjects).to.equal(@[ @"first" ]);
+    expect(token[0]).to.equal(@"first");
+
+    [token flush];
+
+    expect(token.count).to.equal(2);
+    expect(token.allObjects).to.equal(@[ @"second", @"first" ]);
+    expect(token[0]).to.equal(@"second");
+
+    [token invalidate];
+}
+
+- (void)testThatCoalescedTokenFlushesAfterInterval
+{
+    CBRTestNotificationToken *testToken = [[CBRTestNotificationToken alloc] init];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"flush"];
+
+    CBRCoalescedNotificationToken *token = [[CBRCoalescedNotificationToken alloc] initWithInterval:1.0 / 60.0 block:^(NSArray *objects, CBRPersistentObjectChange *change) {
+        [expectation fulfill];
+    } observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        testToken.observer = observer;
+        return testToken;
+    }];
+
+    testToken.observer(@[], [[CBRPersistentObjectChange alloc] initWithDeletions:@[ @0 ] insertions:@[] updates:@[]]);
+
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    [token invalidate];
+}
+
+@end
@@ -0,0 +1,170 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+#import "CBRTestConnection.h"
+
+@interface CBRPrimaryKeyFilterTests : CBRTestCase
+@property (nonatomic, strong) CBRCoreDataInterface *adapter;
+@property (nonatomic, strong) CBRCloudBridge *cloudBridge;
+@end
+
+@implementation CBRPrimaryKeyFilterTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.adapter = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+    CBRThreadingEnvironment *environment = [[CBRThreadingEnvironment alloc] initWithCoreDataAdapter:self.adapter];
+    self.cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:[[CBRTestConnection alloc] init] interface:self.adapter threadingEnvironment:environment];
+
+    [NSManagedObject setCloudBridge:self.cloudBridge];
+}
+
+- (void)tearDown
+{
+    CBRInstrumentationSetCurrent(nil);
+
+    [super tearDown];
+}
+
+- (void)testThatFilterContainsEveryAddedValue
+{
+    CBRPrimaryKeyFilter *filter = [[CBRPrimaryKeyFilter alloc] initWithCapacity:10000];
+
+    for (NSInteger i = 0; i < 10000; i++) {
+        [filter addValue:@(i)];
+    }
+
+    NSInteger falsePositives = 0;
+    for (NSInteger i = 0; i < 10000; i++) {
+        expect([filter containsValue:@(i)]).to.beTruthy();
+        falsePositives += [filter containsValue:@(i + 10000)] ? 1 : 0;
+    }
+
+    expect(falsePositives).to.beLessThan(300);
+    expect(filter.isSaturated).to.beFalsy();
+}
+
+- (void)testThatFilterForgetsRemovedValues
+{
+    CBRPrimaryKeyFilter *filter = [[CBRPrimaryKeyFilter alloc] initWithCapacity:1024];
+
+    [filter addValue:@"a"];
+    [filter addValue:@"b"];
+    [filter removeValue:@"a"];
+
+    expect([filter containsValue:@"a"]).to.beFalsy();
+    expect([filter containsValue:@"b"]).to.beTruthy();
+    expect(filter.count).to.equal(1);
+}
+
+- (void)testThatCoreDataInterfaceSeedsFilterFromStore
+{
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity.identifier = @7;
+    [self.context save:NULL];
+
+    CBRPrimaryKeyFilter *filter = [self.adapter primaryKeyFilterForEntity:NSStringFromClass([SLEntity6 class]) attribute:@"identifier"];
+    expect([filter containsValue:@7]).to.beTruthy();
+    expect([self.adapter primaryKeyFilterForEntity:NSStringFromClass([SLEntity6 class]) attribute:@"name"]).to.beNil();
+
+    SLEntity6 *otherEntity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    otherEntity.identifier = @8;
+    [self.context deleteObject:entity];
+    [self.context save:NULL];
+
+    expect([filter containsValue:@8]).to.beTruthy();
+    expect([filter containsValue:@7]).to.beFalsy();
+}
+
+- (void)testThatFilterIsSizedForUnsavedObjects
+{
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+
+    for (NSInteger i = 0; i < 2000; i++) {
+        SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:entityName inManagedObjectContext:self.context];
+        entity.identifier = @(i);
+    }
+
+    CBRPrimaryKeyFilter *filter = [self.adapter primaryKeyFilterForEntity:entityName attribute:@"identifier"];
+    expect(filter.capacity).to.beGreaterThanOrEqualTo(4000);
+    expect(filter.isSaturated).to.beFalsy();
+    expect([filter containsValue:@1999]).to.beTruthy();
+    expect([self.adapter primaryKeyFilterForEntity:entityName attribute:@"identifier"]).to.beIdenticalTo(filter);
+}
+
+- (void)testThatSaturatedFilterIsRebuiltLarger
+{
+    NSString *entityName = NSStringFromClass([SLEntity6 class]);
+
+    CBRPrimaryKeyFilter *filter = [self.adapter primaryKeyFilterForEntity:entityName attribute:@"identifier"];
+    for (NSUInteger i = 0; i <= filter.capacity; i++) {
+        [filter addValue:@(i)];
+    }
+    expect(filter.isSaturated).to.beTruthy();
+
+    CBRPrimaryKeyFilter *rebuiltFilter = [self.adapter primaryKeyFilterForEntity:entityName attribute:@"identifier"];
+    expect(rebuiltFilter).toNot.beIdenticalTo(filter);
+    expect(rebuiltFilter.capacity).to.beGreaterThanOrEqualTo(2 * filter.capacity);
+}
+
+- (void)testThatMissingPrimaryKeysAreNotFetched
+{
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+
+    CBRInstrumentationAggregator *aggregator = [[CBRInstrumentationAggregator alloc] init];
+    CBRInstrumentationSetCurrent(aggregator);
+
+    expect([databaseAdapter persistentObjectOfType:entityDescription withPrimaryKey:@9]).to.beNil();
+    expect(aggregator.snapshot[@"counters"][CBRCounterPrimaryKeyFilterSkips]).to.equal(1);
+
+    SLEntity6 *entity = [databaseAdapter newMutablePersistentObjectOfType:entityDescription];
+    entity.identifier = @9;
+
+    // inserted but unsaved objects are still found
+    expect([databaseAdapter persistentObjectOfType:entityDescription withPrimaryKey:@9]).to.equal(entity);
+}
+
+- (void)testThatObjectsInsertedOutsideOfTheCacheAreFound
+{
+    CBRDatabaseAdapter *databaseAdapter = self.cloudBridge.databaseAdapter;
+    CBREntityDescription *entityDescription = [SLEntity6 cloudBridgeEntityDescription];
+
+    expect([databaseAdapter persistentObjectOfType:entityDescription withPrimaryKey:@9]).to.beNil();
+
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity.identifier = @10;
+
+    expect([databaseAdapter persistentObjectOfType:entityDescription withPrimaryKey:@10]).to.equal(entity);
+}
+
+@end
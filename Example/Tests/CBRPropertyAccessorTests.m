@@ -0,0 +1,88 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+
+@interface CBRPropertyAccessorTestObject : NSObject
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, readonly) NSString *readonlyName;
+@property (nonatomic, strong, getter=isEnabled) NSNumber *enabled;
+@end
+
+@implementation CBRPropertyAccessorTestObject
+
+- (NSString *)readonlyName
+{
+    return @"readonly";
+}
+
+@end
+
+
+
+@interface CBRPropertyAccessorTests : CBRTestCase
+
+@end
+
+@implementation CBRPropertyAccessorTests
+
+- (void)testThatAccessorReadsAndWritesPlainObjects
+{
+    CBRPropertyAccessorTestObject *object = [[CBRPropertyAccessorTestObject alloc] init];
+
+    CBRPropertyAccessorSetValue(object, @"name", @"name");
+    CBRPropertyAccessorSetValue(object, @YES, @"enabled");
+
+    expect(object.name).to.equal(@"name");
+    expect(object.isEnabled).to.equal(@YES);
+    expect(CBRPropertyAccessorGetValue(object, @"name")).to.equal(@"name");
+    expect(CBRPropertyAccessorGetValue(object, @"enabled")).to.equal(@YES);
+    expect(CBRPropertyAccessorGetValue(object, @"readonlyName")).to.equal(@"readonly");
+}
+
+- (void)testThatAccessorsAreCachedPerClass
+{
+    CBRPropertyAccessor *accessor = [CBRPropertyAccessor accessorForClass:[CBRPropertyAccessorTestObject class] key:@"name"];
+    expect([CBRPropertyAccessor accessorForClass:[CBRPropertyAccessorTestObject class] key:@"name"]).to.beIdenticalTo(accessor);
+}
+
+- (void)testThatAccessorReadsAndWritesManagedObjects
+{
+    SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+
+    CBRPropertyAccessorSetValue(entity, @5, @"identifier");
+    CBRPropertyAccessorSetValue(entity, @"name", @"name");
+
+    expect(entity.identifier).to.equal(@5);
+    expect(entity.name).to.equal(@"name");
+    expect(entity.changedValues[@"name"]).to.equal(@"name");
+    expect(CBRPropertyAccessorGetValue(entity, @"identifier")).to.equal(@5);
+}
+
+@end
@@ -151,6 +151,30 @@
     expect(query.path).to.endWith(@"entity6/5/children");
 }
 
+- (void)testThatConnectionFetchesObjectsForRelationshipOfMultipleObjects
+{
+    SLEntity6 *entity1 = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity1.identifier = @5;
+
+    SLEntity6 *entity2 = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
+    entity2.identifier = @6;
+
+    CBREntityDescription *entityDescription = self.adapter.entitiesByName[NSStringFromClass([SLEntity6Child class])];
+
+    __block AFQueryDescription *query = nil;
+    OCMStub([self.mockedSessionManager GET:OCMOCK_ANY parameters:OCMOCK_ANY progress:OCMOCK_ANY success:OCMOCK_ANY failure:OCMOCK_ANY]).andQuery(^(AFQueryDescription *theQuery) {
+        query = theQuery;
+    });
+
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"parent IN %@", @[ entity1, entity2 ]];
+    NSDictionary *userInfo = @{ CBRRESTConnectionUserInfoURLOverrideKey: @"entity6_children" };
+    [self.connection fetchCloudObjectsForEntity:entityDescription withPredicate:predicate userInfo:userInfo completionHandler:NULL];
+
+    expect(query).willNot.beNil();
+    expect(query.path).to.endWith(@"entity6_children");
+    expect(query.parameters).to.equal(@{ @"parent_ids": @"5,6" });
+}
+
 - (void)testThatConnectionFetchesObjectsFromAPath
 {
     SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:self.context];
@@ -0,0 +1,186 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+@interface CBRRealmInterfaceBulkIngestTests : CBRTestCase
+@property (nonatomic, strong) CBRRealmInterface *adapter;
+@property (nonatomic, strong) CBREntityDescription *entity;
+@end
+
+@implementation CBRRealmInterfaceBulkIngestTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.inMemoryIdentifier = self.testRun.test.name;
+    config.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    self.adapter = [[CBRRealmInterface alloc] initWithConfiguration:config];
+    self.entity = self.adapter.entitiesByName[NSStringFromClass([RLMEntity6 class])];
+}
+
+- (void)testThatIngestedObjectsAreCommittedOnce
+{
+    RLMRealm *realm = self.adapter.realm;
+
+    NSError *error = nil;
+    BOOL success = [self.adapter ingestWithBlock:^{
+        for (NSInteger i = 0; i < 100; i++) {
+            RLMEntity6 *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+            entity.identifier = @(i);
+        }
+
+        expect(realm.inWriteTransaction).to.beTruthy();
+        expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(0);
+    } error:&error];
+
+    expect(success).to.beTruthy();
+    expect(error).to.beNil();
+    expect(realm.inWriteTransaction).to.beFalsy();
+    expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(100);
+}
+
+- (void)testThatIngestCollectsDeletions
+{
+    RLMRealm *realm = self.adapter.realm;
+
+    [realm transactionWithBlock:^{
+        for (NSInteger i = 0; i < 10; i++) {
+            RLMEntity6 *entity = [[RLMEntity6 alloc] init];
+            entity.identifier = @(i);
+            [realm addObject:entity];
+        }
+    }];
+
+    [self.adapter ingestWithBlock:^{
+        RLMEntity6 *discardedEntity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        discardedEntity.identifier = @100;
+
+        RLMEntity6 *newEntity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        newEntity.identifier = @101;
+
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([RLMEntity6 class])];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"identifier < 5"];
+
+        [self.adapter deletePersistentObjects:[self.adapter executeFetchRequest:fetchRequest error:NULL]];
+        [self.adapter deletePersistentObjects:@[ discardedEntity ]];
+
+        expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(10);
+    } error:NULL];
+
+    RLMResults *results = [[RLMEntity6 allObjectsInRealm:realm] sortedResultsUsingKeyPath:@"identifier" ascending:YES];
+    expect(results.count).to.equal(6);
+    expect([results.firstObject identifier]).to.equal(5);
+    expect([results.lastObject identifier]).to.equal(101);
+}
+
+- (void)testThatPendingObjectsAreFoundByPrimaryKey
+{
+    RLMRealm *realm = self.adapter.realm;
+    CBRPersistentObjectCache *cache = [self.adapter persistentObjectCacheOnCurrentThreadForEntity:self.entity];
+    NSString *type = NSStringFromClass([RLMEntity6 class]);
+
+    [self.adapter ingestWithBlock:^{
+        RLMEntity6 *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        entity.identifier = @1;
+        entity.name = @"first";
+
+        RLMEntity6 *otherEntity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        otherEntity.identifier = @2;
+
+        expect([cache objectOfType:type withValue:@1 forAttribute:@"identifier"]).to.beIdenticalTo(entity);
+        expect([cache indexedObjectsOfType:type withValues:[NSSet setWithArray:@[ @1, @2, @3 ]] forAttribute:@"identifier"]).to.equal(@{ @1: entity, @2: otherEntity });
+    } error:NULL];
+
+    expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(2);
+    expect([[RLMEntity6 objectsInRealm:realm where:@"identifier == 1"].firstObject name]).to.equal(@"first");
+}
+
+- (void)testThatPendingObjectsAreSortedAndLimited
+{
+    RLMRealm *realm = self.adapter.realm;
+
+    [realm transactionWithBlock:^{
+        for (NSInteger i = 0; i < 3; i++) {
+            RLMEntity6 *entity = [[RLMEntity6 alloc] init];
+            entity.identifier = @(2 * i);
+            [realm addObject:entity];
+        }
+    }];
+
+    [self.adapter ingestWithBlock:^{
+        for (NSInteger i = 0; i < 3; i++) {
+            RLMEntity6 *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+            entity.identifier = @(2 * i + 1);
+        }
+
+        NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([RLMEntity6 class])];
+        fetchRequest.predicate = [NSPredicate predicateWithFormat:@"identifier IN %@", @[ @0, @1, @2, @3, @4, @5 ]];
+        fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"identifier" ascending:NO] ];
+        fetchRequest.fetchOffset = 1;
+        fetchRequest.fetchLimit = 3;
+
+        NSArray *objects = [self.adapter executeFetchRequest:fetchRequest error:NULL];
+        expect([objects valueForKey:@"identifier"]).to.equal(@[ @4, @3, @2 ]);
+    } error:NULL];
+}
+
+- (void)testThatThrowingIngestIsCancelled
+{
+    RLMRealm *realm = self.adapter.realm;
+    CBRPersistentObjectCache *cache = [self.adapter persistentObjectCacheOnCurrentThreadForEntity:self.entity];
+    NSString *type = NSStringFromClass([RLMEntity6 class]);
+
+    expect(^{
+        [self.adapter ingestWithBlock:^{
+            RLMEntity6 *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+            entity.identifier = @1;
+            expect([cache objectOfType:type withValue:@1 forAttribute:@"identifier"]).to.beIdenticalTo(entity);
+
+            [NSException raise:NSInternalInconsistencyException format:@"ingest failed"];
+        } error:NULL];
+    }).to.raise(NSInternalInconsistencyException);
+
+    expect(realm.inWriteTransaction).to.beFalsy();
+    expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(0);
+    expect([cache objectOfType:type withValue:@1 forAttribute:@"identifier"]).to.beNil();
+
+    [self.adapter ingestWithBlock:^{
+        RLMEntity6 *entity = [self.adapter newMutablePersistentObjectOfType:self.entity];
+        entity.identifier = @2;
+    } error:NULL];
+    expect([RLMEntity6 allObjectsInRealm:realm].count).to.equal(1);
+}
+
+@end
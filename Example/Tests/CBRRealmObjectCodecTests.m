@@ -0,0 +1,104 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <OCMock/OCMock.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+@interface CBRRealmObjectCodecTests : CBRTestCase
+@property (nonatomic, strong) RLMRealm *realm;
+@end
+
+@implementation CBRRealmObjectCodecTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.inMemoryIdentifier = self.testRun.test.name;
+    config.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    self.realm = [RLMRealm realmWithConfiguration:config error:NULL];
+}
+
+- (void)testThatPropertyListCodecRoundTripsPlainValues
+{
+    CBRPropertyListCodec *codec = [CBRPropertyListCodec sharedCodec];
+    NSArray *value = @[ @"string", @1, @{ @"key": @[ [NSDate dateWithTimeIntervalSince1970:0] ] } ];
+
+    NSData *data = [codec dataFromValue:value];
+    expect(data.length).to.beLessThan([NSKeyedArchiver archivedDataWithRootObject:value].length);
+    expect([codec valueFromData:data]).to.equal(value);
+}
+
+- (void)testThatPropertyListCodecFallsBackToKeyedArchives
+{
+    CBRPropertyListCodec *codec = [CBRPropertyListCodec sharedCodec];
+    NSArray *value = @[ [NSURL URLWithString:@"https://example.com"], [NSNull null] ];
+
+    expect([codec valueFromData:[codec dataFromValue:value]]).to.equal(value);
+    expect([codec valueFromData:[NSKeyedArchiver archivedDataWithRootObject:@[ @"legacy" ]]]).to.equal(@[ @"legacy" ]);
+}
+
+- (void)testThatUnmanagedObjectsAreEncodedWhenAdded
+{
+    RLMEntity4 *entity = [[RLMEntity4 alloc] init];
+    entity.array = @[ @1, @2 ];
+
+    [self.realm transactionWithBlock:^{
+        [self.realm addObject:entity];
+    }];
+
+    RLMEntity4 *fetchedEntity = [RLMEntity4 allObjectsInRealm:self.realm].firstObject;
+    expect(fetchedEntity).toNot.beIdenticalTo(entity);
+    expect(fetchedEntity.array).to.equal(@[ @1, @2 ]);
+}
+
+- (void)testThatTransformablePropertiesAreVisibleToOtherAccessorsBeforeCommit
+{
+    RLMEntity4 *entity = [[RLMEntity4 alloc] init];
+
+    [self.realm transactionWithBlock:^{
+        [self.realm addObject:entity];
+    }];
+
+    [self.realm beginWriteTransaction];
+    entity.array = @[ @1, @2 ];
+
+    RLMEntity4 *otherEntity = [RLMEntity4 allObjectsInRealm:self.realm].firstObject;
+    expect(otherEntity).toNot.beIdenticalTo(entity);
+    expect(otherEntity.array).to.equal(@[ @1, @2 ]);
+    expect([RLMEntity4 objectsInRealm:self.realm where:@"array_Data != nil"].count).to.equal(1);
+
+    [self.realm commitWriteTransaction];
+}
+
+@end
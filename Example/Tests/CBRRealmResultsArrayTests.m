@@ -0,0 +1,183 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+@interface CBRRealmResultsArrayTests : CBRTestCase
+@property (nonatomic, strong) CBRRealmInterface *adapter;
+@end
+
+@implementation CBRRealmResultsArrayTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.inMemoryIdentifier = self.testRun.test.name;
+    config.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    self.adapter = [[CBRRealmInterface alloc] initWithConfiguration:config];
+
+    [self.adapter.realm transactionWithBlock:^{
+        for (NSInteger i = 0; i < 10; i++) {
+            RLMEntity6 *entity = [[RLMEntity6 alloc] init];
+            entity.identifier = @(i);
+            [self.adapter.realm addObject:entity];
+        }
+    }];
+}
+
+- (NSFetchRequest *)_fetchRequest
+{
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([RLMEntity6 class])];
+    fetchRequest.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"identifier" ascending:YES] ];
+    return fetchRequest;
+}
+
+- (void)testThatFetchRequestsHonorOffsetAndLimit
+{
+    NSFetchRequest *fetchRequest = [self _fetchRequest];
+    fetchRequest.fetchOffset = 3;
+    fetchRequest.fetchLimit = 4;
+    fetchRequest.fetchBatchSize = 3;
+
+    NSArray<RLMEntity6 *> *objects = [self.adapter executeFetchRequest:fetchRequest error:NULL];
+    expect(objects).to.beKindOf([CBRRealmResultsArray class]);
+    expect(objects.count).to.equal(4);
+    expect(objects.firstObject.identifier).to.equal(3);
+    expect(objects.lastObject.identifier).to.equal(6);
+
+    NSMutableArray *identifiers = [NSMutableArray array];
+    for (RLMEntity6 *object in objects) {
+        [identifiers addObject:object.identifier];
+    }
+    expect(identifiers).to.equal(@[ @3, @4, @5, @6 ]);
+
+    fetchRequest.fetchOffset = 8;
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL].count).to.equal(2);
+
+    fetchRequest.fetchOffset = 20;
+    expect([self.adapter executeFetchRequest:fetchRequest error:NULL].count).to.equal(0);
+}
+
+- (void)testThatEnumeratedObjectsSurviveDrainedAutoreleasePools
+{
+    NSFetchRequest *fetchRequest = [self _fetchRequest];
+    fetchRequest.fetchOffset = 1;
+    fetchRequest.fetchBatchSize = 2;
+
+    NSArray<RLMEntity6 *> *objects = [self.adapter executeFetchRequest:fetchRequest error:NULL];
+
+    NSMutableArray *identifiers = [NSMutableArray array];
+    for (RLMEntity6 *object in objects) {
+        @autoreleasepool {
+            [identifiers addObject:object.identifier];
+        }
+
+        @autoreleasepool {
+            expect(object.invalidated).to.beFalsy();
+            [identifiers addObject:object.identifier];
+        }
+    }
+
+    expect(identifiers).to.haveCountOf(18);
+    expect(identifiers.lastObject).to.equal(9);
+}
+
+- (void)testThatFetchedObjectsAreLive
+{
+    NSArray *objects = [self.adapter executeFetchRequest:[self _fetchRequest] error:NULL];
+    expect(objects.count).to.equal(10);
+
+    [self.adapter.realm transactionWithBlock:^{
+        RLMEntity6 *entity = [[RLMEntity6 alloc] init];
+        entity.identifier = @10;
+        [self.adapter.realm addObject:entity];
+    }];
+
+    expect(objects.count).to.equal(11);
+}
+
+- (void)testThatCopiesAreSnapshots
+{
+    NSArray *objects = [self.adapter executeFetchRequest:[self _fetchRequest] error:NULL];
+    NSArray *copiedObjects = [objects copy];
+
+    [self.adapter.realm transactionWithBlock:^{
+        RLMEntity6 *entity = [[RLMEntity6 alloc] init];
+        entity.identifier = @10;
+        [self.adapter.realm addObject:entity];
+    }];
+
+    expect(copiedObjects).toNot.beKindOf([CBRRealmResultsArray class]);
+    expect(copiedObjects.count).to.equal(10);
+    expect(objects.count).to.equal(11);
+}
+
+- (void)testThatEnumerationEndsWhenResultsShrink
+{
+    NSFetchRequest *fetchRequest = [self _fetchRequest];
+    fetchRequest.fetchLimit = 8;
+    fetchRequest.fetchBatchSize = 2;
+
+    NSArray<RLMEntity6 *> *objects = [self.adapter executeFetchRequest:fetchRequest error:NULL];
+
+    NSMutableArray *identifiers = [NSMutableArray array];
+    for (RLMEntity6 *object in objects) {
+        [identifiers addObject:object.identifier];
+
+        if (identifiers.count == 2) {
+            [self.adapter.realm transactionWithBlock:^{
+                [self.adapter.realm deleteObjects:[RLMEntity6 objectsInRealm:self.adapter.realm where:@"identifier >= 4"]];
+            }];
+        }
+    }
+
+    expect(identifiers).to.equal(@[ @0, @1, @2, @3 ]);
+}
+
+- (void)testThatLimitedFetchedObjectsCanBeDeleted
+{
+    NSFetchRequest *fetchRequest = [self _fetchRequest];
+    fetchRequest.fetchLimit = 4;
+
+    [self.adapter deletePersistentObjects:[self.adapter executeFetchRequest:fetchRequest error:NULL]];
+
+    NSArray<RLMEntity6 *> *objects = [self.adapter executeFetchRequest:[self _fetchRequest] error:NULL];
+    expect(objects.count).to.equal(6);
+    expect(objects.firstObject.identifier).to.equal(4);
+
+    [self.adapter deletePersistentObjects:objects];
+    expect([self.adapter executeFetchRequest:[self _fetchRequest] error:NULL].count).to.equal(0);
+}
+
+@end
@@ -0,0 +1,152 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+
+#import "CBRTestCase.h"
+#import "CBRTestDataStore.h"
+
+#import "RLMEntity4.h"
+#import "RLMEntity6.h"
+
+@implementation SLEntity6 (CBRSharedDatabaseInterfaceTests)
+
+- (BOOL)validateName:(id *)value error:(NSError **)error
+{
+    if (![*value isEqual:@"invalid"]) {
+        return YES;
+    }
+
+    if (error != NULL) {
+        *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSValidationStringPatternMatchingError userInfo:nil];
+    }
+    return NO;
+}
+
+@end
+
+
+
+@interface CBRSharedDatabaseInterfaceTests : CBRTestCase
+@property (nonatomic, strong) CBRSharedDatabaseInterface *interface;
+@property (nonatomic, strong) RLMRealm *realm;
+@end
+
+@implementation CBRSharedDatabaseInterfaceTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    RLMRealmConfiguration *config = [RLMRealmConfiguration defaultConfiguration];
+    config.inMemoryIdentifier = self.testRun.test.name;
+    config.objectClasses = @[ RLMEntity4.class, RLMEntity6.class, RLMEntity6Child.class ];
+
+    CBRCoreDataInterface *coreDataInterface = [[CBRCoreDataInterface alloc] initWithStack:[CBRCoreDataStack testStore]];
+    CBRRealmInterface *realmInterface = [[CBRRealmInterface alloc] initWithConfiguration:config];
+
+    self.interface = [[CBRSharedDatabaseInterface alloc] initWithCoreDataInterface:coreDataInterface realmInterface:realmInterface];
+    self.realm = realmInterface.realm;
+}
+
+- (void)testThatEntitiesAreRoutedToTheirStore
+{
+    CBREntityDescription *coreDataEntity = self.interface.entitiesByName[NSStringFromClass([SLEntity6 class])];
+    CBREntityDescription *realmEntity = self.interface.entitiesByName[NSStringFromClass([RLMEntity6 class])];
+
+    expect([self.interface persistentObjectCacheOnCurrentThreadForEntity:coreDataEntity]).to.beIdenticalTo([self.interface.coreDataInterface persistentObjectCacheOnCurrentThreadForEntity:coreDataEntity]);
+    expect([self.interface persistentObjectCacheOnCurrentThreadForEntity:realmEntity]).to.beIdenticalTo([self.interface.realmInterface persistentObjectCacheOnCurrentThreadForEntity:realmEntity]);
+
+    [self.interface beginWriteTransaction];
+    id coreDataObject = [self.interface newMutablePersistentObjectOfType:coreDataEntity];
+    id realmObject = [self.interface newMutablePersistentObjectOfType:realmEntity];
+    expect([self.interface commitWriteTransaction:NULL]).to.beTruthy();
+
+    expect(coreDataObject).to.beKindOf([SLEntity6 class]);
+    expect(realmObject).to.beKindOf([RLMEntity6 class]);
+}
+
+- (void)testThatBothStoresCommitFromBackgroundThreads
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"commit"];
+    NSNumber *identifier = @(arc4random());
+
+    // like CBRThreadingEnvironment, callers run on the queue of the background context
+    __block BOOL success = NO;
+    [self.interface.coreDataInterface.stack.backgroundThreadManagedObjectContext performBlock:^{
+        [self.interface beginWriteTransaction];
+
+        SLEntity6 *coreDataObject = [self.interface newMutablePersistentObjectOfType:self.interface.entitiesByName[NSStringFromClass([SLEntity6 class])]];
+        coreDataObject.identifier = identifier;
+
+        RLMEntity6 *realmObject = [self.interface newMutablePersistentObjectOfType:self.interface.entitiesByName[NSStringFromClass([RLMEntity6 class])]];
+        realmObject.identifier = identifier;
+
+        success = [self.interface commitWriteTransaction:NULL];
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithTimeout:10.0 handler:nil];
+    expect(success).to.beTruthy();
+
+    [self.realm refresh];
+    expect([RLMEntity6 objectsInRealm:self.realm where:@"identifier == %@", identifier].count).to.equal(1);
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([SLEntity6 class])];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"identifier == %@", identifier];
+    expect([self.interface executeFetchRequest:fetchRequest error:NULL].count).to.equal(1);
+}
+
+- (void)testThatInvalidCoreDataChangesDiscardBothStores
+{
+    [self.interface beginWriteTransaction];
+
+    SLEntity6 *coreDataObject = [self.interface newMutablePersistentObjectOfType:self.interface.entitiesByName[NSStringFromClass([SLEntity6 class])]];
+    coreDataObject.identifier = @1;
+    coreDataObject.name = @"invalid";
+
+    RLMEntity6 *realmObject = [self.interface newMutablePersistentObjectOfType:self.interface.entitiesByName[NSStringFromClass([RLMEntity6 class])]];
+    realmObject.identifier = @1;
+
+    NSError *error = nil;
+    expect([self.interface commitWriteTransaction:&error]).to.beFalsy();
+    expect(error).toNot.beNil();
+
+    expect(self.realm.inWriteTransaction).to.beFalsy();
+    expect([RLMEntity6 allObjectsInRealm:self.realm].count).to.equal(0);
+    expect(self.interface.coreDataInterface.stack.mainThreadManagedObjectContext.hasChanges).to.beFalsy();
+
+    [self.interface beginWriteTransaction];
+
+    SLEntity6 *otherObject = [self.interface newMutablePersistentObjectOfType:self.interface.entitiesByName[NSStringFromClass([SLEntity6 class])]];
+    otherObject.identifier = @2;
+    expect([self.interface commitWriteTransaction:NULL]).to.beTruthy();
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([SLEntity6 class])];
+    expect([[self.interface executeFetchRequest:fetchRequest error:NULL] valueForKey:@"identifier"]).to.equal(@[ @2 ]);
+}
+
+@end
@@ -0,0 +1,695 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+
+#import <CloudBridge/CloudBridge.h>
+#import <CloudBridge/CBRRESTConnection.h>
+
+#import "CBRTestDataStore.h"
+
+static NSString * const CBRFixtureServerHost = @"fixtures.local";
+
+static NSUInteger CBRSyncBenchmarkEnvironmentValue(NSString *name, NSUInteger defaultValue)
+{
+    NSString *value = [NSProcessInfo processInfo].environment[name];
+    return value.length > 0 ? (NSUInteger)value.integerValue : defaultValue;
+}
+
+
+
+/**
+ Replays recorded fixtures for `CBRFixtureURLProtocol`. Collections are served in pages of `pageSize` through the `page` query parameter, `POST` assigns a new `id` and echoes the request body, `PUT` echoes the request body and `DELETE` responds with an empty object.
+ */
+@interface CBRFixtureServer : NSObject
+
+@property (nonatomic, assign) NSTimeInterval latency;
+@property (nonatomic, assign) NSUInteger pageSize;
+@property (nonatomic, assign) NSUInteger payloadSize;
+
+@property (nonatomic, readonly) NSUInteger requestCount;
+@property (nonatomic, readonly) unsigned long long bytesReceived;
+@property (nonatomic, readonly) unsigned long long bytesSent;
+
+- (void)recordFixture:(NSArray<NSDictionary *> *)objects forPath:(NSString *)path;
+- (NSArray<NSDictionary *> *)generateObjectsWithCount:(NSUInteger)count;
+
+- (NSData *)responseToRequest:(NSURLRequest *)request body:(NSData *)body statusCode:(NSInteger *)statusCode;
+
+@end
+
+@interface CBRFixtureServer ()
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, NSArray<NSDictionary *> *> *fixtures;
+@property (nonatomic, assign) NSUInteger nextIdentifier;
+@end
+
+@implementation CBRFixtureServer
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _fixtures = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)recordFixture:(NSArray<NSDictionary *> *)objects forPath:(NSString *)path
+{
+    @synchronized (self) {
+        self.fixtures[path] = objects;
+    }
+}
+
+- (NSArray<NSDictionary *> *)generateObjectsWithCount:(NSUInteger)count
+{
+    NSString *padding = [@"" stringByPaddingToLength:self.payloadSize withString:@"x" startingAtIndex:0];
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:count];
+
+    @synchronized (self) {
+        for (NSUInteger i = 0; i < count; i++) {
+            [objects addObject:@{ @"id": @(++self.nextIdentifier), @"name": padding }];
+        }
+    }
+
+    return objects;
+}
+
+- (NSData *)responseToRequest:(NSURLRequest *)request body:(NSData *)body statusCode:(NSInteger *)statusCode
+{
+    NSURLComponents *components = [NSURLComponents componentsWithURL:request.URL resolvingAgainstBaseURL:NO];
+    NSString *path = [components.path substringFromIndex:1];
+    NSString *page = [components.queryItems filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == 'page'"]].firstObject.value;
+
+    id requestObject = body.length > 0 ? [NSJSONSerialization JSONObjectWithData:body options:kNilOptions error:NULL] : nil;
+    id responseObject = @{};
+    *statusCode = 200;
+
+    @synchronized (self) {
+        _requestCount++;
+        _bytesReceived += body.length;
+
+        if ([request.HTTPMethod isEqualToString:@"GET"]) {
+            NSArray *fixture = self.fixtures[path];
+
+            if (!fixture) {
+                *statusCode = 404;
+            } else if (page) {
+                NSUInteger location = MIN(page.integerValue * self.pageSize, fixture.count);
+                responseObject = [fixture subarrayWithRange:NSMakeRange(location, MIN(self.pageSize, fixture.count - location))];
+            } else {
+                responseObject = fixture;
+            }
+        } else if ([request.HTTPMethod isEqualToString:@"POST"]) {
+            NSMutableDictionary *object = [requestObject mutableCopy] ?: [NSMutableDictionary dictionary];
+            object[@"id"] = @(++self.nextIdentifier);
+            responseObject = object;
+        } else if ([request.HTTPMethod isEqualToString:@"PUT"]) {
+            responseObject = requestObject ?: @{};
+        }
+    }
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:responseObject options:kNilOptions error:NULL];
+
+    @synchronized (self) {
+        _bytesSent += data.length;
+    }
+
+    return data;
+}
+
+@end
+
+
+
+/**
+ Serves every request to `CBRFixtureServerHost` from the current `CBRFixtureServer` after its `latency`.
+ */
+@interface CBRFixtureURLProtocol : NSURLProtocol
+@property (nonatomic, class, strong) CBRFixtureServer *server;
+@property (atomic, assign) BOOL cancelled;
+@end
+
+@implementation CBRFixtureURLProtocol
+
+static CBRFixtureServer *_server = nil;
+
++ (CBRFixtureServer *)server
+{
+    @synchronized (self) {
+        return _server;
+    }
+}
+
++ (void)setServer:(CBRFixtureServer *)server
+{
+    @synchronized (self) {
+        _server = server;
+    }
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    return [request.URL.host isEqualToString:CBRFixtureServerHost] && self.server != nil;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)startLoading
+{
+    NSThread *thread = [NSThread currentThread];
+    NSArray *modes = @[ [NSRunLoop currentRunLoop].currentMode ?: NSDefaultRunLoopMode ];
+    CBRFixtureServer *server = [self.class server];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(server.latency * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [self performSelector:@selector(_respondWithServer:) onThread:thread withObject:server waitUntilDone:NO modes:modes];
+    });
+}
+
+- (void)stopLoading
+{
+    self.cancelled = YES;
+}
+
+- (void)_respondWithServer:(CBRFixtureServer *)server
+{
+    if (self.cancelled) {
+        return;
+    }
+
+    NSInteger statusCode = 0;
+    NSData *data = [server responseToRequest:self.request body:[self _bodyOfRequest:self.request] statusCode:&statusCode];
+
+    NSDictionary *headers = @{ @"Content-Type": @"application/json", @"Content-Length": @(data.length).stringValue };
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers];
+
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocol:self didLoadData:data];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (NSData *)_bodyOfRequest:(NSURLRequest *)request
+{
+    if (request.HTTPBody || !request.HTTPBodyStream) {
+        return request.HTTPBody;
+    }
+
+    NSMutableData *body = [NSMutableData data];
+    NSInputStream *stream = request.HTTPBodyStream;
+    uint8_t buffer[4096];
+
+    [stream open];
+    while (stream.hasBytesAvailable) {
+        NSInteger length = [stream read:buffer maxLength:sizeof(buffer)];
+        if (length <= 0) {
+            break;
+        }
+
+        [body appendBytes:buffer length:length];
+    }
+    [stream close];
+
+    return body;
+}
+
+@end
+
+
+
+/**
+ Offline capable connection which replays bulk operations as individual requests of a `CBRRESTConnection`.
+ */
+@interface CBRFixtureOfflineConnection : NSObject <CBROfflineCapableCloudConnection>
+@property (nonatomic, readonly) CBRRESTConnection *connection;
+@property (nonatomic, readonly) NSString *path;
+- (instancetype)initWithConnection:(CBRRESTConnection *)connection path:(NSString *)path;
+@end
+
+@implementation CBRFixtureOfflineConnection
+
+- (instancetype)initWithConnection:(CBRRESTConnection *)connection path:(NSString *)path
+{
+    if (self = [super init]) {
+        _connection = connection;
+        _path = path;
+    }
+    return self;
+}
+
+- (id<CBRCloudObjectTransformer>)objectTransformer
+{
+    return self.connection.objectTransformer;
+}
+
+- (void)fetchCloudObjectsForEntity:(CBREntityDescription *)entity withPredicate:(NSPredicate *)predicate userInfo:(NSDictionary *)userInfo completionHandler:(void (^)(NSArray *, NSError *))completionHandler
+{
+    [self.connection fetchCloudObjectsForEntity:entity withPredicate:predicate userInfo:userInfo completionHandler:completionHandler];
+}
+
+- (void)createCloudObject:(id<CBRCloudObject>)cloudObject forPersistentObject:(id<CBRPersistentObject>)persistentObject withUserInfo:(NSDictionary *)userInfo completionHandler:(void (^)(id<CBRCloudObject>, NSError *))completionHandler
+{
+    [self.connection createCloudObject:cloudObject forPersistentObject:persistentObject withUserInfo:[self _userInfo:userInfo identifier:nil] completionHandler:completionHandler];
+}
+
+- (void)latestCloudObjectForPersistentObject:(id<CBRPersistentObject>)persistentObject withUserInfo:(NSDictionary *)userInfo completionHandler:(void (^)(id<CBRCloudObject>, NSError *))completionHandler
+{
+    [self.connection latestCloudObjectForPersistentObject:persistentObject withUserInfo:[self _userInfo:userInfo identifier:[persistentObject valueForKey:@"identifier"]] completionHandler:completionHandler];
+}
+
+- (void)saveCloudObject:(id<CBRCloudObject>)cloudObject forPersistentObject:(id<CBRPersistentObject>)persistentObject withUserInfo:(NSDictionary *)userInfo completionHandler:(void (^)(id<CBRCloudObject>, NSError *))completionHandler
+{
+    [self.connection saveCloudObject:cloudObject forPersistentObject:persistentObject withUserInfo:[self _userInfo:userInfo identifier:[persistentObject valueForKey:@"identifier"]] completionHandler:completionHandler];
+}
+
+- (void)deleteCloudObject:(id<CBRCloudObject>)cloudObject forPersistentObject:(id<CBRPersistentObject>)persistentObject withUserInfo:(NSDictionary *)userInfo completionHandler:(void (^)(NSError *))completionHandler
+{
+    [self.connection deleteCloudObject:cloudObject forPersistentObject:persistentObject withUserInfo:[self _userInfo:userInfo identifier:[persistentObject valueForKey:@"identifier"]] completionHandler:completionHandler];
+}
+
+- (void)bulkCreateCloudObjects:(NSArray *)cloudObjects forPersistentObjects:(NSArray *)persistentObjects completionHandler:(void (^)(NSArray *, NSError *))completionHandler
+{
+    [self _performBulkOperationWithPersistentObjects:persistentObjects operation:^(NSUInteger index, void (^completion)(id, NSError *)) {
+        [self createCloudObject:cloudObjects[index] forPersistentObject:persistentObjects[index] withUserInfo:nil completionHandler:completion];
+    } completionHandler:completionHandler];
+}
+
+- (void)bulkSaveCloudObjects:(NSArray *)cloudObjects forPersistentObjects:(NSArray *)persistentObjects completionHandler:(void (^)(NSArray *, NSError *))completionHandler
+{
+    [self _performBulkOperationWithPersistentObjects:persistentObjects operation:^(NSUInteger index, void (^completion)(id, NSError *)) {
+        [self saveCloudObject:cloudObjects[index] forPersistentObject:persistentObjects[index] withUserInfo:nil completionHandler:completion];
+    } completionHandler:completionHandler];
+}
+
+- (void)bulkDeleteCloudObjects:(NSArray *)cloudObjects forPersistentObjects:(NSArray *)persistentObjects completionHandler:(void (^)(NSArray *, NSError *))completionHandler
+{
+    NSMutableArray *identifiers = [NSMutableArray arrayWithCapacity:persistentObjects.count];
+    for (id<CBRPersistentObject> persistentObject in persistentObjects) {
+        [identifiers addObject:[[CBRDeletedObjectIdentifier alloc] initWithCloudIdentifier:[persistentObject valueForKey:@"identifier"] entitiyName:persistentObject.cloudBridgeEntityDescription.name]];
+    }
+
+    [self _performBulkOperationWithPersistentObjects:persistentObjects operation:^(NSUInteger index, void (^completion)(id, NSError *)) {
+        [self deleteCloudObject:cloudObjects[index] forPersistentObject:persistentObjects[index] withUserInfo:nil completionHandler:^(NSError *error) {
+            completion(identifiers[index], error);
+        }];
+    } completionHandler:completionHandler];
+}
+
+- (NSDictionary *)_userInfo:(NSDictionary *)userInfo identifier:(id)identifier
+{
+    NSMutableDictionary *result = [NSMutableDictionary dictionaryWithDictionary:userInfo ?: @{}];
+    result[CBRRESTConnectionUserInfoURLOverrideKey] = identifier ? [NSString stringWithFormat:@"%@/%@", self.path, identifier] : self.path;
+    return result;
+}
+
+- (void)_performBulkOperationWithPersistentObjects:(NSArray *)persistentObjects
+                                         operation:(void(^)(NSUInteger index, void(^completion)(id result, NSError *error)))operation
+                                 completionHandler:(void (^)(NSArray *, NSError *))completionHandler
+{
+    dispatch_group_t group = dispatch_group_create();
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:persistentObjects.count];
+    __block NSError *bulkError = nil;
+
+    for (NSUInteger i = 0; i < persistentObjects.count; i++) {
+        [results addObject:[NSNull null]];
+        dispatch_group_enter(group);
+
+        operation(i, ^(id result, NSError *error) {
+            @synchronized (results) {
+                results[i] = result ?: [NSNull null];
+                bulkError = bulkError ?: error;
+            }
+
+            dispatch_group_leave(group);
+        });
+    }
+
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        if (completionHandler) {
+            completionHandler(bulkError ? nil : results, bulkError);
+        }
+    });
+}
+
+@end
+
+
+
+/**
+ Samples the latency of the main queue and accumulates every stall longer than one frame.
+ */
+@interface CBRMainThreadWatchdog : NSObject
+@property (nonatomic, readonly) NSTimeInterval blockedTime;
+- (void)start;
+- (void)stop;
+@end
+
+@interface CBRMainThreadWatchdog ()
+@property (nonatomic, readonly) dispatch_queue_t queue;
+@property (nonatomic, strong) dispatch_source_t timer;
+@property (nonatomic, assign) BOOL waitingForMainThread;
+@end
+
+@implementation CBRMainThreadWatchdog
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _queue = dispatch_queue_create("de.sparrow-labs.CloudBridge.watchdog", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)start
+{
+    self.timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.queue);
+    dispatch_source_set_timer(self.timer, DISPATCH_TIME_NOW, 2 * NSEC_PER_MSEC, NSEC_PER_MSEC);
+
+    __weak typeof(self) weakSelf = self;
+    dispatch_source_set_event_handler(self.timer, ^{
+        __strong typeof(weakSelf) self = weakSelf;
+        if (!self || self.waitingForMainThread) {
+            return;
+        }
+
+        self.waitingForMainThread = YES;
+        NSTimeInterval sent = CBRInstrumentationTimestamp();
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            NSTimeInterval latency = CBRInstrumentationTimestamp() - sent;
+
+            dispatch_async(self.queue, ^{
+                if (latency > 1.0 / 60.0) {
+                    self->_blockedTime += latency;
+                }
+
+                self.waitingForMainThread = NO;
+            });
+        });
+    });
+
+    dispatch_resume(self.timer);
+}
+
+- (void)stop
+{
+    dispatch_source_cancel(self.timer);
+    dispatch_sync(self.queue, ^{});
+}
+
+@end
+
+
+
+/**
+ End-to-end sync benchmarks of `CBRRESTConnection` and `CBRCloudBridge` against `CBRFixtureServer`. Latency, page size, payload size and number of objects can be configured through the `CBR_SYNC_LATENCY_MS`, `CBR_SYNC_PAGE_SIZE`, `CBR_SYNC_PAYLOAD_BYTES` and `CBR_SYNC_OBJECT_COUNT` environment variables.
+
+ Benchmarks only run if the `CBR_BENCHMARKS` environment variable is set, e.g. in a dedicated scheme.
+ */
+@interface CBRSyncBenchmarkTests : XCTestCase
+@property (nonatomic, strong) CBRFixtureServer *server;
+@property (nonatomic, strong) CBRCoreDataStack *stack;
+@property (nonatomic, strong) CBRCoreDataInterface *adapter;
+@property (nonatomic, strong) CBRThreadingEnvironment *environment;
+@property (nonatomic, strong) CBRRESTConnection *connection;
+@property (nonatomic, strong) CBRCloudBridge *cloudBridge;
+@property (nonatomic, strong) CBRInstrumentationAggregator *aggregator;
+@property (nonatomic, assign) NSUInteger objectCount;
+@end
+
+@implementation CBRSyncBenchmarkTests
+
++ (XCTestSuite *)defaultTestSuite
+{
+    if ([NSProcessInfo processInfo].environment[@"CBR_BENCHMARKS"].length == 0) {
+        return [[XCTestSuite alloc] initWithName:NSStringFromClass(self)];
+    }
+
+    return [super defaultTestSuite];
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    self.server = [[CBRFixtureServer alloc] init];
+    self.server.latency = CBRSyncBenchmarkEnvironmentValue(@"CBR_SYNC_LATENCY_MS", 5) / 1000.0;
+    self.server.pageSize = CBRSyncBenchmarkEnvironmentValue(@"CBR_SYNC_PAGE_SIZE", 100);
+    self.server.payloadSize = CBRSyncBenchmarkEnvironmentValue(@"CBR_SYNC_PAYLOAD_BYTES", 256);
+    self.objectCount = CBRSyncBenchmarkEnvironmentValue(@"CBR_SYNC_OBJECT_COUNT", 400);
+    [CBRFixtureURLProtocol setServer:self.server];
+
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    configuration.protocolClasses = @[ [CBRFixtureURLProtocol class] ];
+
+    NSURL *baseURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://%@", CBRFixtureServerHost]];
+    AFHTTPSessionManager *sessionManager = [[AFHTTPSessionManager alloc] initWithBaseURL:baseURL sessionConfiguration:configuration];
+    sessionManager.requestSerializer = [AFJSONRequestSerializer serializerWithWritingOptions:kNilOptions];
+    sessionManager.responseSerializer = [AFJSONResponseSerializer serializerWithReadingOptions:kNilOptions];
+
+    CBRUnderscoredPropertyMapping *propertyMapping = [[CBRUnderscoredPropertyMapping alloc] init];
+    [propertyMapping registerObjcNamingConvention:@"identifier" forJSONNamingConvention:@"id"];
+
+    NSBundle *bundle = [NSBundle bundleForClass:[SLEntity6 class]];
+    NSURL *modelURL = [bundle URLForResource:@"CBRTestDataStore" withExtension:@"momd"] ?: [bundle URLForResource:@"CBRTestDataStore" withExtension:@"mom"];
+    NSURL *location = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"CBRSyncBenchmark.store"];
+
+    self.stack = [[CBRCoreDataStack alloc] initWithType:NSInMemoryStoreType location:location model:modelURL inBundle:bundle type:CBRCoreDataStackTypeParallel];
+    self.connection = [[CBRRESTConnection alloc] initWithPropertyMapping:propertyMapping sessionManager:sessionManager];
+    self.adapter = [[CBRCoreDataInterface alloc] initWithStack:self.stack];
+    self.environment = [[CBRThreadingEnvironment alloc] initWithCoreDataAdapter:self.adapter];
+    self.cloudBridge = [[CBRCloudBridge alloc] initWithCloudConnection:self.connection interface:self.adapter threadingEnvironment:self.environment];
+    [NSManagedObject setCloudBridge:self.cloudBridge];
+
+    self.aggregator = [[CBRInstrumentationAggregator alloc] init];
+    CBRInstrumentationSetCurrent(self.aggregator);
+}
+
+- (void)tearDown
+{
+    CBRInstrumentationSetCurrent(nil);
+    [CBRFixtureURLProtocol setServer:nil];
+    [OfflineEntity setCloudBridge:nil];
+
+    [self.connection.sessionManager invalidateSessionCancelingTasks:YES];
+    [self.stack.mainThreadManagedObjectContext reset];
+
+    [super tearDown];
+}
+
+#pragma mark - Benchmarks
+
+- (void)testPagedFetchSync
+{
+    [self.server recordFixture:[self.server generateObjectsWithCount:self.objectCount] forPath:@"entity6"];
+
+    [self _benchmark:@"sync.fetch" operation:^(dispatch_block_t completion) {
+        [self _fetchPagesOfPath:@"entity6" startingAtPage:0 completion:completion];
+    }];
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([SLEntity6 class])];
+    expect([self.stack.mainThreadManagedObjectContext countForFetchRequest:fetchRequest error:NULL]).to.equal(self.objectCount);
+}
+
+- (void)testBulkCreateSync
+{
+    NSArray<SLEntity6 *> *entities = [self _insertEntitiesWithCount:self.server.pageSize];
+
+    [self _benchmark:@"sync.bulkCreate" operation:^(dispatch_block_t completion) {
+        dispatch_group_t group = dispatch_group_create();
+
+        for (SLEntity6 *entity in entities) {
+            dispatch_group_enter(group);
+            [self.cloudBridge createPersistentObject:entity withCompletionHandler:^(id persistentObject, NSError *error) {
+                dispatch_group_leave(group);
+            }];
+        }
+
+        dispatch_group_notify(group, dispatch_get_main_queue(), completion);
+    }];
+
+    expect([entities valueForKeyPath:@"@min.identifier"]).to.beGreaterThan(0);
+}
+
+- (void)testOfflineReplaySync
+{
+    CBRFixtureOfflineConnection *offlineConnection = [[CBRFixtureOfflineConnection alloc] initWithConnection:self.connection path:@"offline_entities"];
+    CBROfflineCapableCloudBridge *offlineBridge = [[CBROfflineCapableCloudBridge alloc] initWithCloudConnection:offlineConnection interface:self.adapter threadingEnvironment:self.environment];
+    [OfflineEntity setCloudBridge:offlineBridge];
+
+    NSManagedObjectContext *context = self.stack.mainThreadManagedObjectContext;
+    for (NSUInteger i = 0; i < self.server.pageSize; i++) {
+        OfflineEntity *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([OfflineEntity class]) inManagedObjectContext:context];
+        entity.identifier = nil;
+        entity.hasPendingCloudBridgeChanges = @YES;
+    }
+    [context save:NULL];
+
+    [offlineBridge enableOfflineMode];
+
+    [self _benchmark:@"sync.offlineReplay" operation:^(dispatch_block_t completion) {
+        [offlineBridge reenableOnlineModeWithCompletionHandler:^(NSError *error) {
+            completion();
+        }];
+    }];
+
+    NSFetchRequest *fetchRequest = [NSFetchRequest fetchRequestWithEntityName:NSStringFromClass([OfflineEntity class])];
+    fetchRequest.predicate = [NSPredicate predicateWithFormat:@"hasPendingCloudBridgeChanges == YES"];
+    expect([context countForFetchRequest:fetchRequest error:NULL]).to.equal(0);
+}
+
+- (void)testConcurrentMixedCRUD
+{
+    NSUInteger operationCount = self.server.pageSize;
+    NSUInteger pageCount = 4;
+
+    [self.server recordFixture:[self.server generateObjectsWithCount:pageCount * self.server.pageSize] forPath:@"entity6"];
+    NSArray<SLEntity6 *> *existingEntities = [self _insertEntitiesWithCount:operationCount];
+    [existingEntities enumerateObjectsUsingBlock:^(SLEntity6 *entity, NSUInteger idx, BOOL *stop) {
+        entity.identifier = @(1000000 + idx);
+    }];
+    NSArray<SLEntity6 *> *newEntities = [self _insertEntitiesWithCount:operationCount];
+    [self.stack.mainThreadManagedObjectContext save:NULL];
+
+    [self _benchmark:@"sync.mixedCRUD" operation:^(dispatch_block_t completion) {
+        dispatch_group_t group = dispatch_group_create();
+        NSUInteger page = 0;
+
+        for (NSUInteger i = 0; i < operationCount; i++) {
+            SLEntity6 *existingEntity = existingEntities[i];
+
+            switch (i % 4) {
+                case 0: {
+                    dispatch_group_enter(group);
+                    [SLEntity6 fetchObjectsFromPath:[NSString stringWithFormat:@"entity6?page=%lu", (unsigned long)(page++ % pageCount)] withCompletionHandler:^(NSArray *fetchedObjects, NSError *error) {
+                        dispatch_group_leave(group);
+                    }];
+                    break;
+                }
+                case 1: {
+                    dispatch_group_enter(group);
+                    [self.cloudBridge createPersistentObject:newEntities[i] withCompletionHandler:^(id persistentObject, NSError *error) {
+                        dispatch_group_leave(group);
+                    }];
+                    break;
+                }
+                case 2: {
+                    existingEntity.name = @"updated";
+
+                    dispatch_group_enter(group);
+                    [self.cloudBridge savePersistentObject:existingEntity withCompletionHandler:^(id persistentObject, NSError *error) {
+                        dispatch_group_leave(group);
+                    }];
+                    break;
+                }
+                case 3: {
+                    dispatch_group_enter(group);
+                    [self.cloudBridge deletePersistentObject:existingEntity withCompletionHandler:^(NSError *error) {
+                        dispatch_group_leave(group);
+                    }];
+                    break;
+                }
+            }
+        }
+
+        dispatch_group_notify(group, dispatch_get_main_queue(), completion);
+    }];
+}
+
+#pragma mark - Private category implementation ()
+
+- (void)_benchmark:(NSString *)name operation:(void(^)(dispatch_block_t completion))operation
+{
+    NSManagedObjectContext *context = self.stack.mainThreadManagedObjectContext;
+    CBRMainThreadWatchdog *watchdog = [[CBRMainThreadWatchdog alloc] init];
+    XCTestExpectation *expectation = [self expectationWithDescription:name];
+
+    __block NSTimeInterval timeToFirstObject = -1.0;
+    NSTimeInterval start = CBRInstrumentationTimestamp();
+
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:NSManagedObjectContextObjectsDidChangeNotification object:context queue:nil usingBlock:^(NSNotification *notification) {
+        if (timeToFirstObject < 0.0 && [notification.userInfo[NSInsertedObjectsKey] count] + [notification.userInfo[NSUpdatedObjectsKey] count] + [notification.userInfo[NSRefreshedObjectsKey] count] > 0) {
+            timeToFirstObject = CBRInstrumentationTimestamp() - start;
+        }
+    }];
+
+    [watchdog start];
+    operation(^{
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:60.0 handler:nil];
+
+    NSTimeInterval duration = CBRInstrumentationTimestamp() - start;
+    [watchdog stop];
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+    NSDictionary *metrics = self.aggregator.snapshot[@"metrics"];
+    NSLog(@"[CBRSyncBenchmark] %@: %.3fs wall clock, %.3fs to first object, %.3fs main thread blocked, %lu requests, %llu bytes sent, %llu bytes received, transaction p50 %.4fs p99 %.4fs, queue wait p99 %.4fs, main thread handoff p99 %.4fs",
+          name,
+          duration,
+          timeToFirstObject,
+          watchdog.blockedTime,
+          (unsigned long)self.server.requestCount,
+          self.server.bytesReceived,
+          self.server.bytesSent,
+          [metrics[CBRMetricTransactionDuration][@"p50"] doubleValue],
+          [metrics[CBRMetricTransactionDuration][@"p99"] doubleValue],
+          [metrics[CBRMetricQueueWaitDuration][@"p99"] doubleValue],
+          [metrics[CBRMetricMainThreadHandoffDuration][@"p99"] doubleValue]);
+}
+
+- (void)_fetchPagesOfPath:(NSString *)path startingAtPage:(NSUInteger)page completion:(dispatch_block_t)completion
+{
+    NSString *pagePath = [NSString stringWithFormat:@"%@?page=%lu", path, (unsigned long)page];
+
+    [SLEntity6 fetchObjectsFromPath:pagePath withCompletionHandler:^(NSArray *fetchedObjects, NSError *error) {
+        NSAssert(error == nil, @"error fetching page %@: %@", pagePath, error);
+
+        if (fetchedObjects.count < self.server.pageSize) {
+            completion();
+            return;
+        }
+
+        [self _fetchPagesOfPath:path startingAtPage:page + 1 completion:completion];
+    }];
+}
+
+- (NSArray<SLEntity6 *> *)_insertEntitiesWithCount:(NSUInteger)count
+{
+    NSManagedObjectContext *context = self.stack.mainThreadManagedObjectContext;
+    NSString *padding = [@"" stringByPaddingToLength:self.server.payloadSize withString:@"x" startingAtIndex:0];
+    NSMutableArray *entities = [NSMutableArray arrayWithCapacity:count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        SLEntity6 *entity = [NSEntityDescription insertNewObjectForEntityForName:NSStringFromClass([SLEntity6 class]) inManagedObjectContext:context];
+        entity.name = padding;
+        [entities addObject:entity];
+    }
+
+    [context save:NULL];
+    return entities;
+}
+
+@end
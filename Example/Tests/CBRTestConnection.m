@@ -18,6 +18,11 @@
     return @"identifier";
 }
 
+- (id)primaryKeyOfRelationship:(CBRRelationshipDescription *)relationshipDescription inCloudObject:(id<CBRCloudObject>)cloudObject
+{
+    return cloudObject[[relationshipDescription.name stringByAppendingString:@"Identifier"]];
+}
+
 - (id<CBRCloudObject>)cloudObjectFromPersistentObject:(id<CBRPersistentObject>)persistentObject
 {
     NSMutableDictionary *cloudObject = [NSMutableDictionary dictionary];
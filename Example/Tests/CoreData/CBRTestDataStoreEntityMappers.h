@@ -0,0 +1,18 @@
+//
+//  CBRTestDataStoreEntityMappers.h
+//  CloudBridge
+//
+//  Generated by cbr-generate-mappers from CBRTestDataStore.xcdatamodeld, do not edit.
+//
+
+#import <CloudBridge/CloudBridge.h>
+#import <CloudBridge/CBRRESTConnection.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Registers the generated mapper of every entity of `entitiesByName` with `transformer`, returns the number of registered mappers.
+ */
+FOUNDATION_EXTERN NSUInteger CBRTestDataStoreRegisterEntityMappers(CBRJSONDictionaryTransformer *transformer, NSDictionary<NSString *, CBREntityDescription *> *entitiesByName);
+
+NS_ASSUME_NONNULL_END
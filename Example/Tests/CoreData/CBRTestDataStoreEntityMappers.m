@@ -0,0 +1,1386 @@
+//
+//  CBRTestDataStoreEntityMappers.m
+//  CloudBridge
+//
+//  Generated by cbr-generate-mappers from CBRTestDataStore.xcdatamodeld, do not edit.
+//
+
+#import "CBRTestDataStoreEntityMappers.h"
+
+
+
+@protocol _CBRTestDataStoreJSONEntity1Attributes <NSObject>
+
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, strong) id dictionary;
+@property (nonatomic, strong) NSNumber *floatNumber;
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *otherString;
+@property (nonatomic, strong) NSString *string;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreJSONEntity1Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreJSONEntity1Mapper
+
+- (NSString *)entityName
+{
+    return @"JSONEntity1";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"date": @"date",
+        @"dictionary": @"dictionary",
+        @"floatNumber": @"float_number",
+        @"identifier": @"id",
+        @"otherString": @"some_dictionary.string_value",
+        @"string": @"string",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreJSONEntity1Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"date"];
+    if (cloudValue) {
+        NSDate *newValue = [cloudValue isKindOfClass:[NSString class]] ? [transformer.dateFormatter dateFromString:cloudValue] : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.date)) {
+            object.date = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"dictionary"];
+    if (cloudValue) {
+        id newValue = [cloudValue isKindOfClass:[NSNull class]] ? nil : cloudValue;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.dictionary)) {
+            object.dictionary = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"float_number"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.floatNumber)) {
+            object.floatNumber = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = [cloudObject valueForKeyPath:@"some_dictionary.string_value"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.otherString)) {
+            object.otherString = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"string"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.string)) {
+            object.string = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreJSONEntity1Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.date;
+    if (value) {
+        id cloudValue = [transformer.dateFormatter stringFromDate:value];
+        if (cloudValue) {
+            cloudObject[@"date"] = cloudValue;
+        }
+    }
+
+    value = object.dictionary;
+    if (value) {
+        cloudObject[@"dictionary"] = value;
+    }
+
+    value = object.floatNumber;
+    if (value) {
+        cloudObject[@"float_number"] = value;
+    }
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.otherString;
+    if (value) {
+        CBREntityMapperSetCloudValue(cloudObject, value, @[ @"some_dictionary", @"string_value" ]);
+    }
+
+    value = object.string;
+    if (value) {
+        cloudObject[@"string"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreOfflineEntityAttributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *hasPendingCloudBridgeChanges;
+@property (nonatomic, strong) NSNumber *hasPendingCloudBridgeDeletion;
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreOfflineEntityMapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreOfflineEntityMapper
+
+- (NSString *)entityName
+{
+    return @"OfflineEntity";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"hasPendingCloudBridgeChanges": @"has_pending_cloud_bridge_changes",
+        @"hasPendingCloudBridgeDeletion": @"has_pending_cloud_bridge_deletion",
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreOfflineEntityAttributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"has_pending_cloud_bridge_changes"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.hasPendingCloudBridgeChanges)) {
+            object.hasPendingCloudBridgeChanges = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"has_pending_cloud_bridge_deletion"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.hasPendingCloudBridgeDeletion)) {
+            object.hasPendingCloudBridgeDeletion = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreOfflineEntityAttributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.hasPendingCloudBridgeChanges;
+    if (value) {
+        id cloudValue = [value boolValue] ? @YES : @NO;
+        if (cloudValue) {
+            cloudObject[@"has_pending_cloud_bridge_changes"] = cloudValue;
+        }
+    }
+
+    value = object.hasPendingCloudBridgeDeletion;
+    if (value) {
+        id cloudValue = [value boolValue] ? @YES : @NO;
+        if (cloudValue) {
+            cloudObject[@"has_pending_cloud_bridge_deletion"] = cloudValue;
+        }
+    }
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreOnlyOnlineEntityAttributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreOnlyOnlineEntityMapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreOnlyOnlineEntityMapper
+
+- (NSString *)entityName
+{
+    return @"OnlyOnlineEntity";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreOnlyOnlineEntityAttributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreOnlyOnlineEntityAttributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStorePrefixedEntitiyAttributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStorePrefixedEntitiyMapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStorePrefixedEntitiyMapper
+
+- (NSString *)entityName
+{
+    return @"PrefixedEntitiy";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+        @"name": @"name",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStorePrefixedEntitiyAttributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"name"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.name)) {
+            object.name = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStorePrefixedEntitiyAttributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.name;
+    if (value) {
+        cloudObject[@"name"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity2Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSString *unregisteredAttribute;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity2Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity2Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity2";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+        @"name": @"name",
+        @"unregisteredAttribute": @"unregistered_attribute",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity2Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"name"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.name)) {
+            object.name = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"unregistered_attribute"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.unregisteredAttribute)) {
+            object.unregisteredAttribute = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity2Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.name;
+    if (value) {
+        cloudObject[@"name"] = value;
+    }
+
+    value = object.unregisteredAttribute;
+    if (value) {
+        cloudObject[@"unregistered_attribute"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity3Attributes <NSObject>
+
+@property (nonatomic, strong) NSString *someValue;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity3Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity3Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity3";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"someValue": @"some_value",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity3Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"some_value"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.someValue)) {
+            object.someValue = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity3Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.someValue;
+    if (value) {
+        cloudObject[@"some_value"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity4Attributes <NSObject>
+
+@property (nonatomic, strong) id array;
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSNumber *number;
+@property (nonatomic, strong) NSString *string;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity4Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity4Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity4";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"array": @"array",
+        @"date": @"date",
+        @"identifier": @"id",
+        @"number": @"number",
+        @"string": @"string",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity4Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"array"];
+    if (cloudValue) {
+        id newValue = [cloudValue isKindOfClass:[NSNull class]] ? nil : cloudValue;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.array)) {
+            object.array = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"date"];
+    if (cloudValue) {
+        NSDate *newValue = [cloudValue isKindOfClass:[NSString class]] ? [transformer.dateFormatter dateFromString:cloudValue] : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.date)) {
+            object.date = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"number"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.number)) {
+            object.number = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"string"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.string)) {
+            object.string = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity4Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.array;
+    if (value) {
+        cloudObject[@"array"] = value;
+    }
+
+    value = object.date;
+    if (value) {
+        id cloudValue = [transformer.dateFormatter stringFromDate:value];
+        if (cloudValue) {
+            cloudObject[@"date"] = cloudValue;
+        }
+    }
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.number;
+    if (value) {
+        cloudObject[@"number"] = value;
+    }
+
+    value = object.string;
+    if (value) {
+        cloudObject[@"string"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Attributes <NSObject>
+
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, strong) id dictionary;
+@property (nonatomic, strong) NSNumber *floatNumber;
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *otherString;
+@property (nonatomic, strong) NSString *string;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"date": @"date",
+        @"dictionary": @"dictionary",
+        @"floatNumber": @"float_number",
+        @"identifier": @"id",
+        @"otherString": @"some_dictionary.string_value",
+        @"string": @"string",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"date"];
+    if (cloudValue) {
+        NSDate *newValue = [cloudValue isKindOfClass:[NSString class]] ? [transformer.dateFormatter dateFromString:cloudValue] : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.date)) {
+            object.date = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"dictionary"];
+    if (cloudValue) {
+        id newValue = [cloudValue isKindOfClass:[NSNull class]] ? nil : cloudValue;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.dictionary)) {
+            object.dictionary = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"float_number"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.floatNumber)) {
+            object.floatNumber = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = [cloudObject valueForKeyPath:@"some_dictionary.string_value"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.otherString)) {
+            object.otherString = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"string"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.string)) {
+            object.string = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.date;
+    if (value) {
+        id cloudValue = [transformer.dateFormatter stringFromDate:value];
+        if (cloudValue) {
+            cloudObject[@"date"] = cloudValue;
+        }
+    }
+
+    value = object.dictionary;
+    if (value) {
+        cloudObject[@"dictionary"] = value;
+    }
+
+    value = object.floatNumber;
+    if (value) {
+        cloudObject[@"float_number"] = value;
+    }
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.otherString;
+    if (value) {
+        CBREntityMapperSetCloudValue(cloudObject, value, @[ @"some_dictionary", @"string_value" ]);
+    }
+
+    value = object.string;
+    if (value) {
+        cloudObject[@"string"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child1Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child1Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child1Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child1";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child1Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child1Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child2Attributes <NSObject>
+
+@property (nonatomic, strong) NSString *uniqueString;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child2Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child2Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child2";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"uniqueString": @"unique_str",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child2Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"unique_str"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.uniqueString)) {
+            object.uniqueString = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child2Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.uniqueString;
+    if (value) {
+        cloudObject[@"unique_str"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child3Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child3Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child3Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child3";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child3Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child3Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child4Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSNumber *parentIdentifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child4Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child4Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child4";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+        @"parentIdentifier": @"parent_id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child4Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"parent_id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.parentIdentifier)) {
+            object.parentIdentifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child4Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.parentIdentifier;
+    if (value) {
+        cloudObject[@"parent_id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child5Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child5Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child5Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child5";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child5Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child5Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5Child6Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *fooIdentifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5Child6Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5Child6Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Child6";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"fooIdentifier": @"foo_id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child6Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"foo_id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.fooIdentifier)) {
+            object.fooIdentifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5Child6Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.fooIdentifier;
+    if (value) {
+        cloudObject[@"foo_id"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity5SubclassAttributes <NSObject>
+
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, strong) id dictionary;
+@property (nonatomic, strong) NSNumber *floatNumber;
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *otherString;
+@property (nonatomic, strong) NSString *string;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity5SubclassMapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity5SubclassMapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity5Subclass";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"date": @"date",
+        @"dictionary": @"dictionary",
+        @"floatNumber": @"float_number",
+        @"identifier": @"id",
+        @"otherString": @"some_dictionary.string_value",
+        @"string": @"string",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5SubclassAttributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"date"];
+    if (cloudValue) {
+        NSDate *newValue = [cloudValue isKindOfClass:[NSString class]] ? [transformer.dateFormatter dateFromString:cloudValue] : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.date)) {
+            object.date = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"dictionary"];
+    if (cloudValue) {
+        id newValue = [cloudValue isKindOfClass:[NSNull class]] ? nil : cloudValue;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.dictionary)) {
+            object.dictionary = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"float_number"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.floatNumber)) {
+            object.floatNumber = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = [cloudObject valueForKeyPath:@"some_dictionary.string_value"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.otherString)) {
+            object.otherString = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"string"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.string)) {
+            object.string = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity5SubclassAttributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.date;
+    if (value) {
+        id cloudValue = [transformer.dateFormatter stringFromDate:value];
+        if (cloudValue) {
+            cloudObject[@"date"] = cloudValue;
+        }
+    }
+
+    value = object.dictionary;
+    if (value) {
+        cloudObject[@"dictionary"] = value;
+    }
+
+    value = object.floatNumber;
+    if (value) {
+        cloudObject[@"float_number"] = value;
+    }
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.otherString;
+    if (value) {
+        CBREntityMapperSetCloudValue(cloudObject, value, @[ @"some_dictionary", @"string_value" ]);
+    }
+
+    value = object.string;
+    if (value) {
+        cloudObject[@"string"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity6Attributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity6Mapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity6Mapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity6";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+        @"name": @"name",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity6Attributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+
+    cloudValue = cloudObject[@"name"];
+    if (cloudValue) {
+        NSString *newValue = [cloudValue isKindOfClass:[NSString class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.name)) {
+            object.name = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity6Attributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+
+    value = object.name;
+    if (value) {
+        cloudObject[@"name"] = value;
+    }
+}
+
+@end
+
+
+@protocol _CBRTestDataStoreSLEntity6ChildAttributes <NSObject>
+
+@property (nonatomic, strong) NSNumber *identifier;
+
+@end
+
+
+__attribute__((objc_subclassing_restricted))
+@interface CBRTestDataStoreSLEntity6ChildMapper : NSObject <CBREntityMapper>
+@end
+
+
+
+@implementation CBRTestDataStoreSLEntity6ChildMapper
+
+- (NSString *)entityName
+{
+    return @"SLEntity6Child";
+}
+
+- (NSDictionary<NSString *, NSString *> *)cloudKeyPathsByAttributeName
+{
+    return @{
+        @"identifier": @"id",
+    };
+}
+
+- (void)updatePersistentObject:(id<CBRPersistentObject>)persistentObject withAttributesFromCloudObject:(NSDictionary *)cloudObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity6ChildAttributes> object = (id)persistentObject;
+    id cloudValue = nil;
+
+    cloudValue = cloudObject[@"id"];
+    if (cloudValue) {
+        NSNumber *newValue = [cloudValue isKindOfClass:[NSNumber class]] ? cloudValue : nil;
+        if (CBREntityMapperShouldUpdateValue(cloudValue, newValue, object.identifier)) {
+            object.identifier = newValue;
+        }
+    }
+}
+
+- (void)updateCloudObject:(NSMutableDictionary *)cloudObject withAttributesFromPersistentObject:(id<CBRPersistentObject>)persistentObject transformer:(CBRJSONDictionaryTransformer *)transformer
+{
+    id<_CBRTestDataStoreSLEntity6ChildAttributes> object = (id)persistentObject;
+    id value = nil;
+
+    value = object.identifier;
+    if (value) {
+        cloudObject[@"id"] = value;
+    }
+}
+
+@end
+
+
+NSUInteger CBRTestDataStoreRegisterEntityMappers(CBRJSONDictionaryTransformer *transformer, NSDictionary<NSString *, CBREntityDescription *> *entitiesByName)
+{
+    NSArray<id<CBREntityMapper>> *entityMappers = @[
+        [[CBRTestDataStoreJSONEntity1Mapper alloc] init],
+        [[CBRTestDataStoreOfflineEntityMapper alloc] init],
+        [[CBRTestDataStoreOnlyOnlineEntityMapper alloc] init],
+        [[CBRTestDataStorePrefixedEntitiyMapper alloc] init],
+        [[CBRTestDataStoreSLEntity2Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity3Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity4Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child1Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child2Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child3Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child4Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child5Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5Child6Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity5SubclassMapper alloc] init],
+        [[CBRTestDataStoreSLEntity6Mapper alloc] init],
+        [[CBRTestDataStoreSLEntity6ChildMapper alloc] init],
+    ];
+
+    NSUInteger count = 0;
+    for (id<CBREntityMapper> entityMapper in entityMappers) {
+        CBREntityDescription *entity = entitiesByName[entityMapper.entityName];
+        if (entity && [transformer registerEntityMapper:entityMapper forEntity:entity]) {
+            count++;
+        }
+    }
+
+    return count;
+}
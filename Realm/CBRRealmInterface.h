@@ -53,6 +53,21 @@ __attribute__((objc_subclassing_restricted))
 
 - (CBRPersistentObjectCache *)cacheForRealm:(RLMRealm *)realm;
 
+/**
+ Opens the realm and runs pending migrations in the background, `completionHandler` is called on the main queue once `realm` is available there without blocking.
+ */
+- (void)openRealmWithCompletionHandler:(nullable void(^)(NSError * _Nullable error))completionHandler;
+
+/**
+ Runs `block` as one bulk ingest in a single write transaction. Objects created or saved through this interface during `block` are collected and upserted with `addOrUpdateObjects:` keyed on their primary key, deletions are collected and applied before the upserts, everything is committed once. Objects created during an ingest become visible to queries once it finishes, lookups by value through `CBRPersistentObjectCache` already find them while it runs. Nested ingests join the outer one. If `block` throws, the ingest is discarded and a write transaction started by this call is cancelled.
+ */
+- (BOOL)ingestWithBlock:(NS_NOESCAPE dispatch_block_t)block error:(NSError **)error;
+
+/**
+ Realm files can only be compacted while no realm is open. Compaction is requested for the next launch, where `shouldCompactOnLaunch` of `configuration` compacts the file if it is still fragmented.
+ */
+- (BOOL)compactStoreIfFragmentationExceeds:(double)threshold error:(NSError **)error;
+
 @end
 
 
@@ -23,14 +23,18 @@
 
 #import <Realm/Realm.h>
 #import <objc/runtime.h>
+#import <pthread.h>
+#import <stdatomic.h>
 
 #import "CBRPersistentObjectChange.h"
+#import "CBRCoalescedNotificationToken.h"
 #import "CBRRealmInterface.h"
 #import "CBRCloudBridge.h"
 #import "CBREntityDescription.h"
 #import "CBRThreadingEnvironment.h"
 #import "CBREntityDescription+Realm.h"
 #import "RLMResults+CloudBridge.h"
+#import "CBRRealmResultsArray.h"
 
 static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSelector)
 {
@@ -67,7 +71,7 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 @interface _RLMResultNotificationToken : NSObject <CBRNotificationToken>
 
-@property (nonatomic, strong) NSArray *allObjects;
+@property (nonatomic, strong, readonly) NSArray *allObjects;
 
 @property (nonatomic, readonly) RLMResults *results;
 @property (nonatomic, readonly) RLMNotificationToken *token;
@@ -79,23 +83,21 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 - (NSInteger)count
 {
-    return self.allObjects.count;
+    return self.results.count;
 }
 
-- (instancetype)initWithResults:(RLMResults *)results predicate:(NSPredicate *)predicate observer:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))observer
+- (instancetype)initWithResults:(RLMResults *)results predicate:(NSPredicate *)predicate batchSize:(NSUInteger)batchSize observer:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))observer
 {
     if (self = [super init]) {
         _results = results;
-        _allObjects = results.allObjects;
+        _allObjects = [[CBRRealmResultsArray alloc] initWithResults:results offset:0 limit:0 batchSize:batchSize];
 
         __weak typeof(self) weakSelf = self;
         _token = [results addNotificationBlock:^(RLMResults * _Nullable results, RLMCollectionChange * _Nullable change, NSError * _Nullable error) {
             __strong typeof(self) self = weakSelf;
             assert(error == nil);
 
-            self.allObjects = results.allObjects;
-
-            if (change != nil) {
+            if (change != nil && self.allObjects != nil) {
                 observer(self.allObjects, [[CBRPersistentObjectChange alloc] initWithDeletions:change.deletions insertions:change.insertions updates:change.modifications]);
             }
         }];
@@ -114,7 +116,162 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 - (id)objectAtIndexedSubscript:(NSUInteger)idx
 {
-    return [self.allObjects objectAtIndexedSubscript:idx];
+    return [self.results objectAtIndex:idx];
+}
+
+@end
+
+
+
+@interface _CBRRealmBulkIngest : NSObject
+
+@property (nonatomic, readonly) NSMutableArray<CBRRealmObject *> *objectsToAddOrUpdate;
+@property (nonatomic, readonly) NSMutableArray<CBRRealmObject *> *objectsToDelete;
+
+- (void)addOrUpdateObject:(CBRRealmObject *)object;
+- (void)deleteObject:(CBRRealmObject *)object;
+
+/**
+ Pending objects of `className` whose `attribute` is one of `values`.
+ */
+- (NSArray<CBRRealmObject *> *)pendingObjectsOfClassName:(NSString *)className withValues:(id<NSFastEnumeration>)values forAttribute:(NSString *)attribute;
+
+- (void)applyToRealm:(RLMRealm *)realm;
+
+@end
+
+@interface _CBRRealmBulkIngestIndex : NSObject
+
+@property (nonatomic, readonly) NSMutableDictionary<id, CBRRealmObject *> *objectsByValue;
+@property (nonatomic, readonly) NSMutableArray<CBRRealmObject *> *unresolvedObjects;
+@property (nonatomic, assign) NSUInteger numberOfIndexedObjects;
+
+@end
+
+@implementation _CBRRealmBulkIngestIndex
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _objectsByValue = [NSMutableDictionary dictionary];
+        _unresolvedObjects = [NSMutableArray array];
+    }
+    return self;
+}
+
+@end
+
+@implementation _CBRRealmBulkIngest {
+    NSHashTable<CBRRealmObject *> *_pendingObjects;
+    NSHashTable<CBRRealmObject *> *_deletedObjects;
+
+    // every object ever added, in order, indexes pick up new objects from here
+    NSMutableArray<CBRRealmObject *> *_addedObjects;
+    NSMutableDictionary<NSString *, _CBRRealmBulkIngestIndex *> *_indexes;
+}
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _objectsToAddOrUpdate = [NSMutableArray array];
+        _objectsToDelete = [NSMutableArray array];
+
+        _pendingObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality capacity:0];
+        _deletedObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality capacity:0];
+
+        _addedObjects = [NSMutableArray array];
+        _indexes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)addOrUpdateObject:(CBRRealmObject *)object
+{
+    if (![_pendingObjects containsObject:object]) {
+        [_pendingObjects addObject:object];
+        [_objectsToAddOrUpdate addObject:object];
+        [_addedObjects addObject:object];
+    }
+}
+
+- (NSArray<CBRRealmObject *> *)pendingObjectsOfClassName:(NSString *)className withValues:(id<NSFastEnumeration>)values forAttribute:(NSString *)attribute
+{
+    NSString *key = [NSString stringWithFormat:@"%@#%@", className, attribute];
+    _CBRRealmBulkIngestIndex *index = _indexes[key];
+    if (!index) {
+        index = [[_CBRRealmBulkIngestIndex alloc] init];
+        _indexes[key] = index;
+    }
+
+    Class klass = NSClassFromString(className);
+    for (NSUInteger i = index.numberOfIndexedObjects; i < _addedObjects.count; i++) {
+        if ([_addedObjects[i] isKindOfClass:klass]) {
+            [index.unresolvedObjects addObject:_addedObjects[i]];
+        }
+    }
+    index.numberOfIndexedObjects = _addedObjects.count;
+
+    // objects are created before their attributes are mapped, so they are indexed once the attribute has a value
+    NSMutableArray<CBRRealmObject *> *unresolvedObjects = [NSMutableArray array];
+    for (CBRRealmObject *object in index.unresolvedObjects) {
+        id value = [object valueForKeyPath:attribute];
+
+        if (!value) {
+            [unresolvedObjects addObject:object];
+        } else if (!index.objectsByValue[value]) {
+            index.objectsByValue[value] = object;
+        }
+    }
+    [index.unresolvedObjects setArray:unresolvedObjects];
+
+    NSMutableArray<CBRRealmObject *> *result = [NSMutableArray array];
+    for (id value in values) {
+        CBRRealmObject *object = index.objectsByValue[value];
+
+        if (object && [_pendingObjects containsObject:object] && [[object valueForKeyPath:attribute] isEqual:value]) {
+            [result addObject:object];
+        }
+    }
+
+    return result;
+}
+
+- (void)deleteObject:(CBRRealmObject *)object
+{
+    if ([_pendingObjects containsObject:object]) {
+        [_pendingObjects removeObject:object];
+        [_objectsToAddOrUpdate removeObjectIdenticalTo:object];
+    } else if (object.realm != nil && ![_deletedObjects containsObject:object]) {
+        [_deletedObjects addObject:object];
+        [_objectsToDelete addObject:object];
+    }
+}
+
+- (void)applyToRealm:(RLMRealm *)realm
+{
+    if (self.objectsToDelete.count > 0) {
+        [realm deleteObjects:self.objectsToDelete];
+    }
+
+    NSMutableDictionary<NSString *, NSMutableArray<CBRRealmObject *> *> *objectsByClassName = [NSMutableDictionary dictionary];
+    for (CBRRealmObject *object in self.objectsToAddOrUpdate) {
+        NSString *className = [object.class className];
+        if (!objectsByClassName[className]) {
+            objectsByClassName[className] = [NSMutableArray array];
+        }
+
+        [objectsByClassName[className] addObject:object];
+    }
+
+    for (NSString *className in objectsByClassName) {
+        NSArray<CBRRealmObject *> *objects = objectsByClassName[className];
+
+        if ([objects.firstObject.class primaryKey] != nil) {
+            [realm addOrUpdateObjects:objects];
+        } else {
+            [realm addObjects:objects];
+        }
+    }
 }
 
 @end
@@ -189,8 +346,87 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 
 
+/**
+ Realm and cache of one interface on one thread.
+ */
+@interface _CBRRealmThreadSlot : NSObject
+
+@property (nonatomic, weak, readonly) CBRRealmInterface *interface;
+@property (nonatomic, readonly) RLMRealm *realm;
+@property (nonatomic, readonly) CBRPersistentObjectCache *cache;
+
+@end
+
+@implementation _CBRRealmThreadSlot
+
+- (instancetype)initWithInterface:(CBRRealmInterface *)interface realm:(RLMRealm *)realm
+{
+    if (self = [super init]) {
+        _interface = interface;
+        _realm = realm;
+        _cache = [interface cacheForRealm:realm];
+    }
+    return self;
+}
+
+@end
+
+
+
+/**
+ Thread local slots of all interfaces, the slot of the last used interface is remembered for a lookup without hashing.
+ */
+@interface _CBRRealmThreadSlots : NSObject {
+    @public
+    uint64_t _lastIdentifier;
+    __unsafe_unretained _CBRRealmThreadSlot *_lastSlot;
+}
+
+@property (nonatomic, readonly) NSMutableDictionary<NSNumber *, _CBRRealmThreadSlot *> *slotsByIdentifier;
+
+@end
+
+@implementation _CBRRealmThreadSlots
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _slotsByIdentifier = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+@end
+
+static pthread_key_t CBRRealmThreadSlotsKey;
+
+static void CBRRealmThreadSlotsDestructor(void *slots)
+{
+    CFRelease(slots);
+}
+
+static _CBRRealmThreadSlots *CBRRealmThreadSlotsGetCurrent(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&CBRRealmThreadSlotsKey, CBRRealmThreadSlotsDestructor);
+    });
+
+    void *slots = pthread_getspecific(CBRRealmThreadSlotsKey);
+    if (slots == NULL) {
+        slots = (__bridge_retained void *)[[_CBRRealmThreadSlots alloc] init];
+        pthread_setspecific(CBRRealmThreadSlotsKey, slots);
+    }
+
+    return (__bridge _CBRRealmThreadSlots *)slots;
+}
+
+
+
 @interface CBRRealmInterface () <_CBRPersistentStoreInterfaceInternal>
 
+@property (nonatomic, readonly) uint64_t identifier;
+
 @end
 
 
@@ -200,17 +436,7 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 - (RLMRealm *)realm
 {
-    NSValue *value = [NSValue valueWithNonretainedObject:self];
-    if ([NSThread currentThread].threadDictionary[value]) {
-        return [NSThread currentThread].threadDictionary[value];
-    }
-
-    NSError *error = nil;
-    RLMRealm *realm = [RLMRealm realmWithConfiguration:self.configuration error:&error];
-    assert(realm != nil);
-
-    [NSThread currentThread].threadDictionary[value] = realm;
-    return realm;
+    return [self _threadSlot].realm;
 }
 
 - (instancetype)init
@@ -221,17 +447,28 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 - (instancetype)initWithConfiguration:(RLMRealmConfiguration *)configuration
 {
     if (self = [super init]) {
-        _configuration = configuration;
+        static _Atomic(uint64_t) identifier = 0;
+        _identifier = atomic_fetch_add(&identifier, 1) + 1;
+
+        _configuration = [self _configurationCompactingOnLaunch:configuration];
+
+        // a cached schema spares opening the realm until it is first used
+        NSString *schemaCacheKey = [self _schemaCacheKey];
+        NSArray<CBREntityDescription *> *cachedEntities = [CBREntityDescription cachedEntitiesForKey:schemaCacheKey interface:self];
 
         NSMutableArray<CBREntityDescription *> *entities = [NSMutableArray array];
 
-        for (Class klass in self.configuration.objectClasses) {
-            NSString *name = [klass className];
+        if (cachedEntities != nil) {
+            [entities addObjectsFromArray:cachedEntities];
+        } else {
+            for (Class klass in self.configuration.objectClasses) {
+                NSString *name = [klass className];
 
-            RLMObjectSchema *schema = self.realm.schema[name];
-            CBREntityDescription *result = [[CBREntityDescription alloc] initWithInterface:self realmObjectSchema:schema];
+                RLMObjectSchema *schema = self.realm.schema[name];
+                CBREntityDescription *result = [[CBREntityDescription alloc] initWithInterface:self realmObjectSchema:schema];
 
-            [entities addObject:result];
+                [entities addObject:result];
+            }
         }
 
         _entities = entities.copy;
@@ -242,17 +479,28 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
         }
         _entitiesByName = entitiesByName.copy;
 
-        for (CBREntityDescription *description in _entities) {
-            for (CBRRelationshipDescription *relationship in description.relationships) {
-                [relationship _realmUpdateUserInfo];
+        if (cachedEntities == nil) {
+            for (CBREntityDescription *description in _entities) {
+                for (CBRRelationshipDescription *relationship in description.relationships) {
+                    [relationship _realmUpdateUserInfo];
+                }
             }
+
+            [CBREntityDescription cacheEntities:_entities forKey:schemaCacheKey];
         }
+
+        [_entities makeObjectsPerformSelector:@selector(freeze)];
     }
     return self;
 }
 
 - (CBRPersistentObjectCache *)cacheForRealm:(RLMRealm *)realm
 {
+    _CBRRealmThreadSlots *slots = CBRRealmThreadSlotsGetCurrent();
+    if (slots->_lastIdentifier == _identifier && slots->_lastSlot.realm == realm) {
+        return slots->_lastSlot.cache;
+    }
+
     @synchronized (realm) {
         if (objc_getAssociatedObject(realm, _cmd)) {
             return objc_getAssociatedObject(realm, _cmd);
@@ -264,6 +512,62 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
     }
 }
 
+- (void)openRealmWithCompletionHandler:(void(^)(NSError * _Nullable error))completionHandler
+{
+    [RLMRealm asyncOpenWithConfiguration:self.configuration callbackQueue:dispatch_get_main_queue() callback:^(RLMRealm * _Nullable realm, NSError * _Nullable error) {
+        if (realm != nil) {
+            // keeps the opened realm as the main thread's realm of this interface
+            [self _threadSlot];
+        }
+
+        if (completionHandler != nil) {
+            completionHandler(error);
+        }
+    }];
+}
+
+- (BOOL)ingestWithBlock:(dispatch_block_t)block error:(NSError **)error
+{
+    RLMRealm *realm = self.realm;
+    if ([self _bulkIngestInRealm:realm]) {
+        block();
+        return YES;
+    }
+
+    BOOL transactionOwner = NO;
+    if (!realm.inWriteTransaction) {
+        [realm beginWriteTransaction];
+        transactionOwner = YES;
+    }
+
+    _CBRRealmBulkIngest *bulkIngest = [[_CBRRealmBulkIngest alloc] init];
+    objc_setAssociatedObject(realm, @selector(_bulkIngestInRealm:), bulkIngest, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+
+    BOOL finished = NO;
+    @try {
+        block();
+        finished = YES;
+    } @finally {
+        objc_setAssociatedObject(realm, @selector(_bulkIngestInRealm:), nil, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+
+        if (!finished) {
+            // discarded objects must not be served by later lookups
+            CBRPersistentObjectCache *cache = [self cacheForRealm:realm];
+            for (CBRRealmObject *object in bulkIngest.objectsToAddOrUpdate) {
+                [cache removePersistentObject:object];
+            }
+        }
+
+        if (!finished && transactionOwner) {
+            [realm cancelWriteTransaction];
+        }
+    }
+
+    [bulkIngest applyToRealm:realm];
+
+    return transactionOwner ? [realm commitWriteTransaction:error] : YES;
+}
+
 #pragma mark - _CBRPersistentStoreInterfaceInternal
 
 - (BOOL)hasPersistedObjects:(NSArray<CBRRealmObject *> *)persistentObjects
@@ -279,7 +583,10 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
 - (BOOL)saveChangedForPersistentObject:(CBRRealmObject *)persistentObject error:(NSError **)error
 {
-    if (persistentObject.realm == nil) {
+    _CBRRealmBulkIngest *bulkIngest = [self _bulkIngestInRealm:self.realm];
+    if (persistentObject.realm == nil && bulkIngest != nil) {
+        [bulkIngest addOrUpdateObject:persistentObject];
+    } else if (persistentObject.realm == nil) {
         [self _transactionInRealm:self.realm block:^{
             [self.realm addObject:persistentObject];
         }];
@@ -304,12 +611,19 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
         results = [results sortedResultsUsingDescriptors:sortDescriptors];
     }
 
-    return [[_RLMResultNotificationToken alloc] initWithResults:results predicate:fetchRequest.predicate observer:block];
+    return [[_RLMResultNotificationToken alloc] initWithResults:results predicate:fetchRequest.predicate batchSize:fetchRequest.fetchBatchSize observer:block];
+}
+
+- (id<CBRNotificationToken>)changesWithFetchRequest:(NSFetchRequest *)fetchRequest coalescingInterval:(NSTimeInterval)interval block:(void(^)(NSArray *objects, CBRPersistentObjectChange *change))block
+{
+    return [[CBRCoalescedNotificationToken alloc] initWithInterval:interval block:block observe:^id<CBRNotificationToken>(void (^observer)(NSArray *objects, CBRPersistentObjectChange *change)) {
+        return [self changesWithFetchRequest:fetchRequest block:observer];
+    }];
 }
 
 - (CBRPersistentObjectCache *)persistentObjectCacheOnCurrentThreadForEntity:(CBREntityDescription *)entityDescription
 {
-    return [self cacheForRealm:self.realm];
+    return [self _threadSlot].cache;
 }
 
 - (void)beginWriteTransaction
@@ -362,6 +676,12 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
     CBRRealmObject *result = [[NSClassFromString(entityDescription.name) alloc] init];
 
+    _CBRRealmBulkIngest *bulkIngest = [self _bulkIngestInRealm:realm];
+    if (bulkIngest != nil) {
+        [bulkIngest addOrUpdateObject:result];
+        return result;
+    }
+
     [self _transactionInRealm:realm block:^{
         [realm addObject:result];
     }];
@@ -374,8 +694,32 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
     assert(self.entitiesByName[fetchRequest.entityName] != nil);
 
     RLMRealm *realm = self.realm;
+    NSArray *pendingObjects = [self _pendingObjectsForFetchRequest:fetchRequest inRealm:realm];
     RLMResults *results = [NSClassFromString(fetchRequest.entityName) objectsInRealm:realm withPredicate:fetchRequest.predicate];
 
+    if (pendingObjects.count > 0) {
+        // unsorted requests list pending objects first and only read committed objects up to the requested range
+        NSUInteger numberOfObjects = fetchRequest.fetchLimit > 0 && fetchRequest.sortDescriptors.count == 0 ? fetchRequest.fetchOffset + fetchRequest.fetchLimit : NSUIntegerMax;
+
+        NSMutableArray *objects = [pendingObjects mutableCopy];
+        for (id object in results) {
+            if (objects.count >= numberOfObjects) {
+                break;
+            }
+
+            [objects addObject:object];
+        }
+
+        if (fetchRequest.sortDescriptors.count > 0) {
+            [objects sortUsingDescriptors:fetchRequest.sortDescriptors];
+        }
+
+        NSUInteger offset = MIN(fetchRequest.fetchOffset, objects.count);
+        NSUInteger length = fetchRequest.fetchLimit > 0 ? MIN(fetchRequest.fetchLimit, objects.count - offset) : objects.count - offset;
+
+        return [objects subarrayWithRange:NSMakeRange(offset, length)];
+    }
+
     if (fetchRequest.sortDescriptors.count > 0) {
         NSMutableArray<RLMSortDescriptor *> *sortDescriptors = [NSMutableArray array];
         for (NSSortDescriptor *descriptor in fetchRequest.sortDescriptors) {
@@ -385,7 +729,7 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
         results = [results sortedResultsUsingDescriptors:sortDescriptors];
     }
 
-    return results.allObjects;
+    return [[CBRRealmResultsArray alloc] initWithResults:results offset:fetchRequest.fetchOffset limit:fetchRequest.fetchLimit batchSize:fetchRequest.fetchBatchSize];
 }
 
 - (void)deletePersistentObjects:(id<NSFastEnumeration>)persistentObjects
@@ -396,11 +740,155 @@ static void class_swizzleSelector(Class class, SEL originalSelector, SEL newSele
 
     RLMRealm *realm = self.realm;
 
+    _CBRRealmBulkIngest *bulkIngest = [self _bulkIngestInRealm:realm];
+    if (bulkIngest != nil) {
+        for (CBRRealmObject *object in persistentObjects) {
+            [bulkIngest deleteObject:object];
+        }
+        return;
+    }
+
+    if ([(id)persistentObjects isKindOfClass:[CBRRealmResultsArray class]]) {
+        // deleting objects shifts the remaining ones within a limited range, unbounded results are deleted as a whole
+        CBRRealmResultsArray *array = (CBRRealmResultsArray *)persistentObjects;
+        persistentObjects = array.isUnbounded ? array.results : [NSArray arrayWithArray:array];
+    }
+
     [self _transactionInRealm:realm block:^{
         [realm deleteObjects:persistentObjects];
     }];
 }
 
+- (BOOL)compactStoreIfFragmentationExceeds:(double)threshold error:(NSError **)error
+{
+    NSURL *compactionRequestURL = [self _compactionRequestURLForConfiguration:self.configuration];
+    if (compactionRequestURL == nil) {
+        return NO;
+    }
+
+    // the realm is open, fragmentation is measured and the file compacted when it is opened next
+    [@{ @"threshold": @(threshold) } writeToURL:compactionRequestURL atomically:YES];
+    return NO;
+}
+
+- (NSString *)_schemaCacheKey
+{
+    // the schema is derived from the compiled classes, a rebuilt binary invalidates it
+    NSMutableArray<NSString *> *components = [NSMutableArray arrayWithObjects:@"Realm", @(self.configuration.schemaVersion).stringValue, nil];
+    NSMutableSet<NSBundle *> *bundles = [NSMutableSet set];
+
+    for (Class klass in self.configuration.objectClasses) {
+        [components addObject:[klass className]];
+        [bundles addObject:[NSBundle bundleForClass:klass]];
+    }
+    [components sortUsingSelector:@selector(compare:)];
+
+    for (NSBundle *bundle in bundles) {
+        NSDate *modificationDate = nil;
+        [bundle.executableURL getResourceValue:&modificationDate forKey:NSURLContentModificationDateKey error:NULL];
+
+        [components addObject:[NSString stringWithFormat:@"%@@%@", bundle.executablePath, @(modificationDate.timeIntervalSince1970)]];
+    }
+
+    return [CBREntityDescription schemaCacheKeyWithComponents:components];
+}
+
+- (nullable NSURL *)_compactionRequestURLForConfiguration:(RLMRealmConfiguration *)configuration
+{
+    if (configuration.fileURL == nil || configuration.readOnly) {
+        return nil;
+    }
+
+    return [NSURL fileURLWithPath:[configuration.fileURL.path stringByAppendingString:@".compaction"]];
+}
+
+- (RLMRealmConfiguration *)_configurationCompactingOnLaunch:(RLMRealmConfiguration *)configuration
+{
+    NSURL *compactionRequestURL = [self _compactionRequestURLForConfiguration:configuration];
+    if (compactionRequestURL == nil || configuration.shouldCompactOnLaunch != nil) {
+        return configuration;
+    }
+
+    NSNumber *threshold = [NSDictionary dictionaryWithContentsOfURL:compactionRequestURL][@"threshold"];
+    if (threshold == nil) {
+        return configuration;
+    }
+
+    RLMRealmConfiguration *result = [configuration copy];
+    result.shouldCompactOnLaunch = ^BOOL(NSUInteger totalBytes, NSUInteger usedBytes) {
+        [[NSFileManager defaultManager] removeItemAtURL:compactionRequestURL error:NULL];
+        return totalBytes > 0 && (double)(totalBytes - usedBytes) / totalBytes > threshold.doubleValue;
+    };
+
+    return result;
+}
+
+- (_CBRRealmThreadSlot *)_threadSlot
+{
+    _CBRRealmThreadSlots *slots = CBRRealmThreadSlotsGetCurrent();
+    if (slots->_lastIdentifier == _identifier) {
+        return slots->_lastSlot;
+    }
+
+    NSNumber *identifier = @(_identifier);
+    _CBRRealmThreadSlot *slot = slots.slotsByIdentifier[identifier];
+
+    if (!slot) {
+        NSError *error = nil;
+        RLMRealm *realm = [RLMRealm realmWithConfiguration:self.configuration error:&error];
+        assert(realm != nil);
+
+        // slots of deallocated interfaces would otherwise keep their realms open until the thread exits
+        for (NSNumber *slotIdentifier in slots.slotsByIdentifier.allKeys) {
+            if (slots.slotsByIdentifier[slotIdentifier].interface == nil) {
+                [slots.slotsByIdentifier removeObjectForKey:slotIdentifier];
+            }
+        }
+
+        slot = [[_CBRRealmThreadSlot alloc] initWithInterface:self realm:realm];
+        slots.slotsByIdentifier[identifier] = slot;
+    }
+
+    slots->_lastIdentifier = _identifier;
+    slots->_lastSlot = slot;
+
+    return slot;
+}
+
+- (_CBRRealmBulkIngest *)_bulkIngestInRealm:(RLMRealm *)realm
+{
+    return objc_getAssociatedObject(realm, _cmd);
+}
+
+/**
+ Pending objects of a bulk ingest matching the `attribute == value` and `attribute IN values` lookups of `CBRPersistentObjectCache`, other predicates only see committed objects.
+ */
+- (NSArray *)_pendingObjectsForFetchRequest:(NSFetchRequest *)fetchRequest inRealm:(RLMRealm *)realm
+{
+    _CBRRealmBulkIngest *bulkIngest = [self _bulkIngestInRealm:realm];
+    if (bulkIngest == nil || bulkIngest.objectsToAddOrUpdate.count == 0 || ![fetchRequest.predicate isKindOfClass:[NSComparisonPredicate class]]) {
+        return nil;
+    }
+
+    NSComparisonPredicate *predicate = (NSComparisonPredicate *)fetchRequest.predicate;
+    if (predicate.leftExpression.expressionType != NSKeyPathExpressionType || predicate.rightExpression.expressionType != NSConstantValueExpressionType || predicate.comparisonPredicateModifier != NSDirectPredicateModifier) {
+        return nil;
+    }
+
+    id value = predicate.rightExpression.constantValue;
+    if (value == nil) {
+        return nil;
+    }
+
+    if (predicate.predicateOperatorType == NSEqualToPredicateOperatorType) {
+        return [bulkIngest pendingObjectsOfClassName:fetchRequest.entityName withValues:@[ value ] forAttribute:predicate.leftExpression.keyPath];
+    } else if (predicate.predicateOperatorType == NSInPredicateOperatorType && [value conformsToProtocol:@protocol(NSFastEnumeration)]) {
+        return [bulkIngest pendingObjectsOfClassName:fetchRequest.entityName withValues:value forAttribute:predicate.leftExpression.keyPath];
+    }
+
+    return nil;
+}
+
 - (void)_transactionInRealm:(RLMRealm *)realm block:(dispatch_block_t)block
 {
     BOOL transactionOwner = NO;
@@ -24,6 +24,7 @@
 #import <Realm/Realm.h>
 #import <Foundation/Foundation.h>
 #import <CoreData/NSFetchRequest.h>
+#import <CloudBridge/CBRRealmObjectCodec.h>
 
 
 
@@ -41,6 +42,11 @@ NS_REQUIRES_PROPERTY_DEFINITIONS
 + (nullable NSArray<NSString *> *)transformableProperties;
 + (nullable NSArray<NSString *> *)primitiveProperties;
 
+/**
+ Codec used to store a transformable property in its `<property>_Data` column, defaults to `CBRPropertyListCodec`. Values are encoded whenever they are set.
+ */
++ (id<CBRRealmObjectCodec>)codecForTransformableProperty:(NSString *)property;
+
 - (nullable id)primitiveValueForKey:(NSString *)key;
 - (void)setPrimitiveValue:(nullable id)value forKey:(NSString *)key;
 
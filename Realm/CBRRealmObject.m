@@ -37,6 +37,14 @@
 //    free(attributes);
 //}
 
+@interface CBRRealmObject ()
+
++ (NSSet<NSString *> *)_transformablePropertySet;
+
+@end
+
+
+
 @implementation CBRRealmObject
 
 + (BOOL)resolveInstanceMethod:(SEL)selector
@@ -136,6 +144,11 @@
     return result;
 }
 
++ (id<CBRRealmObjectCodec>)codecForTransformableProperty:(NSString *)property
+{
+    return [CBRPropertyListCodec sharedCodec];
+}
+
 + (nullable NSArray<NSString *> *)primitiveProperties
 {
     Class klass = NSClassFromString([self className]);
@@ -230,6 +243,12 @@
         return;
     }
 
+    NSSet<NSString *> *transformablePropertySet = [NSSet setWithArray:[self transformableProperties]];
+    IMP transformablePropertySetGetter = imp_implementationWithBlock(^NSSet<NSString *> *(Class klass) {
+        return transformablePropertySet;
+    });
+    class_addMethod(object_getClass(self), @selector(_transformablePropertySet), transformablePropertySetGetter, "@@:");
+
     for (NSString *property in [self primitiveProperties]) {
         IMP getter = imp_implementationWithBlock(^NSData *(id self) {
             return [self primitiveValueForKey:property];
@@ -245,15 +264,16 @@
 
     for (NSString *property in [self transformableProperties]) {
         NSString *backingProperty = [property stringByAppendingString:@"_Data"];
+        SEL backingKey = NSSelectorFromString(backingProperty);
 
         IMP getter = imp_implementationWithBlock(^NSData *(id self) {
-            return objc_getAssociatedObject(self, NSSelectorFromString(backingProperty));
+            return objc_getAssociatedObject(self, backingKey);
         });
-        BOOL success = class_addMethod(self, NSSelectorFromString(backingProperty), getter, "@@:");
+        BOOL success = class_addMethod(self, backingKey, getter, "@@:");
         assert(success);
 
         IMP setter = imp_implementationWithBlock(^(id self, NSData *data) {
-            objc_setAssociatedObject(self, NSSelectorFromString(backingProperty), data, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+            objc_setAssociatedObject(self, backingKey, data, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
         });
         NSArray *setterName = @[ @"set", [backingProperty substringToIndex:1].capitalizedString, [backingProperty substringFromIndex:1], @":" ];
         success = class_addMethod(self, NSSelectorFromString([setterName componentsJoinedByString:@""]), setter, "v@:@");
@@ -288,45 +308,42 @@
 
 - (nullable id)primitiveValueForKey:(NSString *)property
 {
-    if (objc_getAssociatedObject(self, NSSelectorFromString(property))) {
-        return objc_getAssociatedObject(self, NSSelectorFromString(property));
+    SEL key = NSSelectorFromString(property);
+    id value = objc_getAssociatedObject(self, key);
+
+    if (value != nil) {
+        return value;
     }
 
-    if ([[self.class transformableProperties] containsObject:property]) {
+    if ([[self.class _transformablePropertySet] containsObject:property]) {
         NSString *backingProperty = [property stringByAppendingString:@"_Data"];
 
         NSData *data = [self valueForKey:backingProperty];
         if (data != nil) {
-            NSError *error = nil;
-            id result = [NSKeyedUnarchiver unarchiveTopLevelObjectWithData:data error:&error];
-
-            if (error != nil) {
-                NSLog(@"[%@ - %@], error unarchiving: %@", [self class], property, error);
-            }
-
-            objc_setAssociatedObject(self, NSSelectorFromString(property), result, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+            value = [[self.class codecForTransformableProperty:property] valueFromData:data];
+            objc_setAssociatedObject(self, key, value, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
         }
-
-        return objc_getAssociatedObject(self, NSSelectorFromString(property));
     }
 
-    return nil;
+    return value;
 }
 
 - (void)setPrimitiveValue:(nullable id)value forKey:(NSString *)property
 {
     objc_setAssociatedObject(self, NSSelectorFromString(property), value, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
 
-    if ([[self.class transformableProperties] containsObject:property]) {
-        NSString *backingProperty = [property stringByAppendingString:@"_Data"];
-
-        if (value == nil) {
-            [self setValue:nil forKey:backingProperty];
-        } else {
-            NSData *data = [NSKeyedArchiver archivedDataWithRootObject:value];
-            [self setValue:data forKey:backingProperty];
-        }
+    if ([[self.class _transformablePropertySet] containsObject:property]) {
+        // encoded right away, other accessors of the row and queries on the backing column see the new value
+        NSData *data = value != nil ? [[self.class codecForTransformableProperty:property] dataFromValue:value] : nil;
+        [self setValue:data forKey:[property stringByAppendingString:@"_Data"]];
     }
 }
 
+#pragma mark - Private category implementation ()
+
++ (NSSet<NSString *> *)_transformablePropertySet
+{
+    return [NSSet set];
+}
+
 @end
@@ -0,0 +1,76 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRRealmObjectCodec.h"
+
+static const char CBRPropertyListCodecTag[4] = { 'C', 'B', 'R', 'P' };
+
+
+
+@implementation CBRPropertyListCodec
+
++ (instancetype)sharedCodec
+{
+    static CBRPropertyListCodec *codec = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        codec = [[CBRPropertyListCodec alloc] init];
+    });
+
+    return codec;
+}
+
+- (NSData *)dataFromValue:(id)value
+{
+    NSData *propertyList = [NSPropertyListSerialization dataWithPropertyList:value format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+    if (propertyList == nil) {
+        return [NSKeyedArchiver archivedDataWithRootObject:value];
+    }
+
+    NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(CBRPropertyListCodecTag) + propertyList.length];
+    [data appendBytes:CBRPropertyListCodecTag length:sizeof(CBRPropertyListCodecTag)];
+    [data appendData:propertyList];
+
+    return data;
+}
+
+- (id)valueFromData:(NSData *)data
+{
+    NSError *error = nil;
+    id result = nil;
+
+    if (data.length >= sizeof(CBRPropertyListCodecTag) && memcmp(data.bytes, CBRPropertyListCodecTag, sizeof(CBRPropertyListCodecTag)) == 0) {
+        NSData *propertyList = [NSData dataWithBytesNoCopy:(void *)((const char *)data.bytes + sizeof(CBRPropertyListCodecTag)) length:data.length - sizeof(CBRPropertyListCodecTag) freeWhenDone:NO];
+        result = [NSPropertyListSerialization propertyListWithData:propertyList options:NSPropertyListImmutable format:NULL error:&error];
+    } else {
+        result = [NSKeyedUnarchiver unarchiveTopLevelObjectWithData:data error:&error];
+    }
+
+    if (error != nil) {
+        NSLog(@"[%@] error decoding: %@", self, error);
+    }
+
+    return result;
+}
+
+@end
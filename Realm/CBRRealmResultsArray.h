@@ -0,0 +1,63 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import <Realm/Realm.h>
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Lazy `NSArray` over a range of `RLMResults`. Objects are read from the results on access, so the array reflects the results as they change and only costs memory for the objects that are actually read.
+
+ Unlike other `NSArray` instances the array is live: `count` and the objects at an index change with the results. Enumeration ends early if the results shrink while it runs. `copy` returns a regular `NSArray` holding the objects at the time of the call.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface CBRRealmResultsArray<ObjectType> : NSArray<ObjectType>
+
+@property (nonatomic, readonly) RLMResults<ObjectType> *results;
+
+/**
+ First index of `results` in this array.
+ */
+@property (nonatomic, readonly) NSUInteger offset;
+
+/**
+ Maximum number of objects, `0` for no limit.
+ */
+@property (nonatomic, readonly) NSUInteger limit;
+
+/**
+ Number of objects read ahead during fast enumeration, `0` reads as many objects as requested.
+ */
+@property (nonatomic, readonly) NSUInteger batchSize;
+
+/**
+ `YES` if the array contains all objects of `results`.
+ */
+@property (nonatomic, readonly, getter=isUnbounded) BOOL unbounded;
+
+- (instancetype)initWithResults:(RLMResults<ObjectType> *)results offset:(NSUInteger)offset limit:(NSUInteger)limit batchSize:(NSUInteger)batchSize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,124 @@
+/**
+ CloudBridge
+ Copyright (c) 2018 Layered Pieces gUG
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#import "CBRRealmResultsArray.h"
+
+
+
+@implementation CBRRealmResultsArray
+
+#pragma mark - Initialization
+
+- (instancetype)initWithResults:(RLMResults *)results offset:(NSUInteger)offset limit:(NSUInteger)limit batchSize:(NSUInteger)batchSize
+{
+    if (self = [super init]) {
+        _results = results;
+        _offset = offset;
+        _limit = limit;
+        _batchSize = batchSize;
+    }
+    return self;
+}
+
+#pragma mark - Instance methods
+
+- (BOOL)isUnbounded
+{
+    return self.offset == 0 && self.limit == 0;
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count
+{
+    NSUInteger count = self.results.count;
+    if (self.offset >= count) {
+        return 0;
+    }
+
+    count -= self.offset;
+    return self.limit > 0 ? MIN(count, self.limit) : count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+    if (index >= self.count) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)self.count];
+    }
+
+    return [self.results objectAtIndex:self.offset + index];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // the array itself changes with its results
+    return [[NSArray allocWithZone:zone] initWithArray:self];
+}
+
+- (NSUInteger)indexOfObject:(id)object
+{
+    NSUInteger index = [self.results indexOfObject:object];
+    if (index == NSNotFound || index < self.offset || index - self.offset >= self.count) {
+        return NSNotFound;
+    }
+
+    return index - self.offset;
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len
+{
+    // RLMResults enumerate a snapshot which stays valid while the enumerated objects are modified or deleted
+    if (self.isUnbounded) {
+        return [self.results countByEnumeratingWithState:state objects:buffer count:len];
+    }
+
+    if (state->state == 0) {
+        state->mutationsPtr = &state->extra[0];
+        state->extra[1] = self.count;
+    }
+
+    // objects deleted while enumerating shrink the results, enumeration ends at their current end
+    NSUInteger index = state->state;
+    NSUInteger end = MIN(state->extra[1], self.count);
+    if (index >= end) {
+        return 0;
+    }
+
+    NSUInteger count = MIN(end - index, self.batchSize > 0 ? MIN(len, self.batchSize) : len);
+
+    NSMutableArray *batch = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [batch addObject:[self.results objectAtIndex:self.offset + index + i]];
+    }
+
+    // accessors are created on demand, the batch keeps them alive until the surrounding autorelease pool drains
+    CFAutorelease(CFBridgingRetain(batch));
+    [batch getObjects:buffer range:NSMakeRange(0, count)];
+
+    state->state = index + count;
+    state->itemsPtr = buffer;
+
+    return count;
+}
+
+@end